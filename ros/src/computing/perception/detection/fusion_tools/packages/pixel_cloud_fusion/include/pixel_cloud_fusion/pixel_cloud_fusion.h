@@ -27,7 +27,6 @@
 
 #include <string>
 #include <vector>
-#include <unordered_map>
 #include <chrono>
 
 #include <ros/ros.h>
@@ -57,63 +56,82 @@
 
 #include <Eigen/Eigen>
 
-namespace std {
-	template <>
-	class hash< cv::Point >{
-	public :
-		size_t operator()(const cv::Point &pixel_cloud ) const
-		{
-			return hash<std::string>()( std::to_string(pixel_cloud.x) + "|" + std::to_string(pixel_cloud.y) );
-		}
-	};
-};
-
 class ROSPixelCloudFusionApp
 {
+	/*!
+	 * Image, intrinsics and extrinsics of one of the cameras colouring the cloud
+	 */
+	struct CameraFusionContext
+	{
+		std::string                         image_src;
+		std::string                         camera_info_src;
+		ros::Subscriber                     image_subscriber;
+		ros::Subscriber                     intrinsics_subscriber;
+
+		tf::StampedTransform                camera_lidar_tf;
+
+		cv::Size                            image_size;
+		cv::Mat                             camera_instrinsics;
+		cv::Mat                             distortion_coefficients;
+		cv::Mat                             current_frame;
+
+		std::string                         image_frame_id;
+
+		bool                                camera_info_ok;
+		bool                                camera_lidar_tf_ok;
+
+		float                               fx, fy, cx, cy;
+
+		// point index of the nearest point of each pixel, -1 if none, sized to the image
+		std::vector<int>                    pixel_owner;
+	};
+
 	ros::NodeHandle                     node_handle_;
 	ros::Publisher                      publisher_fused_cloud_;
-	ros::Subscriber                     intrinsics_subscriber_;
 
 	tf::TransformListener*              transform_listener_;
-	tf::StampedTransform                camera_lidar_tf_;
 
-	cv::Size                            image_size_;
-	cv::Mat                             camera_instrinsics_;
-	cv::Mat                             distortion_coefficients_;
-	cv::Mat                             current_frame_;
-
-	std::string 						image_frame_id_;
+	std::vector<CameraFusionContext>    cameras_;
 
 	bool                                processing_;
-	bool                                camera_info_ok_;
-	bool                                camera_lidar_tf_ok_;
 
-	float                               fx_, fy_, cx_, cy_;
+	// per point scratch buffers, reused between scans
+	std::vector<int>                    point_pixels_;
+	std::vector<float>                  point_depths_;
+	std::vector<unsigned char>          point_colored_;
 	pcl::PointCloud<pcl::PointXYZRGB>   colored_cloud_;
 
 	typedef
 	message_filters::sync_policies::ApproximateTime<sensor_msgs::PointCloud2, sensor_msgs::Image> SyncPolicyT;
 
 	ros::Subscriber                     cloud_subscriber_;
-	ros::Subscriber                     image_subscriber_;
 	message_filters::Synchronizer<SyncPolicyT>              *cloud_synchronizer_;
 
 	pcl::PointXYZ TransformPoint(const pcl::PointXYZ &in_point, const tf::StampedTransform &in_transform);
 
-	void ImageCallback(const sensor_msgs::Image::ConstPtr &in_image_msg);
+	void ImageCallback(const sensor_msgs::Image::ConstPtr &in_image_msg, size_t in_camera_index);
 
 	void CloudCallback(const sensor_msgs::PointCloud2::ConstPtr &in_cloud_msg);
 
+	/*!
+	 * Colours the points of in_cloud seen by the camera and not coloured yet.
+	 * Points hidden behind a nearer point of the same pixel are left for the next cameras.
+	 * @param in_cloud cloud in the LiDAR frame
+	 * @param in_camera camera with image, intrinsics and extrinsics available
+	 */
+	void ColorPointsFromCamera(const pcl::PointCloud<pcl::PointXYZ> &in_cloud, CameraFusionContext &in_camera);
+
 	/*!
 	 * Obtains Transformation between two transforms registered in the TF Tree
 	 * @param in_target_frame
 	 * @param in_source_frame
+	 * @param out_found true if the transformation was available
 	 * @return the found transformation in the tree
 	 */
 	tf::StampedTransform
-	FindTransform(const std::string &in_target_frame, const std::string &in_source_frame);
+	FindTransform(const std::string &in_target_frame, const std::string &in_source_frame, bool &out_found);
 
-	void IntrinsicsCallback(const sensor_msgs::CameraInfo& in_message);
+	void IntrinsicsCallback(const sensor_msgs::CameraInfo::ConstPtr &in_message, size_t in_camera_index);
 
 	/*!
 	 * Reads the config params from the command line
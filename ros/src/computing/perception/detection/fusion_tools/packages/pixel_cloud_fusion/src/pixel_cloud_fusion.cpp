@@ -31,11 +31,12 @@ ROSPixelCloudFusionApp::TransformPoint(const pcl::PointXYZ &in_point, const tf::
 	return pcl::PointXYZ(tf_point_t.x(), tf_point_t.y(), tf_point_t.z());
 }
 
-void ROSPixelCloudFusionApp::ImageCallback(const sensor_msgs::Image::ConstPtr &in_image_msg)
+void ROSPixelCloudFusionApp::ImageCallback(const sensor_msgs::Image::ConstPtr &in_image_msg, size_t in_camera_index)
 {
-	if (!camera_info_ok_)
+	CameraFusionContext &camera = cameras_[in_camera_index];
+	if (!camera.camera_info_ok)
 	{
-		ROS_INFO("[%s] Waiting for Intrinsics to be available.", __APP_NAME__);
+		ROS_INFO("[%s] Waiting for Intrinsics to be available on %s.", __APP_NAME__, camera.camera_info_src.c_str());
 		return;
 	}
 	if (processing_)
@@ -44,77 +45,134 @@ void ROSPixelCloudFusionApp::ImageCallback(const sensor_msgs::Image::ConstPtr &i
 	cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(in_image_msg, "bgr8");
 	cv::Mat in_image = cv_image->image;
 
-	cv::Mat undistorted_image;
-	cv::undistort(in_image, current_frame_, camera_instrinsics_, distortion_coefficients_);
+	cv::undistort(in_image, camera.current_frame, camera.camera_instrinsics, camera.distortion_coefficients);
 
-	image_frame_id_ = in_image_msg->header.frame_id;
-	image_size_.height = current_frame_.rows;
-	image_size_.width = current_frame_.cols;
+	camera.image_frame_id = in_image_msg->header.frame_id;
+	camera.image_size.height = camera.current_frame.rows;
+	camera.image_size.width = camera.current_frame.cols;
 }
 
-void ROSPixelCloudFusionApp::CloudCallback(const sensor_msgs::PointCloud2::ConstPtr &in_cloud_msg)
+void ROSPixelCloudFusionApp::ColorPointsFromCamera(const pcl::PointCloud<pcl::PointXYZ> &in_cloud,
+                                                   CameraFusionContext &in_camera)
 {
-	if (current_frame_.empty() || image_frame_id_ == "")
+	const int points_num = in_cloud.points.size();
+	const int width = in_camera.current_frame.cols;
+	const int height = in_camera.current_frame.rows;
+	if (in_camera.pixel_owner.size() != static_cast<size_t>(width * height))
 	{
-		ROS_INFO("[%s] Waiting for Image frame to be available.", __APP_NAME__);
-		return;
+		in_camera.pixel_owner.assign(width * height, -1);
 	}
-	if (!camera_lidar_tf_ok_)
+
+	// project every point, coloured or not, so that they all take part in the occlusion test
+#pragma omp parallel for
+	for (int i = 0; i < points_num; i++)
 	{
-		camera_lidar_tf_ = FindTransform(image_frame_id_,
-		                                 in_cloud_msg->header.frame_id);
+		point_pixels_[i] = -1;
+		pcl::PointXYZ cam_point = TransformPoint(in_cloud.points[i], in_camera.camera_lidar_tf);
+		if (cam_point.z <= 0)
+			continue;
+
+		int u = int(cam_point.x * in_camera.fx / cam_point.z + in_camera.cx);
+		int v = int(cam_point.y * in_camera.fy / cam_point.z + in_camera.cy);
+		if ((u >= 0) && (u < width)
+			&& (v >= 0) && (v < height)
+				)
+		{
+			point_pixels_[i] = v * width + u;
+			point_depths_[i] = cam_point.z;
+		}
 	}
-	if (!camera_info_ok_ || !camera_lidar_tf_ok_)
+
+	// z-buffer: keep the nearest point of each pixel, the first one on ties
+	for (int i = 0; i < points_num; i++)
 	{
-		ROS_INFO("[%s] Waiting for Camera-Lidar TF and Intrinsics to be available.", __APP_NAME__);
-		return;
+		const int pixel = point_pixels_[i];
+		if (pixel < 0)
+			continue;
+		int &owner = in_camera.pixel_owner[pixel];
+		if (owner < 0 || point_depths_[i] < point_depths_[owner])
+			owner = i;
 	}
 
-	pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud(new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud(new pcl::PointCloud<pcl::PointXYZRGB>);
-	pcl::fromROSMsg(*in_cloud_msg, *in_cloud);
-	std::unordered_map<cv::Point, pcl::PointXYZ> projection_map;
+#pragma omp parallel for
+	for (int i = 0; i < points_num; i++)
+	{
+		const int pixel = point_pixels_[i];
+		if (pixel < 0 || point_colored_[i] || in_camera.pixel_owner[pixel] != i)
+			continue;
+
+		cv::Vec3b rgb_pixel = in_camera.current_frame.at<cv::Vec3b>(pixel / width, pixel % width);
+		pcl::PointXYZRGB &colored_3d_point = colored_cloud_.points[i];
+		colored_3d_point.x = in_cloud.points[i].x;
+		colored_3d_point.y = in_cloud.points[i].y;
+		colored_3d_point.z = in_cloud.points[i].z;
+		colored_3d_point.r = rgb_pixel[2];
+		colored_3d_point.g = rgb_pixel[1];
+		colored_3d_point.b = rgb_pixel[0];
+		point_colored_[i] = 1;
+	}
 
-	std::vector<pcl::PointXYZ> cam_cloud(in_cloud->points.size());
-	for (size_t i = 0; i < in_cloud->points.size(); i++)
+	// only the touched pixels are cleared, so the cost does not depend on the image size
+	for (int i = 0; i < points_num; i++)
 	{
-		cam_cloud[i] = TransformPoint(in_cloud->points[i], camera_lidar_tf_);
-		int u = int(cam_cloud[i].x * fx_ / cam_cloud[i].z + cx_);
-		int v = int(cam_cloud[i].y * fy_ / cam_cloud[i].z + cy_);
-		if ((u >= 0) && (u < image_size_.width)
-			&& (v >= 0) && (v < image_size_.height)
-			&& cam_cloud[i].z > 0
-				)
+		if (point_pixels_[i] >= 0)
+			in_camera.pixel_owner[point_pixels_[i]] = -1;
+	}
+}
+
+void ROSPixelCloudFusionApp::CloudCallback(const sensor_msgs::PointCloud2::ConstPtr &in_cloud_msg)
+{
+	std::vector<size_t> ready_cameras;
+	for (size_t i = 0; i < cameras_.size(); i++)
+	{
+		CameraFusionContext &camera = cameras_[i];
+		if (camera.current_frame.empty() || camera.image_frame_id == "")
+		{
+			ROS_INFO("[%s] Waiting for Image frame to be available on %s.", __APP_NAME__, camera.image_src.c_str());
+			continue;
+		}
+		if (!camera.camera_lidar_tf_ok)
+		{
+			camera.camera_lidar_tf = FindTransform(camera.image_frame_id,
+			                                       in_cloud_msg->header.frame_id,
+			                                       camera.camera_lidar_tf_ok);
+		}
+		if (!camera.camera_info_ok || !camera.camera_lidar_tf_ok)
 		{
-			projection_map.insert(std::pair<cv::Point, pcl::PointXYZ>(cv::Point(u, v), in_cloud->points[i]));
+			ROS_INFO("[%s] Waiting for Camera-Lidar TF and Intrinsics to be available on %s.", __APP_NAME__,
+			         camera.image_src.c_str());
+			continue;
 		}
+		ready_cameras.push_back(i);
 	}
+	if (ready_cameras.empty())
+		return;
+
+	pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud(new pcl::PointCloud<pcl::PointXYZ>);
+	pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud(new pcl::PointCloud<pcl::PointXYZRGB>);
+	pcl::fromROSMsg(*in_cloud_msg, *in_cloud);
 
-	out_cloud->points.clear();
+	const size_t points_num = in_cloud->points.size();
+	point_pixels_.resize(points_num);
+	point_depths_.resize(points_num);
+	point_colored_.assign(points_num, 0);
+	colored_cloud_.points.resize(points_num);
 
-#pragma omp for
-	for (int row = 0; row < image_size_.height; row++)
+	// a point seen by several cameras takes the colour of the first one
+	for (size_t i = 0; i < ready_cameras.size(); i++)
 	{
-		for (int col = 0; col < image_size_.width; col++)
-		{
-			std::unordered_map<cv::Point, pcl::PointXYZ>::const_iterator iterator_3d_2d;
-			pcl::PointXYZ corresponding_3d_point;
-			pcl::PointXYZRGB colored_3d_point;
-			iterator_3d_2d = projection_map.find(cv::Point(col, row));
-			if (iterator_3d_2d != projection_map.end())
-			{
-				corresponding_3d_point = iterator_3d_2d->second;
-				cv::Vec3b rgb_pixel = current_frame_.at<cv::Vec3b>(row, col);
-				colored_3d_point.x = corresponding_3d_point.x;
-				colored_3d_point.y = corresponding_3d_point.y;
-				colored_3d_point.z = corresponding_3d_point.z;
-				colored_3d_point.r = rgb_pixel[2];
-				colored_3d_point.g = rgb_pixel[1];
-				colored_3d_point.b = rgb_pixel[0];
-				out_cloud->points.push_back(colored_3d_point);
-			}
-		}
+		ColorPointsFromCamera(*in_cloud, cameras_[ready_cameras[i]]);
+	}
+
+	out_cloud->points.reserve(points_num);
+	for (size_t i = 0; i < points_num; i++)
+	{
+		if (point_colored_[i])
+			out_cloud->points.push_back(colored_cloud_.points[i]);
 	}
+	out_cloud->width = out_cloud->points.size();
+	out_cloud->height = 1;
+
 	// Publish PC
 	sensor_msgs::PointCloud2 cloud_msg;
 	pcl::toROSMsg(*out_cloud, cloud_msg);
@@ -122,46 +180,49 @@ void ROSPixelCloudFusionApp::CloudCallback(const sensor_msgs::PointCloud2::Const
 	publisher_fused_cloud_.publish(cloud_msg);
 }
 
-void ROSPixelCloudFusionApp::IntrinsicsCallback(const sensor_msgs::CameraInfo &in_message)
+void ROSPixelCloudFusionApp::IntrinsicsCallback(const sensor_msgs::CameraInfo::ConstPtr &in_message,
+                                                size_t in_camera_index)
 {
-	image_size_.height = in_message.height;
-	image_size_.width = in_message.width;
+	CameraFusionContext &camera = cameras_[in_camera_index];
+	camera.image_size.height = in_message->height;
+	camera.image_size.width = in_message->width;
 
-	camera_instrinsics_ = cv::Mat(3, 3, CV_64F);
+	camera.camera_instrinsics = cv::Mat(3, 3, CV_64F);
 	for (int row = 0; row < 3; row++)
 	{
 		for (int col = 0; col < 3; col++)
 		{
-			camera_instrinsics_.at<double>(row, col) = in_message.K[row * 3 + col];
+			camera.camera_instrinsics.at<double>(row, col) = in_message->K[row * 3 + col];
 		}
 	}
 
-	distortion_coefficients_ = cv::Mat(1, 5, CV_64F);
+	camera.distortion_coefficients = cv::Mat(1, 5, CV_64F);
 	for (int col = 0; col < 5; col++)
 	{
-		distortion_coefficients_.at<double>(col) = in_message.D[col];
+		camera.distortion_coefficients.at<double>(col) = in_message->D[col];
 	}
 
-	fx_ = static_cast<float>(in_message.P[0]);
-	fy_ = static_cast<float>(in_message.P[5]);
-	cx_ = static_cast<float>(in_message.P[2]);
-	cy_ = static_cast<float>(in_message.P[6]);
+	camera.fx = static_cast<float>(in_message->P[0]);
+	camera.fy = static_cast<float>(in_message->P[5]);
+	camera.cx = static_cast<float>(in_message->P[2]);
+	camera.cy = static_cast<float>(in_message->P[6]);
 
-	intrinsics_subscriber_.shutdown();
-	camera_info_ok_ = true;
-	ROS_INFO("[%s] CameraIntrinsics obtained.", __APP_NAME__);
+	camera.intrinsics_subscriber.shutdown();
+	camera.camera_info_ok = true;
+	ROS_INFO("[%s] CameraIntrinsics obtained from %s.", __APP_NAME__, camera.camera_info_src.c_str());
 }
 
 tf::StampedTransform
-ROSPixelCloudFusionApp::FindTransform(const std::string &in_target_frame, const std::string &in_source_frame)
+ROSPixelCloudFusionApp::FindTransform(const std::string &in_target_frame, const std::string &in_source_frame,
+                                      bool &out_found)
 {
 	tf::StampedTransform transform;
 
-	camera_lidar_tf_ok_ = false;
+	out_found = false;
 	try
 	{
 		transform_listener_->lookupTransform(in_target_frame, in_source_frame, ros::Time(0), transform);
-		camera_lidar_tf_ok_ = true;
+		out_found = true;
 		ROS_INFO("[%s] Camera-Lidar TF obtained", __APP_NAME__);
 	}
 	catch (tf::TransformException ex)
@@ -176,6 +237,7 @@ void ROSPixelCloudFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
 {
 	//get params
 	std::string points_src, image_src, camera_info_src, fused_topic_str = "/points_fused";
+	std::vector<std::string> image_srcs, camera_info_srcs;
 	std::string name_space_str = ros::this_node::getNamespace();
 
 	ROS_INFO("[%s] This node requires: Registered TF(Lidar-Camera), CameraInfo, Image, and PointCloud.", __APP_NAME__);
@@ -183,10 +245,22 @@ void ROSPixelCloudFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
 	ROS_INFO("[%s] points_src: %s", __APP_NAME__, points_src.c_str());
 
 	in_private_handle.param<std::string>("image_src", image_src, "/image_rectified");
-	ROS_INFO("[%s] image_src: %s", __APP_NAME__, image_src.c_str());
-
 	in_private_handle.param<std::string>("camera_info_src", camera_info_src, "/camera_info");
-	ROS_INFO("[%s] camera_info_src: %s", __APP_NAME__, camera_info_src.c_str());
+
+	// several cameras can colour the same cloud, given as lists of the same size
+	in_private_handle.param<std::vector<std::string> >("image_srcs", image_srcs, std::vector<std::string>());
+	in_private_handle.param<std::vector<std::string> >("camera_info_srcs", camera_info_srcs,
+	                                                   std::vector<std::string>());
+	if (image_srcs.empty() || image_srcs.size() != camera_info_srcs.size())
+	{
+		if (!image_srcs.empty() || !camera_info_srcs.empty())
+		{
+			ROS_ERROR("[%s] image_srcs and camera_info_srcs must have the same size, using image_src and camera_info_src",
+			          __APP_NAME__);
+		}
+		image_srcs.assign(1, image_src);
+		camera_info_srcs.assign(1, camera_info_src);
+	}
 
 	if (name_space_str != "/")
 	{
@@ -194,23 +268,41 @@ void ROSPixelCloudFusionApp::InitializeROSIo(ros::NodeHandle &in_private_handle)
 		{
 			name_space_str.erase(name_space_str.begin());
 		}
-		image_src = name_space_str + image_src;
+		for (size_t i = 0; i < image_srcs.size(); i++)
+		{
+			image_srcs[i] = name_space_str + image_srcs[i];
+			camera_info_srcs[i] = name_space_str + camera_info_srcs[i];
+		}
 		fused_topic_str = name_space_str + fused_topic_str;
-		camera_info_src = name_space_str + camera_info_src;
 	}
 
 	//generate subscribers and sychronizers
-	ROS_INFO("[%s] Subscribing to... %s", __APP_NAME__, camera_info_src.c_str());
-	intrinsics_subscriber_ = in_private_handle.subscribe(camera_info_src,
-	                                                     1,
-	                                                     &ROSPixelCloudFusionApp::IntrinsicsCallback, this);
-
-	ROS_INFO("[%s] Subscribing to... %s", __APP_NAME__, image_src.c_str());
-	cloud_subscriber_ = in_private_handle.subscribe(image_src,
-	                                                1,
-	                                                &ROSPixelCloudFusionApp::ImageCallback, this);
+	cameras_.resize(image_srcs.size());
+	for (size_t i = 0; i < cameras_.size(); i++)
+	{
+		CameraFusionContext &camera = cameras_[i];
+		camera.image_src = image_srcs[i];
+		camera.camera_info_src = camera_info_srcs[i];
+		camera.image_frame_id = "";
+		camera.camera_info_ok = false;
+		camera.camera_lidar_tf_ok = false;
+		ROS_INFO("[%s] image_src: %s", __APP_NAME__, camera.image_src.c_str());
+		ROS_INFO("[%s] camera_info_src: %s", __APP_NAME__, camera.camera_info_src.c_str());
+
+		ROS_INFO("[%s] Subscribing to... %s", __APP_NAME__, camera.camera_info_src.c_str());
+		camera.intrinsics_subscriber = in_private_handle.subscribe<sensor_msgs::CameraInfo>(camera.camera_info_src,
+		                                                 1,
+		                                                 boost::bind(&ROSPixelCloudFusionApp::IntrinsicsCallback,
+		                                                             this, _1, i));
+
+		ROS_INFO("[%s] Subscribing to... %s", __APP_NAME__, camera.image_src.c_str());
+		camera.image_subscriber = in_private_handle.subscribe<sensor_msgs::Image>(camera.image_src,
+		                                                 1,
+		                                                 boost::bind(&ROSPixelCloudFusionApp::ImageCallback,
+		                                                             this, _1, i));
+	}
 	ROS_INFO("[%s] Subscribing to... %s", __APP_NAME__, points_src.c_str());
-	image_subscriber_ = in_private_handle.subscribe(points_src,
+	cloud_subscriber_ = in_private_handle.subscribe(points_src,
 	                                                1,
 	                                                &ROSPixelCloudFusionApp::CloudCallback, this);
 
@@ -238,8 +330,5 @@ void ROSPixelCloudFusionApp::Run()
 
 ROSPixelCloudFusionApp::ROSPixelCloudFusionApp()
 {
-	camera_lidar_tf_ok_ = false;
-	camera_info_ok_ = false;
 	processing_ = false;
-	image_frame_id_ = "";
 }
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef GRID_EUCLIDEAN_H_
+#define GRID_EUCLIDEAN_H_
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Euclidean clustering on the XY plane, CPU counterpart of GpuEuclideanCluster.
+ *
+ * Points are bucketed in a 2D grid of threshold / 2 cells, so all points of a cell
+ * are connected. Cells are then joined with a union-find when any pair of their points
+ * is within the threshold, only the cells up to two steps away need to be checked.
+ * The clusters are the same as the ones of pcl::EuclideanClusterExtraction on the
+ * flattened cloud: ordered by decreasing size (equal sizes by first point index) and
+ * with the point indices sorted.
+ */
+class GridEuclideanCluster
+{
+public:
+  typedef struct
+  {
+    int index_value;
+    std::vector<int> points_in_cluster;
+  } GClusterIndex;
+
+  GridEuclideanCluster();
+
+  void setInputPoints(const float* x, const float* y, int size);
+  void setThreshold(double threshold);
+  void setMinClusterPts(int min_cluster_pts);
+  void setMaxClusterPts(int max_cluster_pts);
+  void extractClusters();
+  std::vector<GClusterIndex> getOutput();
+
+private:
+  const float *x_, *y_;
+  int size_;
+  double threshold_;
+  int min_cluster_pts_;
+  int max_cluster_pts_;
+
+  std::vector<std::pair<uint64_t, int> > point_cells_;  // cell key and index of each valid point, sorted by key
+  std::vector<uint64_t> cell_keys_;
+  std::vector<int> cell_begin_;                          // first entry of each cell in point_cells_
+  std::vector<int> cell_parent_;                         // union-find forest over the cells
+  std::vector<GClusterIndex> clusters_;
+
+  static uint64_t cellKey(int64_t cell_x, int64_t cell_y);
+
+  int findRoot(int cell);
+
+  /* True if a point of cell_a and a point of cell_b are within the threshold */
+  bool cellsConnected(int cell_a, int cell_b, float threshold2) const;
+};
+
+#endif
@@ -131,6 +131,7 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   // extract pointcloud using the indices
   // calculate min and max points
   pcl::PointCloud<pcl::PointXYZRGB>::Ptr current_cluster(new pcl::PointCloud<pcl::PointXYZRGB>);
+  current_cluster->points.reserve(in_cluster_indices.size());
   float min_x = std::numeric_limits<float>::max();
   float max_x = -std::numeric_limits<float>::max();
   float min_y = std::numeric_limits<float>::max();
@@ -214,7 +215,10 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   double rz = 0;
 
   {
-    std::vector<cv::Point2f> points;
+    // scratch buffers of the calling thread, the clusters of a frame are set in parallel
+    static thread_local std::vector<cv::Point2f> points;
+    static thread_local std::vector<cv::Point2f> hull;
+    points.clear();
     for (unsigned int i = 0; i < current_cluster->points.size(); i++)
     {
       cv::Point2f pt;
@@ -223,10 +227,10 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
       points.push_back(pt);
     }
 
-    std::vector<cv::Point2f> hull;
     cv::convexHull(points, hull);
 
     polygon_.header = in_ros_header;
+    polygon_.polygon.points.reserve(2 * (hull.size() + 1));
     for (size_t i = 0; i < hull.size() + 1; i++)
     {
       geometry_msgs::Point32 point;
@@ -266,12 +270,10 @@ void Cluster::SetCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_origin_cloud
   // Get EigenValues, eigenvectors
   if (current_cluster->points.size() > 3)
   {
-    pcl::PCA<pcl::PointXYZ> current_cluster_pca;
-    pcl::PointCloud<pcl::PointXYZ>::Ptr current_cluster_mono(new pcl::PointCloud<pcl::PointXYZ>);
+    // only the basis is used, and the colored points can be used as they are
+    pcl::PCA<pcl::PointXYZRGB> current_cluster_pca(true);
 
-    pcl::copyPointCloud<pcl::PointXYZRGB, pcl::PointXYZ>(*current_cluster, *current_cluster_mono);
-
-    current_cluster_pca.setInputCloud(current_cluster_mono);
+    current_cluster_pca.setInputCloud(current_cluster);
     eigen_vectors_ = current_cluster_pca.getEigenVectors();
     eigen_values_ = current_cluster_pca.getEigenValues();
   }
@@ -0,0 +1,177 @@
+#include "grid_euclidean_clustering.h"
+
+#include <algorithm>
+#include <cmath>
+
+GridEuclideanCluster::GridEuclideanCluster()
+{
+  x_ = NULL;
+  y_ = NULL;
+  size_ = 0;
+  threshold_ = 0;
+  min_cluster_pts_ = 0;
+  max_cluster_pts_ = 1000000000;
+}
+
+void GridEuclideanCluster::setInputPoints(const float* x, const float* y, int size)
+{
+  x_ = x;
+  y_ = y;
+  size_ = size;
+}
+
+void GridEuclideanCluster::setThreshold(double threshold)
+{
+  threshold_ = threshold;
+}
+
+void GridEuclideanCluster::setMinClusterPts(int min_cluster_pts)
+{
+  min_cluster_pts_ = min_cluster_pts;
+}
+
+void GridEuclideanCluster::setMaxClusterPts(int max_cluster_pts)
+{
+  max_cluster_pts_ = max_cluster_pts;
+}
+
+uint64_t GridEuclideanCluster::cellKey(int64_t cell_x, int64_t cell_y)
+{
+  const int64_t offset = (int64_t) 1 << 31;
+  return ((uint64_t) (cell_x + offset) << 32) | (uint64_t) (uint32_t) (cell_y + offset);
+}
+
+int GridEuclideanCluster::findRoot(int cell)
+{
+  while (cell_parent_[cell] != cell)
+  {
+    cell_parent_[cell] = cell_parent_[cell_parent_[cell]];
+    cell = cell_parent_[cell];
+  }
+  return cell;
+}
+
+bool GridEuclideanCluster::cellsConnected(int cell_a, int cell_b, float threshold2) const
+{
+  for (int i = cell_begin_[cell_a]; i < cell_begin_[cell_a + 1]; i++)
+  {
+    const float ax = x_[point_cells_[i].second];
+    const float ay = y_[point_cells_[i].second];
+    for (int j = cell_begin_[cell_b]; j < cell_begin_[cell_b + 1]; j++)
+    {
+      const float dx = ax - x_[point_cells_[j].second];
+      const float dy = ay - y_[point_cells_[j].second];
+      if (dx * dx + dy * dy <= threshold2)
+        return true;
+    }
+  }
+  return false;
+}
+
+void GridEuclideanCluster::extractClusters()
+{
+  clusters_.clear();
+  point_cells_.clear();
+  cell_keys_.clear();
+  cell_begin_.clear();
+
+  if (size_ <= 0 || threshold_ <= 0)
+    return;
+
+  // A cell side of half the threshold keeps every pair of points of a cell within the threshold,
+  // and two points within the threshold at most two cells apart
+  const double cell_size = threshold_ / 2;
+  const float threshold2 = (float) (threshold_ * threshold_);
+
+  for (int i = 0; i < size_; i++)
+  {
+    if (!std::isfinite(x_[i]) || !std::isfinite(y_[i]))
+      continue;
+
+    int64_t cell_x = (int64_t) std::floor(x_[i] / cell_size);
+    int64_t cell_y = (int64_t) std::floor(y_[i] / cell_size);
+    point_cells_.push_back(std::make_pair(cellKey(cell_x, cell_y), i));
+  }
+  std::sort(point_cells_.begin(), point_cells_.end());
+
+  for (size_t i = 0; i < point_cells_.size(); i++)
+  {
+    if (i == 0 || point_cells_[i].first != point_cells_[i - 1].first)
+    {
+      cell_keys_.push_back(point_cells_[i].first);
+      cell_begin_.push_back(i);
+    }
+  }
+  const int cell_num = cell_keys_.size();
+  cell_begin_.push_back(point_cells_.size());
+
+  cell_parent_.resize(cell_num);
+  for (int c = 0; c < cell_num; c++)
+    cell_parent_[c] = c;
+
+  // join each cell with the connected cells after it (larger x, or same x and larger y)
+  const int64_t offset = (int64_t) 1 << 31;
+  for (int c = 0; c < cell_num; c++)
+  {
+    const int64_t cell_x = (int64_t) (cell_keys_[c] >> 32) - offset;
+    const int64_t cell_y = (int64_t) (cell_keys_[c] & 0xFFFFFFFF) - offset;
+
+    for (int64_t dx = 0; dx <= 2; dx++)
+    {
+      const uint64_t first_key = cellKey(cell_x + dx, (dx == 0) ? cell_y + 1 : cell_y - 2);
+      const uint64_t last_key = cellKey(cell_x + dx, cell_y + 2);
+
+      std::vector<uint64_t>::const_iterator it = std::lower_bound(cell_keys_.begin() + c + 1, cell_keys_.end(),
+                                                                  first_key);
+      for (; it != cell_keys_.end() && *it <= last_key; ++it)
+      {
+        const int neighbor = it - cell_keys_.begin();
+        int root_a = findRoot(c);
+        int root_b = findRoot(neighbor);
+        if (root_a != root_b && cellsConnected(c, neighbor, threshold2))
+          cell_parent_[root_b] = root_a;
+      }
+    }
+  }
+
+  // gather the points of each connected component
+  std::vector<int> cluster_of_root(cell_num, -1);
+  std::vector<GClusterIndex> components;
+  for (int c = 0; c < cell_num; c++)
+  {
+    int root = findRoot(c);
+    if (cluster_of_root[root] < 0)
+    {
+      cluster_of_root[root] = components.size();
+      components.push_back(GClusterIndex());
+    }
+    std::vector<int>& points = components[cluster_of_root[root]].points_in_cluster;
+    for (int i = cell_begin_[c]; i < cell_begin_[c + 1]; i++)
+      points.push_back(point_cells_[i].second);
+  }
+
+  for (size_t k = 0; k < components.size(); k++)
+  {
+    int points_num = components[k].points_in_cluster.size();
+    if (points_num >= min_cluster_pts_ && points_num <= max_cluster_pts_)
+    {
+      clusters_.push_back(GClusterIndex());
+      clusters_.back().points_in_cluster.swap(components[k].points_in_cluster);
+      std::sort(clusters_.back().points_in_cluster.begin(), clusters_.back().points_in_cluster.end());
+    }
+  }
+
+  std::sort(clusters_.begin(), clusters_.end(), [](const GClusterIndex& a, const GClusterIndex& b) {
+    if (a.points_in_cluster.size() != b.points_in_cluster.size())
+      return a.points_in_cluster.size() > b.points_in_cluster.size();
+    return a.points_in_cluster[0] < b.points_in_cluster[0];
+  });
+
+  for (size_t k = 0; k < clusters_.size(); k++)
+    clusters_[k].index_value = k;
+}
+
+std::vector<GridEuclideanCluster::GClusterIndex> GridEuclideanCluster::getOutput()
+{
+  return clusters_;
+}
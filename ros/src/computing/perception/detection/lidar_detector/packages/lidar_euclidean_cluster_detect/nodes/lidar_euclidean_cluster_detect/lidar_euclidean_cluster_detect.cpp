@@ -73,6 +73,7 @@
 #endif
 
 #include "cluster.h"
+#include "grid_euclidean_clustering.h"
 
 #ifdef GPU_CLUSTERING
 
@@ -123,6 +124,7 @@ static double _cluster_merge_threshold;
 static double _clustering_distance;
 
 static bool _use_gpu;
+static bool _use_grid_clustering;
 static std::chrono::system_clock::time_point _start, _end;
 
 std::vector<std::vector<geometry_msgs::Point>> _way_area_points;
@@ -376,16 +378,15 @@ std::vector<ClusterPtr> clusterAndColorGpu(const pcl::PointCloud<pcl::PointXYZ>:
   gecl_cluster.extractClusters();
   std::vector<GpuEuclideanCluster::GClusterIndex> cluster_indices = gecl_cluster.getOutput();
 
-  unsigned int k = 0;
+  clusters.resize(cluster_indices.size());
 
-  for (auto it = cluster_indices.begin(); it != cluster_indices.end(); it++)
+#pragma omp parallel for
+  for (int k = 0; k < (int) cluster_indices.size(); k++)
   {
-    ClusterPtr cluster(new Cluster());
-    cluster->SetCloud(in_cloud_ptr, it->points_in_cluster, _velodyne_header, k, (int) _colors[k].val[0],
-                      (int) _colors[k].val[1], (int) _colors[k].val[2], "", _pose_estimation);
-    clusters.push_back(cluster);
-
-    k++;
+    clusters[k].reset(new Cluster());
+    clusters[k]->SetCloud(in_cloud_ptr, cluster_indices[k].points_in_cluster, _velodyne_header, k,
+                          (int) _colors[k].val[0], (int) _colors[k].val[1], (int) _colors[k].val[2], "",
+                          _pose_estimation);
   }
 
   free(tmp_x);
@@ -397,6 +398,50 @@ std::vector<ClusterPtr> clusterAndColorGpu(const pcl::PointCloud<pcl::PointXYZ>:
 
 #endif
 
+std::vector<ClusterPtr> clusterAndColorGrid(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
+                                            pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud_ptr,
+                                            autoware_msgs::Centroids &in_out_centroids,
+                                            double in_max_cluster_distance = 0.5)
+{
+  std::vector<ClusterPtr> clusters;
+
+  // Convert input point cloud to vectors of x and y, the clustering is done on the XY plane
+  int size = in_cloud_ptr->points.size();
+
+  if (size == 0)
+    return clusters;
+
+  std::vector<float> tmp_x(size), tmp_y(size);
+
+  for (int i = 0; i < size; i++)
+  {
+    tmp_x[i] = in_cloud_ptr->points[i].x;
+    tmp_y[i] = in_cloud_ptr->points[i].y;
+  }
+
+  GridEuclideanCluster grid_cluster;
+
+  grid_cluster.setInputPoints(tmp_x.data(), tmp_y.data(), size);
+  grid_cluster.setThreshold(in_max_cluster_distance);
+  grid_cluster.setMinClusterPts(_cluster_size_min);
+  grid_cluster.setMaxClusterPts(_cluster_size_max);
+  grid_cluster.extractClusters();
+  std::vector<GridEuclideanCluster::GClusterIndex> cluster_indices = grid_cluster.getOutput();
+
+  clusters.resize(cluster_indices.size());
+
+#pragma omp parallel for
+  for (int k = 0; k < (int) cluster_indices.size(); k++)
+  {
+    clusters[k].reset(new Cluster());
+    clusters[k]->SetCloud(in_cloud_ptr, cluster_indices[k].points_in_cluster, _velodyne_header, k,
+                          (int) _colors[k].val[0], (int) _colors[k].val[1], (int) _colors[k].val[2], "",
+                          _pose_estimation);
+  }
+
+  return clusters;
+}
+
 std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
                                         pcl::PointCloud<pcl::PointXYZRGB>::Ptr out_cloud_ptr,
                                         autoware_msgs::Centroids &in_out_centroids,
@@ -431,21 +476,18 @@ std::vector<ClusterPtr> clusterAndColor(const pcl::PointCloud<pcl::PointXYZ>::Pt
   /////////////////////////////////
   //---	3. Color clustered points
   /////////////////////////////////
-  unsigned int k = 0;
   // pcl::PointCloud<pcl::PointXYZRGB>::Ptr final_cluster (new pcl::PointCloud<pcl::PointXYZRGB>);
 
-  std::vector<ClusterPtr> clusters;
+  std::vector<ClusterPtr> clusters(cluster_indices.size());
   // pcl::PointCloud<pcl::PointXYZRGB>::Ptr cloud_cluster (new pcl::PointCloud<pcl::PointXYZRGB>);//coord + color
-  // cluster
-  for (auto it = cluster_indices.begin(); it != cluster_indices.end(); ++it)
+  // cluster, in parallel, each cluster keeps its position in the output
+#pragma omp parallel for
+  for (int k = 0; k < (int) cluster_indices.size(); k++)
   {
-    ClusterPtr cluster(new Cluster());
-    cluster->SetCloud(in_cloud_ptr, it->indices, _velodyne_header, k, (int) _colors[k].val[0],
-                      (int) _colors[k].val[1],
-                      (int) _colors[k].val[2], "", _pose_estimation);
-    clusters.push_back(cluster);
-
-    k++;
+    clusters[k].reset(new Cluster());
+    clusters[k]->SetCloud(in_cloud_ptr, cluster_indices[k].indices, _velodyne_header, k, (int) _colors[k].val[0],
+                          (int) _colors[k].val[1],
+                          (int) _colors[k].val[2], "", _pose_estimation);
   }
   // std::cout << "Clusters: " << k << std::endl;
   return clusters;
@@ -547,6 +589,7 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   // 4 => >60   d=2.6
 
   std::vector<ClusterPtr> all_clusters;
+  std::chrono::system_clock::time_point clustering_start = std::chrono::system_clock::now();
 
   if (!_use_multiple_thres)
   {
@@ -566,14 +609,25 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
     {
       all_clusters = clusterAndColorGpu(cloud_ptr, out_cloud_ptr, in_out_centroids,
                                         _clustering_distance);
+    } else if (_use_grid_clustering)
+    {
+      all_clusters =
+        clusterAndColorGrid(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
     } else
     {
       all_clusters =
         clusterAndColor(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
     }
 #else
-    all_clusters =
+    if (_use_grid_clustering)
+    {
+      all_clusters =
+        clusterAndColorGrid(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
+    } else
+    {
+      all_clusters =
         clusterAndColor(cloud_ptr, out_cloud_ptr, in_out_centroids, _clustering_distance);
+    }
 #endif
   } else
   {
@@ -615,27 +669,52 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
       }
     }
 
-    std::vector<ClusterPtr> local_clusters;
+    // the bands are independent, with the grid backend they are clustered in parallel
+    std::vector<std::vector<ClusterPtr> > local_clusters(cloud_segments_array.size());
+#ifdef GPU_CLUSTERING
+    const bool parallel_bands = _use_grid_clustering && !_use_gpu;
+#else
+    const bool parallel_bands = _use_grid_clustering;
+#endif
+#pragma omp parallel for if (parallel_bands)
     for (unsigned int i = 0; i < cloud_segments_array.size(); i++)
     {
 #ifdef GPU_CLUSTERING
       if (_use_gpu)
       {
-        local_clusters = clusterAndColorGpu(cloud_segments_array[i], out_cloud_ptr,
-                                            in_out_centroids, _clustering_distances[i]);
+        local_clusters[i] = clusterAndColorGpu(cloud_segments_array[i], out_cloud_ptr,
+                                               in_out_centroids, _clustering_distances[i]);
+      } else if (_use_grid_clustering)
+      {
+        local_clusters[i] = clusterAndColorGrid(cloud_segments_array[i], out_cloud_ptr,
+                                                in_out_centroids, _clustering_distances[i]);
       } else
       {
-        local_clusters = clusterAndColor(cloud_segments_array[i], out_cloud_ptr,
-                                         in_out_centroids, _clustering_distances[i]);
+        local_clusters[i] = clusterAndColor(cloud_segments_array[i], out_cloud_ptr,
+                                            in_out_centroids, _clustering_distances[i]);
       }
 #else
-      local_clusters = clusterAndColor(
-          cloud_segments_array[i], out_cloud_ptr, in_out_centroids, _clustering_distances[i]);
+      if (_use_grid_clustering)
+      {
+        local_clusters[i] = clusterAndColorGrid(
+            cloud_segments_array[i], out_cloud_ptr, in_out_centroids, _clustering_distances[i]);
+      } else
+      {
+        local_clusters[i] = clusterAndColor(
+            cloud_segments_array[i], out_cloud_ptr, in_out_centroids, _clustering_distances[i]);
+      }
 #endif
-      all_clusters.insert(all_clusters.end(), local_clusters.begin(), local_clusters.end());
+    }
+    for (unsigned int i = 0; i < local_clusters.size(); i++)
+    {
+      all_clusters.insert(all_clusters.end(), local_clusters[i].begin(), local_clusters[i].end());
     }
   }
 
+  std::chrono::system_clock::time_point clustering_end = std::chrono::system_clock::now();
+  ROS_DEBUG("[%s] clustering of %d points: %f ms", __APP_NAME__, (int) in_cloud_ptr->points.size(),
+            std::chrono::duration<double, std::milli>(clustering_end - clustering_start).count());
+
   // Clusters can be merged or checked in here
   //....
   // check for mergable clusters
@@ -652,10 +731,19 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
   else
     final_clusters = mid_clusters;
 
+    // Build the cluster messages in parallel, they are added below in the cluster order
+    std::vector<autoware_msgs::CloudCluster> cluster_messages(final_clusters.size());
+#pragma omp parallel for
+    for (int i = 0; i < (int) final_clusters.size(); i++)
+    {
+      if (final_clusters[i]->IsValid())
+        final_clusters[i]->ToROSMessage(_velodyne_header, cluster_messages[i]);
+    }
+
     // Get final PointCloud to be published
     for (unsigned int i = 0; i < final_clusters.size(); i++)
     {
-      *out_cloud_ptr = *out_cloud_ptr + *(final_clusters[i]->GetCloud());
+      *out_cloud_ptr += *(final_clusters[i]->GetCloud());
 
       jsk_recognition_msgs::BoundingBox bounding_box = final_clusters[i]->GetBoundingBox();
       geometry_msgs::PolygonStamped polygon = final_clusters[i]->GetPolygon();
@@ -694,9 +782,7 @@ void segmentByDistance(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
 
         in_out_centroids.points.push_back(centroid);
 
-        autoware_msgs::CloudCluster cloud_cluster;
-        final_clusters[i]->ToROSMessage(_velodyne_header, cloud_cluster);
-        in_out_clusters.clusters.push_back(cloud_cluster);
+        in_out_clusters.clusters.push_back(std::move(cluster_messages[i]));
       }
     }
 }
@@ -1011,6 +1097,9 @@ int main(int argc, char **argv)
   private_nh.param("use_gpu", _use_gpu, false);
   ROS_INFO("[%s] use_gpu: %d", __APP_NAME__, _use_gpu);
 
+  private_nh.param("use_grid_clustering", _use_grid_clustering, false);
+  ROS_INFO("[%s] use_grid_clustering: %d", __APP_NAME__, _use_grid_clustering);
+
   private_nh.param("use_multiple_thres", _use_multiple_thres, false);
   ROS_INFO("[%s] use_multiple_thres: %d", __APP_NAME__, _use_multiple_thres);
 
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBJECT_TRACKING_CENTROID_GRID_H
+#define OBJECT_TRACKING_CENTROID_GRID_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+// Uniform XY grid over object centroids, used to gate the association stages
+// so each query only visits the centroids of the cells overlapping its box
+class CentroidGrid
+{
+public:
+  explicit CentroidGrid(double cell_size = 1.0);
+
+  void clear(double cell_size);
+
+  // add the centroid with the given index
+  void insert(double x, double y, size_t index);
+
+  // indices, in increasing order, of the centroids of the cells overlapping
+  // [x - radius, x + radius] x [y - radius, y + radius]; the caller does the exact check
+  void query(double x, double y, double radius, std::vector<size_t>& indices) const;
+
+  size_t size() const;
+
+private:
+  double cell_size_;
+  size_t size_;
+  std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+
+  int64_t cellIndex(double value) const;
+  static uint64_t cellKey(int64_t cell_x, int64_t cell_y);
+};
+
+#endif /* OBJECT_TRACKING_CENTROID_GRID_H */
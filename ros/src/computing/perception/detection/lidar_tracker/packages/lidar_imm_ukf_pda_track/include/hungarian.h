@@ -0,0 +1,29 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef OBJECT_TRACKING_HUNGARIAN_H
+#define OBJECT_TRACKING_HUNGARIAN_H
+
+#include <vector>
+
+#include "Eigen/Dense"
+
+// Minimum cost assignment of the rows of a (rows x cols) cost matrix to distinct columns,
+// solved with the O(n^3) Hungarian method. row_to_col[row] is the assigned column,
+// or -1 for the rows left over when there are more rows than columns.
+void solveHungarian(const Eigen::MatrixXd& cost, std::vector<int>& row_to_col);
+
+#endif /* OBJECT_TRACKING_HUNGARIAN_H */
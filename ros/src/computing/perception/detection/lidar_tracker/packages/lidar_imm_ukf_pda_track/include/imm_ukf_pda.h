@@ -39,6 +39,15 @@
 #include "autoware_msgs/DetectedObjectArray.h"
 
 #include "ukf.h"
+#include "centroid_grid.h"
+#include "hungarian.h"
+
+// input objects inside the validation gate of a target, in increasing index order
+struct ObjectGate
+{
+  std::vector<size_t> indices;
+  std::vector<double> nis;
+};
 
 class ImmUkfPda
 {
@@ -54,6 +63,9 @@ private:
   double gate_probability_;
   double detection_probability_;
 
+  // one to one assignment of objects to targets instead of the nearest object of each target
+  bool use_global_nearest_neighbor_;
+
   // object association param
   int life_time_thres_;
 
@@ -82,10 +94,14 @@ private:
   double nearest_lane_distance_thres_;
   std::string vectormap_frame_;
   vector_map::VectorMap vmap_;
-  std::vector<vector_map_msgs::Lane> lanes_;
 
   double merge_distance_threshold_;
   const double CENTROID_DISTANCE = 0.2;//distance to consider centroids the same
+  const double GATING_GRID_SIZE = 2.0;//cell size of the grid over input objects used for gating
+
+  // reused between frames
+  CentroidGrid object_grid_;
+  std::vector<ObjectGate> gates_;
 
   std::string input_topic_;
   std::string output_topic_;
@@ -115,9 +131,11 @@ private:
 
   bool updateNecessaryTransform();
 
+  bool gateObjects(const autoware_msgs::DetectedObjectArray& input, UKF& target, ObjectGate& gate);
+  void globalNearestNeighborAssociation(const size_t object_num);
   void measurementValidation(const autoware_msgs::DetectedObjectArray& input, UKF& target, const bool second_init,
-                             const Eigen::VectorXd& max_det_z, const Eigen::MatrixXd& max_det_s,
-                             std::vector<autoware_msgs::DetectedObject>& object_vec, std::vector<bool>& matching_vec);
+                             const ObjectGate& gate, std::vector<autoware_msgs::DetectedObject>& object_vec,
+                             std::vector<bool>& matching_vec);
   autoware_msgs::DetectedObject getNearestObject(UKF& target,
                                                  const std::vector<autoware_msgs::DetectedObject>& object_vec);
   void updateBehaviorState(const UKF& target, autoware_msgs::DetectedObject& object);
@@ -128,7 +146,7 @@ private:
   void updateTrackingNum(const std::vector<autoware_msgs::DetectedObject>& object_vec, UKF& target);
 
   bool probabilisticDataAssociation(const autoware_msgs::DetectedObjectArray& input, const double dt,
-                                    std::vector<bool>& matching_vec,
+                                    const ObjectGate& gate, std::vector<bool>& matching_vec,
                                     std::vector<autoware_msgs::DetectedObject>& object_vec, UKF& target);
   void makeNewTargets(const double timestamp, const autoware_msgs::DetectedObjectArray& input,
                       const std::vector<bool>& matching_vec);
@@ -174,6 +192,7 @@ private:
 
   bool
   isPointInPool(const std::vector<geometry_msgs::Point>& in_pool,
+                const CentroidGrid& in_pool_grid,
                 const geometry_msgs::Point& in_point);
 
   void updateTargetWithAssociatedObject(const std::vector<autoware_msgs::DetectedObject>& object_vec,
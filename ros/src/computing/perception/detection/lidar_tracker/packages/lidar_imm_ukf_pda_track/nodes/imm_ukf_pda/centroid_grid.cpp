@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "centroid_grid.h"
+
+#include <algorithm>
+#include <cmath>
+
+// cell indices are clamped so that far away or huge queries stay in range
+static const int64_t MAX_CELL_INDEX = (int64_t) 1 << 30;
+
+CentroidGrid::CentroidGrid(double cell_size)
+  : cell_size_(cell_size)
+  , size_(0)
+{
+}
+
+void CentroidGrid::clear(double cell_size)
+{
+  cell_size_ = cell_size;
+  size_ = 0;
+  cells_.clear();
+}
+
+int64_t CentroidGrid::cellIndex(double value) const
+{
+  double cell = std::floor(value / cell_size_);
+  if (cell > MAX_CELL_INDEX)
+    return MAX_CELL_INDEX;
+  if (cell < -MAX_CELL_INDEX)
+    return -MAX_CELL_INDEX;
+  return (int64_t) cell;
+}
+
+uint64_t CentroidGrid::cellKey(int64_t cell_x, int64_t cell_y)
+{
+  const int64_t offset = (int64_t) 1 << 31;
+  return ((uint64_t) (cell_x + offset) << 32) | (uint64_t) (uint32_t) (cell_y + offset);
+}
+
+void CentroidGrid::insert(double x, double y, size_t index)
+{
+  // non finite centroids are never close to anything
+  if (!std::isfinite(x) || !std::isfinite(y))
+    return;
+
+  cells_[cellKey(cellIndex(x), cellIndex(y))].push_back(index);
+  size_++;
+}
+
+void CentroidGrid::query(double x, double y, double radius, std::vector<size_t>& indices) const
+{
+  indices.clear();
+  if (!std::isfinite(x) || !std::isfinite(y) || std::isnan(radius) || cells_.empty())
+    return;
+
+  // grow the box a little so that rounding never drops a centroid on its border
+  radius = radius * (1 + 1e-6) + 1e-6 * cell_size_;
+
+  const int64_t min_x = cellIndex(x - radius);
+  const int64_t max_x = cellIndex(x + radius);
+  const int64_t min_y = cellIndex(y - radius);
+  const int64_t max_y = cellIndex(y + radius);
+
+  // visit the occupied cells directly when the box covers more cells than there are
+  if ((double) (max_x - min_x + 1) * (double) (max_y - min_y + 1) > (double) cells_.size())
+  {
+    const int64_t offset = (int64_t) 1 << 31;
+    for (const auto& cell : cells_)
+    {
+      const int64_t cell_x = (int64_t) (cell.first >> 32) - offset;
+      const int64_t cell_y = (int64_t) (cell.first & 0xFFFFFFFF) - offset;
+      if (cell_x >= min_x && cell_x <= max_x && cell_y >= min_y && cell_y <= max_y)
+      {
+        indices.insert(indices.end(), cell.second.begin(), cell.second.end());
+      }
+    }
+  }
+  else
+  {
+    for (int64_t cell_x = min_x; cell_x <= max_x; cell_x++)
+    {
+      for (int64_t cell_y = min_y; cell_y <= max_y; cell_y++)
+      {
+        auto cell = cells_.find(cellKey(cell_x, cell_y));
+        if (cell != cells_.end())
+        {
+          indices.insert(indices.end(), cell->second.begin(), cell->second.end());
+        }
+      }
+    }
+  }
+  std::sort(indices.begin(), indices.end());
+}
+
+size_t CentroidGrid::size() const
+{
+  return size_;
+}
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hungarian.h"
+
+#include <algorithm>
+#include <limits>
+
+void solveHungarian(const Eigen::MatrixXd& cost, std::vector<int>& row_to_col)
+{
+  const int rows = cost.rows();
+  const int cols = cost.cols();
+  row_to_col.assign(rows, -1);
+  if (rows == 0 || cols == 0)
+  {
+    return;
+  }
+
+  // the method needs n <= m, work on the transposed problem otherwise
+  const bool transposed = rows > cols;
+  const int n = transposed ? cols : rows;
+  const int m = transposed ? rows : cols;
+  auto at = [&](int i, int j) { return transposed ? cost(j, i) : cost(i, j); };
+
+  const double inf = std::numeric_limits<double>::infinity();
+  // potentials and matching are 1-based, column 0 is a virtual column for the augmenting row
+  std::vector<double> u(n + 1, 0), v(m + 1, 0), min_v(m + 1);
+  std::vector<int> col_to_row(m + 1, 0), way(m + 1, 0);
+  std::vector<char> used(m + 1);
+
+  for (int i = 1; i <= n; i++)
+  {
+    col_to_row[0] = i;
+    int j0 = 0;
+    std::fill(min_v.begin(), min_v.end(), inf);
+    std::fill(used.begin(), used.end(), false);
+    do
+    {
+      used[j0] = true;
+      const int i0 = col_to_row[j0];
+      double delta = inf;
+      int j1 = 0;
+      for (int j = 1; j <= m; j++)
+      {
+        if (used[j])
+        {
+          continue;
+        }
+        double reduced = at(i0 - 1, j - 1) - u[i0] - v[j];
+        if (reduced < min_v[j])
+        {
+          min_v[j] = reduced;
+          way[j] = j0;
+        }
+        if (min_v[j] < delta)
+        {
+          delta = min_v[j];
+          j1 = j;
+        }
+      }
+      for (int j = 0; j <= m; j++)
+      {
+        if (used[j])
+        {
+          u[col_to_row[j]] += delta;
+          v[j] -= delta;
+        }
+        else
+        {
+          min_v[j] -= delta;
+        }
+      }
+      j0 = j1;
+    } while (col_to_row[j0] != 0);
+
+    // flip the augmenting path
+    do
+    {
+      const int j1 = way[j0];
+      col_to_row[j0] = col_to_row[j1];
+      j0 = j1;
+    } while (j0 != 0);
+  }
+
+  for (int j = 1; j <= m; j++)
+  {
+    if (col_to_row[j] == 0)
+    {
+      continue;
+    }
+    if (transposed)
+    {
+      row_to_col[j - 1] = col_to_row[j] - 1;
+    }
+    else
+    {
+      row_to_col[col_to_row[j] - 1] = j - 1;
+    }
+  }
+}
@@ -15,6 +15,9 @@
  */
 
 
+#include <algorithm>
+#include <numeric>
+
 #include "imm_ukf_pda.h"
 
 ImmUkfPda::ImmUkfPda()
@@ -23,6 +26,7 @@ ImmUkfPda::ImmUkfPda()
   init_(false),
   frame_count_(0),
   has_subscribed_vectormap_(false),
+  object_grid_(GATING_GRID_SIZE),
   private_nh_("~")
 {
   private_nh_.param<std::string>("tracking_frame", tracking_frame_, "world");
@@ -30,6 +34,7 @@ ImmUkfPda::ImmUkfPda()
   private_nh_.param<double>("gating_thres", gating_thres_, 9.22);
   private_nh_.param<double>("gate_probability", gate_probability_, 0.99);
   private_nh_.param<double>("detection_probability", detection_probability_, 0.9);
+  private_nh_.param<bool>("use_global_nearest_neighbor", use_global_nearest_neighbor_, false);
   private_nh_.param<double>("static_velocity_thres", static_velocity_thres_, 0.5);
   private_nh_.param<int>("static_velocity_history_thres", static_num_history_thres_, 3);
   private_nh_.param<double>("prevent_explosion_thres", prevent_explosion_thres_, 1000);
@@ -99,8 +104,7 @@ void ImmUkfPda::checkVectormapSubscription()
 {
   if (use_vectormap_ && !has_subscribed_vectormap_)
   {
-    lanes_ = vmap_.findByFilter([](const vector_map_msgs::Lane& lane) { return true; });
-    if (lanes_.empty())
+    if (!vmap_.hasSubscribed(vector_map::Category::POINT | vector_map::Category::NODE | vector_map::Category::LANE))
     {
       ROS_INFO("Has not subscribed vectormap");
     }
@@ -185,9 +189,154 @@ geometry_msgs::Pose ImmUkfPda::getTransformedPose(const geometry_msgs::Pose& in_
   return out_pose.pose;
 }
 
+bool ImmUkfPda::gateObjects(const autoware_msgs::DetectedObjectArray& input, UKF& target, ObjectGate& gate)
+{
+  gate.indices.clear();
+  gate.nis.clear();
+
+  double det_s = 0;
+  Eigen::VectorXd max_det_z;
+  Eigen::MatrixXd max_det_s;
+
+  if (use_sukf_)
+  {
+    max_det_z = target.z_pred_ctrv_;
+    max_det_s = target.s_ctrv_;
+    det_s = max_det_s.determinant();
+  }
+  else
+  {
+    // find maxDetS associated with predZ
+    target.findMaxZandS(max_det_z, max_det_s);
+    det_s = max_det_s.determinant();
+  }
+
+  // prevent ukf not to explode
+  if (std::isnan(det_s) || det_s > prevent_explosion_thres_)
+  {
+    target.tracking_num_ = TrackingState::Die;
+    return false;
+  }
+
+  const Eigen::Vector2d z = max_det_z;
+  const Eigen::Matrix2d s_inv = max_det_s.inverse();
+
+  // nis is at least the smallest eigenvalue of s_inv times the squared distance,
+  // which bounds the distance of the objects inside the gate (with a margin for rounding)
+  const double a = s_inv(0, 0);
+  const double d = s_inv(1, 1);
+  const double b = 0.5 * (s_inv(0, 1) + s_inv(1, 0));
+  const double min_eigenvalue = 0.5 * (a + d) - std::sqrt(0.25 * (a - d) * (a - d) + b * b);
+  double radius = std::numeric_limits<double>::infinity();
+  if (min_eigenvalue > 0)
+  {
+    radius = std::sqrt(gating_thres_ / min_eigenvalue) * (1 + 1e-6);
+  }
+  object_grid_.query(z(0), z(1), radius, gate.indices);
+
+  // nis of all the candidates at once
+  Eigen::Matrix2Xd diff(2, gate.indices.size());
+  for (size_t k = 0; k < gate.indices.size(); k++)
+  {
+    diff(0, k) = input.objects[gate.indices[k]].pose.position.x - z(0);
+    diff(1, k) = input.objects[gate.indices[k]].pose.position.y - z(1);
+  }
+  Eigen::RowVectorXd nis = (s_inv.transpose() * diff).cwiseProduct(diff).colwise().sum();
+
+  size_t gated_num = 0;
+  for (size_t k = 0; k < gate.indices.size(); k++)
+  {
+    if (nis(k) < gating_thres_)
+    {
+      gate.indices[gated_num++] = gate.indices[k];
+      gate.nis.push_back(nis(k));
+    }
+  }
+  gate.indices.resize(gated_num);
+  return true;
+}
+
+void ImmUkfPda::globalNearestNeighborAssociation(const size_t object_num)
+{
+  // targets sharing gated objects are solved together, the other groups are independent
+  std::vector<size_t> parent(object_num);
+  std::iota(parent.begin(), parent.end(), 0);
+  auto find_root = [&parent](size_t object) {
+    while (parent[object] != object)
+    {
+      parent[object] = parent[parent[object]];
+      object = parent[object];
+    }
+    return object;
+  };
+  for (const auto& gate : gates_)
+  {
+    for (size_t k = 1; k < gate.indices.size(); k++)
+    {
+      parent[find_root(gate.indices[k])] = find_root(gate.indices[0]);
+    }
+  }
+
+  std::vector<std::vector<size_t>> group_targets(object_num);
+  for (size_t i = 0; i < gates_.size(); i++)
+  {
+    if (!gates_[i].indices.empty())
+    {
+      group_targets[find_root(gates_[i].indices[0])].push_back(i);
+    }
+  }
+
+  std::vector<int> object_column(object_num, -1);
+  std::vector<int> target_column;
+  for (const auto& targets : group_targets)
+  {
+    if (targets.empty())
+    {
+      continue;
+    }
+
+    std::vector<size_t> objects;
+    for (size_t target : targets)
+    {
+      for (size_t object : gates_[target].indices)
+      {
+        if (object_column[object] < 0)
+        {
+          object_column[object] = objects.size();
+          objects.push_back(object);
+        }
+      }
+    }
+
+    // leaving a target unassigned costs as much as an object on the gate boundary
+    Eigen::MatrixXd cost = Eigen::MatrixXd::Constant(targets.size(), objects.size(), gating_thres_);
+    for (size_t row = 0; row < targets.size(); row++)
+    {
+      const ObjectGate& gate = gates_[targets[row]];
+      for (size_t k = 0; k < gate.indices.size(); k++)
+      {
+        cost(row, object_column[gate.indices[k]]) = gate.nis[k];
+      }
+    }
+    solveHungarian(cost, target_column);
+
+    for (size_t row = 0; row < targets.size(); row++)
+    {
+      ObjectGate& gate = gates_[targets[row]];
+      const int column = target_column[row];
+      gate.indices.clear();
+      gate.nis.clear();
+      if (column >= 0 && cost(row, column) < gating_thres_)
+      {
+        gate.indices.push_back(objects[column]);
+        gate.nis.push_back(cost(row, column));
+      }
+    }
+  }
+}
+
 void ImmUkfPda::measurementValidation(const autoware_msgs::DetectedObjectArray& input, UKF& target,
-                                      const bool second_init, const Eigen::VectorXd& max_det_z,
-                                      const Eigen::MatrixXd& max_det_s,
+                                      const bool second_init, const ObjectGate& gate,
                                       std::vector<autoware_msgs::DetectedObject>& object_vec,
                                       std::vector<bool>& matching_vec)
 {
@@ -196,30 +345,18 @@ void ImmUkfPda::measurementValidation(const autoware_msgs::DetectedObjectArray&
   bool exists_smallest_nis_object = false;
   double smallest_nis = std::numeric_limits<double>::max();
   int smallest_nis_ind = 0;
-  for (size_t i = 0; i < input.objects.size(); i++)
+  for (size_t k = 0; k < gate.indices.size(); k++)
   {
-    double x = input.objects[i].pose.position.x;
-    double y = input.objects[i].pose.position.y;
-
-    Eigen::VectorXd meas = Eigen::VectorXd(2);
-    meas << x, y;
-
-    Eigen::VectorXd diff = meas - max_det_z;
-    double nis = diff.transpose() * max_det_s.inverse() * diff;
-
-    if (nis < gating_thres_)
+    if (gate.nis[k] < smallest_nis)
     {
-      if (nis < smallest_nis)
-      {
-        smallest_nis = nis;
-        target.object_ = input.objects[i];
-        smallest_nis_ind = i;
-        exists_smallest_nis_object = true;
-      }
+      smallest_nis = gate.nis[k];
+      smallest_nis_ind = gate.indices[k];
+      exists_smallest_nis_object = true;
     }
   }
   if (exists_smallest_nis_object)
   {
+    target.object_ = input.objects[smallest_nis_ind];
     matching_vec[smallest_nis_ind] = true;
     if (use_vectormap_ && has_subscribed_vectormap_)
     {
@@ -265,33 +402,19 @@ bool ImmUkfPda::storeObjectWithNearestLaneDirection(const autoware_msgs::Detecte
                                                  autoware_msgs::DetectedObject& out_object)
 {
   geometry_msgs::Pose lane_frame_pose = getTransformedPose(in_object.pose, tracking_frame2lane_frame_);
-  double min_dist = std::numeric_limits<double>::max();
 
-  double min_yaw = 0;
-  for (auto const& lane : lanes_)
+  vector_map_msgs::Lane lane = vmap_.findNearest(lane_frame_pose.position, nearest_lane_distance_thres_,
+                                                 [](const vector_map_msgs::Lane&) { return true; });
+  if (lane.lnid == 0)
   {
-    vector_map_msgs::Node node = vmap_.findByKey(vector_map::Key<vector_map_msgs::Node>(lane.bnid));
-    vector_map_msgs::Point point = vmap_.findByKey(vector_map::Key<vector_map_msgs::Point>(node.pid));
-    double distance = std::sqrt(std::pow(point.bx - lane_frame_pose.position.y, 2) +
-                                std::pow(point.ly - lane_frame_pose.position.x, 2));
-    if (distance < min_dist)
-    {
-      min_dist = distance;
-      vector_map_msgs::Node front_node = vmap_.findByKey(vector_map::Key<vector_map_msgs::Node>(lane.fnid));
-      vector_map_msgs::Point front_point = vmap_.findByKey(vector_map::Key<vector_map_msgs::Point>(front_node.pid));
-      min_yaw = std::atan2((front_point.bx - point.bx), (front_point.ly - point.ly));
-    }
+    return false;
   }
 
-  bool success = false;
-  if (min_dist < nearest_lane_distance_thres_)
-  {
-    success = true;
-  }
-  else
-  {
-    return success;
-  }
+  vector_map_msgs::Node node = vmap_.findByKey(vector_map::Key<vector_map_msgs::Node>(lane.bnid));
+  vector_map_msgs::Point point = vmap_.findByKey(vector_map::Key<vector_map_msgs::Point>(node.pid));
+  vector_map_msgs::Node front_node = vmap_.findByKey(vector_map::Key<vector_map_msgs::Node>(lane.fnid));
+  vector_map_msgs::Point front_point = vmap_.findByKey(vector_map::Key<vector_map_msgs::Point>(front_node.pid));
+  double min_yaw = std::atan2((front_point.bx - point.bx), (front_point.ly - point.ly));
 
   // map yaw in rotation matrix representation
   tf::Quaternion map_quat = tf::createQuaternionFromYaw(min_yaw);
@@ -308,7 +431,7 @@ bool ImmUkfPda::storeObjectWithNearestLaneDirection(const autoware_msgs::Detecte
 
   out_object = in_object;
   out_object.angle = yaw;
-  return success;
+  return true;
 }
 
 void ImmUkfPda::updateTargetWithAssociatedObject(const std::vector<autoware_msgs::DetectedObject>& object_vec,
@@ -434,35 +557,11 @@ void ImmUkfPda::updateTrackingNum(const std::vector<autoware_msgs::DetectedObjec
 }
 
 bool ImmUkfPda::probabilisticDataAssociation(const autoware_msgs::DetectedObjectArray& input, const double dt,
-                                             std::vector<bool>& matching_vec,
+                                             const ObjectGate& gate, std::vector<bool>& matching_vec,
                                              std::vector<autoware_msgs::DetectedObject>& object_vec, UKF& target)
 {
-  double det_s = 0;
-  Eigen::VectorXd max_det_z;
-  Eigen::MatrixXd max_det_s;
   bool success = true;
 
-  if (use_sukf_)
-  {
-    max_det_z = target.z_pred_ctrv_;
-    max_det_s = target.s_ctrv_;
-    det_s = max_det_s.determinant();
-  }
-  else
-  {
-    // find maxDetS associated with predZ
-    target.findMaxZandS(max_det_z, max_det_s);
-    det_s = max_det_s.determinant();
-  }
-
-  // prevent ukf not to explode
-  if (std::isnan(det_s) || det_s > prevent_explosion_thres_)
-  {
-    target.tracking_num_ = TrackingState::Die;
-    success = false;
-    return success;
-  }
-
   bool is_second_init;
   if (target.tracking_num_ == TrackingState::Init)
   {
@@ -474,7 +573,7 @@ bool ImmUkfPda::probabilisticDataAssociation(const autoware_msgs::DetectedObject
   }
 
   // measurement gating
-  measurementValidation(input, target, is_second_init, max_det_z, max_det_s, object_vec, matching_vec);
+  measurementValidation(input, target, is_second_init, gate, object_vec, matching_vec);
 
   // second detection for a target: update v and yaw
   if (is_second_init)
@@ -559,11 +658,14 @@ ImmUkfPda::arePointsEqual(const geometry_msgs::Point& in_point_a,
 
 bool
 ImmUkfPda::isPointInPool(const std::vector<geometry_msgs::Point>& in_pool,
+                          const CentroidGrid& in_pool_grid,
                           const geometry_msgs::Point& in_point)
 {
-  for(size_t j=0; j<in_pool.size(); j++)
+  std::vector<size_t> candidates;
+  in_pool_grid.query(in_point.x, in_point.y, (float) CENTROID_DISTANCE, candidates);
+  for(size_t j=0; j<candidates.size(); j++)
   {
-    if (arePointsEqual(in_pool[j], in_point))
+    if (arePointsEqual(in_pool[candidates[j]], in_point))
     {
       return true;
     }
@@ -582,21 +684,33 @@ ImmUkfPda::removeRedundantObjects(const autoware_msgs::DetectedObjectArray& in_d
   resulting_objects.header = in_detected_objects.header;
 
   std::vector<geometry_msgs::Point> centroids;
+  CentroidGrid centroid_grid(CENTROID_DISTANCE);
   //create unique points
   for(size_t i=0; i<in_detected_objects.objects.size(); i++)
   {
-    if(!isPointInPool(centroids, in_detected_objects.objects[i].pose.position))
+    const auto& position = in_detected_objects.objects[i].pose.position;
+    if(!isPointInPool(centroids, centroid_grid, position))
     {
-      centroids.push_back(in_detected_objects.objects[i].pose.position);
+      centroid_grid.insert(position.x, position.y, centroids.size());
+      centroids.push_back(position);
     }
   }
-  //assign objects to the points
+  //assign objects to the points, only the points of the nearby cells are checked
+  CentroidGrid merge_grid(std::max(merge_distance_threshold_, CENTROID_DISTANCE));
+  for(size_t i=0; i< centroids.size(); i++)
+  {
+    merge_grid.insert(centroids[i].x, centroids[i].y, i);
+  }
   std::vector<std::vector<size_t>> matching_objects(centroids.size());
+  std::vector<size_t> candidates;
   for(size_t k=0; k<in_detected_objects.objects.size(); k++)
   {
     const auto& object=in_detected_objects.objects[k];
-    for(size_t i=0; i< centroids.size(); i++)
+    merge_grid.query(object.pose.position.x, object.pose.position.y, (float) merge_distance_threshold_,
+                     candidates);
+    for(size_t j=0; j< candidates.size(); j++)
     {
+      size_t i = candidates[j];
       if (arePointsClose(object.pose.position, centroids[i], merge_distance_threshold_))
       {
         matching_objects[i].push_back(k);//store index of matched object to this point
@@ -781,6 +895,7 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
   double dt = (timestamp - timestamp_);
   timestamp_ = timestamp;
 
+  std::chrono::steady_clock::time_point prediction_start = std::chrono::steady_clock::now();
 
   // start UKF process
   for (size_t i = 0; i < targets_.size(); i++)
@@ -801,9 +916,41 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
     }
 
     targets_[i].prediction(use_sukf_, has_subscribed_vectormap_, dt);
+  }
+
+  std::chrono::steady_clock::time_point association_start = std::chrono::steady_clock::now();
+
+  // measurement gating, each target only looks at the input objects around its predicted measurement
+  object_grid_.clear(GATING_GRID_SIZE);
+  for (size_t i = 0; i < input.objects.size(); i++)
+  {
+    object_grid_.insert(input.objects[i].pose.position.x, input.objects[i].pose.position.y, i);
+  }
+  gates_.resize(targets_.size());
+  for (size_t i = 0; i < targets_.size(); i++)
+  {
+    if (targets_[i].tracking_num_ == TrackingState::Die || !gateObjects(input, targets_[i], gates_[i]))
+    {
+      gates_[i].indices.clear();
+      gates_[i].nis.clear();
+    }
+  }
+  if (use_global_nearest_neighbor_)
+  {
+    globalNearestNeighborAssociation(input.objects.size());
+  }
+
+  std::chrono::steady_clock::time_point update_start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < targets_.size(); i++)
+  {
+    if (targets_[i].tracking_num_ == TrackingState::Die)
+    {
+      continue;
+    }
 
     std::vector<autoware_msgs::DetectedObject> object_vec;
-    bool success = probabilisticDataAssociation(input, dt, matching_vec, object_vec, targets_[i]);
+    bool success = probabilisticDataAssociation(input, dt, gates_[i], matching_vec, object_vec, targets_[i]);
     if (!success)
     {
       continue;
@@ -813,6 +960,8 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
   }
   // end UKF process
 
+  std::chrono::steady_clock::time_point output_start = std::chrono::steady_clock::now();
+
   // making new ukf target for no data association objects
   makeNewTargets(timestamp, input, matching_vec);
 
@@ -822,6 +971,14 @@ void ImmUkfPda::tracker(const autoware_msgs::DetectedObjectArray& input,
   // making output for visualization
   makeOutput(input, matching_vec, detected_objects_output);
 
+  std::chrono::steady_clock::time_point output_end = std::chrono::steady_clock::now();
+  ROS_DEBUG("imm_ukf_pda: %d targets, %d objects: prediction %f ms, association %f ms, update %f ms, output %f ms",
+            (int) targets_.size(), (int) input.objects.size(),
+            std::chrono::duration<double, std::milli>(association_start - prediction_start).count(),
+            std::chrono::duration<double, std::milli>(update_start - association_start).count(),
+            std::chrono::duration<double, std::milli>(output_start - update_start).count(),
+            std::chrono::duration<double, std::milli>(output_end - output_start).count());
+
   // remove unnecessary ukf object
   removeUnnecessaryTarget();
 }
@@ -17,6 +17,7 @@
  */
 
 #include "bounding_box.hpp"
+#include <algorithm>
 #include <cmath>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
@@ -59,13 +60,15 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
       max_z = cluster.at(i).z;
   }
 
-  // calc circumscribed circle on x-y plane
-  cv::Mat_<float> cv_points((int)cluster.size(), 2);
-  for (size_t i = 0; i < cluster.size(); ++i)
+  // points and convex hull on x-y plane
+  std::vector<cv::Point2f> cv_points;
+  cv_points.reserve(cluster.size());
+  for (const auto& pcl_point : cluster)
   {
-    cv_points(i, 0) = cluster.at(i).x;  // x
-    cv_points(i, 1) = cluster.at(i).y;  // y
+    cv_points.emplace_back(pcl_point.x, pcl_point.y);
   }
+  std::vector<cv::Point2f> hull;
+  cv::convexHull(cv_points, hull);
 
   /*
    * Paper : IV2017, Efficient L-Shape Fitting for Vehicle Detection Using Laser Scanners
@@ -73,34 +76,49 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
    */
 
   // Paper : Algo.2 Search-Based Rectangle Fitting
-  std::vector<std::pair<double /*theta*/, double /*q*/>> Q;
+  // The criterion is evaluated every coarse_step angles first, then on every angle around the best coarse ones
+  std::vector<double> thetas;
   const double max_angle = M_PI / 2.0;
   const double angle_reso = M_PI / 180.0;
   for (double theta = 0; theta < max_angle; theta += angle_reso)
+    thetas.push_back(theta);
+
+  constexpr int coarse_step = 5;
+  constexpr int refined_coarse_num = 3;
+  const int theta_num = thetas.size();
+  std::vector<double> Q(theta_num, 0.0);
+  std::vector<bool> evaluated(theta_num, false);
+  auto evaluate = [&](int i) {
+    if (evaluated[i])
+      return;
+    Q[i] = calcClosenessCriterion(cv_points, hull, std::cos(thetas[i]), std::sin(thetas[i]));  // col.3-7, Algo.2
+    evaluated[i] = true;
+  };
+
+  std::vector<int> coarse_indices;
+  for (int i = 0; i < theta_num; i += coarse_step)
   {
-    Eigen::Vector2d e_1;
-    e_1 << std::cos(theta), std::sin(theta);  // col.3, Algo.2
-    Eigen::Vector2d e_2;
-    e_2 << -std::sin(theta), std::cos(theta);  // col.4, Algo.2
-    std::vector<double> C_1;                   // col.5, Algo.2
-    std::vector<double> C_2;                   // col.6, Algo.2
-    for (const auto& point : cluster)
-    {
-      C_1.push_back(point.x * e_1.x() + point.y * e_1.y());
-      C_2.push_back(point.x * e_2.x() + point.y * e_2.y());
-    }
-    double q = calcClosenessCriterion(C_1, C_2);  // col.7, Algo.2
-    Q.push_back(std::make_pair(theta, q));        // col.8, Algo.2
+    evaluate(i);
+    coarse_indices.push_back(i);
+  }
+  std::stable_sort(coarse_indices.begin(), coarse_indices.end(), [&Q](int a, int b) { return Q[a] > Q[b]; });
+  for (int k = 0; k < refined_coarse_num && k < (int)coarse_indices.size(); ++k)
+  {
+    const int center = coarse_indices[k];
+    for (int i = std::max(center - coarse_step + 1, 0); i < std::min(center + coarse_step, theta_num); ++i)
+      evaluate(i);
   }
 
   double theta_star;  // col.10, Algo.2
   double max_q;
-  for (size_t i = 0; i < Q.size(); ++i)
+  bool has_max_q = false;
+  for (int i = 0; i < theta_num; ++i)
   {
-    if (max_q < Q.at(i).second || i == 0)
+    if (evaluated[i] && (max_q < Q[i] || !has_max_q))
     {
-      max_q = Q.at(i).second;
-      theta_star = Q.at(i).first;
+      max_q = Q[i];
+      theta_star = thetas[i];
+      has_max_q = true;
     }
   }
 
@@ -110,7 +128,7 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
   e_2_star << -std::sin(theta_star), std::cos(theta_star);
   std::vector<double> C_1_star;  // col.11, Algo.2
   std::vector<double> C_2_star;  // col.11, Algo.2
-  for (const auto& point : cluster)
+  for (const auto& point : hull)
   {
     C_1_star.push_back(point.x * e_1_star.x() + point.y * e_1_star.y());
     C_2_star.push_back(point.x * e_2_star.x() + point.y * e_2_star.y());
@@ -288,34 +306,41 @@ bool BoundingBoxModel::estimate(const pcl::PointCloud<pcl::PointXYZ>& cluster, a
 //     return max_beta;
 // }
 
-double BoundingBoxModel::calcClosenessCriterion(const std::vector<double>& C_1, const std::vector<double>& C_2)
+double BoundingBoxModel::calcClosenessCriterion(const std::vector<cv::Point2f>& points,
+                                                const std::vector<cv::Point2f>& hull, const double cos_theta,
+                                                const double sin_theta)
 {
   // Paper : Algo.4 Closeness Criterion
-  const double min_c_1 = *std::min_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const double max_c_1 = *std::max_element(C_1.begin(), C_1.end());  // col.2, Algo.4
-  const double min_c_2 = *std::min_element(C_2.begin(), C_2.end());  // col.3, Algo.4
-  const double max_c_2 = *std::max_element(C_2.begin(), C_2.end());  // col.3, Algo.4
-
-  std::vector<double> D_1;  // col.4, Algo.4
-  for (const auto& c_1_element : C_1)
-  {
-    const double v = std::min(max_c_1 - c_1_element, c_1_element - min_c_1);
-    D_1.push_back(std::fabs(v));
-  }
-
-  std::vector<double> D_2;  // col.5, Algo.4
-  for (const auto& c_2_element : C_2)
+  double min_c_1 = 0;  // col.2, Algo.4
+  double max_c_1 = 0;  // col.2, Algo.4
+  double min_c_2 = 0;  // col.3, Algo.4
+  double max_c_2 = 0;  // col.3, Algo.4
+  for (size_t i = 0; i < hull.size(); ++i)
   {
-    const double v = std::min(max_c_2 - c_2_element, c_2_element - min_c_2);
-    D_2.push_back(v * v);
+    const double c_1 = hull[i].x * cos_theta + hull[i].y * sin_theta;
+    const double c_2 = hull[i].x * -sin_theta + hull[i].y * cos_theta;
+    if (c_1 < min_c_1 || i == 0)
+      min_c_1 = c_1;
+    if (max_c_1 < c_1 || i == 0)
+      max_c_1 = c_1;
+    if (c_2 < min_c_2 || i == 0)
+      min_c_2 = c_2;
+    if (max_c_2 < c_2 || i == 0)
+      max_c_2 = c_2;
   }
 
+  // col.4-6, Algo.4, without storing D_1 and D_2
   const double d_min = 0.05;
   const double d_max = 0.50;
-  double beta = 0;  // col.6, Algo.4
-  for (size_t i = 0; i < D_1.size(); ++i)
+  double beta = 0;
+  for (const auto& point : points)
   {
-    const double d = std::min(std::max(std::min(D_1.at(i), D_2.at(i)), d_min), d_max);
+    const double c_1 = point.x * cos_theta + point.y * sin_theta;
+    const double c_2 = point.x * -sin_theta + point.y * cos_theta;
+    const double d_1 = std::fabs(std::min(max_c_1 - c_1, c_1 - min_c_1));
+    const double v = std::min(max_c_2 - c_2, c_2 - min_c_2);
+    const double d_2 = v * v;
+    const double d = std::min(std::max(std::min(d_1, d_2), d_min), d_max);
     beta += 1.0 / d;
   }
   return beta;
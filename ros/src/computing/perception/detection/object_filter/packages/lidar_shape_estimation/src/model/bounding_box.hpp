@@ -20,11 +20,18 @@
 #pragma once
 
 #include "lidar_shape_estimation/model_interface.hpp"
+#include <vector>
+#include <opencv2/core/core.hpp>
 
 class BoundingBoxModel : public ShapeEstimationModelInterface
 {
 private:
-  double calcClosenessCriterion(const std::vector<double>& C_1, const std::vector<double>& C_2);
+  /*
+   * closeness criterion of the points projected on e_1 = (cos, sin) and e_2 = (-sin, cos).
+   * the extent of the projections is taken on the convex hull of the points, which holds the extremes.
+   */
+  double calcClosenessCriterion(const std::vector<cv::Point2f>& points, const std::vector<cv::Point2f>& hull,
+                                const double cos_theta, const double sin_theta);
 
 public:
   BoundingBoxModel(){};
@@ -35,9 +35,11 @@ void ShapeEstimationNode::callback(const autoware_msgs::DetectedObjectArray::Con
   // Create output msg
   auto output_msg = *input_msg;
 
-  // Estimate shape for each object and pack msg
-  for (auto& object : output_msg.objects)
+  // Estimate shape for each object and pack msg, objects are independent so they are estimated in parallel
+#pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < output_msg.objects.size(); ++i)
   {
+    autoware_msgs::DetectedObject& object = output_msg.objects.at(i);
     // convert ros to pcl
     pcl::PointCloud<pcl::PointXYZ>::Ptr cluster(new pcl::PointCloud<pcl::PointXYZ>);
     pcl::fromROSMsg(object.pointcloud, *cluster);
@@ -128,6 +128,38 @@ TEST(TestSuite, CheckEmptyPoint)
                          << "false";
 }
 
+TEST(TestSuite, CheckLShapeBoundingBox)
+{
+  ShapeEstimationTestClass test_shape_estimation;
+
+  // two sides of a 4m x 2m box rotated by 30 degrees around (10, 5)
+  const double yaw = M_PI / 6.0;
+  pcl::PointCloud<pcl::PointXYZ> pointcloud;
+  for (int i = 0; i <= 40; ++i)
+  {
+    pcl::PointXYZ p;
+    const double local_x = (i <= 20) ? -2.0 + 0.2 * i : -2.0;
+    const double local_y = (i <= 20) ? -1.0 : -1.0 + 0.1 * (i - 20);
+    p.x = 10.0 + std::cos(yaw) * local_x - std::sin(yaw) * local_y;
+    p.y = 5.0 + std::sin(yaw) * local_x + std::cos(yaw) * local_y;
+    p.z = 0.1 * (i % 10);
+    pointcloud.push_back(p);
+  }
+  autoware_msgs::DetectedObject output;
+
+  bool ret = test_shape_estimation.shape_estimator.getShapeAndPose(std::string("car"), pointcloud, output);
+
+  ASSERT_EQ(ret, true);
+  const double output_yaw = 2.0 * std::atan2(output.pose.orientation.z, output.pose.orientation.w);
+  // the search is done on a 1 degree grid
+  EXPECT_NEAR(yaw, output_yaw, 2.0 * M_PI / 180.0);
+  EXPECT_NEAR(10.0, output.pose.position.x, 0.1);
+  EXPECT_NEAR(5.0, output.pose.position.y, 0.1);
+  EXPECT_NEAR(4.0, output.dimensions.x, 0.1);
+  EXPECT_NEAR(2.0, output.dimensions.y, 0.1);
+  EXPECT_NEAR(0.9, output.dimensions.z, 1e-4);
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
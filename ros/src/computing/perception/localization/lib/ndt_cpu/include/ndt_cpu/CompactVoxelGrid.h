@@ -0,0 +1,188 @@
+#ifndef CPU_COMPACT_VGRID_H_
+#define CPU_COMPACT_VGRID_H_
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <float.h>
+#include <limits.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include <eigen3/Eigen/Dense>
+#include <eigen3/Eigen/Geometry>
+
+namespace cpu {
+
+/* Voxel grid that only stores non-empty voxels.
+ *
+ * Unlike VoxelGrid, which allocates a dense vgrid_x * vgrid_y * vgrid_z array
+ * of double precision centroids/covariances plus a list of point indexes per
+ * voxel, this grid keeps one record per occupied voxel, split into separate
+ * float arrays (centroid, inverse covariance, covariance, point count), so
+ * new points can still be merged without keeping the points themselves.
+ * Occupied voxels are found through an open addressing hash table keyed by
+ * the packed integer voxel coordinate. The input point cloud is not kept. */
+template <typename PointSourceType>
+class CompactVoxelGrid {
+public:
+	CompactVoxelGrid();
+
+	/* Set input points */
+	void setInput(typename pcl::PointCloud<PointSourceType>::Ptr input);
+
+	/* Same semantics as VoxelGrid::radiusSearch. The output ids are
+	 * indexes of voxel records, valid until the grid is modified. */
+	void radiusSearch(PointSourceType query_point, float radius, std::vector<int> &voxel_ids, int max_nn = INT_MAX) const;
+
+	/* Distance between the query point and the closest voxel centroid.
+	 * If the distance is larger than max_range, then return DBL_MAX.
+	 * Only the voxels within MAX_NN_RING_ voxels of the query point are
+	 * searched. The result is exact up to MAX_NN_RING_ times the smallest leaf
+	 * size, larger distances are clamped to that bound. VoxelGrid only searches
+	 * the nearest octree node and may return a farther voxel. */
+	double nearestNeighborDistance(PointSourceType query_point, float max_range) const;
+
+	/* Merge new points into the grid */
+	void update(typename pcl::PointCloud<PointSourceType>::Ptr new_cloud);
+
+	/* Remove voxels whose center lies in [min_x, max_x) x [min_y, max_y),
+	 * regardless of their height */
+	void removeRegion(float min_x, float min_y, float max_x, float max_y);
+
+	void setLeafSize(float voxel_x, float voxel_y, float voxel_z);
+
+	int getVoxelNum() const;
+
+	float getMaxX() const;
+	float getMaxY() const;
+	float getMaxZ() const;
+
+	float getMinX() const;
+	float getMinY() const;
+	float getMinZ() const;
+
+	float getVoxelX() const;
+	float getVoxelY() const;
+	float getVoxelZ() const;
+
+	Eigen::Vector3d getCentroid(int voxel_id) const;
+	Eigen::Matrix3d getCovariance(int voxel_id) const;
+	Eigen::Matrix3d getInverseCovariance(int voxel_id) const;
+	int getPointNum(int voxel_id) const;
+
+	/* Approximate number of bytes held by the grid */
+	size_t getMemoryUsage() const;
+
+	/* Write voxels whose center lies in [min_x, max_x) x [min_y, max_y)
+	 * to a voxel map tile (see below). The region is stored in the tile. */
+	bool save(const std::string &path, float min_x, float min_y, float max_x, float max_y) const;
+
+	/* Same as above, but only the given voxels are written */
+	bool save(const std::string &path, float min_x, float min_y, float max_x, float max_y, const std::vector<int> &voxel_ids) const;
+
+	/* Group the voxels by tiles of voxels_per_tile x voxels_per_tile voxels
+	 * in one pass. Tile (i, j) covers the voxels of x index in
+	 * [i * voxels_per_tile, (i + 1) * voxels_per_tile), and likewise in y.
+	 * The voxel ids are valid until the grid is modified. */
+	void splitIntoTiles(int voxels_per_tile, std::map<std::pair<int, int>, std::vector<int> > &tiles) const;
+
+	/* Memory-map a voxel map tile and add its voxels to the grid. Records are
+	 * copied as they are, only voxels already present are merged. If the grid
+	 * is empty, its leaf size is taken from the tile. */
+	bool load(const std::string &path);
+
+	/* Remove the region covered by a voxel map tile */
+	bool unload(const std::string &path);
+
+	/* Voxel map tile layout (version 1, host byte order):
+	 *   char     magic[8]			"NDTVOXEL"
+	 *   uint32_t version
+	 *   uint32_t header_size		offset of the first array
+	 *   float    leaf_size[3]
+	 *   int32_t  min_points_per_voxel
+	 *   float    region[4]			min_x, min_y, max_x, max_y of the tile
+	 *   float    bounds[6]			min_x, min_y, min_z, max_x, max_y, max_z of the points
+	 *   uint64_t voxel_num
+	 * followed by the record arrays keys_, centroid_, icovariance_,
+	 * covariance_, points_per_voxel_ and valid_ of voxel_num entries each. */
+	static const uint32_t FILE_VERSION = 1;
+
+private:
+	/* Sufficient statistics of the points falling into one voxel */
+	typedef struct {
+		uint64_t key;
+		int point_num;
+		Eigen::Vector3d centroid;
+		Eigen::Matrix3d scatter;	// Sum of (p - centroid) * (p - centroid)^T
+	} VoxelStatistics;
+
+	uint64_t voxelKey(int idx, int idy, int idz) const;
+
+	uint64_t voxelKey(float x, float y, float z) const;
+
+	/* Integer voxel coordinate stored in the key */
+	Eigen::Vector3i voxelIndex(uint64_t key) const;
+
+	/* Bucket of the key in the hash table */
+	uint64_t hashKey(uint64_t key) const;
+
+	/* Return the record index of the voxel, or -1 if it is empty */
+	int findVoxel(uint64_t key) const;
+
+	/* Append a new voxel record and insert it to the hash table */
+	int insertVoxel(uint64_t key);
+
+	/* Rebuild the hash table with at least the given number of buckets */
+	void rehash(size_t min_bucket_num);
+
+	/* Group points by voxel and compute statistics of each group */
+	void computeStatistics(typename pcl::PointCloud<PointSourceType>::Ptr cloud, std::vector<VoxelStatistics> &stats) const;
+
+	/* Merge statistics into the voxel record and refresh its
+	 * centroid, covariance and inverse covariance */
+	void mergeStatistics(const VoxelStatistics &stat);
+
+	void updateBoundaries(typename pcl::PointCloud<PointSourceType>::Ptr cloud);
+
+	/* Header of a voxel map tile, see save() */
+	typedef struct {
+		char magic[8];
+		uint32_t version;
+		uint32_t header_size;
+		float leaf_size[3];
+		int32_t min_points_per_voxel;
+		float region[4];
+		float bounds[6];
+		uint64_t voxel_num;
+	} FileHeader;
+
+	static bool readHeader(const std::string &path, FileHeader &header);
+
+	void clear();
+
+	float max_x_, max_y_, max_z_;		// Upper bounds of the grid (maximum coordinate)
+	float min_x_, min_y_, min_z_;		// Lower bounds of the grid (minimum coordinate)
+	float voxel_x_, voxel_y_, voxel_z_;	// Leaf size, a.k.a, size of each voxel
+	int min_points_per_voxel_;			// Voxels with fewer points are ignored by radiusSearch
+
+	/* Voxel records, one entry per occupied voxel */
+	std::vector<uint64_t> keys_;			// Packed voxel coordinates
+	std::vector<float> centroid_;			// 3 floats per voxel
+	std::vector<float> icovariance_;		// 6 floats per voxel (upper triangle, row major)
+	std::vector<float> covariance_;			// 6 floats per voxel, covariance of the points (upper triangle, row major)
+	std::vector<int> points_per_voxel_;		// Number of points of each voxel
+	std::vector<unsigned char> valid_;		// True if the inverse covariance is usable
+
+	std::vector<int> buckets_;				// Hash table, record index or -1 if empty
+	uint64_t bucket_mask_;
+	int bucket_shift_;
+
+	static const int KEY_BITS_ = 21;
+	static const int KEY_OFFSET_ = 1 << (KEY_BITS_ - 1);
+	static const int MAX_NN_RING_ = 8;
+};
+}
+
+#endif
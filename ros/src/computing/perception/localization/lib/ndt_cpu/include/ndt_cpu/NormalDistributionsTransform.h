@@ -3,6 +3,7 @@
 
 #include "Registration.h"
 #include "VoxelGrid.h"
+#include "CompactVoxelGrid.h"
 #include <eigen3/Eigen/Geometry>
 
 namespace cpu {
@@ -20,12 +21,29 @@ public:
 
 	void setOutlierRatio(double olr);
 
+	/* Set the number of threads used to accumulate the score gradient
+	 * and the Hessian. The source points are split into num_threads
+	 * contiguous chunks whose partial sums are reduced in chunk order,
+	 * so the result does not depend on thread scheduling. */
+	void setNumThreads(int num_threads);
+
+	/* Use CompactVoxelGrid (sparse, float precision) instead of the
+	 * dense VoxelGrid for the target map. Must be set before setInputTarget. */
+	void setUseCompactVoxelGrid(bool use_compact_voxel_grid);
+
 	double getStepSize() const;
 
 	float getResolution() const;
 
 	double getOutlierRatio() const;
 
+	int getNumThreads() const;
+
+	bool getUseCompactVoxelGrid() const;
+
+	/* Number of voxels of the target map */
+	int getVoxelNum() const;
+
 	double getTransformationProbability() const;
 
 	int getRealIterations();
@@ -38,6 +56,24 @@ public:
 
 	void updateVoxelGrid(typename pcl::PointCloud<PointTargetType>::Ptr new_cloud);
 
+	/* Evict target voxels whose center lies in [min_x, max_x) x [min_y, max_y).
+	 * Together with updateVoxelGrid this lets the target map be changed
+	 * tile by tile. Only supported with the compact voxel grid. */
+	bool removeTargetRegion(float min_x, float min_y, float max_x, float max_y);
+
+	/* Write target voxels whose center lies in [min_x, max_x) x [min_y, max_y)
+	 * to a map tile (see CompactVoxelGrid::save).
+	 * Only supported with the compact voxel grid. */
+	bool saveTargetTile(const std::string &path, float min_x, float min_y, float max_x, float max_y) const;
+
+	/* Add a pre-voxelized map tile (see CompactVoxelGrid::save) to the target.
+	 * When the target is empty, the resolution is taken from the tile.
+	 * Only supported with the compact voxel grid. */
+	bool loadTargetTile(const std::string &path);
+
+	/* Evict the region covered by a map tile from the target */
+	bool unloadTargetTile(const std::string &path);
+
 protected:
 	void computeTransformation(const Eigen::Matrix<float, 4, 4> &guess);
 
@@ -78,6 +114,25 @@ private:
 
 	void computeHessian(Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud, Eigen::Matrix<double, 6, 1> &p);
 
+	/* Accumulate score, gradient and Hessian of source points in [begin, end) */
+	template <typename VoxelGridType>
+	double accumulateDerivatives(VoxelGridType &voxel_grid, int begin, int end,
+									Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+									typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian);
+
+	/* Accumulate Hessian of source points in [begin, end) */
+	template <typename VoxelGridType>
+	void accumulateHessian(VoxelGridType &voxel_grid, int begin, int end, Eigen::Matrix<double, 6, 6> &hessian,
+							typename pcl::PointCloud<PointSourceType> &trans_cloud);
+
+	double accumulateDerivatives(int begin, int end, Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+									typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian);
+
+	void accumulateHessian(int begin, int end, Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud);
+
+	/* Number of chunks the source points are split into */
+	int chunkNum() const;
+
 	double computeDerivatives(Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
 								typename pcl::PointCloud<PointSourceType> &trans_cloud,
 								Eigen::Matrix<double, 6, 1> pose, bool compute_hessian = true);
@@ -106,8 +161,12 @@ private:
 
 	int real_iterations_;
 
+	int num_threads_;
+
+	bool use_compact_voxel_grid_;
 
 	VoxelGrid<PointSourceType> voxel_grid_;
+	CompactVoxelGrid<PointSourceType> compact_voxel_grid_;
 };
 }
 
@@ -0,0 +1,919 @@
+#include "ndt_cpu/CompactVoxelGrid.h"
+#include <math.h>
+#include <string.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+#include <eigen3/Eigen/Eigenvalues>
+
+namespace cpu {
+
+template <typename PointSourceType>
+CompactVoxelGrid<PointSourceType>::CompactVoxelGrid():
+	max_x_(-FLT_MAX),
+	max_y_(-FLT_MAX),
+	max_z_(-FLT_MAX),
+	min_x_(FLT_MAX),
+	min_y_(FLT_MAX),
+	min_z_(FLT_MAX),
+	voxel_x_(0),
+	voxel_y_(0),
+	voxel_z_(0),
+	min_points_per_voxel_(6),
+	bucket_mask_(0),
+	bucket_shift_(63)
+{
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::setLeafSize(float voxel_x, float voxel_y, float voxel_z)
+{
+	voxel_x_ = voxel_x;
+	voxel_y_ = voxel_y;
+	voxel_z_ = voxel_z;
+}
+
+template <typename PointSourceType>
+int CompactVoxelGrid<PointSourceType>::getVoxelNum() const
+{
+	return static_cast<int>(keys_.size());
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMaxX() const
+{
+	return max_x_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMaxY() const
+{
+	return max_y_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMaxZ() const
+{
+	return max_z_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMinX() const
+{
+	return min_x_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMinY() const
+{
+	return min_y_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getMinZ() const
+{
+	return min_z_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getVoxelX() const
+{
+	return voxel_x_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getVoxelY() const
+{
+	return voxel_y_;
+}
+
+template <typename PointSourceType>
+float CompactVoxelGrid<PointSourceType>::getVoxelZ() const
+{
+	return voxel_z_;
+}
+
+template <typename PointSourceType>
+Eigen::Vector3d CompactVoxelGrid<PointSourceType>::getCentroid(int voxel_id) const
+{
+	const float *c = &centroid_[3 * voxel_id];
+
+	return Eigen::Vector3d(c[0], c[1], c[2]);
+}
+
+template <typename PointSourceType>
+Eigen::Matrix3d CompactVoxelGrid<PointSourceType>::getCovariance(int voxel_id) const
+{
+	const float *c = &covariance_[6 * voxel_id];
+	Eigen::Matrix3d covariance;
+
+	covariance << c[0], c[1], c[2],
+				c[1], c[3], c[4],
+				c[2], c[4], c[5];
+
+	return covariance;
+}
+
+template <typename PointSourceType>
+Eigen::Matrix3d CompactVoxelGrid<PointSourceType>::getInverseCovariance(int voxel_id) const
+{
+	const float *c = &icovariance_[6 * voxel_id];
+	Eigen::Matrix3d icovariance;
+
+	icovariance << c[0], c[1], c[2],
+				c[1], c[3], c[4],
+				c[2], c[4], c[5];
+
+	return icovariance;
+}
+
+template <typename PointSourceType>
+int CompactVoxelGrid<PointSourceType>::getPointNum(int voxel_id) const
+{
+	return points_per_voxel_[voxel_id];
+}
+
+template <typename PointSourceType>
+size_t CompactVoxelGrid<PointSourceType>::getMemoryUsage() const
+{
+	return keys_.capacity() * sizeof(uint64_t) +
+			(centroid_.capacity() + icovariance_.capacity() + covariance_.capacity()) * sizeof(float) +
+			points_per_voxel_.capacity() * sizeof(int) +
+			valid_.capacity() * sizeof(unsigned char) +
+			buckets_.capacity() * sizeof(int);
+}
+
+template <typename PointSourceType>
+uint64_t CompactVoxelGrid<PointSourceType>::voxelKey(int idx, int idy, int idz) const
+{
+	const uint64_t mask = (static_cast<uint64_t>(1) << KEY_BITS_) - 1;
+
+	return ((static_cast<uint64_t>(idx + KEY_OFFSET_) & mask) << (2 * KEY_BITS_)) |
+			((static_cast<uint64_t>(idy + KEY_OFFSET_) & mask) << KEY_BITS_) |
+			(static_cast<uint64_t>(idz + KEY_OFFSET_) & mask);
+}
+
+template <typename PointSourceType>
+uint64_t CompactVoxelGrid<PointSourceType>::voxelKey(float x, float y, float z) const
+{
+	return voxelKey(static_cast<int>(floor(x / voxel_x_)),
+					static_cast<int>(floor(y / voxel_y_)),
+					static_cast<int>(floor(z / voxel_z_)));
+}
+
+template <typename PointSourceType>
+Eigen::Vector3i CompactVoxelGrid<PointSourceType>::voxelIndex(uint64_t key) const
+{
+	const uint64_t mask = (static_cast<uint64_t>(1) << KEY_BITS_) - 1;
+
+	return Eigen::Vector3i(static_cast<int>((key >> (2 * KEY_BITS_)) & mask) - KEY_OFFSET_,
+							static_cast<int>((key >> KEY_BITS_) & mask) - KEY_OFFSET_,
+							static_cast<int>(key & mask) - KEY_OFFSET_);
+}
+
+template <typename PointSourceType>
+uint64_t CompactVoxelGrid<PointSourceType>::hashKey(uint64_t key) const
+{
+	// Fibonacci hashing, taking the well mixed high bits of the product
+	return (key * 0x9E3779B97F4A7C15ULL) >> bucket_shift_;
+}
+
+template <typename PointSourceType>
+int CompactVoxelGrid<PointSourceType>::findVoxel(uint64_t key) const
+{
+	if (buckets_.empty()) {
+		return -1;
+	}
+
+	uint64_t bucket = hashKey(key);
+
+	while (buckets_[bucket] >= 0) {
+		int vid = buckets_[bucket];
+
+		if (keys_[vid] == key) {
+			return vid;
+		}
+
+		bucket = (bucket + 1) & bucket_mask_;
+	}
+
+	return -1;
+}
+
+template <typename PointSourceType>
+int CompactVoxelGrid<PointSourceType>::insertVoxel(uint64_t key)
+{
+	// Keep the load factor of the hash table below 0.5
+	if ((keys_.size() + 1) * 2 > buckets_.size()) {
+		rehash((keys_.size() + 1) * 2);
+	}
+
+	int vid = static_cast<int>(keys_.size());
+
+	keys_.push_back(key);
+	centroid_.resize(centroid_.size() + 3, 0);
+	icovariance_.resize(icovariance_.size() + 6, 0);
+	covariance_.resize(covariance_.size() + 6, 0);
+	points_per_voxel_.push_back(0);
+	valid_.push_back(0);
+
+	uint64_t bucket = hashKey(key);
+
+	while (buckets_[bucket] >= 0) {
+		bucket = (bucket + 1) & bucket_mask_;
+	}
+
+	buckets_[bucket] = vid;
+
+	return vid;
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::rehash(size_t min_bucket_num)
+{
+	size_t bucket_num = 16;
+	int bucket_bits = 4;
+
+	while (bucket_num < min_bucket_num) {
+		bucket_num <<= 1;
+		bucket_bits++;
+	}
+
+	bucket_mask_ = bucket_num - 1;
+	bucket_shift_ = 64 - bucket_bits;
+	buckets_.assign(bucket_num, -1);
+
+	for (int vid = 0; vid < static_cast<int>(keys_.size()); vid++) {
+		uint64_t bucket = hashKey(keys_[vid]);
+
+		while (buckets_[bucket] >= 0) {
+			bucket = (bucket + 1) & bucket_mask_;
+		}
+
+		buckets_[bucket] = vid;
+	}
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::clear()
+{
+	keys_.clear();
+	centroid_.clear();
+	icovariance_.clear();
+	covariance_.clear();
+	points_per_voxel_.clear();
+	valid_.clear();
+	buckets_.clear();
+	bucket_mask_ = 0;
+	bucket_shift_ = 63;
+
+	max_x_ = max_y_ = max_z_ = -FLT_MAX;
+	min_x_ = min_y_ = min_z_ = FLT_MAX;
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::updateBoundaries(typename pcl::PointCloud<PointSourceType>::Ptr cloud)
+{
+	for (int i = 0; i < cloud->points.size(); i++) {
+		float x = cloud->points[i].x;
+		float y = cloud->points[i].y;
+		float z = cloud->points[i].z;
+
+		max_x_ = (max_x_ > x) ? max_x_ : x;
+		max_y_ = (max_y_ > y) ? max_y_ : y;
+		max_z_ = (max_z_ > z) ? max_z_ : z;
+
+		min_x_ = (min_x_ < x) ? min_x_ : x;
+		min_y_ = (min_y_ < y) ? min_y_ : y;
+		min_z_ = (min_z_ < z) ? min_z_ : z;
+	}
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::computeStatistics(typename pcl::PointCloud<PointSourceType>::Ptr cloud, std::vector<VoxelStatistics> &stats) const
+{
+	int point_num = cloud->points.size();
+
+	// Sort point indexes by voxel key so points of a voxel are contiguous
+	std::vector<std::pair<uint64_t, int> > keyed_points(point_num);
+
+	for (int i = 0; i < point_num; i++) {
+		const PointSourceType &p = cloud->points[i];
+
+		keyed_points[i] = std::make_pair(voxelKey(p.x, p.y, p.z), i);
+	}
+
+	std::sort(keyed_points.begin(), keyed_points.end());
+
+	stats.clear();
+
+	int begin = 0;
+
+	while (begin < point_num) {
+		int end = begin + 1;
+
+		while (end < point_num && keyed_points[end].first == keyed_points[begin].first) {
+			end++;
+		}
+
+		VoxelStatistics stat;
+
+		stat.key = keyed_points[begin].first;
+		stat.point_num = end - begin;
+		stat.centroid.setZero();
+		stat.scatter.setZero();
+
+		// Two passes, so the scatter matrix does not suffer from
+		// cancellation at large map coordinates
+		for (int i = begin; i < end; i++) {
+			const PointSourceType &p = cloud->points[keyed_points[i].second];
+
+			stat.centroid += Eigen::Vector3d(p.x, p.y, p.z);
+		}
+
+		stat.centroid /= static_cast<double>(stat.point_num);
+
+		for (int i = begin; i < end; i++) {
+			const PointSourceType &p = cloud->points[keyed_points[i].second];
+			Eigen::Vector3d d = Eigen::Vector3d(p.x, p.y, p.z) - stat.centroid;
+
+			stat.scatter += d * d.transpose();
+		}
+
+		stats.push_back(stat);
+
+		begin = end;
+	}
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::mergeStatistics(const VoxelStatistics &stat)
+{
+	int vid = findVoxel(stat.key);
+
+	if (vid < 0) {
+		vid = insertVoxel(stat.key);
+	}
+
+	int old_num = points_per_voxel_[vid];
+	int ipoint_num = old_num + stat.point_num;
+	double point_num = static_cast<double>(ipoint_num);
+
+	Eigen::Vector3d centroid = stat.centroid;
+	Eigen::Matrix3d scatter = stat.scatter;
+
+	if (old_num > 0) {
+		// Recover the scatter matrix of the stored voxel and combine
+		// both groups (parallel axis theorem)
+		double old_n = static_cast<double>(old_num);
+		double new_n = static_cast<double>(stat.point_num);
+		Eigen::Vector3d old_centroid = getCentroid(vid);
+		Eigen::Matrix3d old_scatter = getCovariance(vid) * old_n;
+		Eigen::Vector3d delta = stat.centroid - old_centroid;
+
+		centroid = (old_centroid * old_n + stat.centroid * new_n) / point_num;
+		scatter = old_scatter + stat.scatter + delta * delta.transpose() * (old_n * new_n / point_num);
+	}
+
+	Eigen::Matrix3d covariance = scatter / point_num;
+
+	float *c = &centroid_[3 * vid];
+	float *cov = &covariance_[6 * vid];
+	float *icov = &icovariance_[6 * vid];
+
+	c[0] = static_cast<float>(centroid(0));
+	c[1] = static_cast<float>(centroid(1));
+	c[2] = static_cast<float>(centroid(2));
+
+	cov[0] = static_cast<float>(covariance(0, 0));
+	cov[1] = static_cast<float>(covariance(0, 1));
+	cov[2] = static_cast<float>(covariance(0, 2));
+	cov[3] = static_cast<float>(covariance(1, 1));
+	cov[4] = static_cast<float>(covariance(1, 2));
+	cov[5] = static_cast<float>(covariance(2, 2));
+
+	points_per_voxel_[vid] = ipoint_num;
+	valid_[vid] = 0;
+
+	if (ipoint_num < min_points_per_voxel_) {
+		return;
+	}
+
+	/* Same regularization as VoxelGrid::computeCentroidAndCovariance,
+	 * whose sum of squares is seeded with the identity matrix */
+	covariance = (scatter + Eigen::Matrix3d::Identity()) * (point_num - 1.0) / (point_num * point_num);
+
+	Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> sv;
+
+	sv.computeDirect(covariance);
+
+	Eigen::Matrix3d evecs = sv.eigenvectors();
+	Eigen::Matrix3d evals = sv.eigenvalues().asDiagonal();
+
+	if (evals(0, 0) < 0 || evals(1, 1) < 0 || evals(2, 2) <= 0) {
+		return;
+	}
+
+	double min_cov_eigvalue = evals(2, 2) * 0.01;
+
+	if (evals(0, 0) < min_cov_eigvalue) {
+		evals(0, 0) = min_cov_eigvalue;
+
+		if (evals(1, 1) < min_cov_eigvalue) {
+			evals(1, 1) = min_cov_eigvalue;
+		}
+
+		covariance = evecs * evals * evecs.inverse();
+	}
+
+	Eigen::Matrix3d icovariance = covariance.inverse();
+
+	icov[0] = static_cast<float>(icovariance(0, 0));
+	icov[1] = static_cast<float>(icovariance(0, 1));
+	icov[2] = static_cast<float>(icovariance(0, 2));
+	icov[3] = static_cast<float>(icovariance(1, 1));
+	icov[4] = static_cast<float>(icovariance(1, 2));
+	icov[5] = static_cast<float>(icovariance(2, 2));
+
+	valid_[vid] = 1;
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::setInput(typename pcl::PointCloud<PointSourceType>::Ptr input)
+{
+	clear();
+
+	if (input->points.size() > 0) {
+		std::vector<VoxelStatistics> stats;
+
+		computeStatistics(input, stats);
+
+		keys_.reserve(stats.size());
+		centroid_.reserve(stats.size() * 3);
+		icovariance_.reserve(stats.size() * 6);
+		covariance_.reserve(stats.size() * 6);
+		points_per_voxel_.reserve(stats.size());
+		valid_.reserve(stats.size());
+		rehash(stats.size() * 2);
+
+		for (int i = 0; i < stats.size(); i++) {
+			mergeStatistics(stats[i]);
+		}
+
+		updateBoundaries(input);
+	}
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::update(typename pcl::PointCloud<PointSourceType>::Ptr new_cloud)
+{
+	if (new_cloud->points.size() <= 0) {
+		return;
+	}
+
+	std::vector<VoxelStatistics> stats;
+
+	computeStatistics(new_cloud, stats);
+
+	for (int i = 0; i < stats.size(); i++) {
+		mergeStatistics(stats[i]);
+	}
+
+	updateBoundaries(new_cloud);
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::removeRegion(float min_x, float min_y, float max_x, float max_y)
+{
+	int voxel_num = keys_.size();
+	int kept_num = 0;
+
+	float new_max_x, new_max_y, new_max_z;
+	float new_min_x, new_min_y, new_min_z;
+
+	new_max_x = new_max_y = new_max_z = -FLT_MAX;
+	new_min_x = new_min_y = new_min_z = FLT_MAX;
+
+	// Compact the remaining records to the front, preserving their order
+	for (int vid = 0; vid < voxel_num; vid++) {
+		Eigen::Vector3i id = voxelIndex(keys_[vid]);
+		float cx = (id(0) + 0.5f) * voxel_x_;
+		float cy = (id(1) + 0.5f) * voxel_y_;
+
+		if (cx >= min_x && cx < max_x && cy >= min_y && cy < max_y) {
+			continue;
+		}
+
+		if (kept_num != vid) {
+			keys_[kept_num] = keys_[vid];
+			std::copy(&centroid_[3 * vid], &centroid_[3 * vid] + 3, &centroid_[3 * kept_num]);
+			std::copy(&icovariance_[6 * vid], &icovariance_[6 * vid] + 6, &icovariance_[6 * kept_num]);
+			std::copy(&covariance_[6 * vid], &covariance_[6 * vid] + 6, &covariance_[6 * kept_num]);
+			points_per_voxel_[kept_num] = points_per_voxel_[vid];
+			valid_[kept_num] = valid_[vid];
+		}
+
+		// Boundaries shrink to the voxels that are left
+		new_max_x = std::max(new_max_x, (id(0) + 1) * voxel_x_);
+		new_max_y = std::max(new_max_y, (id(1) + 1) * voxel_y_);
+		new_max_z = std::max(new_max_z, (id(2) + 1) * voxel_z_);
+
+		new_min_x = std::min(new_min_x, id(0) * voxel_x_);
+		new_min_y = std::min(new_min_y, id(1) * voxel_y_);
+		new_min_z = std::min(new_min_z, id(2) * voxel_z_);
+
+		kept_num++;
+	}
+
+	if (kept_num == voxel_num) {
+		return;
+	}
+
+	keys_.resize(kept_num);
+	centroid_.resize(kept_num * 3);
+	icovariance_.resize(kept_num * 6);
+	covariance_.resize(kept_num * 6);
+	points_per_voxel_.resize(kept_num);
+	valid_.resize(kept_num);
+
+	rehash(kept_num * 2);
+
+	max_x_ = std::min(max_x_, new_max_x);
+	max_y_ = std::min(max_y_, new_max_y);
+	max_z_ = std::min(max_z_, new_max_z);
+
+	min_x_ = std::max(min_x_, new_min_x);
+	min_y_ = std::max(min_y_, new_min_y);
+	min_z_ = std::max(min_z_, new_min_z);
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::radiusSearch(PointSourceType p, float radius, std::vector<int> &voxel_ids, int max_nn) const
+{
+	float t_x = p.x;
+	float t_y = p.y;
+	float t_z = p.z;
+
+	int max_id_x = static_cast<int>(floor((t_x + radius) / voxel_x_));
+	int max_id_y = static_cast<int>(floor((t_y + radius) / voxel_y_));
+	int max_id_z = static_cast<int>(floor((t_z + radius) / voxel_z_));
+
+	int min_id_x = static_cast<int>(floor((t_x - radius) / voxel_x_));
+	int min_id_y = static_cast<int>(floor((t_y - radius) / voxel_y_));
+	int min_id_z = static_cast<int>(floor((t_z - radius) / voxel_z_));
+
+	int nn = 0;
+
+	for (int idx = min_id_x; idx <= max_id_x && nn < max_nn; idx++) {
+		for (int idy = min_id_y; idy <= max_id_y && nn < max_nn; idy++) {
+			for (int idz = min_id_z; idz <= max_id_z && nn < max_nn; idz++) {
+				int vid = findVoxel(voxelKey(idx, idy, idz));
+
+				if (vid >= 0 && valid_[vid]) {
+					const float *c = &centroid_[3 * vid];
+					float cx = c[0] - t_x;
+					float cy = c[1] - t_y;
+					float cz = c[2] - t_z;
+
+					float distance = sqrtf(cx * cx + cy * cy + cz * cz);
+
+					if (distance < radius) {
+						nn++;
+						voxel_ids.push_back(vid);
+					}
+				}
+			}
+		}
+	}
+}
+
+template <typename PointSourceType>
+double CompactVoxelGrid<PointSourceType>::nearestNeighborDistance(PointSourceType q, float max_range) const
+{
+	if (keys_.empty()) {
+		return DBL_MAX;
+	}
+
+	int qx = static_cast<int>(floor(q.x / voxel_x_));
+	int qy = static_cast<int>(floor(q.y / voxel_y_));
+	int qz = static_cast<int>(floor(q.z / voxel_z_));
+
+	float min_leaf = std::min(voxel_x_, std::min(voxel_y_, voxel_z_));
+	int max_ring = MAX_NN_RING_;
+	bool ring_capped = true;
+
+	if (max_range / min_leaf < max_ring) {
+		max_ring = static_cast<int>(ceil(max_range / min_leaf));
+		ring_capped = false;
+	}
+
+	double min_dist = DBL_MAX;
+	int r = 0;
+
+	/* Visit shells of voxels around the query point. Voxels of ring r are
+	 * at least (r - 1) * leaf size away, so stop once that exceeds the
+	 * best distance found so far. */
+	for (; r <= max_ring && (r - 1) * min_leaf < min_dist; r++) {
+		for (int i = -r; i <= r; i++) {
+			for (int j = -r; j <= r; j++) {
+				bool on_shell = (abs(i) == r || abs(j) == r);
+
+				for (int k = -r; k <= r; k += (on_shell || r == 0) ? 1 : 2 * r) {
+					int vid = findVoxel(voxelKey(qx + i, qy + j, qz + k));
+
+					if (vid >= 0) {
+						const float *c = &centroid_[3 * vid];
+						double cur_dist = sqrt((q.x - c[0]) * (q.x - c[0]) + (q.y - c[1]) * (q.y - c[1]) + (q.z - c[2]) * (q.z - c[2]));
+
+						min_dist = (cur_dist < min_dist) ? cur_dist : min_dist;
+					}
+				}
+			}
+		}
+	}
+
+	/* The rings ran out before a voxel closer than the next ring was found.
+	 * The voxels left out are at least max_ring leaf sizes away, so the
+	 * distance is clamped to that bound instead of scanning every voxel. */
+	if (ring_capped && r > max_ring) {
+		min_dist = std::min(min_dist, static_cast<double>(max_ring * min_leaf));
+	}
+
+	if (min_dist >= max_range) {
+		return DBL_MAX;
+	}
+
+	return min_dist;
+}
+
+static const char FILE_MAGIC[8] = {'N', 'D', 'T', 'V', 'O', 'X', 'E', 'L'};
+
+template <typename PointSourceType>
+bool CompactVoxelGrid<PointSourceType>::save(const std::string &path, float min_x, float min_y, float max_x, float max_y) const
+{
+	std::vector<int> ids;
+
+	for (int vid = 0; vid < static_cast<int>(keys_.size()); vid++) {
+		Eigen::Vector3i id = voxelIndex(keys_[vid]);
+		float cx = (id(0) + 0.5f) * voxel_x_;
+		float cy = (id(1) + 0.5f) * voxel_y_;
+
+		if (cx >= min_x && cx < max_x && cy >= min_y && cy < max_y) {
+			ids.push_back(vid);
+		}
+	}
+
+	return save(path, min_x, min_y, max_x, max_y, ids);
+}
+
+template <typename PointSourceType>
+void CompactVoxelGrid<PointSourceType>::splitIntoTiles(int voxels_per_tile, std::map<std::pair<int, int>, std::vector<int> > &tiles) const
+{
+	tiles.clear();
+
+	for (int vid = 0; vid < static_cast<int>(keys_.size()); vid++) {
+		Eigen::Vector3i id = voxelIndex(keys_[vid]);
+		int tx = (id(0) >= 0) ? id(0) / voxels_per_tile : -((-id(0) + voxels_per_tile - 1) / voxels_per_tile);
+		int ty = (id(1) >= 0) ? id(1) / voxels_per_tile : -((-id(1) + voxels_per_tile - 1) / voxels_per_tile);
+
+		tiles[std::make_pair(tx, ty)].push_back(vid);
+	}
+}
+
+template <typename PointSourceType>
+bool CompactVoxelGrid<PointSourceType>::save(const std::string &path, float min_x, float min_y, float max_x, float max_y, const std::vector<int> &ids) const
+{
+	FileHeader header;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FILE_MAGIC, sizeof(header.magic));
+	header.version = FILE_VERSION;
+	header.header_size = sizeof(FileHeader);
+	header.leaf_size[0] = voxel_x_;
+	header.leaf_size[1] = voxel_y_;
+	header.leaf_size[2] = voxel_z_;
+	header.min_points_per_voxel = min_points_per_voxel_;
+	header.region[0] = min_x;
+	header.region[1] = min_y;
+	header.region[2] = max_x;
+	header.region[3] = max_y;
+
+	float *bounds = header.bounds;
+
+	bounds[0] = bounds[1] = bounds[2] = FLT_MAX;
+	bounds[3] = bounds[4] = bounds[5] = -FLT_MAX;
+
+	for (int i = 0; i < ids.size(); i++) {
+		Eigen::Vector3i id = voxelIndex(keys_[ids[i]]);
+
+		bounds[0] = std::min(bounds[0], id(0) * voxel_x_);
+		bounds[1] = std::min(bounds[1], id(1) * voxel_y_);
+		bounds[2] = std::min(bounds[2], id(2) * voxel_z_);
+		bounds[3] = std::max(bounds[3], (id(0) + 1) * voxel_x_);
+		bounds[4] = std::max(bounds[4], (id(1) + 1) * voxel_y_);
+		bounds[5] = std::max(bounds[5], (id(2) + 1) * voxel_z_);
+	}
+
+	header.voxel_num = ids.size();
+
+	FILE *fp = fopen(path.c_str(), "wb");
+
+	if (fp == NULL) {
+		std::cerr << "Cannot open " << path << " for writing" << std::endl;
+		return false;
+	}
+
+	bool ok = (fwrite(&header, sizeof(header), 1, fp) == 1);
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		ok = (fwrite(&keys_[ids[i]], sizeof(uint64_t), 1, fp) == 1);
+	}
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		ok = (fwrite(&centroid_[3 * ids[i]], sizeof(float), 3, fp) == 3);
+	}
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		ok = (fwrite(&icovariance_[6 * ids[i]], sizeof(float), 6, fp) == 6);
+	}
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		ok = (fwrite(&covariance_[6 * ids[i]], sizeof(float), 6, fp) == 6);
+	}
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		int32_t point_num = points_per_voxel_[ids[i]];
+
+		ok = (fwrite(&point_num, sizeof(int32_t), 1, fp) == 1);
+	}
+
+	for (int i = 0; i < ids.size() && ok; i++) {
+		ok = (fwrite(&valid_[ids[i]], sizeof(unsigned char), 1, fp) == 1);
+	}
+
+	ok = (fclose(fp) == 0) && ok;
+
+	if (!ok) {
+		std::cerr << "Failed to write " << path << std::endl;
+	}
+
+	return ok;
+}
+
+template <typename PointSourceType>
+bool CompactVoxelGrid<PointSourceType>::readHeader(const std::string &path, FileHeader &header)
+{
+	FILE *fp = fopen(path.c_str(), "rb");
+
+	if (fp == NULL) {
+		std::cerr << "Cannot open " << path << std::endl;
+		return false;
+	}
+
+	bool ok = (fread(&header, sizeof(header), 1, fp) == 1);
+
+	fclose(fp);
+
+	if (!ok || memcmp(header.magic, FILE_MAGIC, sizeof(header.magic)) != 0) {
+		std::cerr << path << " is not a voxel map file" << std::endl;
+		return false;
+	}
+
+	if (header.version != FILE_VERSION || header.header_size < sizeof(FileHeader)) {
+		std::cerr << path << ": unsupported voxel map version " << header.version << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+template <typename PointSourceType>
+bool CompactVoxelGrid<PointSourceType>::load(const std::string &path)
+{
+	FileHeader header;
+
+	if (!readHeader(path, header)) {
+		return false;
+	}
+
+	if (keys_.empty()) {
+		setLeafSize(header.leaf_size[0], header.leaf_size[1], header.leaf_size[2]);
+		min_points_per_voxel_ = header.min_points_per_voxel;
+	} else if (header.leaf_size[0] != voxel_x_ || header.leaf_size[1] != voxel_y_ || header.leaf_size[2] != voxel_z_) {
+		std::cerr << path << ": leaf size does not match the voxel grid" << std::endl;
+		return false;
+	}
+
+	size_t voxel_num = header.voxel_num;
+	size_t file_size = header.header_size + voxel_num * (sizeof(uint64_t) + 15 * sizeof(float) + sizeof(int32_t) + sizeof(unsigned char));
+
+	int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd < 0) {
+		std::cerr << "Cannot open " << path << std::endl;
+		return false;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < file_size) {
+		std::cerr << path << " is truncated" << std::endl;
+		close(fd);
+		return false;
+	}
+
+	void *addr = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+	close(fd);
+
+	if (addr == MAP_FAILED) {
+		std::cerr << "Cannot map " << path << std::endl;
+		return false;
+	}
+
+	const char *data = static_cast<const char *>(addr) + header.header_size;
+	const uint64_t *keys = reinterpret_cast<const uint64_t *>(data);
+	const float *centroid = reinterpret_cast<const float *>(keys + voxel_num);
+	const float *icovariance = centroid + 3 * voxel_num;
+	const float *covariance = icovariance + 6 * voxel_num;
+	const int32_t *points_per_voxel = reinterpret_cast<const int32_t *>(covariance + 6 * voxel_num);
+	const unsigned char *valid = reinterpret_cast<const unsigned char *>(points_per_voxel + voxel_num);
+
+	keys_.reserve(keys_.size() + voxel_num);
+	centroid_.reserve(centroid_.size() + voxel_num * 3);
+	icovariance_.reserve(icovariance_.size() + voxel_num * 6);
+	covariance_.reserve(covariance_.size() + voxel_num * 6);
+	points_per_voxel_.reserve(points_per_voxel_.size() + voxel_num);
+	valid_.reserve(valid_.size() + voxel_num);
+
+	if (keys_.size() + voxel_num > buckets_.size() / 2) {
+		rehash((keys_.size() + voxel_num) * 2);
+	}
+
+	for (size_t i = 0; i < voxel_num; i++) {
+		if (findVoxel(keys[i]) >= 0) {
+			// Voxel shared with a loaded tile
+			VoxelStatistics stat;
+			Eigen::Matrix3d cov;
+			const float *c = &covariance[6 * i];
+
+			cov << c[0], c[1], c[2],
+					c[1], c[3], c[4],
+					c[2], c[4], c[5];
+
+			stat.key = keys[i];
+			stat.point_num = points_per_voxel[i];
+			stat.centroid = Eigen::Vector3d(centroid[3 * i], centroid[3 * i + 1], centroid[3 * i + 2]);
+			stat.scatter = cov * static_cast<double>(stat.point_num);
+
+			mergeStatistics(stat);
+			continue;
+		}
+
+		int vid = insertVoxel(keys[i]);
+
+		std::copy(centroid + 3 * i, centroid + 3 * i + 3, &centroid_[3 * vid]);
+		std::copy(icovariance + 6 * i, icovariance + 6 * i + 6, &icovariance_[6 * vid]);
+		std::copy(covariance + 6 * i, covariance + 6 * i + 6, &covariance_[6 * vid]);
+		points_per_voxel_[vid] = points_per_voxel[i];
+		valid_[vid] = valid[i];
+	}
+
+	munmap(addr, file_size);
+
+	if (voxel_num > 0) {
+		min_x_ = std::min(min_x_, header.bounds[0]);
+		min_y_ = std::min(min_y_, header.bounds[1]);
+		min_z_ = std::min(min_z_, header.bounds[2]);
+		max_x_ = std::max(max_x_, header.bounds[3]);
+		max_y_ = std::max(max_y_, header.bounds[4]);
+		max_z_ = std::max(max_z_, header.bounds[5]);
+	}
+
+	return true;
+}
+
+template <typename PointSourceType>
+bool CompactVoxelGrid<PointSourceType>::unload(const std::string &path)
+{
+	FileHeader header;
+
+	if (!readHeader(path, header)) {
+		return false;
+	}
+
+	removeRegion(header.region[0], header.region[1], header.region[2], header.region[3]);
+
+	return true;
+}
+
+template class CompactVoxelGrid<pcl::PointXYZI>;
+template class CompactVoxelGrid<pcl::PointXYZ>;
+
+}
@@ -1,7 +1,9 @@
 #include "ndt_cpu/NormalDistributionsTransform.h"
 #include "ndt_cpu/debug.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
+#include <vector>
 #include <pcl/common/transforms.h>
 
 #define V2_ 1
@@ -29,6 +31,8 @@ NormalDistributionsTransform<PointSourceType, PointTargetType>::NormalDistributi
 	transformation_epsilon_ = 0.1;
 	max_iterations_ = 35;
 	real_iterations_ = 0;
+	num_threads_ = 1;
+	use_compact_voxel_grid_ = false;
 }
 
 template <typename PointSourceType, typename PointTargetType>
@@ -49,6 +53,12 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::setOutlierR
 	outlier_ratio_ = olr;
 }
 
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::setNumThreads(int num_threads)
+{
+	num_threads_ = (num_threads > 0) ? num_threads : 1;
+}
+
 template <typename PointSourceType, typename PointTargetType>
 double NormalDistributionsTransform<PointSourceType, PointTargetType>::getStepSize() const
 {
@@ -67,6 +77,30 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::getOutlie
 	return outlier_ratio_;
 }
 
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::getNumThreads() const
+{
+	return num_threads_;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::setUseCompactVoxelGrid(bool use_compact_voxel_grid)
+{
+	use_compact_voxel_grid_ = use_compact_voxel_grid;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+bool NormalDistributionsTransform<PointSourceType, PointTargetType>::getUseCompactVoxelGrid() const
+{
+	return use_compact_voxel_grid_;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::getVoxelNum() const
+{
+	return (use_compact_voxel_grid_) ? compact_voxel_grid_.getVoxelNum() : voxel_grid_.getVoxelNum();
+}
+
 template <typename PointSourceType, typename PointTargetType>
 double NormalDistributionsTransform<PointSourceType, PointTargetType>::getTransformationProbability() const
 {
@@ -98,8 +132,13 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::setInputTar
 
 	// Build the voxel grid
 	if (input->points.size() > 0) {
-		voxel_grid_.setLeafSize(resolution_, resolution_, resolution_);
-		voxel_grid_.setInput(input);
+		if (use_compact_voxel_grid_) {
+			compact_voxel_grid_.setLeafSize(resolution_, resolution_, resolution_);
+			compact_voxel_grid_.setInput(input);
+		} else {
+			voxel_grid_.setLeafSize(resolution_, resolution_, resolution_);
+			voxel_grid_.setInput(input);
+		}
 	}
 }
 
@@ -181,21 +220,84 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::computeTran
 	}
 }
 
+template <typename PointSourceType, typename PointTargetType>
+int NormalDistributionsTransform<PointSourceType, PointTargetType>::chunkNum() const
+{
+	// Small clouds are not worth the cost of spawning threads
+	static const int MIN_POINTS_PER_CHUNK = 256;
+
+	int points_number = source_cloud_->points.size();
+	int chunk_num = std::min(num_threads_, points_number / MIN_POINTS_PER_CHUNK);
+
+	return (chunk_num > 1) ? chunk_num : 1;
+}
+
 template <typename PointSourceType, typename PointTargetType>
 double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDerivatives(Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
 																							typename pcl::PointCloud<PointSourceType> &trans_cloud,
 																							Eigen::Matrix<double, 6, 1> pose, bool compute_hessian)
 {
-	PointSourceType x_pt, x_trans_pt;
-	Eigen::Vector3d x, x_trans;
-	Eigen::Matrix3d c_inv;
-
 	score_gradient.setZero ();
 	hessian.setZero ();
 
 	//Compute Angle Derivatives
 	computeAngleDerivatives(pose);
 
+	int points_number = source_cloud_->points.size();
+	int chunk_num = chunkNum();
+
+	if (chunk_num == 1) {
+		return accumulateDerivatives(0, points_number, score_gradient, hessian, trans_cloud, compute_hessian);
+	}
+
+	// Per-chunk partial sums, reduced below in chunk order
+	std::vector<double> partial_score(chunk_num, 0);
+	std::vector<Eigen::Matrix<double, 6, 1>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1> > > partial_gradient(chunk_num);
+	std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > > partial_hessian(chunk_num);
+
+#pragma omp parallel for num_threads(chunk_num) schedule(static, 1)
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		int begin = static_cast<int>(static_cast<long>(points_number) * chunk / chunk_num);
+		int end = static_cast<int>(static_cast<long>(points_number) * (chunk + 1) / chunk_num);
+
+		partial_gradient[chunk].setZero();
+		partial_hessian[chunk].setZero();
+		partial_score[chunk] = accumulateDerivatives(begin, end, partial_gradient[chunk], partial_hessian[chunk], trans_cloud, compute_hessian);
+	}
+
+	double score = 0;
+
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		score += partial_score[chunk];
+		score_gradient += partial_gradient[chunk];
+		hessian += partial_hessian[chunk];
+	}
+
+	return score;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+double NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateDerivatives(int begin, int end,
+																								Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+																								typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian)
+{
+	if (use_compact_voxel_grid_) {
+		return accumulateDerivatives(compact_voxel_grid_, begin, end, score_gradient, hessian, trans_cloud, compute_hessian);
+	}
+
+	return accumulateDerivatives(voxel_grid_, begin, end, score_gradient, hessian, trans_cloud, compute_hessian);
+}
+
+template <typename PointSourceType, typename PointTargetType>
+template <typename VoxelGridType>
+double NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateDerivatives(VoxelGridType &voxel_grid, int begin, int end,
+																								Eigen::Matrix<double, 6, 1> &score_gradient, Eigen::Matrix<double, 6, 6> &hessian,
+																								typename pcl::PointCloud<PointSourceType> &trans_cloud, bool compute_hessian)
+{
+	PointSourceType x_pt, x_trans_pt;
+	Eigen::Vector3d x, x_trans;
+	Eigen::Matrix3d c_inv;
+
 	std::vector<int> neighbor_ids;
 	Eigen::Matrix<double, 3, 6> point_gradient;
 	Eigen::Matrix<double, 18, 6> point_hessian;
@@ -205,11 +307,11 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDe
 	point_gradient.block<3, 3>(0, 0).setIdentity();
 	point_hessian.setZero();
 
-	for (int idx = 0; idx < source_cloud_->points.size(); idx++) {
+	for (int idx = begin; idx < end; idx++) {
 		neighbor_ids.clear();
 		x_trans_pt = trans_cloud.points[idx];
 
-		voxel_grid_.radiusSearch(x_trans_pt, resolution_, neighbor_ids);
+		voxel_grid.radiusSearch(x_trans_pt, resolution_, neighbor_ids);
 
 		for (int i = 0; i < neighbor_ids.size(); i++) {
 			int vid = neighbor_ids[i];
@@ -219,8 +321,8 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::computeDe
 
 			x_trans = Eigen::Vector3d(x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
 
-			x_trans -= voxel_grid_.getCentroid(vid);
-			c_inv = voxel_grid_.getInverseCovariance(vid);
+			x_trans -= voxel_grid.getCentroid(vid);
+			c_inv = voxel_grid.getInverseCovariance(vid);
 
 			computePointDerivatives(x, point_gradient, point_hessian, compute_hessian);
 
@@ -680,23 +782,67 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::updateHessi
 
 template <typename PointSourceType, typename PointTargetType>
 void NormalDistributionsTransform<PointSourceType, PointTargetType>::computeHessian(Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud, Eigen::Matrix<double, 6, 1> &p)
+{
+	hessian.setZero();
+
+	int points_number = source_cloud_->points.size();
+	int chunk_num = chunkNum();
+
+	if (chunk_num == 1) {
+		accumulateHessian(0, points_number, hessian, trans_cloud);
+		return;
+	}
+
+	std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > > partial_hessian(chunk_num);
+
+#pragma omp parallel for num_threads(chunk_num) schedule(static, 1)
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		int begin = static_cast<int>(static_cast<long>(points_number) * chunk / chunk_num);
+		int end = static_cast<int>(static_cast<long>(points_number) * (chunk + 1) / chunk_num);
+
+		partial_hessian[chunk].setZero();
+		accumulateHessian(begin, end, partial_hessian[chunk], trans_cloud);
+	}
+
+	for (int chunk = 0; chunk < chunk_num; chunk++) {
+		hessian += partial_hessian[chunk];
+	}
+}
+
+template <typename PointSourceType, typename PointTargetType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateHessian(int begin, int end, Eigen::Matrix<double, 6, 6> &hessian, typename pcl::PointCloud<PointSourceType> &trans_cloud)
+{
+	if (use_compact_voxel_grid_) {
+		accumulateHessian(compact_voxel_grid_, begin, end, hessian, trans_cloud);
+	} else {
+		accumulateHessian(voxel_grid_, begin, end, hessian, trans_cloud);
+	}
+}
+
+template <typename PointSourceType, typename PointTargetType>
+template <typename VoxelGridType>
+void NormalDistributionsTransform<PointSourceType, PointTargetType>::accumulateHessian(VoxelGridType &voxel_grid, int begin, int end, Eigen::Matrix<double, 6, 6> &hessian,
+																						typename pcl::PointCloud<PointSourceType> &trans_cloud)
 {
 	PointSourceType x_pt, x_trans_pt;
 	Eigen::Vector3d x, x_trans;
 	Eigen::Matrix3d c_inv;
 
-	hessian.setZero();
-
 	Eigen::Matrix<double, 3, 6> point_gradient;
 	Eigen::Matrix<double, 18, 6> point_hessian;
 
+	point_gradient.setZero();
+	point_gradient.block<3, 3>(0, 0).setIdentity();
+	point_hessian.setZero();
+
+	std::vector<int> neighbor_ids;
 
-	for (int idx = 0; idx < source_cloud_->points.size(); idx++) {
+	for (int idx = begin; idx < end; idx++) {
 		x_trans_pt = trans_cloud.points[idx];
 
-		std::vector<int> neighbor_ids;
+		neighbor_ids.clear();
 
-		voxel_grid_.radiusSearch(x_trans_pt, resolution_, neighbor_ids);
+		voxel_grid.radiusSearch(x_trans_pt, resolution_, neighbor_ids);
 
 		for (int i = 0; i < neighbor_ids.size(); i++) {
 			int vid = neighbor_ids[i];
@@ -704,16 +850,14 @@ void NormalDistributionsTransform<PointSourceType, PointTargetType>::computeHess
 			x_pt = source_cloud_->points[idx];
 			x = Eigen::Vector3d(x_pt.x, x_pt.y, x_pt.z);
 			x_trans = Eigen::Vector3d(x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
-			x_trans -= voxel_grid_.getCentroid(vid);
-			c_inv = voxel_grid_.getInverseCovariance(vid);
+			x_trans -= voxel_grid.getCentroid(vid);
+			c_inv = voxel_grid.getInverseCovariance(vid);
 
 			computePointDerivatives(x, point_gradient, point_hessian);
 
 			updateHessian(hessian, point_gradient, point_hessian, x_trans, c_inv);
 		}
 	}
-
-
 }
 
 template <typename PointSourceType, typename PointTargetType>
@@ -731,7 +875,11 @@ double NormalDistributionsTransform<PointSourceType, PointTargetType>::getFitnes
 	for (int i = 0; i < trans_cloud.points.size(); i++) {
 		PointSourceType q = trans_cloud.points[i];
 
-		distance = voxel_grid_.nearestNeighborDistance(q, max_range);
+		if (use_compact_voxel_grid_) {
+			distance = compact_voxel_grid_.nearestNeighborDistance(q, max_range);
+		} else {
+			distance = voxel_grid_.nearestNeighborDistance(q, max_range);
+		}
 
 		if (distance < max_range) {
 			fitness_score += distance;
@@ -751,7 +899,68 @@ template <typename PointSourceType, typename PointTargetType>
 void NormalDistributionsTransform<PointSourceType, PointTargetType>::updateVoxelGrid(typename pcl::PointCloud<PointTargetType>::Ptr new_cloud)
 {
 	// Update voxel grid
-	voxel_grid_.update(new_cloud);
+	if (use_compact_voxel_grid_) {
+		// The compact grid can also be built from scratch tile by tile
+		if (compact_voxel_grid_.getVoxelNum() == 0) {
+			compact_voxel_grid_.setLeafSize(resolution_, resolution_, resolution_);
+		}
+
+		compact_voxel_grid_.update(new_cloud);
+	} else {
+		voxel_grid_.update(new_cloud);
+	}
+}
+
+template <typename PointSourceType, typename PointTargetType>
+bool NormalDistributionsTransform<PointSourceType, PointTargetType>::removeTargetRegion(float min_x, float min_y, float max_x, float max_y)
+{
+	if (!use_compact_voxel_grid_) {
+		return false;
+	}
+
+	compact_voxel_grid_.removeRegion(min_x, min_y, max_x, max_y);
+
+	return true;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+bool NormalDistributionsTransform<PointSourceType, PointTargetType>::saveTargetTile(const std::string &path, float min_x, float min_y, float max_x, float max_y) const
+{
+	if (!use_compact_voxel_grid_) {
+		return false;
+	}
+
+	return compact_voxel_grid_.save(path, min_x, min_y, max_x, max_y);
+}
+
+template <typename PointSourceType, typename PointTargetType>
+bool NormalDistributionsTransform<PointSourceType, PointTargetType>::loadTargetTile(const std::string &path)
+{
+	if (!use_compact_voxel_grid_) {
+		return false;
+	}
+
+	if (compact_voxel_grid_.getVoxelNum() > 0) {
+		return compact_voxel_grid_.load(path);
+	}
+
+	if (!compact_voxel_grid_.load(path)) {
+		return false;
+	}
+
+	resolution_ = compact_voxel_grid_.getVoxelX();
+
+	return true;
+}
+
+template <typename PointSourceType, typename PointTargetType>
+bool NormalDistributionsTransform<PointSourceType, PointTargetType>::unloadTargetTile(const std::string &path)
+{
+	if (!use_compact_voxel_grid_) {
+		return false;
+	}
+
+	return compact_voxel_grid_.unload(path);
 }
 
 template class NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI>;
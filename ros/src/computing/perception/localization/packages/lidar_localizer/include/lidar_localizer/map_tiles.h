@@ -0,0 +1,111 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LIDAR_LOCALIZER_MAP_TILES_H
+#define LIDAR_LOCALIZER_MAP_TILES_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <ndt_cpu/NormalDistributionsTransform.h>
+
+/*
+ * Map cut into square tiles aligned to the voxel grid of the NDT target.
+ *
+ * Only the tiles within a radius of the vehicle are kept in memory and in the target.
+ * The others are evicted from the target, their voxels are written as <x_min>_<y_min>.ndtv
+ * and their points are handed to a background thread that writes them as binary compressed
+ * <x_min>_<y_min>.pcd. Saved tiles are read back when the vehicle comes near them again.
+ *
+ * Without an NDT only the points are tiled, the caller builds its target from getSubmap().
+ * Used by ndt_offline_mapping and by the local submap mode of ndt_mapping.
+ */
+class MapTiles
+{
+public:
+  typedef std::pair<int, int> TileIndex;
+  typedef pcl::PointCloud<pcl::PointXYZI> Cloud;
+  typedef cpu::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> NDT;
+
+  /* The NDT, if any, must use the compact voxel grid with the given resolution.
+   * A relative output_dir is taken from the current directory. */
+  MapTiles(NDT* ndt, float resolution, double tile_size, double radius, const std::string& output_dir);
+  ~MapTiles();
+
+  /* Add map points to the tiles and to the NDT target */
+  void addScan(const Cloud::Ptr& scan);
+
+  /* Evict the tiles farther than the radius from (x, y) and read back the saved ones within it.
+   * Returns true if a tile was evicted or read back. */
+  bool update(double x, double y);
+
+  /* Points of the tiles in memory */
+  void getSubmap(Cloud& submap) const;
+
+  /* Write all tiles and their arealist.txt, with absolute paths, and wait for the writes.
+   * Returns false if a tile could not be written. */
+  bool save();
+
+  double getTileSize() const;
+
+  /* Number of tiles in memory */
+  size_t getTileNum() const;
+
+  size_t getSavedTileNum() const;
+
+  const std::string& getOutputDir() const;
+
+private:
+  NDT* ndt_;
+  float resolution_;
+  int voxels_per_tile_;
+  double radius_;
+  std::string output_dir_;
+
+  std::map<TileIndex, Cloud::Ptr> tiles_;
+  std::map<TileIndex, std::pair<float, float> > saved_tiles_;  // z range of the tiles on disk
+
+  // Background writer
+  std::deque<std::pair<std::string, Cloud::Ptr> > writes_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  bool stop_;
+  bool write_failed_;
+  std::thread writer_;
+
+  TileIndex tileIndex(float x, float y) const;
+  void tileRegion(const TileIndex& tile, float& min_x, float& min_y, float& max_x, float& max_y) const;
+  std::string tilePath(const TileIndex& tile, const std::string& extension) const;
+  bool inRadius(const TileIndex& tile, double x, double y) const;
+
+  void saveTile(const TileIndex& tile, const Cloud::Ptr& points);
+  Cloud::Ptr& loadTile(const TileIndex& tile);
+
+  void writerLoop();
+
+  /* Block until the queued writes are done */
+  void waitWrites();
+};
+
+#endif  // LIDAR_LOCALIZER_MAP_TILES_H
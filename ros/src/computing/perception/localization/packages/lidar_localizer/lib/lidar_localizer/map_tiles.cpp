@@ -0,0 +1,301 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "lidar_localizer/map_tiles.h"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <unistd.h>
+
+#include <pcl/io/pcd_io.h>
+
+static int floor_div(int a, int b)
+{
+  return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+// The arealist is read by points_map_loader from its own working directory
+static std::string absolute_path(const std::string& path)
+{
+  if (!path.empty() && path[0] == '/')
+    return path;
+
+  char cwd[PATH_MAX];
+  if (getcwd(cwd, sizeof(cwd)) == NULL)
+    return path;
+  return path.empty() ? std::string(cwd) : std::string(cwd) + "/" + path;
+}
+
+MapTiles::MapTiles(NDT* ndt, float resolution, double tile_size, double radius, const std::string& output_dir)
+  : ndt_(ndt), resolution_(resolution), radius_(radius), output_dir_(absolute_path(output_dir)), stop_(false),
+    write_failed_(false)
+{
+  // Tiles are aligned to the voxel grid so that no voxel is shared by two tiles
+  voxels_per_tile_ = std::max(1, static_cast<int>(std::round(tile_size / resolution_)));
+
+  writer_ = std::thread(&MapTiles::writerLoop, this);
+}
+
+MapTiles::~MapTiles()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cond_.notify_all();
+  writer_.join();
+}
+
+double MapTiles::getTileSize() const
+{
+  return voxels_per_tile_ * resolution_;
+}
+
+size_t MapTiles::getTileNum() const
+{
+  return tiles_.size();
+}
+
+size_t MapTiles::getSavedTileNum() const
+{
+  return saved_tiles_.size();
+}
+
+const std::string& MapTiles::getOutputDir() const
+{
+  return output_dir_;
+}
+
+MapTiles::TileIndex MapTiles::tileIndex(float x, float y) const
+{
+  return TileIndex(floor_div(static_cast<int>(std::floor(x / resolution_)), voxels_per_tile_),
+                   floor_div(static_cast<int>(std::floor(y / resolution_)), voxels_per_tile_));
+}
+
+void MapTiles::tileRegion(const TileIndex& tile, float& min_x, float& min_y, float& max_x, float& max_y) const
+{
+  float tile_size = voxels_per_tile_ * resolution_;
+  min_x = tile.first * tile_size;
+  min_y = tile.second * tile_size;
+  max_x = min_x + tile_size;
+  max_y = min_y + tile_size;
+}
+
+std::string MapTiles::tilePath(const TileIndex& tile, const std::string& extension) const
+{
+  float min_x, min_y, max_x, max_y;
+  tileRegion(tile, min_x, min_y, max_x, max_y);
+
+  std::ostringstream path;
+  path << output_dir_ << "/" << static_cast<long>(std::floor(min_x)) << "_" << static_cast<long>(std::floor(min_y))
+       << extension;
+  return path.str();
+}
+
+bool MapTiles::inRadius(const TileIndex& tile, double x, double y) const
+{
+  float min_x, min_y, max_x, max_y;
+  tileRegion(tile, min_x, min_y, max_x, max_y);
+
+  double dx = std::max(0.0, std::max(min_x - x, x - max_x));
+  double dy = std::max(0.0, std::max(min_y - y, y - max_y));
+  return dx * dx + dy * dy <= radius_ * radius_;
+}
+
+void MapTiles::addScan(const Cloud::Ptr& scan)
+{
+  TileIndex last_tile;
+  Cloud* last_points = NULL;
+
+  for (const pcl::PointXYZI& p : scan->points)
+  {
+    TileIndex tile = tileIndex(p.x, p.y);
+    if (last_points == NULL || tile != last_tile)
+    {
+      std::map<TileIndex, Cloud::Ptr>::iterator it = tiles_.find(tile);
+      if (it != tiles_.end())
+        last_points = it->second.get();
+      else if (saved_tiles_.count(tile) != 0)
+        last_points = loadTile(tile).get();  // read back first so that the saved tile is not overwritten
+      else
+        last_points = (tiles_[tile] = Cloud::Ptr(new Cloud())).get();
+      last_tile = tile;
+    }
+    last_points->push_back(p);
+  }
+
+  if (ndt_ != NULL)
+    ndt_->updateVoxelGrid(scan);
+}
+
+bool MapTiles::update(double x, double y)
+{
+  bool changed = false;
+
+  std::map<TileIndex, Cloud::Ptr>::iterator it = tiles_.begin();
+  while (it != tiles_.end())
+  {
+    if (inRadius(it->first, x, y))
+    {
+      ++it;
+      continue;
+    }
+
+    float min_x, min_y, max_x, max_y;
+    tileRegion(it->first, min_x, min_y, max_x, max_y);
+
+    saveTile(it->first, it->second);
+    if (ndt_ != NULL)
+      ndt_->removeTargetRegion(min_x, min_y, max_x, max_y);
+    tiles_.erase(it++);
+    changed = true;
+  }
+
+  int range = static_cast<int>(std::ceil(radius_ / getTileSize()));
+  TileIndex center = tileIndex(x, y);
+  for (int i = center.first - range; i <= center.first + range; i++)
+  {
+    for (int j = center.second - range; j <= center.second + range; j++)
+    {
+      TileIndex tile(i, j);
+      if (saved_tiles_.count(tile) != 0 && tiles_.count(tile) == 0 && inRadius(tile, x, y))
+      {
+        loadTile(tile);
+        changed = true;
+      }
+    }
+  }
+
+  return changed;
+}
+
+void MapTiles::getSubmap(Cloud& submap) const
+{
+  submap.clear();
+  for (const std::pair<const TileIndex, Cloud::Ptr>& tile : tiles_)
+    submap += *tile.second;
+}
+
+bool MapTiles::save()
+{
+  for (const std::pair<const TileIndex, Cloud::Ptr>& tile : tiles_)
+    saveTile(tile.first, tile.second);
+
+  waitWrites();
+
+  std::string arealist_path = output_dir_ + "/arealist.txt";
+  std::ofstream arealist(arealist_path.c_str());
+  if (!arealist)
+  {
+    std::cerr << "Cannot open " << arealist_path << std::endl;
+    return false;
+  }
+
+  for (const std::pair<const TileIndex, std::pair<float, float> >& tile : saved_tiles_)
+  {
+    float min_x, min_y, max_x, max_y;
+    tileRegion(tile.first, min_x, min_y, max_x, max_y);
+    arealist << tilePath(tile.first, ".pcd") << "," << min_x << "," << min_y << "," << tile.second.first << ","
+             << max_x << "," << max_y << "," << tile.second.second << std::endl;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !write_failed_;
+}
+
+void MapTiles::saveTile(const TileIndex& tile, const Cloud::Ptr& points)
+{
+  if (points->empty())
+    return;
+
+  float min_z = points->points[0].z;
+  float max_z = min_z;
+  for (const pcl::PointXYZI& p : points->points)
+  {
+    min_z = std::min(min_z, p.z);
+    max_z = std::max(max_z, p.z);
+  }
+  saved_tiles_[tile] = std::make_pair(min_z, max_z);
+
+  // The voxels have to be written before they are evicted, the points can wait
+  float min_x, min_y, max_x, max_y;
+  tileRegion(tile, min_x, min_y, max_x, max_y);
+  if (ndt_ != NULL && !ndt_->saveTargetTile(tilePath(tile, ".ndtv"), min_x, min_y, max_x, max_y))
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    write_failed_ = true;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    writes_.push_back(std::make_pair(tilePath(tile, ".pcd"), points));
+  }
+  cond_.notify_all();
+}
+
+MapTiles::Cloud::Ptr& MapTiles::loadTile(const TileIndex& tile)
+{
+  // The tile may still be in the write queue
+  waitWrites();
+
+  Cloud::Ptr& points = tiles_[tile];
+  points.reset(new Cloud());
+
+  std::string path = tilePath(tile, ".pcd");
+  if (pcl::io::loadPCDFile<pcl::PointXYZI>(path, *points) == -1)
+    std::cerr << "Cannot load " << path << std::endl;
+
+  if (ndt_ != NULL)
+    ndt_->loadTargetTile(tilePath(tile, ".ndtv"));
+
+  return points;
+}
+
+void MapTiles::writerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true)
+  {
+    cond_.wait(lock, [this] { return stop_ || !writes_.empty(); });
+    if (writes_.empty())
+      return;
+
+    // Keep the entry queued while it is written, see waitWrites()
+    std::pair<std::string, Cloud::Ptr> write = writes_.front();
+    lock.unlock();
+
+    bool ok = (pcl::io::savePCDFileBinaryCompressed(write.first, *write.second) == 0);
+    if (!ok)
+      std::cerr << "Cannot write " << write.first << std::endl;
+
+    lock.lock();
+    write_failed_ = write_failed_ || !ok;
+    writes_.pop_front();
+    cond_.notify_all();
+  }
+}
+
+void MapTiles::waitWrites()
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [this] { return writes_.empty(); });
+}
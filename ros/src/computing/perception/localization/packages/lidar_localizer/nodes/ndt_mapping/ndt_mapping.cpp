@@ -24,9 +24,12 @@
 
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string>
 
+#include <sys/stat.h>
+
 #include <nav_msgs/Odometry.h>
 #include <ros/ros.h>
 #include <sensor_msgs/Imu.h>
@@ -56,6 +59,8 @@
 #include <autoware_config_msgs/ConfigNDTMapping.h>
 #include <autoware_config_msgs/ConfigNDTMappingOutput.h>
 
+#include "lidar_localizer/map_tiles.h"
+
 #include <time.h>
 
 struct pose
@@ -149,6 +154,16 @@ static bool _imu_upside_down = false;
 
 static bool _incremental_voxel_update = false;
 
+// Local submap mode: only the map tiles within _submap_radius of the current pose are kept
+// as NDT target, the other tiles are written to _map_tile_dir and read back when revisited.
+static bool _use_local_submap = false;
+static double _submap_radius = 200.0;
+static double _map_tile_size = 50.0;
+static std::string _map_tile_dir = ".";
+
+static std::unique_ptr<MapTiles> map_tiles;  // created at the first scan, which fixes the resolution
+static pcl::PointCloud<pcl::PointXYZI>::Ptr submap_ptr(new pcl::PointCloud<pcl::PointXYZI>());
+
 static std::string _imu_topic = "/imu_raw";
 
 static double fitness_score;
@@ -192,6 +207,20 @@ static void output_callback(const autoware_config_msgs::ConfigNDTMappingOutput::
   std::cout << "filter_res: " << filter_res << std::endl;
   std::cout << "filename: " << filename << std::endl;
 
+  // In local submap mode the map is only on disk as a whole
+  if (_use_local_submap == true)
+  {
+    if (!map_tiles)
+      return;
+
+    if (map_tiles->save())
+      std::cout << "Saved " << map_tiles->getSavedTileNum() << " tiles to " << map_tiles->getOutputDir() << "."
+                << std::endl;
+    else
+      std::cerr << "Could not write all tiles to " << map_tiles->getOutputDir() << "." << std::endl;
+    return;
+  }
+
   pcl::PointCloud<pcl::PointXYZI>::Ptr map_ptr(new pcl::PointCloud<pcl::PointXYZI>(map));
   pcl::PointCloud<pcl::PointXYZI>::Ptr map_filtered(new pcl::PointCloud<pcl::PointXYZI>());
   map_ptr->header.frame_id = "map";
@@ -488,7 +517,19 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
   if (initial_scan_loaded == 0)
   {
     pcl::transformPointCloud(*scan_ptr, *transformed_scan_ptr, tf_btol);
-    map += *transformed_scan_ptr;
+    if (_use_local_submap == true)
+    {
+      // The tiles, and the target voxels with PCL_ANH, keep the resolution of the first scan
+      anh_ndt.setResolution(ndt_res);
+      map_tiles.reset(new MapTiles(_method_type == MethodType::PCL_ANH ? &anh_ndt : NULL, ndt_res, _map_tile_size,
+                                   _submap_radius, _map_tile_dir));
+      map_tiles->addScan(transformed_scan_ptr);
+      *submap_ptr = *transformed_scan_ptr;
+    }
+    else
+    {
+      map += *transformed_scan_ptr;
+    }
     initial_scan_loaded = 1;
   }
 
@@ -538,7 +579,22 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 #endif
 
   static bool is_first_map = true;
-  if (is_first_map == true)
+  if (is_first_map == true && _use_local_submap == true)
+  {
+    // The voxels of the PCL_ANH target are already in place
+    if (_method_type == MethodType::PCL_GENERIC)
+      ndt.setInputTarget(submap_ptr);
+#ifdef CUDA_FOUND
+    else if (_method_type == MethodType::PCL_ANH_GPU)
+      anh_gpu_ndt.setInputTarget(submap_ptr);
+#endif
+#ifdef USE_PCL_OPENMP
+    else if (_method_type == MethodType::PCL_OPENMP)
+      omp_ndt.setInputTarget(submap_ptr);
+#endif
+    is_first_map = false;
+  }
+  else if (is_first_map == true)
   {
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setInputTarget(map_ptr);
@@ -749,7 +805,14 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 
   // Calculate the shift between added_pos and current_pos
   double shift = sqrt(pow(current_pose.x - added_pose.x, 2.0) + pow(current_pose.y - added_pose.y, 2.0));
-  if (shift >= min_add_scan_shift)
+  bool submap_changed = false;
+  if (shift >= min_add_scan_shift && _use_local_submap == true)
+  {
+    map_tiles->addScan(transformed_scan_ptr);
+    added_pose = current_pose;
+    submap_changed = true;
+  }
+  else if (shift >= min_add_scan_shift)
   {
     map += *transformed_scan_ptr;
     added_pose.x = current_pose.x;
@@ -778,9 +841,40 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 #endif
   }
 
-  sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
-  pcl::toROSMsg(*map_ptr, *map_msg_ptr);
-  ndt_map_pub.publish(*map_msg_ptr);
+  if (_use_local_submap == true)
+  {
+    if (map_tiles->update(current_pose.x, current_pose.y))
+      submap_changed = true;
+
+    // Only the submap is handed to the target and published, so the cost per scan does not grow with the map
+    if (submap_changed == true && (_method_type != MethodType::PCL_ANH || ndt_map_pub.getNumSubscribers() > 0))
+    {
+      submap_ptr.reset(new pcl::PointCloud<pcl::PointXYZI>());
+      map_tiles->getSubmap(*submap_ptr);
+      submap_ptr->header.frame_id = "map";
+
+      if (_method_type == MethodType::PCL_GENERIC)
+        ndt.setInputTarget(submap_ptr);
+#ifdef CUDA_FOUND
+      else if (_method_type == MethodType::PCL_ANH_GPU)
+        anh_gpu_ndt.setInputTarget(submap_ptr);
+#endif
+#ifdef USE_PCL_OPENMP
+      else if (_method_type == MethodType::PCL_OPENMP)
+        omp_ndt.setInputTarget(submap_ptr);
+#endif
+
+      sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
+      pcl::toROSMsg(*submap_ptr, *map_msg_ptr);
+      ndt_map_pub.publish(*map_msg_ptr);
+    }
+  }
+  else
+  {
+    sensor_msgs::PointCloud2::Ptr map_msg_ptr(new sensor_msgs::PointCloud2);
+    pcl::toROSMsg(*map_ptr, *map_msg_ptr);
+    ndt_map_pub.publish(*map_msg_ptr);
+  }
 
   q.setRPY(current_pose.roll, current_pose.pitch, current_pose.yaw);
   current_pose_msg.header.frame_id = "map";
@@ -829,7 +923,11 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
   std::cout << "Number of scan points: " << scan_ptr->size() << " points." << std::endl;
   std::cout << "Number of filtered scan points: " << filtered_scan_ptr->size() << " points." << std::endl;
   std::cout << "transformed_scan_ptr: " << transformed_scan_ptr->points.size() << " points." << std::endl;
-  std::cout << "map: " << map.points.size() << " points." << std::endl;
+  if (_use_local_submap == true)
+    std::cout << "submap: " << map_tiles->getTileNum() << " tiles, " << map_tiles->getSavedTileNum() << " tiles saved."
+              << std::endl;
+  else
+    std::cout << "map: " << map.points.size() << " points." << std::endl;
   std::cout << "NDT has converged: " << has_converged << std::endl;
   std::cout << "Fitness score: " << fitness_score << std::endl;
   std::cout << "Number of iteration: " << final_num_iteration << std::endl;
@@ -961,6 +1059,10 @@ int main(int argc, char** argv)
   private_nh.getParam("imu_upside_down", _imu_upside_down);
   private_nh.getParam("imu_topic", _imu_topic);
   private_nh.getParam("incremental_voxel_update", _incremental_voxel_update);
+  private_nh.getParam("use_local_submap", _use_local_submap);
+  private_nh.getParam("submap_radius", _submap_radius);
+  private_nh.getParam("map_tile_size", _map_tile_size);
+  private_nh.getParam("map_tile_dir", _map_tile_dir);
 
   std::cout << "method_type: " << static_cast<int>(_method_type) << std::endl;
   std::cout << "use_odom: " << _use_odom << std::endl;
@@ -968,6 +1070,17 @@ int main(int argc, char** argv)
   std::cout << "imu_upside_down: " << _imu_upside_down << std::endl;
   std::cout << "imu_topic: " << _imu_topic << std::endl;
   std::cout << "incremental_voxel_update: " << _incremental_voxel_update << std::endl;
+  std::cout << "use_local_submap: " << _use_local_submap << std::endl;
+  std::cout << "submap_radius: " << _submap_radius << std::endl;
+  std::cout << "map_tile_size: " << _map_tile_size << std::endl;
+  std::cout << "map_tile_dir: " << _map_tile_dir << std::endl;
+
+  if (_use_local_submap == true)
+  {
+    // Scans are inserted into the voxels of the target and evicted tile by tile
+    anh_ndt.setUseCompactVoxelGrid(true);
+    mkdir(_map_tile_dir.c_str(), 0755);
+  }
 
   if (nh.getParam("tf_x", _tf_x) == false)
   {
@@ -21,12 +21,19 @@
  */
 
 #include <pthread.h>
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <set>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 
@@ -90,6 +97,15 @@ struct pose
   double yaw;
 };
 
+// Part of points_map used to find which regions changed between two map updates
+struct MapTile
+{
+  std::size_t point_num;
+  double coordinate_sum;
+  pcl::PointCloud<pcl::PointXYZ>::Ptr points;
+};
+typedef std::map<std::pair<int, int>, MapTile> MapTiles;
+
 enum class MethodType
 {
   PCL_GENERIC = 0,
@@ -113,11 +129,20 @@ static pcl::PointCloud<pcl::PointXYZ> map, add;
 
 // If the map is loaded, map_loaded will be 1.
 static int map_loaded = 0;
+// True while voxel map tiles are loaded, their resolution is then the one stored in the tiles
+static bool voxel_map_loaded = false;
 static int _use_gnss = 1;
 static int init_pos_set = 0;
 
 static pcl::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> ndt;
-static cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> anh_ndt;
+static std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> anh_ndt_ptr =
+    std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+// Second PCL_ANH instance for incremental map updates, unless double_buffer_map_update is turned off. It is
+// only touched by the map thread, and swapped with anh_ndt_ptr once it holds the new map. It keeps a full copy
+// of the target voxels, so the map takes twice the memory.
+static std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> anh_ndt_back_ptr;
+// Resolution of the target built by update_anh_ndt_map, 0 until it is built
+static float anh_ndt_map_res = 0;
 #ifdef CUDA_FOUND
 static std::shared_ptr<gpu::GNormalDistributionsTransform> anh_gpu_ndt_ptr =
     std::make_shared<gpu::GNormalDistributionsTransform>();
@@ -131,6 +156,11 @@ static int max_iter = 30;        // Maximum iterations
 static float ndt_res = 1.0;      // Resolution
 static double step_size = 0.1;   // Step size
 static double trans_eps = 0.01;  // Transformation epsilon
+static int _num_threads = 1;     // Number of threads used by PCL_ANH
+static bool _use_compact_voxel_grid = false;    // Sparse float voxel storage for PCL_ANH
+static bool _incremental_map_update = false;    // Update PCL_ANH target tile by tile
+static bool _double_buffer_map_update = true;   // Apply map updates to a second PCL_ANH instance
+static double _map_tile_size = 20.0;            // [m]
 
 static ros::Publisher predict_pose_pub;
 static geometry_msgs::PoseStamped predict_pose_msg;
@@ -234,6 +264,7 @@ static nav_msgs::Odometry odom;
 static tf::StampedTransform local_transform;
 
 static unsigned int points_map_num = 0;
+static MapTiles map_tiles;
 
 pthread_mutex_t mutex;
 
@@ -277,14 +308,18 @@ static void param_callback(const autoware_config_msgs::ConfigNDT::ConstPtr& inpu
   _use_gnss = input->init_pos_gnss;
 
   // Setting parameters
-  if (input->resolution != ndt_res)
+  if (input->resolution != ndt_res && voxel_map_loaded)
+  {
+    ROS_WARN("Ignoring resolution %f, the loaded voxel map tiles have resolution %f.", input->resolution, ndt_res);
+  }
+  else if (input->resolution != ndt_res)
   {
     ndt_res = input->resolution;
 
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setResolution(ndt_res);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setResolution(ndt_res);
+      anh_ndt_ptr->setResolution(ndt_res);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setResolution(ndt_res);
@@ -302,7 +337,7 @@ static void param_callback(const autoware_config_msgs::ConfigNDT::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setStepSize(step_size);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setStepSize(step_size);
+      anh_ndt_ptr->setStepSize(step_size);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setStepSize(step_size);
@@ -320,7 +355,7 @@ static void param_callback(const autoware_config_msgs::ConfigNDT::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setTransformationEpsilon(trans_eps);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setTransformationEpsilon(trans_eps);
+      anh_ndt_ptr->setTransformationEpsilon(trans_eps);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setTransformationEpsilon(trans_eps);
@@ -338,7 +373,7 @@ static void param_callback(const autoware_config_msgs::ConfigNDT::ConstPtr& inpu
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setMaximumIterations(max_iter);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setMaximumIterations(max_iter);
+      anh_ndt_ptr->setMaximumIterations(max_iter);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setMaximumIterations(max_iter);
@@ -421,6 +456,259 @@ static void param_callback(const autoware_config_msgs::ConfigNDT::ConstPtr& inpu
   }
 }
 
+static MapTiles split_into_map_tiles(const pcl::PointCloud<pcl::PointXYZ>& cloud, int voxels_per_tile)
+{
+  // Tiles are aligned to the NDT voxels, so every voxel belongs to exactly one tile
+  MapTiles tiles;
+
+  for (const pcl::PointXYZ& p : cloud.points)
+  {
+    int vx = static_cast<int>(std::floor(p.x / ndt_res));
+    int vy = static_cast<int>(std::floor(p.y / ndt_res));
+    std::pair<int, int> key(static_cast<int>(std::floor(static_cast<double>(vx) / voxels_per_tile)),
+                            static_cast<int>(std::floor(static_cast<double>(vy) / voxels_per_tile)));
+
+    MapTile& tile = tiles[key];
+    if (!tile.points)
+    {
+      tile.point_num = 0;
+      tile.coordinate_sum = 0.0;
+      tile.points.reset(new pcl::PointCloud<pcl::PointXYZ>());
+    }
+
+    tile.points->push_back(p);
+    tile.point_num++;
+    tile.coordinate_sum += static_cast<double>(p.x) + p.y + p.z;
+  }
+
+  return tiles;
+}
+
+static void set_anh_ndt_params(cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& anh_ndt,
+                               float resolution)
+{
+  anh_ndt.setUseCompactVoxelGrid(true);
+  anh_ndt.setResolution(resolution);
+  anh_ndt.setMaximumIterations(max_iter);
+  anh_ndt.setStepSize(step_size);
+  anh_ndt.setTransformationEpsilon(trans_eps);
+  anh_ndt.setNumThreads(_num_threads);
+}
+
+static void apply_map_tile_changes(cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& anh_ndt,
+                                   const std::vector<std::pair<int, int>>& removed_tiles,
+                                   const std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr>& added_tiles,
+                                   float tile_size)
+{
+  for (const std::pair<int, int>& key : removed_tiles)
+  {
+    anh_ndt.removeTargetRegion(key.first * tile_size, key.second * tile_size, (key.first + 1) * tile_size,
+                               (key.second + 1) * tile_size);
+  }
+
+  for (const pcl::PointCloud<pcl::PointXYZ>::Ptr& points : added_tiles)
+  {
+    anh_ndt.updateVoxelGrid(points);
+  }
+}
+
+/* Swap in a PCL_ANH instance holding a whole new map.
+ * With double_buffer_map_update, a copy of it is kept as the back instance. */
+static void
+replace_anh_ndt(const std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>& new_anh_ndt_ptr)
+{
+  std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_back_ptr;
+  if (_double_buffer_map_update)
+  {
+    new_back_ptr = std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+    *new_back_ptr = *new_anh_ndt_ptr;
+  }
+
+  pthread_mutex_lock(&mutex);
+  anh_ndt_ptr = new_anh_ndt_ptr;
+  pthread_mutex_unlock(&mutex);
+
+  anh_ndt_back_ptr = new_back_ptr;
+}
+
+/* Apply a map change to the PCL_ANH target.
+ * By default the change is applied to the back instance, which is then swapped in, so points_callback
+ * waits for a pointer swap at most. With double_buffer_map_update turned off, to save memory, it is
+ * applied in place, and points_callback waits for the changed tiles to be updated. */
+template <class ApplyChanges>
+static void update_anh_ndt(const ApplyChanges& apply_changes)
+{
+  std::chrono::time_point<std::chrono::system_clock> update_start, lock_start, lock_end;
+  update_start = std::chrono::system_clock::now();
+
+  if (_double_buffer_map_update)
+  {
+    apply_changes(*anh_ndt_back_ptr);
+
+    pthread_mutex_lock(&mutex);
+    lock_start = std::chrono::system_clock::now();
+    anh_ndt_ptr.swap(anh_ndt_back_ptr);
+    lock_end = std::chrono::system_clock::now();
+    pthread_mutex_unlock(&mutex);
+
+    // Bring the previous instance up to date, it becomes the back buffer
+    apply_changes(*anh_ndt_back_ptr);
+  }
+  else
+  {
+    pthread_mutex_lock(&mutex);
+    lock_start = std::chrono::system_clock::now();
+    apply_changes(*anh_ndt_ptr);
+    lock_end = std::chrono::system_clock::now();
+    pthread_mutex_unlock(&mutex);
+  }
+
+  // The lock time is how long points_callback could be kept from aligning
+  std::cout << "Map update time: "
+            << std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - update_start)
+                       .count() /
+                   1000.0
+            << " ms, locked: "
+            << std::chrono::duration_cast<std::chrono::microseconds>(lock_end - lock_start).count() / 1000.0 << " ms"
+            << std::endl;
+}
+
+/* Update the PCL_ANH target map with only the tiles that changed. */
+static void update_anh_ndt_map(const pcl::PointCloud<pcl::PointXYZ>::Ptr& map_ptr)
+{
+  int voxels_per_tile = std::max(1, static_cast<int>(std::round(_map_tile_size / ndt_res)));
+  float tile_size = voxels_per_tile * ndt_res;
+  MapTiles new_tiles = split_into_map_tiles(*map_ptr, voxels_per_tile);
+
+  if (anh_ndt_map_res != ndt_res)
+  {
+    std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+        std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+    set_anh_ndt_params(*new_anh_ndt_ptr, ndt_res);
+    new_anh_ndt_ptr->setInputTarget(map_ptr);
+    replace_anh_ndt(new_anh_ndt_ptr);
+    anh_ndt_map_res = ndt_res;
+  }
+  else
+  {
+    std::vector<std::pair<int, int>> removed_tiles;
+    std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> added_tiles;
+
+    for (const MapTiles::value_type& old_tile : map_tiles)
+    {
+      MapTiles::const_iterator it = new_tiles.find(old_tile.first);
+      if (it == new_tiles.end() || it->second.point_num != old_tile.second.point_num ||
+          it->second.coordinate_sum != old_tile.second.coordinate_sum)
+      {
+        removed_tiles.push_back(old_tile.first);
+      }
+    }
+
+    for (const MapTiles::value_type& new_tile : new_tiles)
+    {
+      MapTiles::const_iterator it = map_tiles.find(new_tile.first);
+      if (it == map_tiles.end() || it->second.point_num != new_tile.second.point_num ||
+          it->second.coordinate_sum != new_tile.second.coordinate_sum)
+      {
+        added_tiles.push_back(new_tile.second.points);
+      }
+    }
+
+    std::cout << "Incremental map update: " << removed_tiles.size() << " tiles removed, " << added_tiles.size()
+              << " tiles added." << std::endl;
+
+    update_anh_ndt([&](cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& anh_ndt) {
+      apply_map_tile_changes(anh_ndt, removed_tiles, added_tiles, tile_size);
+      set_anh_ndt_params(anh_ndt, ndt_res);
+    });
+  }
+
+  // Only the tile signatures are needed to detect the next change
+  for (MapTiles::value_type& tile : new_tiles)
+  {
+    tile.second.points.reset();
+  }
+  map_tiles.swap(new_tiles);
+}
+
+static void apply_voxel_map_changes(cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& anh_ndt,
+                                    const std::vector<std::string>& removed_paths,
+                                    const std::vector<std::string>& added_paths)
+{
+  for (const std::string& path : removed_paths)
+  {
+    if (!anh_ndt.unloadTargetTile(path))
+      ROS_ERROR("Failed to unload voxel map %s", path.c_str());
+  }
+
+  for (const std::string& path : added_paths)
+  {
+    if (!anh_ndt.loadTargetTile(path))
+      ROS_ERROR("Failed to load voxel map %s", path.c_str());
+  }
+}
+
+/* Pre-voxelized map tiles (see ndt_voxel_map_generator) published by
+ * points_map_loader as a list of paths. The tiles are mapped straight into
+ * the PCL_ANH voxel grid, and updated like update_anh_ndt_map does.
+ * The resolution is the one stored in the tiles. */
+static void voxel_map_callback(const std_msgs::String::ConstPtr& input)
+{
+  static std::set<std::string> loaded_paths;
+
+  if (_method_type != MethodType::PCL_ANH)
+  {
+    ROS_ERROR("Voxel maps are only supported by PCL_ANH.");
+    return;
+  }
+
+  std::set<std::string> new_paths;
+  std::istringstream iss(input->data);
+  std::string path;
+  while (std::getline(iss, path))
+  {
+    if (!path.empty())
+      new_paths.insert(path);
+  }
+
+  std::vector<std::string> removed_paths, added_paths;
+  std::set_difference(loaded_paths.begin(), loaded_paths.end(), new_paths.begin(), new_paths.end(),
+                      std::back_inserter(removed_paths));
+  std::set_difference(new_paths.begin(), new_paths.end(), loaded_paths.begin(), loaded_paths.end(),
+                      std::back_inserter(added_paths));
+
+  if (removed_paths.empty() && added_paths.empty())
+    return;
+
+  std::cout << "Update voxel map: " << removed_paths.size() << " tiles removed, " << added_paths.size()
+            << " tiles added." << std::endl;
+
+  if (loaded_paths.empty())
+  {
+    std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+        std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+    new_anh_ndt_ptr->setUseCompactVoxelGrid(true);
+    apply_voxel_map_changes(*new_anh_ndt_ptr, removed_paths, added_paths);
+    set_anh_ndt_params(*new_anh_ndt_ptr, new_anh_ndt_ptr->getResolution());
+    replace_anh_ndt(new_anh_ndt_ptr);
+  }
+  else
+  {
+    update_anh_ndt([&](cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>& anh_ndt) {
+      apply_voxel_map_changes(anh_ndt, removed_paths, added_paths);
+      set_anh_ndt_params(anh_ndt, anh_ndt.getResolution());
+    });
+  }
+
+  loaded_paths.swap(new_paths);
+  voxel_map_loaded = !loaded_paths.empty();
+  if (voxel_map_loaded)
+  {
+    ndt_res = anh_ndt_ptr->getResolution();
+  }
+  map_loaded = 1;
+}
+
 static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
 {
   // if (map_loaded == 0)
@@ -469,24 +757,31 @@ static void map_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
       ndt = new_ndt;
       pthread_mutex_unlock(&mutex);
     }
+    else if (_method_type == MethodType::PCL_ANH && _incremental_map_update)
+    {
+      update_anh_ndt_map(map_ptr);
+    }
     else if (_method_type == MethodType::PCL_ANH)
     {
-      cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> new_anh_ndt;
-      new_anh_ndt.setResolution(ndt_res);
-      new_anh_ndt.setInputTarget(map_ptr);
-      new_anh_ndt.setMaximumIterations(max_iter);
-      new_anh_ndt.setStepSize(step_size);
-      new_anh_ndt.setTransformationEpsilon(trans_eps);
+      std::shared_ptr<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>> new_anh_ndt_ptr =
+          std::make_shared<cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ>>();
+      new_anh_ndt_ptr->setUseCompactVoxelGrid(_use_compact_voxel_grid);
+      new_anh_ndt_ptr->setResolution(ndt_res);
+      new_anh_ndt_ptr->setInputTarget(map_ptr);
+      new_anh_ndt_ptr->setMaximumIterations(max_iter);
+      new_anh_ndt_ptr->setStepSize(step_size);
+      new_anh_ndt_ptr->setTransformationEpsilon(trans_eps);
+      new_anh_ndt_ptr->setNumThreads(_num_threads);
 
       pcl::PointCloud<pcl::PointXYZ>::Ptr dummy_scan_ptr(new pcl::PointCloud<pcl::PointXYZ>());
       pcl::PointXYZ dummy_point;
       dummy_scan_ptr->push_back(dummy_point);
-      new_anh_ndt.setInputSource(dummy_scan_ptr);
+      new_anh_ndt_ptr->setInputSource(dummy_scan_ptr);
 
-      new_anh_ndt.align(Eigen::Matrix4f::Identity());
+      new_anh_ndt_ptr->align(Eigen::Matrix4f::Identity());
 
       pthread_mutex_lock(&mutex);
-      anh_ndt = new_anh_ndt;
+      anh_ndt_ptr = new_anh_ndt_ptr;
       pthread_mutex_unlock(&mutex);
     }
 #ifdef CUDA_FOUND
@@ -946,13 +1241,18 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     std::chrono::time_point<std::chrono::system_clock> align_start, align_end, getFitnessScore_start,
         getFitnessScore_end;
     static double align_time, getFitnessScore_time = 0.0;
+    static double map_lock_wait_time = 0.0;
 
+    std::chrono::time_point<std::chrono::system_clock> lock_start = std::chrono::system_clock::now();
     pthread_mutex_lock(&mutex);
+    map_lock_wait_time =
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now() - lock_start).count() /
+        1000.0;
 
     if (_method_type == MethodType::PCL_GENERIC)
       ndt.setInputSource(filtered_scan_ptr);
     else if (_method_type == MethodType::PCL_ANH)
-      anh_ndt.setInputSource(filtered_scan_ptr);
+      anh_ndt_ptr->setInputSource(filtered_scan_ptr);
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
       anh_gpu_ndt_ptr->setInputSource(filtered_scan_ptr);
@@ -1039,19 +1339,19 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     else if (_method_type == MethodType::PCL_ANH)
     {
       align_start = std::chrono::system_clock::now();
-      anh_ndt.align(init_guess);
+      anh_ndt_ptr->align(init_guess);
       align_end = std::chrono::system_clock::now();
 
-      has_converged = anh_ndt.hasConverged();
+      has_converged = anh_ndt_ptr->hasConverged();
 
-      t = anh_ndt.getFinalTransformation();
-      iteration = anh_ndt.getFinalNumIteration();
+      t = anh_ndt_ptr->getFinalTransformation();
+      iteration = anh_ndt_ptr->getFinalNumIteration();
 
       getFitnessScore_start = std::chrono::system_clock::now();
-      fitness_score = anh_ndt.getFitnessScore();
+      fitness_score = anh_ndt_ptr->getFitnessScore();
       getFitnessScore_end = std::chrono::system_clock::now();
 
-      trans_probability = anh_ndt.getTransformationProbability();
+      trans_probability = anh_ndt_ptr->getTransformationProbability();
     }
 #ifdef CUDA_FOUND
     else if (_method_type == MethodType::PCL_ANH_GPU)
@@ -1456,6 +1756,7 @@ static void points_callback(const sensor_msgs::PointCloud2::ConstPtr& input)
     std::cout << t << std::endl;
     std::cout << "Align time: " << align_time << std::endl;
     std::cout << "Get fitness score time: " << getFitnessScore_time << std::endl;
+    std::cout << "Map lock wait time: " << map_lock_wait_time << std::endl;
     std::cout << "-----------------------------------------------------------------" << std::endl;
 
     offset_imu_x = 0.0;
@@ -1507,6 +1808,7 @@ void* thread_func(void* args)
   nh_map.setCallbackQueue(&map_callback_queue);
 
   ros::Subscriber map_sub = nh_map.subscribe("points_map", 10, map_callback);
+  ros::Subscriber voxel_map_sub = nh_map.subscribe("points_map_voxels", 10, voxel_map_callback);
   ros::Rate ros_rate(10);
   while (nh_map.ok())
   {
@@ -1555,6 +1857,16 @@ int main(int argc, char** argv)
   private_nh.getParam("use_odom", _use_odom);
   private_nh.getParam("imu_upside_down", _imu_upside_down);
   private_nh.getParam("imu_topic", _imu_topic);
+  private_nh.getParam("num_threads", _num_threads);
+  private_nh.getParam("use_compact_voxel_grid", _use_compact_voxel_grid);
+  private_nh.getParam("incremental_map_update", _incremental_map_update);
+  private_nh.getParam("map_tile_size", _map_tile_size);
+  private_nh.getParam("double_buffer_map_update", _double_buffer_map_update);
+  if (_incremental_map_update)
+  {
+    // Evicting tiles needs the compact voxel grid
+    _use_compact_voxel_grid = true;
+  }
 
   if (nh.getParam("localizer", _localizer) == false)
   {
@@ -1604,6 +1916,11 @@ int main(int argc, char** argv)
   std::cout << "use_imu: " << _use_imu << std::endl;
   std::cout << "imu_upside_down: " << _imu_upside_down << std::endl;
   std::cout << "imu_topic: " << _imu_topic << std::endl;
+  std::cout << "num_threads: " << _num_threads << std::endl;
+  std::cout << "use_compact_voxel_grid: " << _use_compact_voxel_grid << std::endl;
+  std::cout << "incremental_map_update: " << _incremental_map_update << std::endl;
+  std::cout << "map_tile_size: " << _map_tile_size << std::endl;
+  std::cout << "double_buffer_map_update: " << _double_buffer_map_update << std::endl;
   std::cout << "localizer: " << _localizer << std::endl;
   std::cout << "(tf_x,tf_y,tf_z,tf_roll,tf_pitch,tf_yaw): (" << _tf_x << ", " << _tf_y << ", " << _tf_z << ", "
             << _tf_roll << ", " << _tf_pitch << ", " << _tf_yaw << ")" << std::endl;
@@ -0,0 +1,497 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Offline NDT mapping.
+ *
+ * Builds a map from the scans of rosbags or of a sequence of PCD files as fast as the
+ * CPU allows, without a ROS master and without replaying in real time. The work is
+ * pipelined: one thread reads the input, a pool of threads decodes, crops and
+ * downsamples the scans, and the main thread registers them in input order against a
+ * local submap of the map (see MapTiles) while finished tiles are written in the
+ * background. The output directory gets binary compressed PCD tiles with their
+ * arealist.txt for points_map_loader, the matching .ndtv voxel tiles, and poses.csv.
+ *
+ * The registration follows ndt_mapping with method_type PCL_ANH and a constant velocity
+ * guess; IMU and odometry are not used.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include <pcl/common/transforms.h>
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl_conversions/pcl_conversions.h>
+
+#include <ndt_cpu/NormalDistributionsTransform.h>
+
+#include "lidar_localizer/map_tiles.h"
+
+typedef pcl::PointCloud<pcl::PointXYZI> Cloud;
+
+struct Options
+{
+  // Same meaning as in ndt_mapping
+  float resolution = 1.0;
+  double step_size = 0.1;
+  double trans_eps = 0.01;
+  int max_iter = 30;
+  double leaf_size = 2.0;
+  double min_scan_range = 5.0;
+  double max_scan_range = 200.0;
+  double min_add_scan_shift = 1.0;
+  double tf[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };  // x, y, z, roll, pitch, yaw of the lidar in base_link
+
+  double tile_size = 50.0;
+  double submap_radius = 200.0;
+  std::string topic = "/points_raw";
+  int threads = 0;
+
+  std::string output_dir;
+  std::vector<std::string> inputs;
+};
+
+struct Scan
+{
+  double stamp;
+  Cloud::Ptr points;    // cropped to the scan range, in the lidar frame
+  Cloud::Ptr filtered;  // downsampled points for the registration
+};
+
+// A raw input scan: a message of a bag or the path of a PCD file
+struct Input
+{
+  size_t index;
+  sensor_msgs::PointCloud2::ConstPtr msg;
+  std::string path;
+};
+
+/*
+ * Hands the inputs to the decode threads and gives their scans back in input order.
+ * Both sides block so that only a bounded number of scans is in flight.
+ */
+class ScanPipeline
+{
+public:
+  explicit ScanPipeline(size_t capacity) : capacity_(capacity), next_(0), input_closed_(false), decoders_(0)
+  {
+  }
+
+  // Reader side
+  void pushInput(const Input& input)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [&] { return input.index < next_ + capacity_; });
+    inputs_.push(input);
+    cond_.notify_all();
+  }
+
+  void closeInput()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_closed_ = true;
+    cond_.notify_all();
+  }
+
+  // Decoder side
+  void startDecoder()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoders_++;
+  }
+
+  bool popInput(Input& input)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return !inputs_.empty() || input_closed_; });
+    if (inputs_.empty())
+      return false;
+    input = inputs_.front();
+    inputs_.pop();
+    return true;
+  }
+
+  // Scans that fail to decode are given back as NULL so that the order is kept
+  void pushScan(size_t index, const std::shared_ptr<Scan>& scan)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    scans_[index] = scan;
+    cond_.notify_all();
+  }
+
+  void stopDecoder()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    decoders_--;
+    cond_.notify_all();
+  }
+
+  // Registration side, returns false at the end of the input
+  bool popScan(std::shared_ptr<Scan>& scan)
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] {
+      return scans_.count(next_) != 0 || (input_closed_ && inputs_.empty() && decoders_ == 0);
+    });
+    std::map<size_t, std::shared_ptr<Scan> >::iterator it = scans_.find(next_);
+    if (it == scans_.end())
+      return false;
+    scan = it->second;
+    scans_.erase(it);
+    next_++;
+    cond_.notify_all();
+    return true;
+  }
+
+private:
+  size_t capacity_;
+  size_t next_;  // index of the next scan to register
+  bool input_closed_;
+  int decoders_;
+  std::queue<Input> inputs_;
+  std::map<size_t, std::shared_ptr<Scan> > scans_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+static void usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [options] <output_dir> <bag_or_pcd_file>..." << std::endl;
+  std::cerr << "  Bags are read on --topic, every PCD file is one scan in the lidar frame." << std::endl;
+  std::cerr << "Options (defaults as in ndt_mapping):" << std::endl;
+  std::cerr << "  --resolution <m>            NDT voxel size (1.0)" << std::endl;
+  std::cerr << "  --step_size <m>             (0.1)" << std::endl;
+  std::cerr << "  --trans_epsilon <m>         (0.01)" << std::endl;
+  std::cerr << "  --max_iterations <n>        (30)" << std::endl;
+  std::cerr << "  --leaf_size <m>             scan downsampling (2.0)" << std::endl;
+  std::cerr << "  --min_scan_range <m>        (5.0)" << std::endl;
+  std::cerr << "  --max_scan_range <m>        (200.0)" << std::endl;
+  std::cerr << "  --min_add_scan_shift <m>    (1.0)" << std::endl;
+  std::cerr << "  --tf <x> <y> <z> <roll> <pitch> <yaw>  lidar pose in base_link (0)" << std::endl;
+  std::cerr << "  --tile_size <m>             side of a map tile, multiple of resolution (50.0)" << std::endl;
+  std::cerr << "  --submap_radius <m>         tiles kept as target, not below max_scan_range (200.0)" << std::endl;
+  std::cerr << "  --topic <name>              point cloud topic of the bags (/points_raw)" << std::endl;
+  std::cerr << "  --threads <n>               decode threads and NDT threads (all cores)" << std::endl;
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+  int i = 1;
+  for (; i < argc && std::strncmp(argv[i], "--", 2) == 0; i++)
+  {
+    std::string name = argv[i] + 2;
+    int values = (name == "tf") ? 6 : 1;
+    if (i + values >= argc)
+      return false;
+
+    if (name == "resolution")
+      options.resolution = std::atof(argv[i + 1]);
+    else if (name == "step_size")
+      options.step_size = std::atof(argv[i + 1]);
+    else if (name == "trans_epsilon")
+      options.trans_eps = std::atof(argv[i + 1]);
+    else if (name == "max_iterations")
+      options.max_iter = std::atoi(argv[i + 1]);
+    else if (name == "leaf_size")
+      options.leaf_size = std::atof(argv[i + 1]);
+    else if (name == "min_scan_range")
+      options.min_scan_range = std::atof(argv[i + 1]);
+    else if (name == "max_scan_range")
+      options.max_scan_range = std::atof(argv[i + 1]);
+    else if (name == "min_add_scan_shift")
+      options.min_add_scan_shift = std::atof(argv[i + 1]);
+    else if (name == "tile_size")
+      options.tile_size = std::atof(argv[i + 1]);
+    else if (name == "submap_radius")
+      options.submap_radius = std::atof(argv[i + 1]);
+    else if (name == "topic")
+      options.topic = argv[i + 1];
+    else if (name == "threads")
+      options.threads = std::atoi(argv[i + 1]);
+    else if (name == "tf")
+      for (int k = 0; k < 6; k++)
+        options.tf[k] = std::atof(argv[i + 1 + k]);
+    else
+      return false;
+
+    i += values;
+  }
+
+  if (argc - i < 2)
+    return false;
+
+  options.output_dir = argv[i];
+  options.inputs.assign(argv + i + 1, argv + argc);
+
+  if (options.threads <= 0)
+    options.threads = std::max(1u, std::thread::hardware_concurrency());
+
+  return options.resolution > 0.0 && options.tile_size > 0.0 && options.submap_radius > 0.0;
+}
+
+static bool is_bag(const std::string& path)
+{
+  return path.size() >= 4 && path.compare(path.size() - 4, 4, ".bag") == 0;
+}
+
+static void read_inputs(const Options& options, ScanPipeline& pipeline)
+{
+  size_t index = 0;
+
+  for (const std::string& path : options.inputs)
+  {
+    if (!is_bag(path))
+    {
+      Input input;
+      input.index = index++;
+      input.path = path;
+      pipeline.pushInput(input);
+      continue;
+    }
+
+    try
+    {
+      rosbag::Bag bag(path, rosbag::bagmode::Read);
+      rosbag::View view(bag, rosbag::TopicQuery(options.topic));
+
+      for (const rosbag::MessageInstance& m : view)
+      {
+        Input input;
+        input.msg = m.instantiate<sensor_msgs::PointCloud2>();
+        if (!input.msg)
+          continue;
+        input.index = index++;
+        pipeline.pushInput(input);
+      }
+    }
+    catch (rosbag::BagException& e)
+    {
+      std::cerr << path << ": " << e.what() << std::endl;
+    }
+  }
+
+  pipeline.closeInput();
+}
+
+static void decode_scans(const Options& options, ScanPipeline& pipeline)
+{
+  Input input;
+
+  while (pipeline.popInput(input))
+  {
+    std::shared_ptr<Scan> scan(new Scan());
+    Cloud raw;
+
+    if (input.msg)
+    {
+      pcl::fromROSMsg(*input.msg, raw);
+      scan->stamp = input.msg->header.stamp.toSec();
+    }
+    else if (pcl::io::loadPCDFile<pcl::PointXYZI>(input.path, raw) == -1)
+    {
+      std::cerr << "Cannot load " << input.path << std::endl;
+      pipeline.pushScan(input.index, std::shared_ptr<Scan>());
+      continue;
+    }
+    else
+    {
+      scan->stamp = raw.header.stamp * 1e-6;
+    }
+
+    scan->points.reset(new Cloud());
+    scan->points->reserve(raw.size());
+    for (const pcl::PointXYZI& p : raw.points)
+    {
+      double r = std::sqrt(p.x * p.x + p.y * p.y);
+      if (options.min_scan_range < r && r < options.max_scan_range)
+        scan->points->push_back(p);
+    }
+
+    scan->filtered.reset(new Cloud());
+    pcl::VoxelGrid<pcl::PointXYZI> voxel_grid_filter;
+    voxel_grid_filter.setLeafSize(options.leaf_size, options.leaf_size, options.leaf_size);
+    voxel_grid_filter.setInputCloud(scan->points);
+    voxel_grid_filter.filter(*scan->filtered);
+
+    pipeline.pushScan(input.index, scan);
+  }
+
+  pipeline.stopDecoder();
+}
+
+static Eigen::Matrix4f pose_matrix(const double* pose)
+{
+  Eigen::AngleAxisf rot_x(pose[3], Eigen::Vector3f::UnitX());
+  Eigen::AngleAxisf rot_y(pose[4], Eigen::Vector3f::UnitY());
+  Eigen::AngleAxisf rot_z(pose[5], Eigen::Vector3f::UnitZ());
+  Eigen::Translation3f translation(pose[0], pose[1], pose[2]);
+
+  return (translation * rot_z * rot_y * rot_x).matrix();
+}
+
+// Same convention as tf::Matrix3x3::getRPY
+static void get_rpy(const Eigen::Matrix4f& pose, double& roll, double& pitch, double& yaw)
+{
+  roll = std::atan2(pose(2, 1), pose(2, 2));
+  pitch = std::asin(std::max(-1.0f, std::min(1.0f, -pose(2, 0))));
+  yaw = std::atan2(pose(1, 0), pose(0, 0));
+}
+
+int main(int argc, char** argv)
+{
+  Options options;
+
+  if (!parse_options(argc, argv, options))
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  mkdir(options.output_dir.c_str(), 0755);
+
+  std::string poses_path = options.output_dir + "/poses.csv";
+  std::ofstream poses(poses_path.c_str());
+  if (!poses)
+  {
+    std::cerr << "Cannot open " << poses_path << std::endl;
+    return EXIT_FAILURE;
+  }
+  poses << "index,stamp,x,y,z,roll,pitch,yaw,iterations,converged" << std::endl;
+
+  cpu::NormalDistributionsTransform<pcl::PointXYZI, pcl::PointXYZI> ndt;
+  ndt.setUseCompactVoxelGrid(true);
+  ndt.setResolution(options.resolution);
+  ndt.setStepSize(options.step_size);
+  ndt.setTransformationEpsilon(options.trans_eps);
+  ndt.setMaximumIterations(options.max_iter);
+  ndt.setNumThreads(options.threads);
+
+  MapTiles tiles(&ndt, options.resolution, options.tile_size, options.submap_radius, options.output_dir);
+
+  // Reader, decoders and registration overlap; a few scans per decoder are enough to keep them busy
+  int decoders = std::max(1, options.threads - 1);
+  ScanPipeline pipeline(4 * decoders);
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < decoders; i++)
+  {
+    pipeline.startDecoder();
+    threads.push_back(std::thread(decode_scans, std::cref(options), std::ref(pipeline)));
+  }
+  threads.push_back(std::thread(read_inputs, std::cref(options), std::ref(pipeline)));
+
+  Eigen::Matrix4f tf_btol = pose_matrix(options.tf);
+  Eigen::Matrix4f tf_ltob = tf_btol.inverse();
+
+  // Poses of base_link in the map
+  Eigen::Matrix4f current_pose = Eigen::Matrix4f::Identity();
+  Eigen::Matrix4f previous_pose = Eigen::Matrix4f::Identity();
+  Eigen::Vector3f added_position = Eigen::Vector3f::Zero();
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  size_t index = 0;
+  size_t added = 0;
+  std::shared_ptr<Scan> scan;
+
+  for (; pipeline.popScan(scan); index++)
+  {
+    if (!scan || scan->filtered->empty())
+      continue;
+
+    Cloud::Ptr transformed(new Cloud());
+    int iterations = 0;
+    bool converged = true;
+
+    if (added == 0)
+    {
+      // The first scan starts the map at the origin of base_link
+      pcl::transformPointCloud(*scan->points, *transformed, tf_btol);
+    }
+    else
+    {
+      // Constant velocity guess
+      Eigen::Matrix4f guess = current_pose * previous_pose.inverse() * current_pose;
+
+      ndt.setInputSource(scan->filtered);
+      ndt.align(guess * tf_btol);
+
+      Eigen::Matrix4f t_localizer = ndt.getFinalTransformation();
+      iterations = ndt.getFinalNumIteration();
+      converged = ndt.hasConverged();
+
+      previous_pose = current_pose;
+      current_pose = t_localizer * tf_ltob;
+
+      pcl::transformPointCloud(*scan->points, *transformed, t_localizer);
+    }
+
+    Eigen::Vector3f position = current_pose.block<3, 1>(0, 3);
+    if (added == 0 || (position - added_position).head<2>().norm() >= options.min_add_scan_shift)
+    {
+      tiles.addScan(transformed);
+      added_position = position;
+      added++;
+    }
+    tiles.update(position(0), position(1));
+
+    double roll, pitch, yaw;
+    get_rpy(current_pose, roll, pitch, yaw);
+    poses << index << "," << std::fixed << std::setprecision(6) << scan->stamp << "," << std::setprecision(5)
+          << position(0) << "," << position(1) << "," << position(2) << "," << roll << "," << pitch << "," << yaw
+          << "," << iterations << "," << converged << std::endl;
+
+    if (index % 100 == 0)
+    {
+      double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      std::cout << "scan " << index << ": " << (index + 1) / elapsed << " scans/s, " << tiles.getTileNum()
+                << " tiles in memory, " << tiles.getSavedTileNum() << " saved" << std::endl;
+    }
+  }
+
+  for (std::thread& thread : threads)
+    thread.join();
+
+  bool ok = tiles.save();
+
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << index << " scans (" << added << " added to the map) in " << elapsed << " s, "
+            << tiles.getSavedTileNum() << " tiles written to " << tiles.getOutputDir() << std::endl;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,236 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Compare the dense cpu::VoxelGrid with cpu::CompactVoxelGrid on a PCD map.
+ *
+ * Both grids are built from the same map, then scans cut out of the map
+ * around random poses are aligned from a perturbed guess with PCL_ANH using
+ * each grid. Build time, memory, alignment time, the final poses and the
+ * fitness scores are reported. The exit status is non-zero if the two grids
+ * converge to poses further apart than the tolerance.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+#include <pcl/common/transforms.h>
+
+#include <ndt_cpu/NormalDistributionsTransform.h>
+
+typedef std::chrono::steady_clock Clock;
+typedef cpu::NormalDistributionsTransform<pcl::PointXYZ, pcl::PointXYZ> NDT;
+
+struct AlignResult
+{
+  Eigen::Matrix4f pose;
+  double seconds;
+  int iterations;
+  double fitness_score;
+};
+
+static void usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " [options] <pcd_file>..." << std::endl;
+  std::cerr << "  -r RESOLUTION  NDT voxel size [m] (default 1.0)" << std::endl;
+  std::cerr << "  -n SCANS       number of scans aligned with each grid (default 20)" << std::endl;
+  std::cerr << "  -s RANGE       range of the scans cut out of the map [m] (default 50.0)" << std::endl;
+  std::cerr << "  -t THREADS     PCL_ANH threads (default 1)" << std::endl;
+  std::cerr << "  -e TOLERANCE   largest accepted distance between the two final poses [m] (default 0.01)"
+            << std::endl;
+}
+
+static double elapsed(const Clock::time_point& start)
+{
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/* Points of the map within range of (x, y), in the frame of the pose */
+static pcl::PointCloud<pcl::PointXYZ>::Ptr cut_scan(const pcl::PointCloud<pcl::PointXYZ>& map,
+                                                     const Eigen::Matrix4f& pose, double range)
+{
+  pcl::PointCloud<pcl::PointXYZ> local;
+  const float x = pose(0, 3);
+  const float y = pose(1, 3);
+
+  for (const pcl::PointXYZ& p : map.points)
+  {
+    if ((p.x - x) * (p.x - x) + (p.y - y) * (p.y - y) < range * range)
+      local.points.push_back(p);
+  }
+  local.width = local.points.size();
+  local.height = 1;
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr scan(new pcl::PointCloud<pcl::PointXYZ>());
+  pcl::transformPointCloud(local, *scan, Eigen::Matrix4f(pose.inverse()));
+  return scan;
+}
+
+static AlignResult align(NDT& ndt, const pcl::PointCloud<pcl::PointXYZ>::Ptr& scan, const Eigen::Matrix4f& guess)
+{
+  AlignResult result;
+  ndt.setInputSource(scan);
+
+  Clock::time_point start = Clock::now();
+  ndt.align(guess);
+  result.seconds = elapsed(start);
+
+  result.pose = ndt.getFinalTransformation();
+  result.iterations = ndt.getFinalNumIteration();
+  result.fitness_score = ndt.getFitnessScore();
+  return result;
+}
+
+int main(int argc, char** argv)
+{
+  float resolution = 1.0;
+  int scan_num = 20;
+  double range = 50.0;
+  int threads = 1;
+  double tolerance = 0.01;
+  std::vector<std::string> pcd_files;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg == "-r" && i + 1 < argc)
+      resolution = std::atof(argv[++i]);
+    else if (arg == "-n" && i + 1 < argc)
+      scan_num = std::atoi(argv[++i]);
+    else if (arg == "-s" && i + 1 < argc)
+      range = std::atof(argv[++i]);
+    else if (arg == "-t" && i + 1 < argc)
+      threads = std::atoi(argv[++i]);
+    else if (arg == "-e" && i + 1 < argc)
+      tolerance = std::atof(argv[++i]);
+    else
+      pcd_files.push_back(arg);
+  }
+
+  if (pcd_files.empty() || resolution <= 0.0 || scan_num <= 0 || range <= 0.0)
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr map(new pcl::PointCloud<pcl::PointXYZ>());
+  for (const std::string& file : pcd_files)
+  {
+    pcl::PointCloud<pcl::PointXYZ> cloud;
+    if (pcl::io::loadPCDFile<pcl::PointXYZ>(file, cloud) == -1)
+    {
+      std::cerr << "load failed " << file << std::endl;
+      return EXIT_FAILURE;
+    }
+    *map += cloud;
+  }
+  std::cout << "map: " << map->points.size() << " points" << std::endl;
+
+  // Memory of each grid on its own, the NDT instances below do not expose it
+  cpu::VoxelGrid<pcl::PointXYZ> dense_grid;
+  dense_grid.setLeafSize(resolution, resolution, resolution);
+  Clock::time_point start = Clock::now();
+  dense_grid.setInput(map);
+  double dense_build = elapsed(start);
+  // Per cell: centroid, inverse covariance, temporary centroid and covariance, point count and point index list
+  double dense_cells = static_cast<double>(dense_grid.getVgridX()) * dense_grid.getVgridY() * dense_grid.getVgridZ();
+  double dense_mb = (dense_cells * (2 * sizeof(Eigen::Vector3d) + 2 * sizeof(Eigen::Matrix3d) + sizeof(int) +
+                                    sizeof(std::vector<int>)) +
+                     map->points.size() * sizeof(int)) /
+                    (1024 * 1024);
+
+  cpu::CompactVoxelGrid<pcl::PointXYZ> compact_grid;
+  compact_grid.setLeafSize(resolution, resolution, resolution);
+  start = Clock::now();
+  compact_grid.setInput(map);
+  double compact_build = elapsed(start);
+  double compact_mb = compact_grid.getMemoryUsage() / (1024.0 * 1024.0);
+
+  std::printf("%-8s %10s %12s %10s\n", "grid", "voxels", "build [s]", "MB");
+  std::printf("%-8s %10d %12.3f %10.1f\n", "dense", dense_grid.getVoxelNum(), dense_build, dense_mb);
+  std::printf("%-8s %10d %12.3f %10.1f\n", "compact", compact_grid.getVoxelNum(), compact_build, compact_mb);
+
+  NDT dense_ndt, compact_ndt;
+  NDT* ndts[] = { &dense_ndt, &compact_ndt };
+  for (int i = 0; i < 2; i++)
+  {
+    ndts[i]->setUseCompactVoxelGrid(i == 1);
+    ndts[i]->setResolution(resolution);
+    ndts[i]->setStepSize(0.1);
+    ndts[i]->setTransformationEpsilon(0.01);
+    ndts[i]->setMaximumIterations(30);
+    ndts[i]->setNumThreads(threads);
+    ndts[i]->setInputTarget(map);
+  }
+
+  // Scans around random map points, aligned from a guess off by up to 0.5 m and 2 degrees
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> point_dist(0, map->points.size() - 1);
+  std::uniform_real_distribution<float> offset_dist(-0.5, 0.5);
+  std::uniform_real_distribution<float> yaw_dist(-M_PI, M_PI);
+  std::uniform_real_distribution<float> yaw_offset_dist(-2.0 * M_PI / 180.0, 2.0 * M_PI / 180.0);
+
+  double dense_seconds = 0, compact_seconds = 0;
+  int dense_iterations = 0, compact_iterations = 0;
+  double max_pose_diff = 0, max_score_diff = 0;
+
+  for (int i = 0; i < scan_num; i++)
+  {
+    const pcl::PointXYZ& center = map->points[point_dist(rng)];
+    Eigen::Affine3f pose(Eigen::Translation3f(center.x, center.y, center.z) *
+                         Eigen::AngleAxisf(yaw_dist(rng), Eigen::Vector3f::UnitZ()));
+    Eigen::Affine3f error(Eigen::Translation3f(offset_dist(rng), offset_dist(rng), 0) *
+                          Eigen::AngleAxisf(yaw_offset_dist(rng), Eigen::Vector3f::UnitZ()));
+    Eigen::Matrix4f guess = (pose * error).matrix();
+
+    pcl::PointCloud<pcl::PointXYZ>::Ptr scan = cut_scan(*map, pose.matrix(), range);
+    AlignResult dense = align(dense_ndt, scan, guess);
+    AlignResult compact = align(compact_ndt, scan, guess);
+
+    dense_seconds += dense.seconds;
+    compact_seconds += compact.seconds;
+    dense_iterations += dense.iterations;
+    compact_iterations += compact.iterations;
+
+    double pose_diff = (dense.pose.block<3, 1>(0, 3) - compact.pose.block<3, 1>(0, 3)).norm();
+    max_pose_diff = std::max(max_pose_diff, pose_diff);
+    max_score_diff = std::max(max_score_diff, std::fabs(dense.fitness_score - compact.fitness_score));
+  }
+
+  std::printf("\n%-8s %14s %14s\n", "grid", "align [ms]", "iterations");
+  std::printf("%-8s %14.2f %14.1f\n", "dense", dense_seconds * 1000 / scan_num,
+              static_cast<double>(dense_iterations) / scan_num);
+  std::printf("%-8s %14.2f %14.1f\n", "compact", compact_seconds * 1000 / scan_num,
+              static_cast<double>(compact_iterations) / scan_num);
+  std::printf("\nlargest difference of the final positions: %.6f m\n", max_pose_diff);
+  std::printf("largest difference of the fitness scores: %.6f\n", max_score_diff);
+
+  if (max_pose_diff > tolerance)
+  {
+    std::cerr << "the grids converge to different poses" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Convert PCD maps into pre-voxelized NDT map tiles.
+ *
+ * The input clouds are merged one by one into a CompactVoxelGrid, so only the
+ * voxel statistics are kept in memory. The grid is then cut into square tiles
+ * aligned to the voxel grid and every non-empty tile is written as
+ * <output_dir>/<x_min>_<y_min>.ndtv, together with an arealist.txt that can be
+ * given to points_map_loader.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pcl/io/pcd_io.h>
+#include <pcl/point_types.h>
+
+#include <ndt_cpu/CompactVoxelGrid.h>
+
+static void usage(const char* program)
+{
+  std::cerr << "Usage: " << program << " <resolution> <tile_size> <output_dir> <pcd_file>..." << std::endl;
+  std::cerr << "  resolution  NDT voxel size [m], must match ndt_matching's resolution" << std::endl;
+  std::cerr << "  tile_size   side length of a tile [m], rounded to a multiple of resolution" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  if (argc < 5)
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  double resolution = std::atof(argv[1]);
+  double tile_size = std::atof(argv[2]);
+  std::string output_dir = argv[3];
+
+  if (resolution <= 0.0 || tile_size <= 0.0)
+  {
+    usage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  // Tiles are aligned to the voxel grid so that no voxel is shared by two tiles
+  int voxels_per_tile = std::max(1, static_cast<int>(std::round(tile_size / resolution)));
+  tile_size = voxels_per_tile * resolution;
+
+  cpu::CompactVoxelGrid<pcl::PointXYZ> grid;
+  grid.setLeafSize(resolution, resolution, resolution);
+
+  for (int i = 4; i < argc; i++)
+  {
+    pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>());
+
+    if (pcl::io::loadPCDFile<pcl::PointXYZ>(argv[i], *cloud) == -1)
+    {
+      std::cerr << "load failed " << argv[i] << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    if (grid.getVoxelNum() == 0)
+      grid.setInput(cloud);
+    else
+      grid.update(cloud);
+
+    std::cout << argv[i] << ": " << cloud->points.size() << " points, " << grid.getVoxelNum() << " voxels ("
+              << grid.getMemoryUsage() / (1024 * 1024) << " MB)" << std::endl;
+  }
+
+  std::string arealist_path = output_dir + "/arealist.txt";
+  std::ofstream arealist(arealist_path.c_str());
+
+  if (!arealist)
+  {
+    std::cerr << "cannot open " << arealist_path << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Voxel ids of every non-empty tile, grouped in one pass over the grid
+  std::map<std::pair<int, int>, std::vector<int> > tiles;
+  grid.splitIntoTiles(voxels_per_tile, tiles);
+
+  for (const auto& tile : tiles)
+  {
+    float min_x = tile.first.first * tile_size;
+    float min_y = tile.first.second * tile_size;
+    float max_x = min_x + tile_size;
+    float max_y = min_y + tile_size;
+
+    std::ostringstream name;
+    name << output_dir << "/" << static_cast<long>(std::floor(min_x)) << "_" << static_cast<long>(std::floor(min_y))
+         << ".ndtv";
+
+    if (!grid.save(name.str(), min_x, min_y, max_x, max_y, tile.second))
+    {
+      std::cerr << "save failed " << name.str() << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    arealist << name.str() << "," << min_x << "," << min_y << "," << grid.getMinZ() << "," << max_x << "," << max_y
+             << "," << grid.getMaxZ() << std::endl;
+  }
+
+  std::cout << tiles.size() << " tiles written to " << output_dir << std::endl;
+
+  return EXIT_SUCCESS;
+}
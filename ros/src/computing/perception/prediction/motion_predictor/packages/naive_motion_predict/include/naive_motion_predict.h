@@ -55,21 +55,40 @@ private:
   int num_prediction_;
   double sensor_height_;
   double filter_out_close_object_threshold_;
+  bool use_compact_prediction_;
+
+  // buffers reused between callbacks
+  autoware_msgs::DetectedObjectArray output_;
+  std::vector<size_t> valid_object_indices_;
+  // num_prediction_ poses per valid object, one object after the other
+  std::vector<geometry_msgs::Pose> predicted_poses_;
 
   void objectsCallback(const autoware_msgs::DetectedObjectArray& input);
 
   void initializeROSmarker(const std_msgs::Header& header, const geometry_msgs::Point& position, const int object_id,
                            visualization_msgs::Marker& predicted_line);
 
-  void makePrediction(const autoware_msgs::DetectedObject& object,
-                      std::vector<autoware_msgs::DetectedObject>& predicted_objects,
-                      visualization_msgs::Marker& predicted_line);
+  void makePrediction(const autoware_msgs::DetectedObjectArray& input);
+
+  void makePredictedObjects(const autoware_msgs::DetectedObjectArray& input,
+                            autoware_msgs::DetectedObjectArray& output);
+
+  void makePredictedTrajectories(const autoware_msgs::DetectedObjectArray& input,
+                                 autoware_msgs::DetectedObjectArray& output);
+
+  void makePredictedLines(const autoware_msgs::DetectedObjectArray& input,
+                          visualization_msgs::MarkerArray& predicted_lines);
+
+  double calculatePredictionScore(const int ith_prediction);
 
-  autoware_msgs::DetectedObject generatePredictedObject(const autoware_msgs::DetectedObject& object);
+  geometry_msgs::Pose generatePredictedPose(const autoware_msgs::DetectedObject& object,
+                                            const geometry_msgs::Pose& pose);
 
-  autoware_msgs::DetectedObject moveConstantVelocity(const autoware_msgs::DetectedObject& object);
+  geometry_msgs::Pose moveConstantVelocity(const autoware_msgs::DetectedObject& object,
+                                           const geometry_msgs::Pose& pose);
 
-  autoware_msgs::DetectedObject moveConstantTurnRateVelocity(const autoware_msgs::DetectedObject& object);
+  geometry_msgs::Pose moveConstantTurnRateVelocity(const autoware_msgs::DetectedObject& object,
+                                                   const geometry_msgs::Pose& pose);
 
   double generateYawFromQuaternion(const geometry_msgs::Quaternion& quaternion);
 
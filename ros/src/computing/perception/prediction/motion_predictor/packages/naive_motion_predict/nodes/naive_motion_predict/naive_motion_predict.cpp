@@ -16,6 +16,8 @@
 
 #include "naive_motion_predict.h"
 
+#include <algorithm>
+
 NaiveMotionPredict::NaiveMotionPredict() :
   nh_(),
   private_nh_("~"),
@@ -25,6 +27,7 @@ NaiveMotionPredict::NaiveMotionPredict() :
   private_nh_.param<int>("num_prediction", num_prediction_, 10);
   private_nh_.param<double>("sensor_height_", sensor_height_, 2.0);
   private_nh_.param<double>("filter_out_close_object_threshold", filter_out_close_object_threshold_, 1.5);
+  private_nh_.param<bool>("use_compact_prediction", use_compact_prediction_, false);
 
   predicted_objects_pub_ = nh_.advertise<autoware_msgs::DetectedObjectArray>("/prediction/motion_predictor/objects", 1);
   predicted_paths_pub_ = nh_.advertise<visualization_msgs::MarkerArray>("/prediction/motion_predictor/path_markers", 1);
@@ -59,82 +62,177 @@ void NaiveMotionPredict::initializeROSmarker(const std_msgs::Header& header, con
   predicted_line.points.push_back(p);
 }
 
-void NaiveMotionPredict::makePrediction(const autoware_msgs::DetectedObject& object,
-                                        std::vector<autoware_msgs::DetectedObject>& predicted_objects_vec,
-                                        visualization_msgs::Marker& predicted_line)
+void NaiveMotionPredict::makePrediction(const autoware_msgs::DetectedObjectArray& input)
 {
-  autoware_msgs::DetectedObject target_object = object;
-  target_object.score = MAX_PREDICTION_SCORE_;
-  initializeROSmarker(object.header, object.pose.position, object.id, predicted_line);
-  for (int ith_prediction = 0; ith_prediction < num_prediction_; ith_prediction++)
-  {
-    autoware_msgs::DetectedObject predicted_object = generatePredictedObject(target_object);
-    predicted_object.score = (-1/(interval_sec_*num_prediction_))*ith_prediction*interval_sec_ + MAX_PREDICTION_SCORE_;
-    predicted_objects_vec.push_back(predicted_object);
-    target_object = predicted_object;
-
-    geometry_msgs::Point p;
-    p.x = predicted_object.pose.position.x;
-    p.y = predicted_object.pose.position.y;
-    p.z = -sensor_height_;
-    predicted_line.points.push_back(p);
+  valid_object_indices_.clear();
+  for (size_t i = 0; i < input.objects.size(); i++)
+  {
+    if (isObjectValid(input.objects[i]))
+    {
+      valid_object_indices_.push_back(i);
+    }
+  }
+
+  // roll out every valid object one step at a time, only poses are propagated
+  const size_t num_prediction = std::max(num_prediction_, 0);
+  predicted_poses_.resize(valid_object_indices_.size() * num_prediction);
+  for (size_t ith_prediction = 0; ith_prediction < num_prediction; ith_prediction++)
+  {
+    for (size_t k = 0; k < valid_object_indices_.size(); k++)
+    {
+      const autoware_msgs::DetectedObject& object = input.objects[valid_object_indices_[k]];
+      const geometry_msgs::Pose& pose =
+          (ith_prediction == 0) ? object.pose : predicted_poses_[k * num_prediction + ith_prediction - 1];
+      predicted_poses_[k * num_prediction + ith_prediction] = generatePredictedPose(object, pose);
+    }
   }
 }
 
+void NaiveMotionPredict::makePredictedObjects(const autoware_msgs::DetectedObjectArray& input,
+                                              autoware_msgs::DetectedObjectArray& output)
+{
+  // assign into the previous output so that the object buffers are reused
+  const size_t num_prediction = std::max(num_prediction_, 0);
+  output.header = input.header;
+  output.objects.resize(input.objects.size() + predicted_poses_.size());
+  for (size_t i = 0; i < input.objects.size(); i++)
+  {
+    output.objects[i] = input.objects[i];
+  }
+
+  size_t output_index = input.objects.size();
+  for (size_t k = 0; k < valid_object_indices_.size(); k++)
+  {
+    for (size_t ith_prediction = 0; ith_prediction < num_prediction; ith_prediction++)
+    {
+      autoware_msgs::DetectedObject& predicted_object = output.objects[output_index++];
+      predicted_object = input.objects[valid_object_indices_[k]];
+      predicted_object.pose = predicted_poses_[k * num_prediction + ith_prediction];
+      predicted_object.score = calculatePredictionScore(ith_prediction);
+    }
+  }
+}
+
+void NaiveMotionPredict::makePredictedTrajectories(const autoware_msgs::DetectedObjectArray& input,
+                                                   autoware_msgs::DetectedObjectArray& output)
+{
+  const size_t num_prediction = std::max(num_prediction_, 0);
+  output.header = input.header;
+  output.objects.resize(input.objects.size());
+  for (size_t i = 0; i < input.objects.size(); i++)
+  {
+    output.objects[i] = input.objects[i];
+  }
+
+  for (size_t k = 0; k < valid_object_indices_.size(); k++)
+  {
+    autoware_msgs::DetectedObject& object = output.objects[valid_object_indices_[k]];
+    object.candidate_trajectories.lanes.emplace_back();
+    autoware_msgs::Lane& trajectory = object.candidate_trajectories.lanes.back();
+    trajectory.header = object.header;
+    trajectory.waypoints.resize(num_prediction);
+    for (size_t ith_prediction = 0; ith_prediction < num_prediction; ith_prediction++)
+    {
+      autoware_msgs::Waypoint& waypoint = trajectory.waypoints[ith_prediction];
+      waypoint.pose.header = object.header;
+      waypoint.pose.header.stamp += ros::Duration(interval_sec_ * (ith_prediction + 1));
+      waypoint.pose.pose = predicted_poses_[k * num_prediction + ith_prediction];
+      waypoint.twist.header = waypoint.pose.header;
+      waypoint.twist.twist = object.velocity;
+      waypoint.cost = calculatePredictionScore(ith_prediction);
+    }
+  }
+}
+
+void NaiveMotionPredict::makePredictedLines(const autoware_msgs::DetectedObjectArray& input,
+                                            visualization_msgs::MarkerArray& predicted_lines)
+{
+  const size_t num_prediction = std::max(num_prediction_, 0);
+  for (size_t k = 0; k < valid_object_indices_.size(); k++)
+  {
+    const autoware_msgs::DetectedObject& object = input.objects[valid_object_indices_[k]];
+
+    // visualize only stably tracked objects
+    if (!object.pose_reliable)
+    {
+      continue;
+    }
+
+    visualization_msgs::Marker predicted_line;
+    initializeROSmarker(object.header, object.pose.position, object.id, predicted_line);
+    for (size_t ith_prediction = 0; ith_prediction < num_prediction; ith_prediction++)
+    {
+      geometry_msgs::Point p;
+      p.x = predicted_poses_[k * num_prediction + ith_prediction].position.x;
+      p.y = predicted_poses_[k * num_prediction + ith_prediction].position.y;
+      p.z = -sensor_height_;
+      predicted_line.points.push_back(p);
+    }
+    predicted_lines.markers.push_back(predicted_line);
+  }
+}
+
+double NaiveMotionPredict::calculatePredictionScore(const int ith_prediction)
+{
+  return (-1/(interval_sec_*num_prediction_))*ith_prediction*interval_sec_ + MAX_PREDICTION_SCORE_;
+}
+
 /*
 This package is a template package for more sopisticated prediction packages.
-Feel free to change/modify generatePredictedObject function
+Feel free to change/modify generatePredictedPose function
 and send pull request to Autoware
  */
 
-autoware_msgs::DetectedObject NaiveMotionPredict::generatePredictedObject(const autoware_msgs::DetectedObject& object)
+geometry_msgs::Pose NaiveMotionPredict::generatePredictedPose(const autoware_msgs::DetectedObject& object,
+                                                              const geometry_msgs::Pose& pose)
 {
-  autoware_msgs::DetectedObject predicted_object;
+  geometry_msgs::Pose predicted_pose;
   if (object.behavior_state == MotionModel::CV)
   {
-    predicted_object = moveConstantVelocity(object);
+    predicted_pose = moveConstantVelocity(object, pose);
   }
   else if (object.behavior_state == MotionModel::CTRV)
   {
-    predicted_object = moveConstantTurnRateVelocity(object);
+    predicted_pose = moveConstantTurnRateVelocity(object, pose);
   }
   else
   {
     // This is because random motion's velocity is 0
-    predicted_object = object;
+    predicted_pose = pose;
   }
 
-  return predicted_object;
+  return predicted_pose;
 }
 
-autoware_msgs::DetectedObject NaiveMotionPredict::moveConstantVelocity(const autoware_msgs::DetectedObject& object)
+geometry_msgs::Pose NaiveMotionPredict::moveConstantVelocity(const autoware_msgs::DetectedObject& object,
+                                                             const geometry_msgs::Pose& pose)
 {
-  autoware_msgs::DetectedObject predicted_object;
-  predicted_object = object;
-  double px = object.pose.position.x;
-  double py = object.pose.position.y;
+  geometry_msgs::Pose predicted_pose;
+  predicted_pose = pose;
+  double px = pose.position.x;
+  double py = pose.position.y;
   double velocity = object.velocity.linear.x;
-  double yaw = generateYawFromQuaternion(object.pose.orientation);
+  double yaw = generateYawFromQuaternion(pose.orientation);
 
   // predicted state values
   double prediction_px = px + velocity * cos(yaw) * interval_sec_;
   double prediction_py = py + velocity * sin(yaw) * interval_sec_;
 
-  predicted_object.pose.position.x = prediction_px;
-  predicted_object.pose.position.y = prediction_py;
+  predicted_pose.position.x = prediction_px;
+  predicted_pose.position.y = prediction_py;
 
-  return predicted_object;
+  return predicted_pose;
 }
 
-autoware_msgs::DetectedObject
-NaiveMotionPredict::moveConstantTurnRateVelocity(const autoware_msgs::DetectedObject& object)
+geometry_msgs::Pose NaiveMotionPredict::moveConstantTurnRateVelocity(const autoware_msgs::DetectedObject& object,
+                                                                     const geometry_msgs::Pose& pose)
 {
-  autoware_msgs::DetectedObject predicted_object;
-  predicted_object = object;
-  double px = object.pose.position.x;
-  double py = object.pose.position.y;
+  geometry_msgs::Pose predicted_pose;
+  predicted_pose = pose;
+  double px = pose.position.x;
+  double py = pose.position.y;
   double velocity = object.velocity.linear.x;
-  double yaw = generateYawFromQuaternion(object.pose.orientation);
+  double yaw = generateYawFromQuaternion(pose.orientation);
   double yawd = object.acceleration.linear.y;
 
   // predicted state values
@@ -158,14 +256,14 @@ NaiveMotionPredict::moveConstantTurnRateVelocity(const autoware_msgs::DetectedOb
   while (prediction_yaw < -M_PI)
     prediction_yaw += 2. * M_PI;
 
-  predicted_object.pose.position.x = prediction_px;
-  predicted_object.pose.position.y = prediction_py;
+  predicted_pose.position.x = prediction_px;
+  predicted_pose.position.y = prediction_py;
   tf::Quaternion q = tf::createQuaternionFromRPY(0, 0, prediction_yaw);
-  predicted_object.pose.orientation.x = q[0];
-  predicted_object.pose.orientation.y = q[1];
-  predicted_object.pose.orientation.z = q[2];
-  predicted_object.pose.orientation.w = q[3];
-  return predicted_object;
+  predicted_pose.orientation.x = q[0];
+  predicted_pose.orientation.y = q[1];
+  predicted_pose.orientation.z = q[2];
+  predicted_pose.orientation.w = q[3];
+  return predicted_pose;
 }
 
 double NaiveMotionPredict::generateYawFromQuaternion(const geometry_msgs::Quaternion& quaternion)
@@ -179,31 +277,24 @@ double NaiveMotionPredict::generateYawFromQuaternion(const geometry_msgs::Quater
 
 void NaiveMotionPredict::objectsCallback(const autoware_msgs::DetectedObjectArray& input)
 {
-  autoware_msgs::DetectedObjectArray output;
-  visualization_msgs::MarkerArray predicted_lines;
-  output = input;
+  makePrediction(input);
 
-  for (const auto &object : input.objects)
+  if (use_compact_prediction_)
   {
-    std::vector<autoware_msgs::DetectedObject> predicted_objects_vec;
-    visualization_msgs::Marker predicted_line;
-    if (isObjectValid(object))
-    {
-      makePrediction(object, predicted_objects_vec, predicted_line);
-
-      // concate to output object array
-      output.objects.insert(output.objects.end(), predicted_objects_vec.begin(), predicted_objects_vec.end());
+    makePredictedTrajectories(input, output_);
+  }
+  else
+  {
+    makePredictedObjects(input, output_);
+  }
+  predicted_objects_pub_.publish(output_);
 
-      // visualize only stably tracked objects
-      if (!object.pose_reliable)
-      {
-        continue;
-      }
-      predicted_lines.markers.push_back(predicted_line);
-    }
+  if (predicted_paths_pub_.getNumSubscribers() > 0)
+  {
+    visualization_msgs::MarkerArray predicted_lines;
+    makePredictedLines(input, predicted_lines);
+    predicted_paths_pub_.publish(predicted_lines);
   }
-  predicted_objects_pub_.publish(output);
-  predicted_paths_pub_.publish(predicted_lines);
 }
 
 bool NaiveMotionPredict::isObjectValid(const autoware_msgs::DetectedObject &in_object)
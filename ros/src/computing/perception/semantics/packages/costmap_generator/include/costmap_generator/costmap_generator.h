@@ -46,8 +46,13 @@
 #include "points_to_costmap.h"
 #include "objects_to_costmap.h"
 
+// headers in OpenCV
+#include <opencv2/core/core.hpp>
+
 // headers in STL
 #include <memory>
+#include <string>
+#include <vector>
 
 class CostmapGenerator
 {
@@ -99,6 +104,17 @@ private:
 
   std::vector<std::vector<geometry_msgs::Point>> area_points_;
 
+  // way areas rasterized once in map frame at the grid resolution
+  struct WayareaImage
+  {
+    cv::Mat image;  // non zero inside a way area, empty when the vectormap is too large to be cached
+    cv::Mat height;  // lowest and highest way area plane over every HEIGHT_CELLS x HEIGHT_CELLS pixels, CV_32FC2
+    double origin_x;
+    double origin_y;
+    static const int HEIGHT_CELLS = 8;
+  };
+  WayareaImage wayarea_image_;
+
   PointsToCostmap points2costmap_;
   ObjectsToCostmap objects2costmap_;
 
@@ -134,11 +150,32 @@ private:
   grid_map::Matrix generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
                                           const bool use_objects_convex_hull);
 
-  /// \brief calculate cost from vectormap
-  grid_map::Matrix generateVectormapCostmap();
-
-  /// \brief calculate cost for final output
-  grid_map::Matrix generateCombinedCostmap();
+  /// \brief rasterize way areas in map frame, done once after the vectormap is subscribed
+  /// \param[in] in_area_points way area polygons in map frame
+  /// \param[in] in_resolution pixel size, the grid resolution
+  /// \param[out] out_wayarea_image rasterized way areas, with an empty image if they cover too many pixels
+  static void rasterizeWayareas(const std::vector<std::vector<geometry_msgs::Point>>& in_area_points,
+                                const double in_resolution, WayareaImage& out_wayarea_image);
+
+  /// \brief sample rasterized way areas at the cells of a grid in lidar frame, like FillPolygonAreas does
+  /// with the polygons. The transform may be tilted, every cell is sampled at the height of the way area under it
+  /// \param[in] in_wayarea_image way areas rasterized by rasterizeWayareas
+  /// \param[in] in_map_from_lidar transform of lidar frame points into map frame
+  /// \param[in] in_inside_value cost of the cells in a way area
+  /// \param[in] in_outside_value cost of the other cells
+  /// \param[in] in_layer_name layer of out_costmap to fill
+  /// \param[out] out_costmap grid in lidar frame
+  /// \return false if the transform is too tilted for the height of the way areas under the grid, such as
+  /// overlapping way areas at different heights, to be known within half a cell. The layer is then incomplete
+  static bool resampleWayareaImage(const WayareaImage& in_wayarea_image, const tf::Transform& in_map_from_lidar,
+                                   const float in_inside_value, const float in_outside_value,
+                                   const std::string& in_layer_name, grid_map::GridMap& out_costmap);
+
+  /// \brief calculate cost from vectormap into the vectormap layer of costmap_
+  void generateVectormapCostmap();
+
+  /// \brief calculate cost for final output into the combined layer of costmap_
+  void generateCombinedCostmap();
 };
 
 #endif  // COSTMAP_GENERATOR_H
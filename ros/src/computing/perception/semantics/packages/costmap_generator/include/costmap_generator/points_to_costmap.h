@@ -66,8 +66,8 @@ private:
   double grid_resolution_;
   double grid_position_x_;
   double grid_position_y_;
-  double y_cell_size_;
-  double x_cell_size_;
+  int y_cell_size_;
+  int x_cell_size_;
 
   /// \brief initialize gridmap parameters
   /// \param[in] gridmap: gridmap object to be initialized
@@ -84,26 +84,32 @@ private:
   grid_map::Index fetchGridIndexFromPoint(const pcl::PointXYZ& point);
 
   /// \brief Assign pointcloud to appropriate cell in gridmap
-  /// \param[in] gridmap: costmap based on gridmap
-  /// \param[in] in_sensor_points: subscribed pointcloud
-  /// \param[out] grid-x-length x grid-y-length size grid stuffed with point's height in corresponding grid cell
-  std::vector<std::vector<std::vector<double>>>
-  assignPoints2GridCell(const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
-
-  /// \brief calculate costmap from subscribed pointcloud
   /// \param[in] maximum_height_thres: Maximum height threshold for pointcloud data
   /// \param[in] minimum_height_thres: Minimum height threshold for pointcloud data
+  /// \param[in] in_sensor_points: subscribed pointcloud
+  /// \param[out] grid_cell_states_: grid-x-length x grid-y-length flat buffer, x index major, telling if each cell
+  /// has no point, only points out of the height thresholds or a point within them
+  void assignPoints2GridCell(const double maximum_height_thres, const double minimum_height_thres,
+                             const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
+
+  /// \brief calculate costmap from the cell states filled by assignPoints2GridCell
   /// \param[in] grid_min_value: Minimum cost for costmap
   /// \param[in] grid_max_value: Maximum cost fot costmap
   /// \param[in] gridmap: costmap based on gridmap
   /// \param[in] gridmap_layer_name: gridmap layer name for gridmap
-  /// \param[in] grid_vec: grid-x-length x grid-y-length size grid stuffed with point's height in corresponding grid
-  /// cell
   /// \param[out] caculated costmap in grid_map::Matrix format
-  grid_map::Matrix calculateCostmap(const double maximum_height_thres, const double minimum_lidar_height_thres,
-                                    const double grid_min_value, const double grid_max_value,
-                                    const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name,
-                                    const std::vector<std::vector<std::vector<double>>> grid_vec);
+  grid_map::Matrix calculateCostmap(const double grid_min_value, const double grid_max_value,
+                                    const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name);
+
+  enum GridCellState : unsigned char
+  {
+    EMPTY_CELL = 0,
+    OUT_OF_HEIGHT_RANGE_CELL = 1,
+    IN_HEIGHT_RANGE_CELL = 2
+  };
+
+  // reused between frames to avoid reallocating per-cell storage
+  std::vector<unsigned char> grid_cell_states_;
 };
 
 #endif  // POINTS_TO_COSTMAP_H
@@ -32,6 +32,11 @@
 #include "object_map/object_map_utils.hpp"
 #include "costmap_generator/costmap_generator.h"
 
+// headers in STL
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 // Constructor
 CostmapGenerator::CostmapGenerator()
   : private_nh_("~")
@@ -99,8 +104,8 @@ void CostmapGenerator::objectsCallback(const autoware_msgs::DetectedObjectArray:
   {
     costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_] = generateObjectsCostmap(in_objects, use_objects_convex_hull_);
   }
-  costmap_[VECTORMAP_COSTMAP_LAYER_] = generateVectormapCostmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateVectormapCostmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_objects->header;
   publishRosMsg(costmap_, in_header);
@@ -111,8 +116,8 @@ void CostmapGenerator::sensorPointsCallback(const sensor_msgs::PointCloud2::Cons
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
   pcl::fromROSMsg(*in_sensor_points_msg, *in_sensor_points);
   costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateSensorPointsCostmap(in_sensor_points);
-  costmap_[VECTORMAP_COSTMAP_LAYER_] = generateVectormapCostmap();
-  costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
+  generateVectormapCostmap();
+  generateCombinedCostmap();
 
   std_msgs::Header in_header = in_sensor_points_msg->header;
   publishRosMsg(costmap_, in_header);
@@ -149,41 +154,280 @@ CostmapGenerator::generateObjectsCostmap(const autoware_msgs::DetectedObjectArra
   return objects_costmap;
 }
 
-// Only this funstion depends on object_map_utils
-grid_map::Matrix CostmapGenerator::generateVectormapCostmap()
+void CostmapGenerator::rasterizeWayareas(const std::vector<std::vector<geometry_msgs::Point>>& in_area_points,
+                                         const double in_resolution, WayareaImage& out_wayarea_image)
 {
-  grid_map::GridMap vectormap_costmap = costmap_;
-  if (use_wayarea_)
+  // above this many cells (128MB) the way areas are rasterized around the grid every frame instead
+  const double max_wayarea_image_cells = 1 << 27;
+
+  double min_x = std::numeric_limits<double>::max();
+  double min_y = std::numeric_limits<double>::max();
+  double max_x = std::numeric_limits<double>::lowest();
+  double max_y = std::numeric_limits<double>::lowest();
+  for (const auto& points : in_area_points)
+  {
+    for (const auto& p : points)
+    {
+      min_x = std::min(min_x, p.x);
+      min_y = std::min(min_y, p.y);
+      max_x = std::max(max_x, p.x);
+      max_y = std::max(max_y, p.y);
+    }
+  }
+
+  out_wayarea_image.image.release();
+  out_wayarea_image.height.release();
+  if (min_x > max_x)
   {
-    if (!has_subscribed_wayarea_)
+    return;
+  }
+
+  // one cell margin around the way areas for the rounding of the polygon corners
+  const double cols = std::ceil((max_x - min_x) / in_resolution) + 3;
+  const double rows = std::ceil((max_y - min_y) / in_resolution) + 3;
+  if (cols * rows > max_wayarea_image_cells)
+  {
+    ROS_WARN("WayArea covers %.0f x %.0f cells, it is rasterized on every costmap update", cols, rows);
+    return;
+  }
+  out_wayarea_image.origin_x = min_x - in_resolution;
+  out_wayarea_image.origin_y = min_y - in_resolution;
+  out_wayarea_image.image = cv::Mat::zeros(rows, cols, CV_8UC1);
+
+  // the heights are kept as ranges over coarser cells, empty where the range is inverted
+  const int height_cells = WayareaImage::HEIGHT_CELLS;
+  const double height_cell_size = height_cells * in_resolution;
+  out_wayarea_image.height =
+      cv::Mat(static_cast<int>(rows) / height_cells + 1, static_cast<int>(cols) / height_cells + 1, CV_32FC2,
+              cv::Scalar(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
+
+  for (const auto& points : in_area_points)
+  {
+    if (points.empty())
+    {
+      continue;
+    }
+    std::vector<cv::Point> cv_points;
+    for (const auto& p : points)
+    {
+      double cv_x = (p.x - out_wayarea_image.origin_x) / in_resolution;
+      double cv_y = (p.y - out_wayarea_image.origin_y) / in_resolution;
+      cv_points.emplace_back(cv::Point(cv_x, cv_y));
+    }
+    cv::fillConvexPoly(out_wayarea_image.image, cv_points.data(), cv_points.size(), cv::Scalar(255));
+
+    // least squares plane z = mean_z + slope_x * (x - mean_x) + slope_y * (y - mean_y) through the polygon
+    double mean_x = 0.0;
+    double mean_y = 0.0;
+    double mean_z = 0.0;
+    for (const auto& p : points)
+    {
+      mean_x += p.x / points.size();
+      mean_y += p.y / points.size();
+      mean_z += p.z / points.size();
+    }
+    double sxx = 0.0;
+    double sxy = 0.0;
+    double syy = 0.0;
+    double sxz = 0.0;
+    double syz = 0.0;
+    for (const auto& p : points)
+    {
+      sxx += (p.x - mean_x) * (p.x - mean_x);
+      sxy += (p.x - mean_x) * (p.y - mean_y);
+      syy += (p.y - mean_y) * (p.y - mean_y);
+      sxz += (p.x - mean_x) * (p.z - mean_z);
+      syz += (p.y - mean_y) * (p.z - mean_z);
+    }
+    const double determinant = sxx * syy - sxy * sxy;
+    double slope_x = 0.0;
+    double slope_y = 0.0;
+    if (determinant > 1e-6 * (sxx + syy) * (sxx + syy))
+    {
+      slope_x = (sxz * syy - syz * sxy) / determinant;
+      slope_y = (syz * sxx - sxz * sxy) / determinant;
+    }
+
+    // the plane is taken at the cell centers, so it is off by the slope over half a cell diagonal besides the
+    // points out of the plane
+    double plane_error = 0.0;
+    for (const auto& p : points)
+    {
+      const double plane_z = mean_z + slope_x * (p.x - mean_x) + slope_y * (p.y - mean_y);
+      plane_error = std::max(plane_error, std::fabs(p.z - plane_z));
+    }
+    plane_error += std::hypot(slope_x, slope_y) * height_cell_size * std::sqrt(0.5);
+
+    // every cell touching the polygon, with a cell margin for the rounding of the corners
+    int min_u = out_wayarea_image.height.cols;
+    int min_v = out_wayarea_image.height.rows;
+    int max_u = 0;
+    int max_v = 0;
+    for (const auto& cv_point : cv_points)
+    {
+      min_u = std::min(min_u, cv_point.x / height_cells - 1);
+      min_v = std::min(min_v, cv_point.y / height_cells - 1);
+      max_u = std::max(max_u, cv_point.x / height_cells + 1);
+      max_v = std::max(max_v, cv_point.y / height_cells + 1);
+    }
+    for (int v = std::max(min_v, 0); v <= std::min(max_v, out_wayarea_image.height.rows - 1); v++)
     {
-      object_map::LoadRoadAreasFromVectorMap(private_nh_, area_points_);
+      for (int u = std::max(min_u, 0); u <= std::min(max_u, out_wayarea_image.height.cols - 1); u++)
+      {
+        const double x = out_wayarea_image.origin_x + (u * height_cells + (height_cells - 1) / 2.0) * in_resolution;
+        const double y = out_wayarea_image.origin_y + (v * height_cells + (height_cells - 1) / 2.0) * in_resolution;
+        const double z = mean_z + slope_x * (x - mean_x) + slope_y * (y - mean_y);
+        cv::Vec2f& height = out_wayarea_image.height.at<cv::Vec2f>(v, u);
+        height[0] = std::min<double>(height[0], z - plane_error);
+        height[1] = std::max<double>(height[1], z + plane_error);
+      }
     }
+  }
+}
+
+bool CostmapGenerator::resampleWayareaImage(const WayareaImage& in_wayarea_image,
+                                            const tf::Transform& in_map_from_lidar, const float in_inside_value,
+                                            const float in_outside_value, const std::string& in_layer_name,
+                                            grid_map::GridMap& out_costmap)
+{
+  // FillPolygonAreas keeps the x and y of the way area points once in lidar frame. The lidar frame cell (x, y)
+  // therefore shows the map point of height z that projects onto it along the lidar z axis:
+  //   z_lidar = (z - t_z - r_20 * x - r_21 * y) / r_22
+  //   map_x = r_00 * x + r_01 * y + r_02 * z_lidar + t_x, and map_y alike
+  // which is affine in (x, y) and moves by (r_02, r_12) / r_22 per meter of z. The z of a cell is the height of the
+  // way area there, found by looking the height up where the previous guess lands until it settles
+  const tf::Matrix3x3& rotation = in_map_from_lidar.getBasis();
+  const tf::Vector3& translation = in_map_from_lidar.getOrigin();
+  const double resolution = out_costmap.getResolution();
+  const double r22 = rotation[2].z();
+  // above 45 degrees of tilt the height lookups may not settle
+  if (in_wayarea_image.image.empty() || std::fabs(r22) < std::sqrt(0.5))
+  {
+    return false;
+  }
+
+  const double ax = rotation[0].x() - rotation[0].z() * rotation[2].x() / r22;
+  const double bx = rotation[0].y() - rotation[0].z() * rotation[2].y() / r22;
+  const double cx = translation.x() - rotation[0].z() * translation.z() / r22;
+  const double dx = rotation[0].z() / r22;
+  const double ay = rotation[1].x() - rotation[1].z() * rotation[2].x() / r22;
+  const double by = rotation[1].y() - rotation[1].z() * rotation[2].y() / r22;
+  const double cy = translation.y() - rotation[1].z() * translation.z() / r22;
+  const double dy = rotation[1].z() / r22;
+  const double shift = std::hypot(dx, dy);
+
+  // Cell (i, j) is sampled at the lidar frame position FillPolygonAreas maps to its pixel,
+  // (x0 - i * resolution, y0 - j * resolution), which moves in the image by a constant step per index
+  const double x0 = out_costmap.getPosition().x() + out_costmap.getLength().x() / 2.0;
+  const double y0 = out_costmap.getPosition().y() + out_costmap.getLength().y() / 2.0;
+  const double u0 = (ax * x0 + bx * y0 + cx - in_wayarea_image.origin_x) / resolution;
+  const double v0 = (ay * x0 + by * y0 + cy - in_wayarea_image.origin_y) / resolution;
+
+  const cv::Mat& image = in_wayarea_image.image;
+  const cv::Mat& height = in_wayarea_image.height;
+  const int height_cells = WayareaImage::HEIGHT_CELLS;
+  // height range of the pixel, false outside of the way areas and their margin
+  auto find_height = [&](const int u, const int v, double& out_min_z, double& out_max_z) {
+    if (u < 0 || v < 0 || u >= image.cols || v >= image.rows)
+    {
+      return false;
+    }
+    const cv::Vec2f& range = height.at<cv::Vec2f>(v / height_cells, u / height_cells);
+    out_min_z = range[0];
+    out_max_z = range[1];
+    return out_min_z <= out_max_z;
+  };
+
+  // start from the way area under the lidar, or the lidar height without one
+  double column_z = translation.z();
+  double min_z;
+  double max_z;
+  if (find_height(std::floor((translation.x() - in_wayarea_image.origin_x) / resolution + 0.5),
+                  std::floor((translation.y() - in_wayarea_image.origin_y) / resolution + 0.5), min_z, max_z))
+  {
+    column_z = (min_z + max_z) / 2.0;
+  }
+
+  grid_map::Matrix& layer = out_costmap[in_layer_name];
+  for (int j = 0; j < layer.cols(); j++)
+  {
+    double z = column_z;
+    for (int i = 0; i < layer.rows(); i++)
+    {
+      int u = std::floor(u0 - i * ax - j * bx + dx * z / resolution + 0.5);
+      int v = std::floor(v0 - i * ay - j * by + dy * z / resolution + 0.5);
+      for (int lookup = 0; find_height(u, v, min_z, max_z); lookup++)
+      {
+        // settled once close to the middle of the height range, or in it as moving would not tell more, the
+        // sample is then off by the distance to the farthest height of the range at most
+        const double offset = (min_z + max_z) / 2.0 - z;
+        if (std::fabs(offset) * shift <= resolution / 8.0 || (min_z <= z && z <= max_z))
+        {
+          if (std::max(max_z - z, z - min_z) * shift > resolution / 2.0)
+          {
+            return false;
+          }
+          break;
+        }
+        if (lookup == 3)
+        {
+          return false;
+        }
+        z += offset;
+        u = std::floor(u0 - i * ax - j * bx + dx * z / resolution + 0.5);
+        v = std::floor(v0 - i * ay - j * by + dy * z / resolution + 0.5);
+      }
+      if (i == 0)
+      {
+        column_z = z;
+      }
+      const bool is_inside =
+          u >= 0 && v >= 0 && u < image.cols && v < image.rows && image.at<unsigned char>(v, u) != 0;
+      layer(i, j) = is_inside ? in_inside_value : in_outside_value;
+    }
+  }
+  return true;
+}
+
+// Only this funstion depends on object_map_utils
+void CostmapGenerator::generateVectormapCostmap()
+{
+  if (!use_wayarea_)
+  {
+    return;
+  }
+  if (!has_subscribed_wayarea_)
+  {
+    object_map::LoadRoadAreasFromVectorMap(private_nh_, area_points_);
     if (!area_points_.empty())
     {
       has_subscribed_wayarea_ = true;
-      object_map::FillPolygonAreas(vectormap_costmap, area_points_, VECTORMAP_COSTMAP_LAYER_, grid_max_value_,
-                                   grid_min_value_, grid_min_value_, grid_max_value_, lidar_frame_, map_frame_,
-                                   tf_listener_);
+      rasterizeWayareas(area_points_, costmap_.getResolution(), wayarea_image_);
     }
   }
-  return vectormap_costmap[VECTORMAP_COSTMAP_LAYER_];
+  if (area_points_.empty())
+  {
+    return;
+  }
+
+  tf::StampedTransform tf = object_map::FindTransform(map_frame_, lidar_frame_, tf_listener_);
+  if (!resampleWayareaImage(wayarea_image_, tf, grid_min_value_, grid_max_value_, VECTORMAP_COSTMAP_LAYER_,
+                            costmap_))
+  {
+    object_map::FillPolygonAreas(costmap_, area_points_, VECTORMAP_COSTMAP_LAYER_, grid_max_value_, grid_min_value_,
+                                 grid_min_value_, grid_max_value_, lidar_frame_, map_frame_, tf_listener_);
+  }
 }
 
-grid_map::Matrix CostmapGenerator::generateCombinedCostmap()
+void CostmapGenerator::generateCombinedCostmap()
 {
   // assuming combined_costmap is calculated by element wise max operation
-  grid_map::GridMap combined_costmap = costmap_;
-  combined_costmap[COMBINED_COSTMAP_LAYER_].setConstant(grid_min_value_);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[SENSOR_POINTS_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[VECTORMAP_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_BOX_COSTMAP_LAYER_]);
-  combined_costmap[COMBINED_COSTMAP_LAYER_] =
-      combined_costmap[COMBINED_COSTMAP_LAYER_].cwiseMax(combined_costmap[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_]);
-  return combined_costmap[COMBINED_COSTMAP_LAYER_];
+  grid_map::Matrix& combined_costmap = costmap_[COMBINED_COSTMAP_LAYER_];
+  combined_costmap.setConstant(grid_min_value_);
+  combined_costmap = combined_costmap.cwiseMax(costmap_[SENSOR_POINTS_COSTMAP_LAYER_])
+                         .cwiseMax(costmap_[VECTORMAP_COSTMAP_LAYER_])
+                         .cwiseMax(costmap_[OBJECTS_BOX_COSTMAP_LAYER_])
+                         .cwiseMax(costmap_[OBJECTS_CONVEX_HULL_COSTMAP_LAYER_]);
 }
 
 void CostmapGenerator::publishRosMsg(const grid_map::GridMap& costmap, const std_msgs::Header& in_header)
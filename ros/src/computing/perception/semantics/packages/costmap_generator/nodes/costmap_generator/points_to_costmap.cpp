@@ -76,50 +76,52 @@ grid_map::Index PointsToCostmap::fetchGridIndexFromPoint(const pcl::PointXYZ& po
   return index;
 }
 
-std::vector<std::vector<std::vector<double>>> PointsToCostmap::assignPoints2GridCell(
-    const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
+void PointsToCostmap::assignPoints2GridCell(const double maximum_height_thres, const double minimum_lidar_height_thres,
+                                            const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
-  double y_cell_size = std::ceil(grid_length_y_ * (1 / grid_resolution_));
-  double x_cell_size = std::ceil(grid_length_x_ * (1 / grid_resolution_));
-  std::vector<double> z_vec;
-  std::vector<std::vector<double>> vec_y_z(y_cell_size, z_vec);
-  std::vector<std::vector<std::vector<double>>> vec_x_y_z(x_cell_size, vec_y_z);
+  y_cell_size_ = std::ceil(grid_length_y_ * (1 / grid_resolution_));
+  x_cell_size_ = std::ceil(grid_length_x_ * (1 / grid_resolution_));
+  grid_cell_states_.assign(static_cast<size_t>(x_cell_size_) * y_cell_size_, EMPTY_CELL);
 
   for (const auto& point : *in_sensor_points)
   {
     grid_map::Index grid_ind = fetchGridIndexFromPoint(point);
     if (isValidInd(grid_ind))
     {
-      vec_x_y_z[grid_ind.x()][grid_ind.y()].push_back(point.z);
+      unsigned char& state = grid_cell_states_[static_cast<size_t>(grid_ind.x()) * y_cell_size_ + grid_ind.y()];
+      if (point.z > maximum_height_thres || point.z < minimum_lidar_height_thres)
+      {
+        if (state == EMPTY_CELL)
+        {
+          state = OUT_OF_HEIGHT_RANGE_CELL;
+        }
+      }
+      else
+      {
+        state = IN_HEIGHT_RANGE_CELL;
+      }
     }
   }
-  return vec_x_y_z;
 }
 
-grid_map::Matrix PointsToCostmap::calculateCostmap(const double maximum_height_thres,
-                                                  const double minimum_lidar_height_thres, const double grid_min_value,
-                                                  const double grid_max_value, const grid_map::GridMap& gridmap,
-                                                  const std::string& gridmap_layer_name,
-                                                  const std::vector<std::vector<std::vector<double>>> grid_vec)
+grid_map::Matrix PointsToCostmap::calculateCostmap(const double grid_min_value, const double grid_max_value,
+                                                  const grid_map::GridMap& gridmap,
+                                                  const std::string& gridmap_layer_name)
 {
+  // cells with only points out of the height thresholds keep their previous cost
   grid_map::Matrix gridmap_data = gridmap[gridmap_layer_name];
-  for (size_t x_ind = 0; x_ind < grid_vec.size(); x_ind++)
+  for (int x_ind = 0; x_ind < x_cell_size_; x_ind++)
   {
-    for (size_t y_ind = 0; y_ind < grid_vec[0].size(); y_ind++)
+    const unsigned char* states = &grid_cell_states_[static_cast<size_t>(x_ind) * y_cell_size_];
+    for (int y_ind = 0; y_ind < y_cell_size_; y_ind++)
     {
-      if (grid_vec[x_ind][y_ind].size() == 0)
+      if (states[y_ind] == EMPTY_CELL)
       {
         gridmap_data(x_ind, y_ind) = grid_min_value;
-        continue;
       }
-      for (const auto& z : grid_vec[x_ind][y_ind])
+      else if (states[y_ind] == IN_HEIGHT_RANGE_CELL)
       {
-        if (z > maximum_height_thres || z < minimum_lidar_height_thres)
-        {
-          continue;
-        }
         gridmap_data(x_ind, y_ind) = grid_max_value;
-        break;
       }
     }
   }
@@ -132,8 +134,7 @@ grid_map::Matrix PointsToCostmap::makeCostmapFromSensorPoints(
     const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
   initGridmapParam(gridmap);
-  std::vector<std::vector<std::vector<double>>> grid_vec = assignPoints2GridCell(gridmap, in_sensor_points);
-  grid_map::Matrix costmap = calculateCostmap(maximum_height_thres, minimum_lidar_height_thres, grid_min_value,
-                                              grid_max_value, gridmap, gridmap_layer_name, grid_vec);
+  assignPoints2GridCell(maximum_height_thres, minimum_lidar_height_thres, in_sensor_points);
+  grid_map::Matrix costmap = calculateCostmap(grid_min_value, grid_max_value, gridmap, gridmap_layer_name);
   return costmap;
 }
@@ -28,6 +28,9 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ********************/
 
+#include <algorithm>
+#include <cmath>
+
 #include <ros/ros.h>
 #include <gtest/gtest.h>
 
@@ -60,7 +63,6 @@ protected:
     test_obj_.fillDummyObjectParam(test_obj_.dummy_object_);
     test_obj_.fillDummyCostmapParam(test_obj_.dummy_costmap_);
     test_obj_.fillDummyObjectsArrayParam(test_obj_.dummy_objects_array_);
-    test_obj_.initDummy3DVecParam();
 
   };
   void TearDown()
@@ -107,16 +109,16 @@ TEST_F(TestSuite, CheckAssignPoints2GridCell)
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
   test_obj_.dummy_pcl_point_->x = 0.5;
   test_obj_.dummy_pcl_point_->y = 0.5;
-  test_obj_.dummy_pcl_point_->z = 100;
+  test_obj_.dummy_pcl_point_->z = 1.0;
   in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
 
 
-  std::vector<std::vector<std::vector<double>>> grid_vec =
+  std::vector<unsigned char> grid_cell_states =
     test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_,
                                     in_sensor_points);
 
-  const double expected_value = 100;
-  EXPECT_EQ(expected_value, grid_vec[5][5][0]);
+  EXPECT_TRUE(test_obj_.isInHeightRangeCell(grid_cell_states, 5, 5));
+  EXPECT_FALSE(test_obj_.isInHeightRangeCell(grid_cell_states, 4, 5));
 }
 
 TEST_F(TestSuite, CheckFetchGridIndexFromPoint)
@@ -157,32 +159,36 @@ TEST_F(TestSuite, CheckNonValidIndex)
 
 TEST_F(TestSuite, CheckCalculationPointsCostmap)
 {
-  test_obj_.dummy_3d_vec_->at(5)[5].push_back(2.2);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  test_obj_.dummy_pcl_point_->x = 0.5;
+  test_obj_.dummy_pcl_point_->y = 0.5;
+  test_obj_.dummy_pcl_point_->z = 2.2;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+  test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_, in_sensor_points);
 
   grid_map::Matrix costmap_mat = test_obj_.calculateCostmap(
-    test_obj_.dummy_maximum_lidar_height_thres_,
-    test_obj_.dummy_minimum_lidar_height_thres_,
     test_obj_.dummy_grid_min_value_,
     test_obj_.dummy_grid_max_value_,
     *test_obj_.dummy_costmap_,
-    test_obj_.dummy_layer_name_,
-    *test_obj_.dummy_3d_vec_);
+    test_obj_.dummy_layer_name_);
   double expected_cost = 1.0;
   EXPECT_DOUBLE_EQ(expected_cost, costmap_mat(5,5));
 }
 
 TEST_F(TestSuite, CheckHeightThresholdForCost)
 {
-  test_obj_.dummy_3d_vec_->at(5)[5].push_back(3.2);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  test_obj_.dummy_pcl_point_->x = 0.5;
+  test_obj_.dummy_pcl_point_->y = 0.5;
+  test_obj_.dummy_pcl_point_->z = 3.2;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+  test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_, in_sensor_points);
 
   grid_map::Matrix costmap_mat = test_obj_.calculateCostmap(
-    test_obj_.dummy_maximum_lidar_height_thres_,
-    test_obj_.dummy_minimum_lidar_height_thres_,
     test_obj_.dummy_grid_min_value_,
     test_obj_.dummy_grid_max_value_,
     *test_obj_.dummy_costmap_,
-    test_obj_.dummy_layer_name_,
-    *test_obj_.dummy_3d_vec_);
+    test_obj_.dummy_layer_name_);
   double expected_cost = 0.0;
   EXPECT_DOUBLE_EQ(expected_cost, costmap_mat(5,5));
 }
@@ -449,6 +455,120 @@ TEST_F(TestSuite, CheckMakeCostmapFromObjectsBoxBlur)
   EXPECT_NEAR(expected_score, gridmap_mat(7,6), buffer);
 }
 
+// way areas in map frame, a quadrangle and a triangle in front of a lidar at (100, 50, 11)
+std::vector<std::vector<geometry_msgs::Point>> makeWayareas(const double quadrangle_z, const double triangle_z)
+{
+  const double corners[][2] = { { 96, 47 }, { 106, 46 }, { 107, 53 }, { 95, 52 }, { 90, 40 }, { 98, 41 }, { 93, 45 } };
+  std::vector<std::vector<geometry_msgs::Point>> area_points(2);
+  for (int i = 0; i < 7; i++)
+  {
+    geometry_msgs::Point point;
+    point.x = corners[i][0];
+    point.y = corners[i][1];
+    point.z = i < 4 ? quadrangle_z : triangle_z;
+    area_points[i < 4 ? 0 : 1].push_back(point);
+  }
+  return area_points;
+}
+
+// the polygon corners are rounded in different frames, so cells can only differ close to a way area border
+void expectSameWayareas(const grid_map::Matrix& filled, const grid_map::Matrix& resampled, const float inside_value,
+                        const int min_inside_cells)
+{
+  int inside_cells = 0;
+  int different_cells = 0;
+  for (int i = 0; i < filled.rows(); i++)
+  {
+    for (int j = 0; j < filled.cols(); j++)
+    {
+      if (filled(i, j) == inside_value)
+      {
+        inside_cells++;
+      }
+      if (filled(i, j) == resampled(i, j))
+      {
+        continue;
+      }
+      different_cells++;
+      bool is_near_border = false;
+      for (int k = std::max(i - 2, 0); k <= std::min(i + 2, (int)filled.rows() - 1); k++)
+      {
+        for (int l = std::max(j - 2, 0); l <= std::min(j + 2, (int)filled.cols() - 1); l++)
+        {
+          is_near_border = is_near_border || filled(k, l) != filled(i, j);
+        }
+      }
+      EXPECT_TRUE(is_near_border) << "cell " << i << ", " << j;
+    }
+  }
+  EXPECT_GT(inside_cells, min_inside_cells);
+  EXPECT_LT(different_cells, inside_cells / 5);
+}
+
+TEST_F(TestSuite, CheckWayareaImageWithTiltedTransform)
+{
+  // the way areas are 10m below the lidar, ignoring the tilt would move them by about 1m
+  std::vector<std::vector<geometry_msgs::Point>> area_points = makeWayareas(1.0, 1.0);
+  tf::Transform map_from_lidar(tf::createQuaternionFromRPY(0.1, -0.05, 0.6), tf::Vector3(100, 50, 11));
+
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(30, 20), 0.25, grid_map::Position(3, -2));
+  costmap.add("filled", test_obj_.dummy_grid_max_value_);
+  costmap.add("resampled", test_obj_.dummy_grid_max_value_);
+  test_obj_.fillWayareas(area_points, map_from_lidar, "filled", costmap);
+  ASSERT_TRUE(test_obj_.resampleWayareas(area_points, map_from_lidar, "resampled", costmap));
+  expectSameWayareas(costmap["filled"], costmap["resampled"], test_obj_.dummy_grid_min_value_, 1000);
+}
+
+TEST_F(TestSuite, CheckWayareaImageOnSlope)
+{
+  // a road climbing 16m along the map under a lidar pitched up with it, way areas at both ends are far apart in
+  // height but the ones under the grid are sampled at their own height
+  const double corners[][2] = { { 0, 46 }, { 10, 46 }, { 10, 54 }, { 0, 54 } };
+  std::vector<std::vector<geometry_msgs::Point>> area_points(20);
+  for (int i = 0; i < 20; i++)
+  {
+    for (int j = 0; j < 4; j++)
+    {
+      geometry_msgs::Point point;
+      point.x = i * 10.0 + corners[j][0];
+      point.y = corners[j][1];
+      point.z = 0.08 * (point.x - 100.0) + 1.0;
+      area_points[i].push_back(point);
+    }
+  }
+  tf::Transform map_from_lidar(tf::createQuaternionFromRPY(0.03, -std::atan(0.08), 0.2), tf::Vector3(100, 50, 3));
+
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(30, 20), 0.25, grid_map::Position(3, -2));
+  costmap.add("filled", test_obj_.dummy_grid_max_value_);
+  costmap.add("resampled", test_obj_.dummy_grid_max_value_);
+  test_obj_.fillWayareas(area_points, map_from_lidar, "filled", costmap);
+  ASSERT_TRUE(test_obj_.resampleWayareas(area_points, map_from_lidar, "resampled", costmap));
+  expectSameWayareas(costmap["filled"], costmap["resampled"], test_obj_.dummy_grid_min_value_, 3000);
+}
+
+TEST_F(TestSuite, CheckWayareaImageOverpass)
+{
+  // a way area crossing over another one 8m below, a level lidar can use the image but not a tilted one
+  std::vector<std::vector<geometry_msgs::Point>> area_points = makeWayareas(1.0, 9.0);
+  const double bridge_corners[][2] = { { 97, 44 }, { 105, 55 }, { 100, 56 } };
+  for (int i = 0; i < 3; i++)
+  {
+    area_points[1][i].x = bridge_corners[i][0];
+    area_points[1][i].y = bridge_corners[i][1];
+  }
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(30, 20), 0.25, grid_map::Position(3, -2));
+  costmap.add("resampled", test_obj_.dummy_grid_max_value_);
+
+  tf::Transform level(tf::createQuaternionFromYaw(0.6), tf::Vector3(100, 50, 11));
+  EXPECT_TRUE(test_obj_.resampleWayareas(area_points, level, "resampled", costmap));
+
+  tf::Transform tilted(tf::createQuaternionFromRPY(0.1, -0.05, 0.6), tf::Vector3(100, 50, 11));
+  EXPECT_FALSE(test_obj_.resampleWayareas(area_points, tilted, "resampled", costmap));
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -30,6 +30,7 @@
 
 
 #include "costmap_generator/costmap_generator.h"
+#include "object_map/object_map_utils.hpp"
 
 class TestClass
 {
@@ -61,29 +62,23 @@ public:
 
   PointsToCostmap *points2costmap_;
 
-  std::unique_ptr<std::vector<std::vector<std::vector<double>>>> dummy_3d_vec_;
-
   void fillDummyObjectParam(autoware_msgs::DetectedObject* dummy_object);
 
   void fillDummyObjectsArrayParam(autoware_msgs::DetectedObjectArray::Ptr dummy_objects_array);
 
   void fillDummyCostmapParam(grid_map::GridMap* dummy_costmap);
 
-  void initDummy3DVecParam();
-
-
-  std::vector<std::vector<std::vector<double>>>
+  std::vector<unsigned char>
   assignPoints2GridCell(const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
+  bool isInHeightRangeCell(const std::vector<unsigned char>& grid_cell_states, const int x_ind, const int y_ind);
+
   grid_map::Index fetchGridIndexFromPoint(const grid_map::GridMap& gridmap, const pcl::PointXYZ& point);
 
   bool isValidInd(const grid_map::GridMap& gridmap, const grid_map::Index& grid_ind);
 
-  grid_map::Matrix calculateCostmap(const double maximum_height_thres,
-                                    const double minimum_lidar_height_thres, const double grid_min_value,
-                                    const double grid_max_value, const grid_map::GridMap& gridmap,
-                                    const std::string& gridmap_layer_name,
-                                    const std::vector<std::vector<std::vector<double>>> grid_vec);
+  grid_map::Matrix calculateCostmap(const double grid_min_value, const double grid_max_value,
+                                    const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name);
 
 
   ObjectsToCostmap *objects2costmap_;
@@ -104,6 +99,14 @@ public:
                                           const double size_of_expansion_kernel,
                                           const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
                                           const bool use_objects_convex_hull);
+
+  bool resampleWayareas(const std::vector<std::vector<geometry_msgs::Point>>& area_points,
+                        const tf::Transform& map_from_lidar, const std::string& gridmap_layer_name,
+                        grid_map::GridMap& costmap);
+
+  void fillWayareas(const std::vector<std::vector<geometry_msgs::Point>>& area_points,
+                    const tf::Transform& map_from_lidar, const std::string& gridmap_layer_name,
+                    grid_map::GridMap& costmap);
 };
 
 TestClass::TestClass():
@@ -174,24 +177,13 @@ void TestClass::fillDummyObjectsArrayParam(autoware_msgs::DetectedObjectArray::P
   dummy_objects_array->objects.push_back(object);
 }
 
-void TestClass::initDummy3DVecParam()
-{
-  double y_cell_size = std::ceil(dummy_grid_length_y_ * (1 / dummy_grid_resolution_));
-  double x_cell_size = std::ceil(dummy_grid_length_x_ * (1 / dummy_grid_resolution_));
-  std::vector<double> z_vec;
-  std::vector<std::vector<double>> vec_y_z(y_cell_size, z_vec);
-  dummy_3d_vec_.reset(new
-    std::vector<std::vector<std::vector<double>>>(x_cell_size, vec_y_z));
-}
-
-
 Eigen::MatrixXd TestClass::makeRectanglePoints(const autoware_msgs::DetectedObject& in_object,
                                                const double expanded_rectangle_size)
 {
   return objects2costmap_->makeRectanglePoints(in_object, expanded_rectangle_size);
 }
 
-std::vector<std::vector<std::vector<double>>> TestClass::assignPoints2GridCell(
+std::vector<unsigned char> TestClass::assignPoints2GridCell(
     const grid_map::GridMap& gridmap, const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
   points2costmap_->grid_length_x_ = gridmap.getLength()[0];
@@ -199,7 +191,15 @@ std::vector<std::vector<std::vector<double>>> TestClass::assignPoints2GridCell(
   points2costmap_->grid_resolution_ = gridmap.getResolution();
   points2costmap_->grid_position_x_ = gridmap.getPosition()[0];
   points2costmap_->grid_position_y_ = gridmap.getPosition()[1];
-  return points2costmap_->assignPoints2GridCell(gridmap, in_sensor_points);
+  points2costmap_->assignPoints2GridCell(dummy_maximum_lidar_height_thres_, dummy_minimum_lidar_height_thres_,
+                                         in_sensor_points);
+  return points2costmap_->grid_cell_states_;
+}
+
+bool TestClass::isInHeightRangeCell(const std::vector<unsigned char>& grid_cell_states, const int x_ind,
+                                    const int y_ind)
+{
+  return grid_cell_states[x_ind * points2costmap_->y_cell_size_ + y_ind] == PointsToCostmap::IN_HEIGHT_RANGE_CELL;
 }
 
 grid_map::Index TestClass::fetchGridIndexFromPoint(const grid_map::GridMap& gridmap, const pcl::PointXYZ& point)
@@ -222,15 +222,10 @@ bool TestClass::isValidInd(const grid_map::GridMap& gridmap, const grid_map::Ind
   return points2costmap_->isValidInd(grid_ind);
 }
 
-grid_map::Matrix TestClass::calculateCostmap(const double maximum_height_thres,
-                                                  const double minimum_lidar_height_thres, const double grid_min_value,
-                                                  const double grid_max_value, const grid_map::GridMap& gridmap,
-                                                  const std::string& gridmap_layer_name,
-                                                  const std::vector<std::vector<std::vector<double>>> grid_vec)
+grid_map::Matrix TestClass::calculateCostmap(const double grid_min_value, const double grid_max_value,
+                                             const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name)
 {
-  return points2costmap_->calculateCostmap(maximum_height_thres, minimum_lidar_height_thres,
-                                          grid_min_value, grid_max_value,
-                                          gridmap, gridmap_layer_name, grid_vec);
+  return points2costmap_->calculateCostmap(grid_min_value, grid_max_value, gridmap, gridmap_layer_name);
 }
 
 geometry_msgs::Point TestClass::makeExpandedPoint(const geometry_msgs::Point& in_centroid,
@@ -264,3 +259,22 @@ grid_map::Matrix TestClass::makeCostmapFromObjects(const grid_map::GridMap& cost
                                                   in_objects,
                                                   use_objects_convex_hull);
 }
+
+bool TestClass::resampleWayareas(const std::vector<std::vector<geometry_msgs::Point>>& area_points,
+                                 const tf::Transform& map_from_lidar, const std::string& gridmap_layer_name,
+                                 grid_map::GridMap& costmap)
+{
+  CostmapGenerator::WayareaImage wayarea_image;
+  CostmapGenerator::rasterizeWayareas(area_points, costmap.getResolution(), wayarea_image);
+  return CostmapGenerator::resampleWayareaImage(wayarea_image, map_from_lidar, dummy_grid_min_value_,
+                                                dummy_grid_max_value_, gridmap_layer_name, costmap);
+}
+
+void TestClass::fillWayareas(const std::vector<std::vector<geometry_msgs::Point>>& area_points,
+                             const tf::Transform& map_from_lidar, const std::string& gridmap_layer_name,
+                             grid_map::GridMap& costmap)
+{
+  object_map::FillPolygonAreas(costmap, area_points, gridmap_layer_name, dummy_grid_max_value_,
+                               dummy_grid_min_value_, dummy_grid_min_value_, dummy_grid_max_value_,
+                               map_from_lidar.inverse());
+}
@@ -120,6 +120,16 @@ namespace object_map
 		                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
 		                      const std::string &in_tf_target_frame, const std::string &in_tf_source_frame,
 		                      const tf::TransformListener &in_tf_listener)
+	{
+		tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
+		FillPolygonAreas(out_grid_map, in_area_points, in_grid_layer_name, in_layer_background_value,
+		                 in_layer_min_value, in_fill_color, in_layer_max_value, tf);
+	}
+
+	void FillPolygonAreas(grid_map::GridMap &out_grid_map, const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+		                      const std::string &in_grid_layer_name, const int in_layer_background_value,
+		                      const int in_layer_min_value, const int in_fill_color, const int in_layer_max_value,
+		                      const tf::Transform &in_tf)
 	{
 		if(!out_grid_map.exists(in_grid_layer_name))
 		{
@@ -137,8 +147,6 @@ namespace object_map
 
 		cv::Mat filled_image = original_image.clone();
 
-		tf::StampedTransform tf = FindTransform(in_tf_target_frame, in_tf_source_frame, in_tf_listener);
-
 		// calculate out_grid_map position
 		grid_map::Position map_pos = out_grid_map.getPosition();
 		double origin_x_offset = out_grid_map.getLength().x() / 2.0 - map_pos.x();
@@ -151,7 +159,7 @@ namespace object_map
 			for (const auto &p : points)
 			{
 				// transform to GridMap coordinate
-				geometry_msgs::Point tf_point = TransformPoint(p, tf);
+				geometry_msgs::Point tf_point = TransformPoint(p, in_tf);
 
 				// coordinate conversion for cv image
 				double cv_x = (out_grid_map.getLength().y() - origin_y_offset - tf_point.y) / out_grid_map.getResolution();
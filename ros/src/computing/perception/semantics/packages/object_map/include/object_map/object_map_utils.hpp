@@ -111,6 +111,19 @@ namespace object_map
                         const std::string &in_tf_source_frame,
                         const tf::TransformListener &in_tf_listener);
 
+  /*!
+   * Same as above with the transformation of the wayarea points into the GridMap frame given directly
+   * @param[in] in_tf Transformation from the frame of the wayarea points to the GridMap frame
+   */
+  void FillPolygonAreas(grid_map::GridMap &out_grid_map,
+                        const std::vector<std::vector<geometry_msgs::Point>> &in_area_points,
+                        const std::string &in_grid_layer_name,
+                        const int in_layer_background_value,
+                        const int in_fill_color,
+                        const int in_layer_min_value,
+                        const int in_layer_max_value,
+                        const tf::Transform &in_tf);
+
 
 
 } // namespace object_map
@@ -10,6 +10,7 @@
 #define MAPPINGHELPERS_H_
 
 #include <math.h>
+#include <unordered_map>
 #include "RoadNetwork.h"
 #include "op_utility/UtilityH.h"
 #include "op_utility/DataRW.h"
@@ -18,6 +19,51 @@
 
 namespace PlannerHNS {
 
+/// \brief Uniform grid over the waypoints of a RoadNetwork plus id to pointer tables for lanes and waypoints.
+/// It holds pointers into the map, so it is built by the map loaders once the lanes are in place and must be
+/// rebuilt with MappingHelpers::UpdateRoadNetworkIndex after lanes or waypoints are added, removed, moved or renumbered.
+class RoadNetworkIndex
+{
+public:
+	/// Closest waypoint of a lane to a query position
+	class LanePoint
+	{
+	public:
+		double distance;
+		Lane* pLane;
+		WayPoint* pPoint;
+	};
+
+	RoadNetworkIndex(RoadNetwork& map, const double& cellSize = 5.0);
+
+	/// True if the index was built from this map object and not copied along with another map
+	bool IsBuiltFor(const RoadNetwork& map) const;
+
+	/// First lane with this id in map order, nullptr if there is none
+	Lane* GetLaneById(const int& id) const;
+
+	/// First waypoint with this id in map order, nullptr if there is none
+	WayPoint* GetWaypointById(const int& id) const;
+
+	/// Same as above, skipping the waypoints of lane excludedLaneId
+	WayPoint* GetWaypointById(const int& id, const int& excludedLaneId) const;
+
+	/// Lanes having at least one waypoint closer than distance to pos (or at distance if bInclusive),
+	/// in map order, each with its closest waypoint (the first one on ties).
+	void GetLanesWithinDistance(const GPSPoint& pos, const double& distance, const bool& bInclusive,
+			std::vector<LanePoint>& lanes) const;
+
+private:
+	long long GetCellKey(const int& cx, const int& cy) const;
+
+	double m_CellSize;
+	int m_MinCellX, m_MinCellY, m_MaxCellX, m_MaxCellY;
+	std::vector<Lane*> m_Lanes; // map order
+	std::unordered_map<long long, std::vector<std::pair<int, int> > > m_Cells; // lane ordinal, waypoint index
+	std::unordered_map<int, Lane*> m_LanesById;
+	std::unordered_map<int, std::vector<std::pair<Lane*, WayPoint*> > > m_WaypointsById; // map order
+	const RoadNetwork* m_pMap;
+};
 
 class MappingHelpers {
 public:
@@ -151,6 +197,11 @@ public:
 	static WayPoint* FindWaypoint(const int& id, RoadNetwork& map);
 	static WayPoint* FindWaypointV2(const int& id, const int& l_id, RoadNetwork& map);
 
+	/// Index of the map, built on first use or when the map was copied, it is not checked against the map content
+	static const RoadNetworkIndex& GetRoadNetworkIndex(RoadNetwork& map);
+	/// Rebuild the index, needed after any edit of the lanes or waypoints of an indexed map
+	static void UpdateRoadNetworkIndex(RoadNetwork& map);
+
 	static std::vector<Curb> GetCurbsList(TiXmlElement* pElem);
 	static std::vector<Boundary> GetBoundariesList(TiXmlElement* pElem);
 	static std::vector<Marking> GetMarkingsList(TiXmlElement* pElem);
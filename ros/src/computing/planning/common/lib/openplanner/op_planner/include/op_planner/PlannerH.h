@@ -10,6 +10,7 @@
 #define LANE_CHANGE_SMOOTH_FACTOR_DISTANCE 8 // meters
 
 #include "RoadNetwork.h"
+#include "PlanningHelpers.h"
 
 namespace PlannerHNS
 {
@@ -49,6 +50,9 @@ public:
 	double PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vector<WayPoint*> closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true, const bool bDirectionBased = false, const bool pathDensity = 1.0);
 
 	void DeleteWaypoints(std::vector<WayPoint*>& wps);
+
+private:
+	PlanningSearchPool m_SearchPool;
 };
 
 }
@@ -8,6 +8,7 @@
 #ifndef PLANNINGHELPERS_H_
 #define PLANNINGHELPERS_H_
 
+#include <unordered_set>
 #include "RoadNetwork.h"
 #include "op_utility/UtilityH.h"
 #include "op_utility/DataRW.h"
@@ -25,6 +26,33 @@ namespace PlannerHNS {
 #define BACKUP_STRAIGHT_PLAN_DISTANCE 75 //meters
 #define LANE_CHANGE_MIN_DISTANCE 5
 
+/// \brief Node of the global planning search, it refers to the map waypoint instead of copying it.
+class PlanningSearchNode
+{
+public:
+	WayPoint* pWaypoint;
+	double cost;
+	int iParent; // index of the node it was expanded from, -1 for the start node
+	DIRECTION_TYPE dir; // FORWARD_DIR, or FORWARD_LEFT_DIR / FORWARD_RIGHT_DIR for a lane change to the left / right
+};
+
+/// \brief Storage of the global planning search (nodes, open list and visited sets), kept between searches
+/// so that replanning does not allocate. Only the nodes of the resulting path are turned into WayPoint cells.
+class PlanningSearchPool
+{
+public:
+	std::vector<PlanningSearchNode> nodes;
+	std::vector<std::pair<double, int> > openList; // min heap of (cost, node index), ties in insertion order
+	std::unordered_set<long long> visitedWaypoints; // laneId and id of every node added to the search
+	std::unordered_set<const Lane*> visitedLanes;
+
+	void Clear();
+	void AddVisited(const WayPoint* pWP);
+	bool IsVisited(const WayPoint* pWP) const;
+	int AddNode(WayPoint* pWP, const double& cost, const int& iParent, const DIRECTION_TYPE& dir);
+	int PopMinCostNode();
+};
+
 class PlanningHelpers
 {
 
@@ -96,6 +124,9 @@ public:
 	static void ExtractPartFromPointToDistanceDirectionFast(const std::vector<WayPoint>& originalPath, const WayPoint& pos, const double& minDistance,
 			const double& pathDensity, std::vector<WayPoint>& extractedPath);
 
+	/// Copy a path point to a trajectory sample, without the road network links (toIds, fromIds, pFronts, pBacks)
+	static void CopyTrajectorySample(const WayPoint& wp, WayPoint& sample);
+
 	static void CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const std::vector<WayPoint>& originalCenter, int& start_index,
 			int& end_index, std::vector<double>& end_laterals ,
 			std::vector<std::vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
@@ -121,15 +152,20 @@ public:
 //			int& nMaxLeftBranches, int& nMaxRightBranches,
 //			std::vector<WayPoint*>& all_cells_to_delete );
 
+	/// Returns the goal cell, only the cells of the path leading to it are added to all_cells_to_delete
 	static WayPoint* BuildPlanningSearchTreeV2(WayPoint* pStart,
 			const WayPoint& goalPos,
 			const std::vector<int>& globalPath, const double& DistanceLimit,
 			const bool& bEnableLaneChange,
-			std::vector<WayPoint*>& all_cells_to_delete );
+			std::vector<WayPoint*>& all_cells_to_delete, PlanningSearchPool* pPool = nullptr);
 
 	static WayPoint* BuildPlanningSearchTreeStraight(WayPoint* pStart,
 			const double& DistanceLimit,
-			std::vector<WayPoint*>& all_cells_to_delete );
+			std::vector<WayPoint*>& all_cells_to_delete, PlanningSearchPool* pPool = nullptr);
+
+	/// Create the WayPoint cells of the path from the start node to node iGoal
+	static WayPoint* CreateSearchPathCells(const PlanningSearchPool& pool, const int& iGoal,
+			WayPoint* pStart, const double& startCost, std::vector<WayPoint*>& all_cells_to_delete);
 
 	static int PredictiveDP(WayPoint* pStart, const double& DistanceLimit,
 			std::vector<WayPoint*>& all_cells_to_delete, std::vector<WayPoint*>& end_waypoints);
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <memory>
 #include "op_utility/UtilityH.h"
 
 #define OPENPLANNER_ENABLE_LOGS
@@ -749,6 +750,8 @@ public:
 
 };
 
+class RoadNetworkIndex;
+
 class RoadNetwork
 {
 public:
@@ -760,6 +763,9 @@ public:
 	std::vector<Crossing> crossings;
 	std::vector<Marking> markings;
 	std::vector<TrafficSign> signs;
+
+	/// Lookup tables over lanes and waypoints, built by the map loaders, see MappingHelpers::UpdateRoadNetworkIndex
+	std::shared_ptr<RoadNetworkIndex> pIndex;
 };
 
 class VehicleState : public ObjTimeStamp
@@ -12,6 +12,9 @@
 #include <float.h>
 
 #include "math.h"
+#include <cmath>
+#include <climits>
+#include <algorithm>
 #include <fstream>
 
 using namespace UtilityHNS;
@@ -30,6 +33,160 @@ int MappingHelpers::g_max_stop_line_id = 0;
 int MappingHelpers::g_max_traffic_light_id = 0;
 double MappingHelpers::m_USING_VER_ZERO = 0;
 
+RoadNetworkIndex::RoadNetworkIndex(RoadNetwork& map, const double& cellSize)
+{
+	m_CellSize = cellSize > 0 ? cellSize : 5.0;
+	m_MinCellX = m_MinCellY = INT_MAX;
+	m_MaxCellX = m_MaxCellY = INT_MIN;
+	m_pMap = &map;
+
+	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+	{
+		RoadSegment& segment = map.roadSegments.at(rs);
+		for(unsigned int i = 0; i < segment.Lanes.size(); i++)
+		{
+			Lane* pL = &segment.Lanes.at(i);
+			int iLane = m_Lanes.size();
+			m_Lanes.push_back(pL);
+			m_LanesById.insert(make_pair(pL->id, pL));
+
+			for(unsigned int p = 0; p < pL->points.size(); p++)
+			{
+				WayPoint* pWP = &pL->points.at(p);
+				m_WaypointsById[pWP->id].push_back(make_pair(pL, pWP));
+
+				// such a point can never be within any distance
+				if(!std::isfinite(pWP->pos.x) || !std::isfinite(pWP->pos.y))
+					continue;
+
+				int cx = floor(pWP->pos.x / m_CellSize);
+				int cy = floor(pWP->pos.y / m_CellSize);
+				m_Cells[GetCellKey(cx, cy)].push_back(make_pair(iLane, (int)p));
+
+				m_MinCellX = min(m_MinCellX, cx);
+				m_MinCellY = min(m_MinCellY, cy);
+				m_MaxCellX = max(m_MaxCellX, cx);
+				m_MaxCellY = max(m_MaxCellY, cy);
+			}
+		}
+	}
+}
+
+bool RoadNetworkIndex::IsBuiltFor(const RoadNetwork& map) const
+{
+	return m_pMap == &map;
+}
+
+Lane* RoadNetworkIndex::GetLaneById(const int& id) const
+{
+	unordered_map<int, Lane*>::const_iterator it = m_LanesById.find(id);
+	if(it == m_LanesById.end())
+		return nullptr;
+
+	return it->second;
+}
+
+WayPoint* RoadNetworkIndex::GetWaypointById(const int& id) const
+{
+	unordered_map<int, vector<pair<Lane*, WayPoint*> > >::const_iterator it = m_WaypointsById.find(id);
+	if(it == m_WaypointsById.end())
+		return nullptr;
+
+	return it->second.at(0).second;
+}
+
+WayPoint* RoadNetworkIndex::GetWaypointById(const int& id, const int& excludedLaneId) const
+{
+	unordered_map<int, vector<pair<Lane*, WayPoint*> > >::const_iterator it = m_WaypointsById.find(id);
+	if(it == m_WaypointsById.end())
+		return nullptr;
+
+	for(unsigned int i = 0; i < it->second.size(); i++)
+	{
+		if(it->second.at(i).first->id != excludedLaneId)
+			return it->second.at(i).second;
+	}
+
+	return nullptr;
+}
+
+void RoadNetworkIndex::GetLanesWithinDistance(const GPSPoint& pos, const double& distance, const bool& bInclusive,
+		vector<LanePoint>& lanes) const
+{
+	lanes.clear();
+	if(m_Cells.size() == 0 || !(distance >= 0))
+		return;
+
+	// clamp in floating point first, the query box may be much larger than the map
+	double min_x = max((double)m_MinCellX, floor((pos.x - distance) / m_CellSize));
+	double min_y = max((double)m_MinCellY, floor((pos.y - distance) / m_CellSize));
+	double max_x = min((double)m_MaxCellX, floor((pos.x + distance) / m_CellSize));
+	double max_y = min((double)m_MaxCellY, floor((pos.y + distance) / m_CellSize));
+	if(!(min_x <= max_x && min_y <= max_y))
+		return;
+
+	vector<const vector<pair<int, int> >*> cells;
+	if((max_x - min_x + 1) * (max_y - min_y + 1) > m_Cells.size())
+	{
+		for(unordered_map<long long, vector<pair<int, int> > >::const_iterator it = m_Cells.begin(); it != m_Cells.end(); it++)
+			cells.push_back(&it->second);
+	}
+	else
+	{
+		for(int cx = min_x; cx <= max_x; cx++)
+		{
+			for(int cy = min_y; cy <= max_y; cy++)
+			{
+				unordered_map<long long, vector<pair<int, int> > >::const_iterator it = m_Cells.find(GetCellKey(cx, cy));
+				if(it != m_Cells.end())
+					cells.push_back(&it->second);
+			}
+		}
+	}
+
+	// lane ordinal, waypoint index, distance
+	vector<pair<pair<int, int>, double> > hits;
+	for(unsigned int c = 0; c < cells.size(); c++)
+	{
+		for(unsigned int i = 0; i < cells.at(c)->size(); i++)
+		{
+			const pair<int, int>& ref = cells.at(c)->at(i);
+			double d = distance2points(m_Lanes.at(ref.first)->points.at(ref.second).pos, pos);
+			if(d < distance || (bInclusive && d == distance))
+				hits.push_back(make_pair(ref, d));
+		}
+	}
+
+	// map order, and the first waypoint of a lane wins on ties
+	sort(hits.begin(), hits.end());
+
+	for(unsigned int i = 0; i < hits.size(); i++)
+	{
+		const pair<int, int>& ref = hits.at(i).first;
+		if(lanes.size() > 0 && lanes.back().pLane == m_Lanes.at(ref.first))
+		{
+			if(hits.at(i).second < lanes.back().distance)
+			{
+				lanes.back().distance = hits.at(i).second;
+				lanes.back().pPoint = &m_Lanes.at(ref.first)->points.at(ref.second);
+			}
+		}
+		else
+		{
+			LanePoint lp;
+			lp.distance = hits.at(i).second;
+			lp.pLane = m_Lanes.at(ref.first);
+			lp.pPoint = &lp.pLane->points.at(ref.second);
+			lanes.push_back(lp);
+		}
+	}
+}
+
+long long RoadNetworkIndex::GetCellKey(const int& cx, const int& cy) const
+{
+	return ((long long)cx << 32) | (unsigned int)cy;
+}
+
 MappingHelpers::MappingHelpers() {
 }
 
@@ -49,16 +206,21 @@ GPSPoint MappingHelpers::GetTransformationOrigin(const int& bToyotaCityMap)
 
 Lane* MappingHelpers::GetLaneById(const int& id,RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			if(map.roadSegments.at(rs).Lanes.at(i).id == id)
-				return &map.roadSegments.at(rs).Lanes.at(i);
-		}
-	}
+	return GetRoadNetworkIndex(map).GetLaneById(id);
+}
 
-	return nullptr;
+const RoadNetworkIndex& MappingHelpers::GetRoadNetworkIndex(RoadNetwork& map)
+{
+	if(!map.pIndex || !map.pIndex->IsBuiltFor(map))
+		UpdateRoadNetworkIndex(map);
+
+	return *map.pIndex;
+}
+
+void MappingHelpers::UpdateRoadNetworkIndex(RoadNetwork& map)
+{
+	// replace rather than rebuild in place, copies of the map may share the old index
+	map.pIndex = std::make_shared<RoadNetworkIndex>(map);
 }
 
 int MappingHelpers::GetLaneIdByWaypointId(const int& id,std::vector<Lane>& lanes)
@@ -339,16 +501,25 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessage(const std::vector<Utilit
 	//Link Lanes and lane's waypoints by pointers
 	//For each lane, the previous code set the fromId as the id of the last waypoint of the previos lane.
 	//here we fix that by finding from each fromID the corresponding point and replace the fromId by the LaneID associated with that point.
+	unordered_map<int, int> waypointLaneIds; // same result as GetLaneIdByWaypointId
+	for(unsigned int l= 0; l < roadLanes.size(); l++)
+	{
+		for(unsigned int p = 0; p < roadLanes.at(l).points.size(); p++)
+			waypointLaneIds.insert(make_pair(roadLanes.at(l).points.at(p).id, roadLanes.at(l).points.at(p).laneId));
+	}
+
 	for(unsigned int l= 0; l < roadLanes.size(); l++)
 	{
 		for(unsigned int fp = 0; fp< roadLanes.at(l).fromIds.size(); fp++)
 		{
-			roadLanes.at(l).fromIds.at(fp) = GetLaneIdByWaypointId(roadLanes.at(l).fromIds.at(fp), roadLanes);
+			unordered_map<int, int>::iterator it = waypointLaneIds.find(roadLanes.at(l).fromIds.at(fp));
+			roadLanes.at(l).fromIds.at(fp) = (it != waypointLaneIds.end()) ? it->second : 0;
 		}
 
 		for(unsigned int tp = 0; tp< roadLanes.at(l).toIds.size(); tp++)
 		{
-			roadLanes.at(l).toIds.at(tp) = GetLaneIdByWaypointId(roadLanes.at(l).toIds.at(tp), roadLanes);
+			unordered_map<int, int>::iterator it = waypointLaneIds.find(roadLanes.at(l).toIds.at(tp));
+			roadLanes.at(l).toIds.at(tp) = (it != waypointLaneIds.end()) ? it->second : 0;
 		}
 
 		double sum_a = 0;
@@ -364,6 +535,7 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessage(const std::vector<Utilit
 	roadSegment1.id = 1;
 	roadSegment1.Lanes = roadLanes;
 	map.roadSegments.push_back(roadSegment1);
+	UpdateRoadNetworkIndex(map);
 
 	//Link Lanes and lane's waypoints by pointers
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
@@ -481,40 +653,12 @@ void MappingHelpers::AssignActionCostToLane(Lane* pL, ACTION_TYPE action, double
 
 WayPoint* MappingHelpers::FindWaypoint(const int& id, RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
-			{
-				if(map.roadSegments.at(rs).Lanes.at(i).points.at(p).id == id)
-					return &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
-			}
-		}
-	}
-
-	return nullptr;
+	return GetRoadNetworkIndex(map).GetWaypointById(id);
 }
 
 WayPoint* MappingHelpers::FindWaypointV2(const int& id, const int& l_id, RoadNetwork& map)
 {
-	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
-	{
-		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
-		{
-			Lane* pLane = &map.roadSegments.at(rs).Lanes.at(i);
-			if(pLane ->id != l_id)
-			{
-				for(unsigned int p= 0; p < pLane->points.size(); p++)
-				{
-					if(pLane->points.at(p).id == id)
-						return &pLane->points.at(p);
-				}
-			}
-		}
-	}
-
-	return nullptr;
+	return GetRoadNetworkIndex(map).GetWaypointById(id, l_id);
 }
 
 void MappingHelpers::ConstructRoadNetworkFromDataFiles(const std::string vectoMapPath, RoadNetwork& map, const bool& bZeroOrigin)
@@ -747,6 +891,7 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 			map.roadSegments.at(i).Lanes.push_back(laneLinksList.at(j));
 		}
 	}
+	UpdateRoadNetworkIndex(map);
 
 	cout << " >> Link lanes and waypoints with pointers ... " << endl;
 	//Link Lanes and lane's waypoints by pointers
@@ -973,19 +1118,20 @@ WayPoint* MappingHelpers::GetClosestBackWaypointFromMap(const WayPoint& pos, Roa
 std::vector<Lane*> MappingHelpers::GetClosestLanesFast(const WayPoint& center, RoadNetwork& map, const double& distance)
 {
 	vector<Lane*> lanesList;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	//only lanes with a waypoint within distance can pass the check below
+	vector<RoadNetworkIndex::LanePoint> candidates;
+	GetRoadNetworkIndex(map).GetLanesWithinDistance(center.pos, distance, true, candidates);
+
+	for(unsigned int i = 0; i < candidates.size(); i++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-		{
-			Lane* pL = &map.roadSegments.at(j).Lanes.at(k);
-			int index = PlanningHelpers::GetClosestNextPointIndexFast(pL->points, center);
+		Lane* pL = candidates.at(i).pLane;
+		int index = PlanningHelpers::GetClosestNextPointIndexFast(pL->points, center);
 
-			if(index < 0 || index >= pL->points.size()) continue;
+		if(index < 0 || index >= pL->points.size()) continue;
 
-			double d = hypot(pL->points.at(index).pos.y - center.pos.y, pL->points.at(index).pos.x - center.pos.x);
-			if(d <= distance)
-				lanesList.push_back(pL);
-		}
+		double d = hypot(pL->points.at(index).pos.y - center.pos.y, pL->points.at(index).pos.x - center.pos.x);
+		if(d <= distance)
+			lanesList.push_back(pL);
 	}
 
 	return lanesList;
@@ -993,50 +1139,30 @@ std::vector<Lane*> MappingHelpers::GetClosestLanesFast(const WayPoint& center, R
 
 Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
 {
-	vector<pair<double, Lane*> > laneLinksList;
-	double d = 0;
-	double min_d = DBL_MAX;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
-	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			 d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-					min_d = d;
-			}
-
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
-		}
-	}
+	vector<RoadNetworkIndex::LanePoint> laneLinksList;
+	GetRoadNetworkIndex(map).GetLanesWithinDistance(pos.pos, distance, false, laneLinksList);
 
 	if(laneLinksList.size() == 0) return nullptr;
 
-	min_d = DBL_MAX;
+	double min_d = DBL_MAX;
 	Lane* closest_lane = 0;
 	for(unsigned int i = 0; i < laneLinksList.size(); i++)
 	{
 		RelativeInfo info;
-		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->points, pos, info);
+		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).pLane->points, pos, info);
 
-		if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+		if(info.perp_distance == 0 && laneLinksList.at(i).distance != 0)
 			continue;
 
 		if(bDirectionBased && fabs(info.perp_distance) < min_d && fabs(info.angle_diff) < 45)
 		{
 			min_d = fabs(info.perp_distance);
-			closest_lane = laneLinksList.at(i).second;
+			closest_lane = laneLinksList.at(i).pLane;
 		}
 		else if(!bDirectionBased && fabs(info.perp_distance) < min_d)
 		{
 			min_d = fabs(info.perp_distance);
-			closest_lane = laneLinksList.at(i).second;
+			closest_lane = laneLinksList.at(i).pLane;
 		}
 	}
 
@@ -1045,28 +1171,8 @@ Lane* MappingHelpers::GetClosestLaneFromMap(const WayPoint& pos, RoadNetwork& ma
 
 vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, RoadNetwork& map, const double& distance, const bool bDirectionBased)
 {
-	vector<pair<double, Lane*> > laneLinksList;
-	double d = 0;
-	double min_d = DBL_MAX;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
-	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			 d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-					min_d = d;
-			}
-
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k)));
-		}
-	}
+	vector<RoadNetworkIndex::LanePoint> laneLinksList;
+	GetRoadNetworkIndex(map).GetLanesWithinDistance(pos.pos, distance, false, laneLinksList);
 
 	vector<Lane*> closest_lanes;
 	if(laneLinksList.size() == 0) return closest_lanes;
@@ -1075,18 +1181,18 @@ vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, Ro
 	for(unsigned int i = 0; i < laneLinksList.size(); i++)
 	{
 		RelativeInfo info;
-		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->points, pos, info);
+		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).pLane->points, pos, info);
 
-		if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+		if(info.perp_distance == 0 && laneLinksList.at(i).distance != 0)
 			continue;
 
 		if(bDirectionBased && fabs(info.perp_distance) < distance && fabs(info.angle_diff) < 30)
 		{
-			closest_lanes.push_back(laneLinksList.at(i).second);
+			closest_lanes.push_back(laneLinksList.at(i).pLane);
 		}
 		else if(!bDirectionBased && fabs(info.perp_distance) < distance)
 		{
-			closest_lanes.push_back(laneLinksList.at(i).second);
+			closest_lanes.push_back(laneLinksList.at(i).pLane);
 		}
 	}
 
@@ -1095,51 +1201,27 @@ vector<Lane*> MappingHelpers::GetClosestLanesListFromMap(const WayPoint& pos, Ro
 
 Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, RoadNetwork& map, const double& distance)
 {
-	vector<pair<double, WayPoint*> > laneLinksList;
-	double d = 0;
-	double min_d = DBL_MAX;
-	int min_i = 0;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
-	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
-		{
-			//Lane* pLane = &pEdge->lanes.at(k);
-			d = 0;
-			min_d = DBL_MAX;
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				if(d < min_d)
-				{
-					min_d = d;
-					min_i = pindex;
-				}
-			}
-
-			if(min_d < distance)
-				laneLinksList.push_back(make_pair(min_d, &map.roadSegments.at(j).Lanes.at(k).points.at(min_i)));
-		}
-	}
+	vector<RoadNetworkIndex::LanePoint> laneLinksList;
+	GetRoadNetworkIndex(map).GetLanesWithinDistance(pos.pos, distance, false, laneLinksList);
 
 	if(laneLinksList.size() == 0) return nullptr;
 
-	min_d = DBL_MAX;
+	double min_d = DBL_MAX;
 	Lane* closest_lane = 0;
 	double a_diff = 0;
 	for(unsigned int i = 0; i < laneLinksList.size(); i++)
 	{
 		RelativeInfo info;
-		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).second->pLane->points, pos, info);
-		if(info.perp_distance == 0 && laneLinksList.at(i).first != 0)
+		PlanningHelpers::GetRelativeInfo(laneLinksList.at(i).pPoint->pLane->points, pos, info);
+		if(info.perp_distance == 0 && laneLinksList.at(i).distance != 0)
 			continue;
 
-		a_diff = UtilityH::AngleBetweenTwoAnglesPositive(laneLinksList.at(i).second->pos.a, pos.pos.a);
+		a_diff = UtilityH::AngleBetweenTwoAnglesPositive(laneLinksList.at(i).pPoint->pos.a, pos.pos.a);
 
 		if(fabs(info.perp_distance)<min_d && a_diff <= M_PI_4)
 		{
 			min_d = fabs(info.perp_distance);
-			closest_lane = laneLinksList.at(i).second->pLane;
+			closest_lane = laneLinksList.at(i).pPoint->pLane;
 		}
 	}
 
@@ -1152,32 +1234,33 @@ Lane* MappingHelpers::GetClosestLaneFromMapDirectionBased(const WayPoint& pos, R
 	vector<Lane*> lanesList;
 	double d = 0;
 	double a_diff = 0;
-	for(unsigned int j=0; j< map.roadSegments.size(); j ++)
+	vector<RoadNetworkIndex::LanePoint> candidates;
+	GetRoadNetworkIndex(map).GetLanesWithinDistance(pos.pos, distance, true, candidates);
+
+	for(unsigned int k=0; k< candidates.size(); k ++)
 	{
-		for(unsigned int k=0; k< map.roadSegments.at(j).Lanes.size(); k ++)
+		Lane* pL = candidates.at(k).pLane;
+		for(unsigned int pindex=0; pindex< pL->points.size(); pindex ++)
 		{
-			for(unsigned int pindex=0; pindex< map.roadSegments.at(j).Lanes.at(k).points.size(); pindex ++)
-			{
-				d = distance2points(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos, pos.pos);
-				a_diff = UtilityH::AngleBetweenTwoAnglesPositive(map.roadSegments.at(j).Lanes.at(k).points.at(pindex).pos.a, pos.pos.a);
+			d = distance2points(pL->points.at(pindex).pos, pos.pos);
+			a_diff = UtilityH::AngleBetweenTwoAnglesPositive(pL->points.at(pindex).pos.a, pos.pos.a);
 
-				if(d <= distance && a_diff <= M_PI_4)
+			if(d <= distance && a_diff <= M_PI_4)
+			{
+				bool bLaneExist = false;
+				for(unsigned int il = 0; il < lanesList.size(); il++)
 				{
-					bool bLaneExist = false;
-					for(unsigned int il = 0; il < lanesList.size(); il++)
+					if(lanesList.at(il)->id == pL->id)
 					{
-						if(lanesList.at(il)->id == map.roadSegments.at(j).Lanes.at(k).id)
-						{
-							bLaneExist = true;
-							break;
-						}
+						bLaneExist = true;
+						break;
 					}
+				}
 
-					if(!bLaneExist)
-						lanesList.push_back(&map.roadSegments.at(j).Lanes.at(k));
+				if(!bLaneExist)
+					lanesList.push_back(pL);
 
-					break;
-				}
+				break;
 			}
 		}
 	}
@@ -2317,6 +2400,7 @@ void MappingHelpers::ConstructRoadNetworkFromROSMessageV2(const std::vector<Util
 	roadSegment1.id = 1;
 	roadSegment1.Lanes = roadLanes;
 	map.roadSegments.push_back(roadSegment1);
+	UpdateRoadNetworkIndex(map);
 
 	//Fix angle for lanes
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
@@ -34,13 +34,14 @@ void PlannerH::GenerateRunoffTrajectory(const std::vector<std::vector<WayPoint>
 
 	if(referencePaths.size()==0) return;
 	if(microPlanDistance <=0 ) return;
-	rollOutsPaths.clear();
+	//the trajectories are regenerated every cycle, reuse the buffers of the previous one
+	rollOutsPaths.resize(referencePaths.size());
 
 	sampledPoints_debug.clear(); //for visualization only
 
 	for(unsigned int i = 0; i < referencePaths.size(); i++)
 	{
-		std::vector<std::vector<WayPoint> > local_rollOutPaths;
+		std::vector<std::vector<WayPoint> >& local_rollOutPaths = rollOutsPaths.at(i);
 		int s_index = 0, e_index = 0;
 		vector<double> e_distances;
 		if(referencePaths.at(i).size()>0)
@@ -52,13 +53,12 @@ void PlannerH::GenerateRunoffTrajectory(const std::vector<std::vector<WayPoint>
 		}
 		else
 		{
+			local_rollOutPaths.resize(rollOutNumber+1);
 			for(int j=0; j< rollOutNumber+1; j++)
 			{
-				local_rollOutPaths.push_back(vector<WayPoint>());
+				local_rollOutPaths.at(j).clear();
 			}
 		}
-
-		rollOutsPaths.push_back(local_rollOutPaths);
 	}
 }
 
@@ -96,7 +96,7 @@ double PlannerH::PlanUsingDPRandom(const WayPoint& start,
 
 	vector<WayPoint*> local_cell_to_delete;
 	WayPoint* pLaneCell = 0;
-	pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, maxPlanningDistance, local_cell_to_delete);
+	pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, maxPlanningDistance, local_cell_to_delete, &m_SearchPool);
 
 	if(!pLaneCell)
 	{
@@ -197,9 +197,9 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 	char bPlan = 'A';
 
 	if(all_cell_to_delete)
-		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, *all_cell_to_delete);
+		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, *all_cell_to_delete, &m_SearchPool);
 	else
-		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, local_cell_to_delete);
+		pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, globalPath, maxPlanningDistance,bEnableLaneChange, local_cell_to_delete, &m_SearchPool);
 
 	if(!pLaneCell)
 	{
@@ -207,9 +207,9 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 		cout << endl << "PlannerH -> Plan (A) Failed, Trying Plan (B)." << endl;
 
 		if(all_cell_to_delete)
-			pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, *all_cell_to_delete);
+			pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, *all_cell_to_delete, &m_SearchPool);
 		else
-			pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete);
+			pLaneCell =  PlanningHelpers::BuildPlanningSearchTreeStraight(pStart, BACKUP_STRAIGHT_PLAN_DISTANCE, local_cell_to_delete, &m_SearchPool);
 
 		if(!pLaneCell)
 		{
@@ -9,6 +9,8 @@
 #include "op_planner/MatrixOperations.h"
 #include <string>
 #include <float.h>
+#include <algorithm>
+#include <functional>
 
 using namespace UtilityHNS;
 using namespace std;
@@ -1148,6 +1150,7 @@ void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& dista
 	double remaining = 0;
 	int nPoints = 0;
 	vector<WayPoint> fixedPath;
+	fixedPath.reserve(path.size());
 	fixedPath.push_back(path.at(0));
 	for(unsigned int si = 0, ei=1; ei < path.size(); )
 	{
@@ -1185,7 +1188,7 @@ void PlanningHelpers::FixPathDensity(vector<WayPoint>& path, const double& dista
 		}
 	}
 
-	path = fixedPath;
+	path.swap(fixedPath);
 }
 
 void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
@@ -1198,8 +1201,11 @@ void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
 		return;
 	}
 
-	const vector<WayPoint>& path_in = path;
-	vector<WayPoint> smoothPath_out =  path_in;
+	//only the positions change, so smooth in place and keep a copy of the original positions
+	vector<GPSPoint> path_in(path.size());
+	for(unsigned int i = 0; i < path.size(); i++)
+		path_in[i] = path[i].pos;
+	vector<WayPoint>& smoothPath_out = path;
 
 	double change = tolerance;
 	double xtemp, ytemp;
@@ -1219,9 +1225,9 @@ void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
 			ytemp = smoothPath_out[i].pos.y;
 
 			smoothPath_out[i].pos.x += weight_data
-					* (path_in[i].pos.x - smoothPath_out[i].pos.x);
+					* (path_in[i].x - smoothPath_out[i].pos.x);
 			smoothPath_out[i].pos.y += weight_data
-					* (path_in[i].pos.y - smoothPath_out[i].pos.y);
+					* (path_in[i].y - smoothPath_out[i].pos.y);
 
 			smoothPath_out[i].pos.x += weight_smooth
 					* (smoothPath_out[i - 1].pos.x + smoothPath_out[i + 1].pos.x
@@ -1236,8 +1242,6 @@ void PlanningHelpers::SmoothPath(vector<WayPoint>& path, double weight_data,
 		}
 		nIterations++;
 	}
-
-	path = smoothPath_out;
 }
 
 void PlanningHelpers::PredictConstantTimeCostForTrajectory(std::vector<PlannerHNS::WayPoint>& path, const PlannerHNS::WayPoint& currPose, const double& minVelocity, const double& minDist)
@@ -1433,9 +1437,11 @@ void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<W
 	if(close_index + 1 >= originalPath.size())
 		close_index = originalPath.size() - 2;
 
+	//find the extracted range first, then copy it at once
+	int start_index = close_index + 1;
 	for(int i=close_index; i >=  0; i--)
 	{
-		extractedPath.insert(extractedPath.begin(),  originalPath.at(i));
+		start_index = i;
 		if(i < originalPath.size())
 			d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
 		if(d > 10)
@@ -1444,15 +1450,18 @@ void PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(const vector<W
 
 	//extractedPath.push_back(info.perp_point);
 	d = 0;
+	int end_index = close_index + 1;
 	for(int i=close_index+1; i < (int)originalPath.size(); i++)
 	{
-		extractedPath.push_back(originalPath.at(i));
+		end_index = i + 1;
 		if(i > 0)
 			d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
 		if(d > minDistance)
 			break;
 	}
 
+	extractedPath.assign(originalPath.begin() + start_index, originalPath.begin() + end_index);
+
 	if(extractedPath.size() < 2)
 	{
 		cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
@@ -1473,9 +1482,10 @@ void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>&
 	if(info.iBack > 0)
 		info.iBack--;
 
+	int start_index = info.iBack + 1;
 	for(int i=info.iBack; i >=  0; i--)
 	{
-		extractedPath.insert(extractedPath.begin(),  originalPath.at(i));
+		start_index = i;
 		if(i < originalPath.size())
 			d += hypot(originalPath.at(i).pos.y - originalPath.at(i+1).pos.y, originalPath.at(i).pos.x - originalPath.at(i+1).pos.x);
 		if(d > 10)
@@ -1484,15 +1494,18 @@ void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>&
 
 	//extractedPath.push_back(info.perp_point);
 	d = 0;
+	int end_index = info.iBack + 1;
 	for(int i=info.iBack+1; i < (int)originalPath.size(); i++)
 	{
-		extractedPath.push_back(originalPath.at(i));
+		end_index = i + 1;
 		if(i > 0)
 			d += hypot(originalPath.at(i).pos.y - originalPath.at(i-1).pos.y, originalPath.at(i).pos.x - originalPath.at(i-1).pos.x);
 		if(d > minDistance)
 			break;
 	}
 
+	extractedPath.assign(originalPath.begin() + start_index, originalPath.begin() + end_index);
+
 	if(extractedPath.size() < 2)
 	{
 		cout << endl << "### Planner Z . Extracted Rollout Path is too Small, Size = " << extractedPath.size() << endl;
@@ -1503,6 +1516,17 @@ void PlanningHelpers::ExtractPartFromPointToDistanceFast(const vector<WayPoint>&
 	CalcAngleAndCost(extractedPath);
 }
 
+void PlanningHelpers::CopyTrajectorySample(const WayPoint& wp, WayPoint& sample)
+{
+	sample = wp;
+
+	//the sample is only a point of a trajectory, drop the road network links so copying it does not allocate
+	sample.toIds.clear();
+	sample.fromIds.clear();
+	sample.pFronts.clear();
+	sample.pBacks.clear();
+}
+
 void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const double& speed, const vector<WayPoint>& originalCenter, int& start_index,
 		int& end_index, vector<double>& end_laterals ,
 		vector<vector<WayPoint> >& rollInPaths, const double& max_roll_distance,
@@ -1624,13 +1648,14 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 
 
 	vector<double> inc_list;
-	rollInPaths.clear();
 	vector<double> inc_list_inc;
+	//keep the buffers of the previous call
+	rollInPaths.resize(rollOutNumber+1);
 	for(int i=0; i< rollOutNumber+1; i++)
 	{
 		double diff = end_laterals.at(i)-initial_roll_in_distance;
 		inc_list.push_back(diff/(double)nSteps);
-		rollInPaths.push_back(vector<WayPoint>());
+		rollInPaths.at(i).clear();
 		inc_list_inc.push_back(0);
 	}
 
@@ -1645,7 +1670,7 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 	//Insert First strait points within the tip of the car range
 	for(unsigned int j = start_index; j < smoothing_start_index; j++)
 	{
-		p = originalCenter.at(j);
+		CopyTrajectorySample(originalCenter.at(j), p);
 		double original_speed = p.v;
 	  for(unsigned int i=0; i< rollOutNumber+1 ; i++)
 	  {
@@ -1667,7 +1692,7 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 
 	for(unsigned int j = smoothing_start_index; j < end_index; j++)
 	  {
-		  p = originalCenter.at(j);
+		  CopyTrajectorySample(originalCenter.at(j), p);
 		  double original_speed = p.v;
 		  for(unsigned int i=0; i< rollOutNumber+1 ; i++)
 		  {
@@ -1689,7 +1714,7 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 	//Insert last strait points to make better smoothing
 	for(unsigned int j = end_index; j < smoothing_end_index; j++)
 	{
-		p = originalCenter.at(j);
+		CopyTrajectorySample(originalCenter.at(j), p);
 		double original_speed = p.v;
 	  for(unsigned int i=0; i< rollOutNumber+1 ; i++)
 	  {
@@ -1732,7 +1757,7 @@ void PlanningHelpers::CalculateRollInTrajectories(const WayPoint& carPos, const
 		if(d_limit > max_roll_distance)
 			break;
 
-			p = originalCenter.at(j);
+			CopyTrajectorySample(originalCenter.at(j), p);
 			double original_speed = p.v;
 		  for(unsigned int i=0; i< rollInPaths.size() ; i++)
 		  {
@@ -1946,66 +1971,140 @@ void PlanningHelpers::GenerateRecommendedSpeed(vector<WayPoint>& path, const dou
 	SmoothSpeedProfiles(path, 0.4,0.3, 0.01);
 }
 
+void PlanningSearchPool::Clear()
+{
+	nodes.clear();
+	openList.clear();
+	visitedWaypoints.clear();
+	visitedLanes.clear();
+}
+
+void PlanningSearchPool::AddVisited(const WayPoint* pWP)
+{
+	visitedWaypoints.insert(((long long)pWP->laneId << 32) | (unsigned int)pWP->id);
+	visitedLanes.insert(pWP->pLane);
+}
+
+bool PlanningSearchPool::IsVisited(const WayPoint* pWP) const
+{
+	return visitedWaypoints.find(((long long)pWP->laneId << 32) | (unsigned int)pWP->id) != visitedWaypoints.end();
+}
+
+int PlanningSearchPool::AddNode(WayPoint* pWP, const double& cost, const int& iParent, const DIRECTION_TYPE& dir)
+{
+	PlanningSearchNode node;
+	node.pWaypoint = pWP;
+	node.cost = cost;
+	node.iParent = iParent;
+	node.dir = dir;
+	nodes.push_back(node);
+	AddVisited(pWP);
+
+	openList.push_back(make_pair(cost, (int)nodes.size()-1));
+	push_heap(openList.begin(), openList.end(), greater<pair<double, int> >());
+
+	return nodes.size()-1;
+}
+
+int PlanningSearchPool::PopMinCostNode()
+{
+	pop_heap(openList.begin(), openList.end(), greater<pair<double, int> >());
+	int iNode = openList.back().second;
+	openList.pop_back();
+	return iNode;
+}
+
+WayPoint* PlanningHelpers::CreateSearchPathCells(const PlanningSearchPool& pool, const int& iGoal,
+		WayPoint* pStart, const double& startCost, vector<WayPoint*>& all_cells_to_delete)
+{
+	vector<int> path_nodes;
+	for(int i = iGoal; i >= 0; i = pool.nodes.at(i).iParent)
+		path_nodes.push_back(i);
+
+	WayPoint* pParent = 0;
+	for(int i = path_nodes.size()-1; i >= 0; i--)
+	{
+		const PlanningSearchNode& node = pool.nodes.at(path_nodes.at(i));
+		WayPoint* wp = new WayPoint();
+
+		if(node.iParent < 0)
+		{
+			*wp = *pStart;
+			wp->cost = startCost;
+		}
+		else
+		{
+			*wp = *node.pWaypoint;
+			wp->cost = node.cost;
+
+			if(node.dir == FORWARD_LEFT_DIR)
+			{
+				wp->pRight = pParent;
+				wp->pLeft = 0;
+			}
+			else if(node.dir == FORWARD_RIGHT_DIR)
+			{
+				wp->pLeft = pParent;
+				wp->pRight = 0;
+			}
+			else
+				wp->pBacks.push_back(pParent);
+		}
+
+		all_cells_to_delete.push_back(wp);
+		pParent = wp;
+	}
+
+	return pParent;
+}
+
 WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 		const WayPoint& goalPos,
 		const vector<int>& globalPath,
 		const double& DistanceLimit,
 		const bool& bEnableLaneChange,
-		vector<WayPoint*>& all_cells_to_delete)
+		vector<WayPoint*>& all_cells_to_delete, PlanningSearchPool* pPool)
 {
 	if(!pStart) return NULL;
 
-	vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
+	PlanningSearchPool local_pool;
+	PlanningSearchPool& pool = pPool ? *pPool : local_pool;
+	pool.Clear();
 
-	WayPoint* pZero = 0;
-	WayPoint* wp    = new WayPoint();
-	*wp = *pStart;
-	nextLeafToTrace.push_back(make_pair(pZero, wp));
-	all_cells_to_delete.push_back(wp);
+	//cells left by a previous search in the same list are not visited again
+	for(unsigned int i=0; i < all_cells_to_delete.size(); i++)
+		pool.AddVisited(all_cells_to_delete.at(i));
+
+	pool.AddNode(pStart, pStart->cost, -1, FORWARD_DIR);
 
 	double 		distance 		= 0;
 	double 		before_change_distance	= 0;
-	WayPoint* 	pGoalCell 		= 0;
-	double 		nCounter 		= 0;
-
+	int 		iGoalNode 		= -1;
 
-	while(nextLeafToTrace.size()>0)
+	while(pool.openList.size()>0)
 	{
-		nCounter++;
-
-		unsigned int min_cost_index = 0;
-		double min_cost = DBL_MAX;
-
-		for(unsigned int i=0; i < nextLeafToTrace.size(); i++)
-		{
-			if(nextLeafToTrace.at(i).second->cost < min_cost)
-			{
-				min_cost = nextLeafToTrace.at(i).second->cost;
-				min_cost_index = i;
-			}
-		}
-
-		WayPoint* pH 	= nextLeafToTrace.at(min_cost_index).second;
+		int iH = pool.PopMinCostNode();
+		WayPoint* pH = pool.nodes.at(iH).pWaypoint;
+		double h_cost = pool.nodes.at(iH).cost;
 
 		assert(pH != 0);
 
-		nextLeafToTrace.erase(nextLeafToTrace.begin()+min_cost_index);
-
 		double distance_to_goal = distance2points(pH->pos, goalPos.pos);
 		double angle_to_goal = UtilityH::AngleBetweenTwoAnglesPositive(UtilityH::FixNegativeAngle(pH->pos.a), UtilityH::FixNegativeAngle(goalPos.pos.a));
 		if( distance_to_goal <= 0.1 && angle_to_goal < M_PI_4)
 		{
 			cout << "Goal Found, LaneID: " << pH->laneId <<", Distance : " << distance_to_goal << ", Angle: " << angle_to_goal*RAD2DEG << endl;
-			pGoalCell = pH;
+			iGoalNode = iH;
 			break;
 		}
 		else
 		{
+			//after a lane change the other side points back to the lane we came from, which is always visited
+			bool bCanChangeLane = bEnableLaneChange && pool.nodes.at(iH).dir == FORWARD_DIR;
 
-			if(pH->pLeft && !CheckLaneExits(all_cells_to_delete, pH->pLeft->pLane) && !CheckNodeExits(all_cells_to_delete, pH->pLeft) && bEnableLaneChange && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
+			if(bCanChangeLane && pH->pLeft && pool.visitedLanes.find(pH->pLeft->pLane) == pool.visitedLanes.end() && !pool.IsVisited(pH->pLeft) && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
 			{
-				wp = new WayPoint();
-				*wp = *pH->pLeft;
+				WayPoint* wp = pH->pLeft;
 				double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
 				distance += d;
 				before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
@@ -2016,18 +2115,12 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 						d += wp->actionCost.at(a).second;
 				}
 
-				wp->cost = pH->cost + d;
-				wp->pRight = pH;
-				wp->pLeft = 0;
-
-				nextLeafToTrace.push_back(make_pair(pH, wp));
-				all_cells_to_delete.push_back(wp);
+				pool.AddNode(wp, h_cost + d, iH, FORWARD_LEFT_DIR);
 			}
 
-			if(pH->pRight && !CheckLaneExits(all_cells_to_delete, pH->pRight->pLane) && !CheckNodeExits(all_cells_to_delete, pH->pRight) && bEnableLaneChange && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
+			if(bCanChangeLane && pH->pRight && pool.visitedLanes.find(pH->pRight->pLane) == pool.visitedLanes.end() && !pool.IsVisited(pH->pRight) && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
 			{
-				wp = new WayPoint();
-				*wp = *pH->pRight;
+				WayPoint* wp = pH->pRight;
 				double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
 				distance += d;
 				before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
@@ -2038,19 +2131,14 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 						d += wp->actionCost.at(a).second;
 				}
 
-				wp->cost = pH->cost + d ;
-				wp->pLeft = pH;
-				wp->pRight = 0;
-				nextLeafToTrace.push_back(make_pair(pH, wp));
-				all_cells_to_delete.push_back(wp);
+				pool.AddNode(wp, h_cost + d, iH, FORWARD_RIGHT_DIR);
 			}
 
 			for(unsigned int i =0; i< pH->pFronts.size(); i++)
 			{
-				if(CheckLaneIdExits(globalPath, pH->pLane) && pH->pFronts.at(i) && !CheckNodeExits(all_cells_to_delete, pH->pFronts.at(i)))
+				if(CheckLaneIdExits(globalPath, pH->pLane) && pH->pFronts.at(i) && !pool.IsVisited(pH->pFronts.at(i)))
 				{
-					wp = new WayPoint();
-					*wp = *pH->pFronts.at(i);
+					WayPoint* wp = pH->pFronts.at(i);
 
 					double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
 					distance += d;
@@ -2062,147 +2150,65 @@ WayPoint* PlanningHelpers::BuildPlanningSearchTreeV2(WayPoint* pStart,
 							d += wp->actionCost.at(a).second;
 					}
 
-					wp->cost = pH->cost + d;
-					wp->pBacks.push_back(pH);
-
-					nextLeafToTrace.push_back(make_pair(pH, wp));
-					all_cells_to_delete.push_back(wp);
+					pool.AddNode(wp, h_cost + d, iH, FORWARD_DIR);
 				}
 			}
 		}
 
 		if(distance > DistanceLimit && globalPath.size()==0)
 		{
-			//if(!pGoalCell)
 			cout << "Goal Not Found, LaneID: " << pH->laneId <<", Distance : " << distance << endl;
-			pGoalCell = pH;
+			iGoalNode = iH;
 			break;
 		}
-
-		//pGoalCell = pH;
 	}
 
-	while(nextLeafToTrace.size()!=0)
-		nextLeafToTrace.pop_back();
-	//closed_nodes.clear();
+	if(iGoalNode < 0)
+		return NULL;
 
-	return pGoalCell;
+	return CreateSearchPathCells(pool, iGoalNode, pStart, pStart->cost, all_cells_to_delete);
 }
 
 WayPoint* PlanningHelpers::BuildPlanningSearchTreeStraight(WayPoint* pStart,
 		const double& DistanceLimit,
-		vector<WayPoint*>& all_cells_to_delete)
+		vector<WayPoint*>& all_cells_to_delete, PlanningSearchPool* pPool)
 {
 	if(!pStart) return NULL;
 
-	vector<pair<WayPoint*, WayPoint*> >nextLeafToTrace;
+	PlanningSearchPool local_pool;
+	PlanningSearchPool& pool = pPool ? *pPool : local_pool;
+	pool.Clear();
 
-	WayPoint* pZero = 0;
-	WayPoint* wp    = new WayPoint();
-	*wp = *pStart;
-	wp->cost = 0;
-	nextLeafToTrace.push_back(make_pair(pZero, wp));
-	all_cells_to_delete.push_back(wp);
-
-	double 		distance 		= 0;
-	WayPoint* 	pGoalCell 		= 0;
-	double 		nCounter 		= 0;
+	for(unsigned int i=0; i < all_cells_to_delete.size(); i++)
+		pool.AddVisited(all_cells_to_delete.at(i));
 
-	while(nextLeafToTrace.size()>0)
-	{
-		nCounter++;
+	pool.AddNode(pStart, 0, -1, FORWARD_DIR);
 
-		unsigned int min_cost_index = 0;
-		double min_cost = DBL_MAX;
+	int iGoalNode = -1;
 
-		for(unsigned int i=0; i < nextLeafToTrace.size(); i++)
-		{
-			if(nextLeafToTrace.at(i).second->cost < min_cost)
-			{
-				min_cost = nextLeafToTrace.at(i).second->cost;
-				min_cost_index = i;
-			}
-		}
-
-		WayPoint* pH 	= nextLeafToTrace.at(min_cost_index).second;
+	while(pool.openList.size()>0)
+	{
+		int iH = pool.PopMinCostNode();
+		WayPoint* pH = pool.nodes.at(iH).pWaypoint;
+		double h_cost = pool.nodes.at(iH).cost;
 		assert(pH != 0);
 
-		nextLeafToTrace.erase(nextLeafToTrace.begin()+min_cost_index);
-
 		for(unsigned int i =0; i< pH->pFronts.size(); i++)
 		{
-			if(pH->pFronts.at(i) && !CheckNodeExits(all_cells_to_delete, pH->pFronts.at(i)))
+			if(pH->pFronts.at(i) && !pool.IsVisited(pH->pFronts.at(i)))
 			{
-				wp = new WayPoint();
-				*wp = *pH->pFronts.at(i);
-
+				WayPoint* wp = pH->pFronts.at(i);
 				double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
-				distance += d;
 
-//				for(unsigned int a = 0; a < wp->actionCost.size(); a++)
-//				{
-//					//if(wp->actionCost.at(a).first == FORWARD_ACTION)
-//						d += wp->actionCost.at(a).second;
-//				}
-
-				wp->cost = pH->cost + d;
-				wp->pBacks.push_back(pH);
-				if(wp->cost < DistanceLimit)
-				{
-					nextLeafToTrace.push_back(make_pair(pH, wp));
-					all_cells_to_delete.push_back(wp);
-				}
-				else
-					delete wp;
+				if(h_cost + d < DistanceLimit)
+					pool.AddNode(wp, h_cost + d, iH, FORWARD_DIR);
 			}
 		}
 
-//		if(pH->pLeft && !CheckLaneExits(all_cells_to_delete, pH->pLeft->pLane))
-//		{
-//			wp = new WayPoint();
-//			*wp = *pH->pLeft;
-//			double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
-//
-//			for(unsigned int a = 0; a < wp->actionCost.size(); a++)
-//			{
-//				//if(wp->actionCost.at(a).first == LEFT_TURN_ACTION)
-//					d += wp->actionCost.at(a).second;
-//			}
-//
-//			wp->cost = pH->cost + d + LANE_CHANGE_COST;
-//			wp->pRight = pH;
-//			wp->pRight = 0;
-//
-//			nextLeafToTrace.push_back(make_pair(pH, wp));
-//			all_cells_to_delete.push_back(wp);
-//		}
-//
-//		if(pH->pRight && !CheckLaneExits(all_cells_to_delete, pH->pRight->pLane))
-//		{
-//			wp = new WayPoint();
-//			*wp = *pH->pRight;
-//			double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);;
-//
-//			for(unsigned int a = 0; a < wp->actionCost.size(); a++)
-//			{
-//				//if(wp->actionCost.at(a).first == RIGHT_TURN_ACTION)
-//					d += wp->actionCost.at(a).second;
-//			}
-//
-//			wp->cost = pH->cost + d + LANE_CHANGE_COST;
-//			wp->pLeft = pH;
-//			wp->pRight = 0;
-//			nextLeafToTrace.push_back(make_pair(pH, wp));
-//			all_cells_to_delete.push_back(wp);
-//		}
-
-		pGoalCell = pH;
+		iGoalNode = iH;
 	}
 
-	while(nextLeafToTrace.size()!=0)
-		nextLeafToTrace.pop_back();
-
-	return pGoalCell;
+	return CreateSearchPathCells(pool, iGoalNode, pStart, 0, all_cells_to_delete);
 }
 
 int PlanningHelpers::PredictiveIgnorIdsDP(WayPoint* pStart, const double& DistanceLimit,
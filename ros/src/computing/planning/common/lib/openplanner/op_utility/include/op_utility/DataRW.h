@@ -14,6 +14,7 @@
 #include <vector>
 #include <iostream>
 #include <limits>
+#include <memory>
 
 #include "vector_map_msgs/PointArray.h"
 #include "vector_map_msgs/LaneArray.h"
@@ -30,6 +31,7 @@
 #include "vector_map_msgs/CurbArray.h"
 #include "vector_map_msgs/RoadEdgeArray.h"
 #include "vector_map_msgs/CrossWalkArray.h"
+#include "vector_map/csv_reader.h"
 
 #include "UtilityH.h"
 
@@ -61,7 +63,7 @@ public:
 class SimpleReaderBase
 {
 private:
-	std::ifstream* m_pFile;
+	std::unique_ptr<vector_map::CsvReader> m_pFile;
 	std::vector<std::string> m_RawHeaders;
 	std::vector<std::string> m_DataTitlesHeader;
 	std::vector<std::vector<std::vector<std::string> > > m_AllData;
@@ -93,6 +95,12 @@ protected:
 	int ReadAllData();
 	bool ReadSingleLine(std::vector<std::vector<std::string> >& line);
 
+	/**
+	 * Split the next line in place, without copying its fields, for the readers with one object per line
+	 * @return the line, or nullptr at the end of the file
+	 */
+	const vector_map::CsvReader* ReadSingleRow();
+
 };
 
 class GPSDataReader : public SimpleReaderBase
@@ -215,22 +215,21 @@ SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,c
 		  const int& iDataTitles, const int& nVariablesForOneObject ,
 		  const int& nLineHeaders, const string& headerRepeatKey)
 {
-	if(fileName.compare("d") != 0)
-	{
-	  m_pFile = new ifstream(fileName.c_str(), ios::in);
-	  if(!m_pFile->is_open())
-	  {
-		  printf("\n Can't Open Map File !, %s", fileName.c_str());
-		  return;
-	  }
-
 	m_nHeders = nHeaders;
 	m_iDataTitles = iDataTitles;
 	m_nVarPerObj = nVariablesForOneObject;
 	m_HeaderRepeatKey = headerRepeatKey;
 	m_nLineHeaders = nLineHeaders;
 	m_Separator = separator;
-	m_pFile->precision(16);
+
+	if(fileName.compare("d") != 0)
+	{
+	  m_pFile.reset(new vector_map::CsvReader(fileName, separator));
+	  if(!m_pFile->isOpen())
+	  {
+		  printf("\n Can't Open Map File !, %s", fileName.c_str());
+		  return;
+	  }
 
 	ReadHeaders();
 	}
@@ -238,27 +237,29 @@ SimpleReaderBase::SimpleReaderBase(const string& fileName, const int& nHeaders,c
 
 SimpleReaderBase::~SimpleReaderBase()
 {
-	if(m_pFile->is_open())
-		m_pFile->close();
 }
 
-bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+const vector_map::CsvReader* SimpleReaderBase::ReadSingleRow()
 {
-	if(!m_pFile->is_open() || m_pFile->eof()) return false;
+	if(m_pFile == nullptr || !m_pFile->readLine()) return nullptr;
 
-	string strLine, innerToken;
+	return m_pFile.get();
+}
+
+bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
+{
 	line.clear();
-	getline(*m_pFile, strLine);
-	istringstream str_stream(strLine);
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow == nullptr) return false;
 
 	vector<string> header;
 	vector<string> obj_part;
 
 	if(m_nVarPerObj == 0)
 	{
-		while(getline(str_stream, innerToken, m_Separator))
+		for(unsigned int i=0; i < pRow->size(); i++)
 		{
-			obj_part.push_back(innerToken);
+			obj_part.push_back(pRow->getString(i));
 		}
 
 		line.push_back(obj_part);
@@ -266,19 +267,20 @@ bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
 	}
 	else
 	{
+		unsigned int iColumn = 0;
 		int iCounter = 0;
-		while(iCounter < m_nLineHeaders && getline(str_stream, innerToken, m_Separator))
+		while(iCounter < m_nLineHeaders && iColumn < pRow->size())
 		{
-			header.push_back(innerToken);
+			header.push_back(pRow->getString(iColumn++));
 			iCounter++;
 		}
 		obj_part.insert(obj_part.begin(), header.begin(), header.end());
 
 		iCounter = 1;
 
-		while(getline(str_stream, innerToken, m_Separator))
+		while(iColumn < pRow->size())
 		{
-			obj_part.push_back(innerToken);
+			obj_part.push_back(pRow->getString(iColumn++));
 			if(iCounter == m_nVarPerObj)
 			{
 				line.push_back(obj_part);
@@ -297,13 +299,12 @@ bool SimpleReaderBase::ReadSingleLine(vector<vector<string> >& line)
 
 int SimpleReaderBase::ReadAllData()
 {
-	if(!m_pFile->is_open()) return 0;
+	if(m_pFile == nullptr || !m_pFile->isOpen()) return 0;
 
 	m_AllData.clear();
 	vector<vector<string> > singleLine;
-	while(!m_pFile->eof())
+	while(ReadSingleLine(singleLine))
 	{
-		ReadSingleLine(singleLine);
 		m_AllData.push_back(singleLine);
 	}
 
@@ -312,14 +313,14 @@ int SimpleReaderBase::ReadAllData()
 
 void SimpleReaderBase::ReadHeaders()
 {
-	if(!m_pFile->is_open()) return;
+	if(m_pFile == nullptr || !m_pFile->isOpen()) return;
 
 	string strLine;
 	int iCounter = 0;
 	m_RawHeaders.clear();
-	while(!m_pFile->eof() && iCounter < m_nHeders)
+	while(iCounter < m_nHeders && m_pFile->readLine())
 	{
-		getline(*m_pFile, strLine);
+		strLine = m_pFile->getLine();
 		m_RawHeaders.push_back(strLine);
 		if(iCounter == m_iDataTitles)
 			ParseDataTitles(strLine);
@@ -518,14 +519,13 @@ AisanNodesFileReader::AisanNode* AisanNodesFileReader::GetDataRowById(int _nid)
 
 bool AisanNodesFileReader::ReadNextLine(AisanNode& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 2) return false;
+		if(pRow->size() < 2) return false;
 
-		data.NID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.PID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
+		data.NID = pRow->getInt(0);
+		data.PID = pRow->getInt(1);
 
 		return true;
 
@@ -630,23 +630,22 @@ AisanPointsFileReader::AisanPoints* AisanPointsFileReader::GetDataRowById(int _p
 
 bool AisanPointsFileReader::ReadNextLine(AisanPoints& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 10) return false;
+		if(pRow->size() < 10) return false;
 
-		data.PID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.B = strtod(lineData.at(0)[1].c_str(), NULL);
-		data.L = strtod(lineData.at(0)[2].c_str(), NULL);
-		data.H = strtod(lineData.at(0)[3].c_str(), NULL);
+		data.PID = pRow->getInt(0);
+		data.B = pRow->getDouble(1);
+		data.L = pRow->getDouble(2);
+		data.H = pRow->getDouble(3);
 
-		data.Bx = strtod(lineData.at(0)[4].c_str(), NULL);
-		data.Ly = strtod(lineData.at(0)[5].c_str(), NULL);
-		data.Ref = strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-		data.MCODE1 = strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-		data.MCODE2 = strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-		data.MCODE3 = strtol(lineData.at(0).at(9).c_str(), NULL, 10);
+		data.Bx = pRow->getDouble(4);
+		data.Ly = pRow->getDouble(5);
+		data.Ref = pRow->getInt(6);
+		data.MCODE1 = pRow->getInt(7);
+		data.MCODE2 = pRow->getInt(8);
+		data.MCODE3 = pRow->getInt(9);
 
 		return true;
 
@@ -746,17 +745,16 @@ AisanLinesFileReader::AisanLine* AisanLinesFileReader::GetDataRowById(int _lid)
 
 bool AisanLinesFileReader::ReadNextLine(AisanLine& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 5) return false;
+		if(pRow->size() < 5) return false;
 
-		data.LID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.BPID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.FPID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.BLID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.FLID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+		data.LID = pRow->getInt(0);
+		data.BPID = pRow->getInt(1);
+		data.FPID = pRow->getInt(2);
+		data.BLID = pRow->getInt(3);
+		data.FLID = pRow->getInt(4);
 
 		return true;
 	}
@@ -861,23 +859,22 @@ AisanCenterLinesFileReader::AisanCenterLine* AisanCenterLinesFileReader::GetData
 
 bool AisanCenterLinesFileReader::ReadNextLine(AisanCenterLine& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 10) return false;
+		if(pRow->size() < 10) return false;
 
-		data.DID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.Dist 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.PID 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+		data.DID 	= pRow->getInt(0);
+		data.Dist 	= pRow->getInt(1);
+		data.PID 	= pRow->getInt(2);
 
-		data.Dir 	= strtod(lineData.at(0)[3].c_str(), NULL);
-		data.Apara 	= strtod(lineData.at(0)[4].c_str(), NULL);
-		data.r 		= strtod(lineData.at(0)[5].c_str(), NULL);
-		data.slope 	= strtod(lineData.at(0)[6].c_str(), NULL);
-		data.cant 	= strtod(lineData.at(0)[7].c_str(), NULL);
-		data.LW 	= strtod(lineData.at(0)[8].c_str(), NULL);
-		data.RW 	= strtod(lineData.at(0)[9].c_str(), NULL);
+		data.Dir 	= pRow->getDouble(3);
+		data.Apara 	= pRow->getDouble(4);
+		data.r 		= pRow->getDouble(5);
+		data.slope 	= pRow->getDouble(6);
+		data.cant 	= pRow->getDouble(7);
+		data.LW 	= pRow->getDouble(8);
+		data.RW 	= pRow->getDouble(9);
 
 		return true;
 	}
@@ -988,44 +985,43 @@ AisanLanesFileReader::AisanLane* AisanLanesFileReader::GetDataRowById(int _lnid)
 
 bool AisanLanesFileReader::ReadNextLine(AisanLane& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
-	{
-		if(lineData.size() == 0) return false;
-		if(lineData.at(0).size() < 17) return false;
-
-		data.LnID		= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.DID		= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.BLID		= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.FLID		= strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.BNID	 	= strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-		data.FNID		= strtol(lineData.at(0).at(5).c_str(), NULL, 10);
-		data.JCT		= strtol(lineData.at(0).at(6).c_str(), NULL, 10);
-		data.BLID2	 	= strtol(lineData.at(0).at(7).c_str(), NULL, 10);
-		data.BLID3		= strtol(lineData.at(0).at(8).c_str(), NULL, 10);
-		data.BLID4		= strtol(lineData.at(0).at(9).c_str(), NULL, 10);
-		data.FLID2	 	= strtol(lineData.at(0).at(10).c_str(), NULL, 10);
-		data.FLID3		= strtol(lineData.at(0).at(11).c_str(), NULL, 10);
-		data.FLID4		= strtol(lineData.at(0).at(12).c_str(), NULL, 10);
-		data.ClossID 	= strtol(lineData.at(0).at(13).c_str(), NULL, 10);
-		data.Span 		= strtod(lineData.at(0).at(14).c_str(), NULL);
-		data.LCnt	 	= strtol(lineData.at(0).at(15).c_str(), NULL, 10);
-		data.Lno	  	= strtol(lineData.at(0).at(16).c_str(), NULL, 10);
-
-
-		if(lineData.at(0).size() < 23) return true;
-
-		data.LaneType	= strtol(lineData.at(0).at(17).c_str(), NULL, 10);
-		data.LimitVel	= strtol(lineData.at(0).at(18).c_str(), NULL, 10);
-		data.RefVel	 	= strtol(lineData.at(0).at(19).c_str(), NULL, 10);
-		data.RoadSecID	= strtol(lineData.at(0).at(20).c_str(), NULL, 10);
-		data.LaneChgFG 	= strtol(lineData.at(0).at(21).c_str(), NULL, 10);
-		data.LinkWAID	= strtol(lineData.at(0).at(22).c_str(), NULL, 10);
-
-
-		if(lineData.at(0).size() > 23)
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
+	{
+		if(pRow->size() < 17) return false;
+
+		data.LnID		= pRow->getInt(0);
+		data.DID		= pRow->getInt(1);
+		data.BLID		= pRow->getInt(2);
+		data.FLID		= pRow->getInt(3);
+		data.BNID	 	= pRow->getInt(4);
+		data.FNID		= pRow->getInt(5);
+		data.JCT		= pRow->getInt(6);
+		data.BLID2	 	= pRow->getInt(7);
+		data.BLID3		= pRow->getInt(8);
+		data.BLID4		= pRow->getInt(9);
+		data.FLID2	 	= pRow->getInt(10);
+		data.FLID3		= pRow->getInt(11);
+		data.FLID4		= pRow->getInt(12);
+		data.ClossID 	= pRow->getInt(13);
+		data.Span 		= pRow->getDouble(14);
+		data.LCnt	 	= pRow->getInt(15);
+		data.Lno	  	= pRow->getInt(16);
+
+
+		if(pRow->size() < 23) return true;
+
+		data.LaneType	= pRow->getInt(17);
+		data.LimitVel	= pRow->getInt(18);
+		data.RefVel	 	= pRow->getInt(19);
+		data.RoadSecID	= pRow->getInt(20);
+		data.LaneChgFG 	= pRow->getInt(21);
+		data.LinkWAID	= pRow->getInt(22);
+
+
+		if(pRow->size() > 23)
 		{
-			string str_dir = lineData.at(0).at(23);
+			string str_dir = pRow->getString(23);
 			if(str_dir.size() > 0)
 				data.LaneDir 	= str_dir.at(0);
 			else
@@ -1135,15 +1131,14 @@ AisanAreasFileReader::AisanArea* AisanAreasFileReader::GetDataRowById(int _aid)
 
 bool AisanAreasFileReader::ReadNextLine(AisanArea& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 3) return false;
+		if(pRow->size() < 3) return false;
 
-		data.AID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.SLID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.ELID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+		data.AID = pRow->getInt(0);
+		data.SLID = pRow->getInt(1);
+		data.ELID = pRow->getInt(2);
 
 		return true;
 
@@ -1229,15 +1224,14 @@ AisanIntersectionFileReader::AisanIntersection* AisanIntersectionFileReader::Get
 
 bool AisanIntersectionFileReader::ReadNextLine(AisanIntersection& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 3) return false;
+		if(pRow->size() < 3) return false;
 
-		data.ID = strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.AID = strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+		data.ID = pRow->getInt(0);
+		data.AID = pRow->getInt(1);
+		data.LinkID = pRow->getInt(2);
 
 		return true;
 
@@ -1325,17 +1319,16 @@ AisanStopLineFileReader::AisanStopLine* AisanStopLineFileReader::GetDataRowById(
 
 bool AisanStopLineFileReader::ReadNextLine(AisanStopLine& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 5) return false;
+		if(pRow->size() < 5) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.LID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.TLID 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.SignID = strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.LID 	= pRow->getInt(1);
+		data.TLID 	= pRow->getInt(2);
+		data.SignID = pRow->getInt(3);
+		data.LinkID = pRow->getInt(4);
 
 		return true;
 
@@ -1423,17 +1416,16 @@ AisanRoadSignFileReader::AisanRoadSign* AisanRoadSignFileReader::GetDataRowById(
 
 bool AisanRoadSignFileReader::ReadNextLine(AisanRoadSign& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 5) return false;
+		if(pRow->size() < 5) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.VID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.PLID 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.Type 	= strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.VID 	= pRow->getInt(1);
+		data.PLID 	= pRow->getInt(2);
+		data.Type 	= pRow->getInt(3);
+		data.LinkID = pRow->getInt(4);
 
 		return true;
 
@@ -1521,17 +1513,16 @@ AisanSignalFileReader::AisanSignal* AisanSignalFileReader::GetDataRowById(int _i
 
 bool AisanSignalFileReader::ReadNextLine(AisanSignal& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 5) return false;
+		if(pRow->size() < 5) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.VID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.PLID 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.Type 	= strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.VID 	= pRow->getInt(1);
+		data.PLID 	= pRow->getInt(2);
+		data.Type 	= pRow->getInt(3);
+		data.LinkID = pRow->getInt(4);
 
 		return true;
 
@@ -1619,16 +1610,15 @@ AisanVectorFileReader::AisanVector* AisanVectorFileReader::GetDataRowById(int _i
 
 bool AisanVectorFileReader::ReadNextLine(AisanVector& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 4) return false;
+		if(pRow->size() < 4) return false;
 
-		data.VID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.PID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.Hang 	= strtod(lineData.at(0).at(2).c_str(), NULL);
-		data.Vang 	= strtod(lineData.at(0).at(3).c_str(), NULL);
+		data.VID 	= pRow->getInt(0);
+		data.PID 	= pRow->getInt(1);
+		data.Hang 	= pRow->getDouble(2);
+		data.Vang 	= pRow->getDouble(3);
 
 		return true;
 
@@ -1717,18 +1707,17 @@ AisanCurbFileReader::AisanCurb* AisanCurbFileReader::GetDataRowById(int _id)
 
 bool AisanCurbFileReader::ReadNextLine(AisanCurb& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 6) return false;
+		if(pRow->size() < 6) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.LID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.Height = strtod(lineData.at(0).at(2).c_str(), NULL);
-		data.Width 	= strtod(lineData.at(0).at(3).c_str(), NULL);
-		data.dir 	= strtol(lineData.at(0).at(4).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(5).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.LID 	= pRow->getInt(1);
+		data.Height = pRow->getDouble(2);
+		data.Width 	= pRow->getDouble(3);
+		data.dir 	= pRow->getInt(4);
+		data.LinkID = pRow->getInt(5);
 
 		return true;
 
@@ -1814,15 +1803,14 @@ AisanRoadEdgeFileReader::AisanRoadEdge* AisanRoadEdgeFileReader::GetDataRowById(
 
 bool AisanRoadEdgeFileReader::ReadNextLine(AisanRoadEdge& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 3) return false;
+		if(pRow->size() < 3) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.LID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.LID 	= pRow->getInt(1);
+		data.LinkID = pRow->getInt(2);
 
 		return true;
 
@@ -1910,17 +1898,16 @@ AisanCrossWalkFileReader::AisanCrossWalk* AisanCrossWalkFileReader::GetDataRowBy
 
 bool AisanCrossWalkFileReader::ReadNextLine(AisanCrossWalk& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 5) return false;
+		if(pRow->size() < 5) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.AID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.Type 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.BdID 	= strtol(lineData.at(0).at(3).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(4).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.AID 	= pRow->getInt(1);
+		data.Type 	= pRow->getInt(2);
+		data.BdID 	= pRow->getInt(3);
+		data.LinkID = pRow->getInt(4);
 
 		return true;
 
@@ -2006,15 +1993,14 @@ AisanWayareaFileReader::AisanWayarea* AisanWayareaFileReader::GetDataRowById(int
 
 bool AisanWayareaFileReader::ReadNextLine(AisanWayarea& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 3) return false;
+		if(pRow->size() < 3) return false;
 
-		data.ID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.AID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.LinkID = strtol(lineData.at(0).at(2).c_str(), NULL, 10);
+		data.ID 	= pRow->getInt(0);
+		data.AID 	= pRow->getInt(1);
+		data.LinkID = pRow->getInt(2);
 
 		return true;
 
@@ -2040,16 +2026,15 @@ int AisanWayareaFileReader::ReadAllData(vector<AisanWayarea>& data_list)
 //Data Conn
 bool AisanDataConnFileReader::ReadNextLine(DataConn& data)
 {
-	vector<vector<string> > lineData;
-	if(ReadSingleLine(lineData))
+	const vector_map::CsvReader* pRow = ReadSingleRow();
+	if(pRow != nullptr)
 	{
-		if(lineData.size()==0) return false;
-		if(lineData.at(0).size() < 4) return false;
+		if(pRow->size() < 4) return false;
 
-		data.LID 	= strtol(lineData.at(0).at(0).c_str(), NULL, 10);
-		data.SLID 	= strtol(lineData.at(0).at(1).c_str(), NULL, 10);
-		data.SID 	= strtol(lineData.at(0).at(2).c_str(), NULL, 10);
-		data.SSID 	= strtol(lineData.at(0).at(3).c_str(), NULL, 10);
+		data.LID 	= pRow->getInt(0);
+		data.SLID 	= pRow->getInt(1);
+		data.SID 	= pRow->getInt(2);
+		data.SSID 	= pRow->getInt(3);
 
 		return true;
 
@@ -17,7 +17,10 @@
 #ifndef LANE_PLANNER_VMAP_HPP
 #define LANE_PLANNER_VMAP_HPP
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <geometry_msgs/Point.h>
@@ -43,14 +46,46 @@ constexpr int TRAFFIC_LIGHT_UNKNOWN = 2;
 
 constexpr double RADIUS_MAX = 90000000000;
 
+// Lookup tables of a VectorMap, all lists of indexes are in increasing order
+struct VectorMapIndex {
+	std::unordered_map<int, std::vector<size_t>> points_by_pid;
+	std::unordered_map<int, std::vector<size_t>> nodes_by_nid;
+	std::unordered_map<int, std::vector<size_t>> nodes_by_pid;
+	std::unordered_map<int, std::vector<size_t>> lanes_by_lnid;
+	std::unordered_map<int, std::vector<size_t>> lanes_by_bnid;
+	std::unordered_map<int, std::vector<size_t>> stoplines_by_linkid;
+	std::unordered_map<int, std::vector<size_t>> dtlanes_by_did;
+
+	// uniform XY grid over the points with a finite position
+	double cell_size;
+	int64_t min_cell_x, max_cell_x, min_cell_y, max_cell_y;
+	std::unordered_map<uint64_t, std::vector<size_t>> point_cells;
+
+	// sizes of the vectors the index was built from, records changed in place are not noticed
+	size_t point_num, lane_num, node_num, stopline_num, dtlane_num;
+};
+
 struct VectorMap {
 	std::vector<vector_map::Point> points;
 	std::vector<vector_map::Lane> lanes;
 	std::vector<vector_map::Node> nodes;
 	std::vector<vector_map::StopLine> stoplines;
 	std::vector<vector_map::DTLane> dtlanes;
+
+	// set by build_vmap_index() and create_lane_vmap(), maps without it are indexed on the fly
+	std::shared_ptr<const VectorMapIndex> index;
 };
 
+// Has to be called again after ids or positions of vmap are changed in place, a stale index is only detected
+// when records are added or removed
+void build_vmap_index(VectorMap& vmap);
+
+// vmap if its index is up to date, otherwise an indexed copy of it stored in tmp
+const VectorMap& indexed_vmap(const VectorMap& vmap, VectorMap& tmp);
+
+// indexes stored for id in a table of VectorMapIndex, empty if there are none
+const std::vector<size_t>& find_indexes(const std::unordered_map<int, std::vector<size_t>>& table, int id);
+
 void write_waypoints(const std::vector<vector_map::Point>& points, double velocity, const std::string& path);
 
 double compute_reduction(const vector_map::DTLane& d, double w);
@@ -14,7 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 #include <fstream>
+#include <iterator>
 #include <tuple>
 
 #include <ros/console.h>
@@ -30,6 +34,15 @@ namespace vmap {
 
 namespace {
 
+// cell indexes are clamped so that far away points and queries stay in range
+constexpr int64_t MAX_CELL_INDEX = (int64_t) 1 << 30;
+
+const std::vector<size_t> NO_INDEXES;
+
+int64_t cell_index(const VectorMapIndex& index, double value);
+uint64_t cell_key(int64_t cell_x, int64_t cell_y);
+bool is_indexed(const VectorMap& vmap);
+
 void write_waypoint(const vector_map::Point& point, double yaw, double velocity, const std::string& path,
 		    bool first);
 
@@ -40,6 +53,7 @@ bool is_merging_point(const VectorMap& vmap, const vector_map::Point& point);
 bool is_branching_lane(const vector_map::Lane& lane);
 bool is_merging_lane(const vector_map::Lane& lane);
 
+vector_map::Point find_node_point(const VectorMap& vmap, int nid);
 vector_map::Point find_start_point(const VectorMap& vmap, const vector_map::Lane& lane);
 vector_map::Point find_end_point(const VectorMap& vmap, const vector_map::Lane& lane);
 vector_map::Point find_departure_point(const VectorMap& lane_vmap, int lno,
@@ -53,11 +67,36 @@ std::vector<vector_map::Point> find_near_points(const VectorMap& vmap, const vec
 						double search_radius);
 
 vector_map::Lane find_lane(const VectorMap& vmap, int lno, const vector_map::Point& point);
+vector_map::Lane find_first_lane(const VectorMap& vmap, int lno, const std::vector<int>& lnids);
 vector_map::Lane find_prev_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane);
 vector_map::Lane find_next_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane);
 vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane,
 					  double coarse_angle, double search_radius);
 
+int64_t cell_index(const VectorMapIndex& index, double value)
+{
+	double cell = std::floor(value / index.cell_size);
+	if (cell > MAX_CELL_INDEX)
+		return MAX_CELL_INDEX;
+	if (cell < -MAX_CELL_INDEX)
+		return -MAX_CELL_INDEX;
+	return (int64_t) cell;
+}
+
+uint64_t cell_key(int64_t cell_x, int64_t cell_y)
+{
+	const int64_t offset = (int64_t) 1 << 31;
+	return ((uint64_t) (cell_x + offset) << 32) | (uint64_t) (uint32_t) (cell_y + offset);
+}
+
+bool is_indexed(const VectorMap& vmap)
+{
+	const VectorMapIndex* index = vmap.index.get();
+	return (index != nullptr && index->point_num == vmap.points.size() && index->lane_num == vmap.lanes.size() &&
+		index->node_num == vmap.nodes.size() && index->stopline_num == vmap.stoplines.size() &&
+		index->dtlane_num == vmap.dtlanes.size());
+}
+
 void write_waypoint(const vector_map::Point& point, double yaw, double velocity, const std::string& path,
 		    bool first)
 {
@@ -115,40 +154,28 @@ bool is_merging_lane(const vector_map::Lane& lane)
 	return (lane.jct == 3 || lane.jct == 4 || lane.jct == 5);
 }
 
-vector_map::Point find_start_point(const VectorMap& vmap, const vector_map::Lane& lane)
+vector_map::Point find_node_point(const VectorMap& vmap, int nid)
 {
 	vector_map::Point error;
 	error.pid = -1;
 
-	for (const vector_map::Node& n : vmap.nodes) {
-		if (n.nid != lane.bnid)
-			continue;
-		for (const vector_map::Point& p : vmap.points) {
-			if (p.pid != n.pid)
-				continue;
-			return p;
-		}
+	for (size_t n : find_indexes(vmap.index->nodes_by_nid, nid)) {
+		const std::vector<size_t>& points = find_indexes(vmap.index->points_by_pid, vmap.nodes[n].pid);
+		if (!points.empty())
+			return vmap.points[points.front()];
 	}
 
 	return error;
 }
 
-vector_map::Point find_end_point(const VectorMap& vmap, const vector_map::Lane& lane)
+vector_map::Point find_start_point(const VectorMap& vmap, const vector_map::Lane& lane)
 {
-	vector_map::Point error;
-	error.pid = -1;
-
-	for (const vector_map::Node& n : vmap.nodes) {
-		if (n.nid != lane.fnid)
-			continue;
-		for (const vector_map::Point& p : vmap.points) {
-			if (p.pid != n.pid)
-				continue;
-			return p;
-		}
-	}
+	return find_node_point(vmap, lane.bnid);
+}
 
-	return error;
+vector_map::Point find_end_point(const VectorMap& vmap, const vector_map::Lane& lane)
+{
+	return find_node_point(vmap, lane.fnid);
 }
 
 vector_map::Point find_departure_point(const VectorMap& lane_vmap, int lno,
@@ -233,26 +260,105 @@ vector_map::Point find_arrival_point(const VectorMap& lane_vmap, int lno,
 
 vector_map::Point find_nearest_point(const VectorMap& vmap, const vector_map::Point& point)
 {
+	const VectorMapIndex& index = *vmap.index;
+
 	vector_map::Point nearest_point;
 	nearest_point.pid = -1;
 
+	if (!std::isfinite(point.bx) || !std::isfinite(point.ly) || index.point_cells.empty())
+		return nearest_point;
+
+	// the last of the nearest points in vmap.points, as a scan in order would find
 	double distance = DBL_MAX;
-	for (const vector_map::Point& p : vmap.points) {
-		double d = hypot(p.bx - point.bx, p.ly - point.ly);
-		if (d <= distance) {
-			nearest_point = p;
-			distance = d;
+	size_t nearest = SIZE_MAX;
+	auto visit_cell = [&](int64_t cell_x, int64_t cell_y) {
+		auto cell = index.point_cells.find(cell_key(cell_x, cell_y));
+		if (cell == index.point_cells.end())
+			return;
+		for (size_t i : cell->second) {
+			const vector_map::Point& p = vmap.points[i];
+			double d = hypot(p.bx - point.bx, p.ly - point.ly);
+			if (d < distance || (d == distance && (nearest == SIZE_MAX || i > nearest))) {
+				nearest = i;
+				distance = d;
+			}
+		}
+	};
+
+	// visit the rings of cells around the point that overlap the grid
+	const int64_t cell_x = cell_index(index, point.bx);
+	const int64_t cell_y = cell_index(index, point.ly);
+	const int64_t first_ring = std::max({ index.min_cell_x - cell_x, cell_x - index.max_cell_x,
+					       index.min_cell_y - cell_y, cell_y - index.max_cell_y, (int64_t) 0 });
+	const int64_t last_ring = std::max({ cell_x - index.min_cell_x, index.max_cell_x - cell_x,
+					      cell_y - index.min_cell_y, index.max_cell_y - cell_y });
+	for (int64_t ring = first_ring; ring <= last_ring; ++ring) {
+		// points in this ring and beyond are more than ring - 1 cells away, one more for rounding
+		if (nearest != SIZE_MAX && distance < (ring - 2) * index.cell_size)
+			break;
+
+		const int64_t min_x = std::max(cell_x - ring, index.min_cell_x);
+		const int64_t max_x = std::min(cell_x + ring, index.max_cell_x);
+		const int64_t min_y = std::max(cell_y - ring, index.min_cell_y);
+		const int64_t max_y = std::min(cell_y + ring, index.max_cell_y);
+		for (int64_t x = min_x; x <= max_x; ++x) {
+			if (cell_y - ring >= index.min_cell_y)
+				visit_cell(x, cell_y - ring);
+			if (ring > 0 && cell_y + ring <= index.max_cell_y)
+				visit_cell(x, cell_y + ring);
+		}
+		for (int64_t y = std::max(min_y, cell_y - ring + 1); y <= std::min(max_y, cell_y + ring - 1); ++y) {
+			if (cell_x - ring >= index.min_cell_x)
+				visit_cell(cell_x - ring, y);
+			if (ring > 0 && cell_x + ring <= index.max_cell_x)
+				visit_cell(cell_x + ring, y);
 		}
 	}
 
+	if (nearest != SIZE_MAX)
+		nearest_point = vmap.points[nearest];
+
 	return nearest_point;
 }
 
 std::vector<vector_map::Point> find_near_points(const VectorMap& vmap, const vector_map::Point& point,
 						double search_radius)
 {
+	const VectorMapIndex& index = *vmap.index;
+
 	std::vector<vector_map::Point> near_points;
-	for (const vector_map::Point& p : vmap.points) {
+	if (!std::isfinite(point.bx) || !std::isfinite(point.ly) || !(search_radius >= 0))
+		return near_points;
+
+	std::vector<size_t> candidates;
+	if (!std::isfinite(search_radius)) {
+		for (size_t i = 0; i < vmap.points.size(); ++i)
+			candidates.push_back(i);
+	} else {
+		// one more cell on each side for rounding
+		const int64_t min_x = cell_index(index, point.bx - search_radius) - 1;
+		const int64_t max_x = cell_index(index, point.bx + search_radius) + 1;
+		const int64_t min_y = cell_index(index, point.ly - search_radius) - 1;
+		const int64_t max_y = cell_index(index, point.ly + search_radius) + 1;
+
+		if ((double) (max_x - min_x + 1) * (double) (max_y - min_y + 1) > (double) index.point_cells.size()) {
+			for (const auto& cell : index.point_cells)
+				candidates.insert(candidates.end(), cell.second.begin(), cell.second.end());
+		} else {
+			for (int64_t x = min_x; x <= max_x; ++x) {
+				for (int64_t y = min_y; y <= max_y; ++y) {
+					auto cell = index.point_cells.find(cell_key(x, y));
+					if (cell != index.point_cells.end())
+						candidates.insert(candidates.end(), cell->second.begin(),
+								  cell->second.end());
+				}
+			}
+		}
+		std::sort(candidates.begin(), candidates.end());
+	}
+
+	for (size_t i : candidates) {
+		const vector_map::Point& p = vmap.points[i];
 		double d = hypot(p.bx - point.bx, p.ly - point.ly);
 		if (d <= search_radius)
 			near_points.push_back(p);
@@ -266,69 +372,52 @@ vector_map::Lane find_lane(const VectorMap& vmap, int lno, const vector_map::Poi
 	vector_map::Lane error;
 	error.lnid = -1;
 
-	for (const vector_map::Node& n : vmap.nodes) {
-		if (n.pid != point.pid)
-			continue;
-		for (const vector_map::Lane& l : vmap.lanes) {
-			if (lno != LNO_ALL && l.lno != lno)
-				continue;
-			if (l.bnid != n.nid)
+	for (size_t n : find_indexes(vmap.index->nodes_by_pid, point.pid)) {
+		for (size_t l : find_indexes(vmap.index->lanes_by_bnid, vmap.nodes[n].nid)) {
+			if (lno != LNO_ALL && vmap.lanes[l].lno != lno)
 				continue;
-			return l;
+			return vmap.lanes[l];
 		}
 	}
 
 	return error;
 }
 
-vector_map::Lane find_prev_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
+// First lane, in vmap.lanes order, of the given ids and lane number
+vector_map::Lane find_first_lane(const VectorMap& vmap, int lno, const std::vector<int>& lnids)
 {
 	vector_map::Lane error;
 	error.lnid = -1;
 
-	if (is_merging_lane(lane)) {
-		for (const vector_map::Lane& l : vmap.lanes) {
-			if (lno != LNO_ALL && l.lno != lno)
-				continue;
-			if (l.lnid != lane.blid && l.lnid != lane.blid2 && l.lnid != lane.blid3 &&
-			    l.lnid != lane.blid4)
-				continue;
-			return l;
-		}
-	} else {
-		for (const vector_map::Lane& l : vmap.lanes) {
-			if (l.lnid != lane.blid)
+	size_t first = SIZE_MAX;
+	for (int lnid : lnids) {
+		for (size_t l : find_indexes(vmap.index->lanes_by_lnid, lnid)) {
+			if (l >= first)
+				break;
+			if (lno != LNO_ALL && vmap.lanes[l].lno != lno)
 				continue;
-			return l;
+			first = l;
+			break;
 		}
 	}
 
-	return error;
+	return (first != SIZE_MAX) ? vmap.lanes[first] : error;
 }
 
-vector_map::Lane find_next_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
+vector_map::Lane find_prev_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
 {
-	vector_map::Lane error;
-	error.lnid = -1;
-
-	if (is_branching_lane(lane)) {
-		for (const vector_map::Lane& l : vmap.lanes) {
-			if (lno != LNO_ALL && l.lno != lno)
-				continue;
-			if (l.lnid != lane.flid && l.lnid != lane.flid2 && l.lnid != lane.flid3 &&
-			    l.lnid != lane.flid4)
-				continue;
-			return l;
-		}
-	} else {
-		for (const vector_map::Lane& l : vmap.lanes) {
-			if (l.lnid != lane.flid)
-				continue;
-			return l;
-		}
-	}
+	if (is_merging_lane(lane))
+		return find_first_lane(vmap, lno, { lane.blid, lane.blid2, lane.blid3, lane.blid4 });
+	else
+		return find_first_lane(vmap, LNO_ALL, { lane.blid });
+}
 
-	return error;
+vector_map::Lane find_next_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
+{
+	if (is_branching_lane(lane))
+		return find_first_lane(vmap, lno, { lane.flid, lane.flid2, lane.flid3, lane.flid4 });
+	else
+		return find_first_lane(vmap, LNO_ALL, { lane.flid });
 }
 
 vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane,
@@ -341,29 +430,37 @@ vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const
 	if (p1.pid < 0)
 		return error;
 
+	// next lanes in vmap.lanes order
+	std::vector<size_t> next_lanes;
+	for (int lnid : { lane.flid, lane.flid2, lane.flid3, lane.flid4 }) {
+		const std::vector<size_t>& lanes = find_indexes(vmap.index->lanes_by_lnid, lnid);
+		next_lanes.insert(next_lanes.end(), lanes.begin(), lanes.end());
+	}
+	std::sort(next_lanes.begin(), next_lanes.end());
+	next_lanes.erase(std::unique(next_lanes.begin(), next_lanes.end()), next_lanes.end());
+
 	std::vector<std::tuple<vector_map::Point, vector_map::Lane>> candidates;
-	for (const vector_map::Lane& l1 : vmap.lanes) {
+	for (size_t i : next_lanes) {
+		const vector_map::Lane& l1 = vmap.lanes[i];
 		if (lno != LNO_ALL && l1.lno != lno)
 			continue;
-		if (l1.lnid == lane.flid || l1.lnid == lane.flid2 || l1.lnid == lane.flid3 || l1.lnid == lane.flid4) {
-			vector_map::Lane l2 = l1;
-			vector_map::Point p = find_end_point(vmap, l2);
+		vector_map::Lane l2 = l1;
+		vector_map::Point p = find_end_point(vmap, l2);
+		if (p.pid < 0)
+			continue;
+		vector_map::Point p2 = p;
+		double d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
+		while (d <= search_radius && l2.flid != 0 && !is_branching_lane(l2)) {
+			l2 = find_next_lane(vmap, LNO_ALL, l2);
+			if (l2.lnid < 0)
+				break;
+			p = find_end_point(vmap, l2);
 			if (p.pid < 0)
-				continue;
-			vector_map::Point p2 = p;
-			double d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
-			while (d <= search_radius && l2.flid != 0 && !is_branching_lane(l2)) {
-				l2 = find_next_lane(vmap, LNO_ALL, l2);
-				if (l2.lnid < 0)
-					break;
-				p = find_end_point(vmap, l2);
-				if (p.pid < 0)
-					break;
-				p2 = p;
-				d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
-			}
-			candidates.push_back(std::make_tuple(p2, l1));
+				break;
+			p2 = p;
+			d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
 		}
+		candidates.push_back(std::make_tuple(p2, l1));
 	}
 
 	if (candidates.empty())
@@ -388,6 +485,88 @@ vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const
 
 } // namespace
 
+const std::vector<size_t>& find_indexes(const std::unordered_map<int, std::vector<size_t>>& table, int id)
+{
+	auto it = table.find(id);
+	return (it != table.end()) ? it->second : NO_INDEXES;
+}
+
+void build_vmap_index(VectorMap& vmap)
+{
+	std::shared_ptr<VectorMapIndex> index = std::make_shared<VectorMapIndex>();
+
+	for (size_t i = 0; i < vmap.points.size(); ++i)
+		index->points_by_pid[vmap.points[i].pid].push_back(i);
+	for (size_t i = 0; i < vmap.nodes.size(); ++i) {
+		index->nodes_by_nid[vmap.nodes[i].nid].push_back(i);
+		index->nodes_by_pid[vmap.nodes[i].pid].push_back(i);
+	}
+	for (size_t i = 0; i < vmap.lanes.size(); ++i) {
+		index->lanes_by_lnid[vmap.lanes[i].lnid].push_back(i);
+		index->lanes_by_bnid[vmap.lanes[i].bnid].push_back(i);
+	}
+	for (size_t i = 0; i < vmap.stoplines.size(); ++i)
+		index->stoplines_by_linkid[vmap.stoplines[i].linkid].push_back(i);
+	for (size_t i = 0; i < vmap.dtlanes.size(); ++i)
+		index->dtlanes_by_did[vmap.dtlanes[i].did].push_back(i);
+
+	// a few points per cell on average
+	double min_x = DBL_MAX, max_x = -DBL_MAX, min_y = DBL_MAX, max_y = -DBL_MAX;
+	size_t finite_num = 0;
+	for (const vector_map::Point& p : vmap.points) {
+		if (!std::isfinite(p.bx) || !std::isfinite(p.ly))
+			continue;
+		min_x = std::min(min_x, p.bx);
+		max_x = std::max(max_x, p.bx);
+		min_y = std::min(min_y, p.ly);
+		max_y = std::max(max_y, p.ly);
+		++finite_num;
+	}
+	index->cell_size = 1;
+	if (finite_num > 0) {
+		double width = max_x - min_x;
+		double height = max_y - min_y;
+		double cell_size = std::max(2 * std::sqrt(width * height / finite_num),
+					    4 * std::max(width, height) / finite_num);
+		if (std::isfinite(cell_size) && cell_size > 0)
+			index->cell_size = cell_size;
+	}
+
+	index->min_cell_x = index->min_cell_y = MAX_CELL_INDEX;
+	index->max_cell_x = index->max_cell_y = -MAX_CELL_INDEX;
+	for (size_t i = 0; i < vmap.points.size(); ++i) {
+		const vector_map::Point& p = vmap.points[i];
+		if (!std::isfinite(p.bx) || !std::isfinite(p.ly))
+			continue;
+		int64_t cell_x = cell_index(*index, p.bx);
+		int64_t cell_y = cell_index(*index, p.ly);
+		index->min_cell_x = std::min(index->min_cell_x, cell_x);
+		index->max_cell_x = std::max(index->max_cell_x, cell_x);
+		index->min_cell_y = std::min(index->min_cell_y, cell_y);
+		index->max_cell_y = std::max(index->max_cell_y, cell_y);
+		index->point_cells[cell_key(cell_x, cell_y)].push_back(i);
+	}
+
+	index->point_num = vmap.points.size();
+	index->lane_num = vmap.lanes.size();
+	index->node_num = vmap.nodes.size();
+	index->stopline_num = vmap.stoplines.size();
+	index->dtlane_num = vmap.dtlanes.size();
+
+	vmap.index = index;
+}
+
+// The lookups use vmap.index, the public functions make sure it is there
+const VectorMap& indexed_vmap(const VectorMap& vmap, VectorMap& tmp)
+{
+	if (is_indexed(vmap))
+		return vmap;
+
+	tmp = vmap;
+	build_vmap_index(tmp);
+	return tmp;
+}
+
 void write_waypoints(const std::vector<vector_map::Point>& points, double velocity, const std::string& path)
 {
 	if (points.size() < 2)
@@ -524,37 +703,41 @@ vector_map::DTLane create_vector_map_dtlane(const autoware_msgs::DTLane& wd)
 
 VectorMap create_lane_vmap(const VectorMap& vmap, int lno)
 {
+	VectorMap tmp;
+	const VectorMapIndex& index = *indexed_vmap(vmap, tmp).index;
+
 	VectorMap lane_vmap;
+	std::vector<size_t> nodes;
 	for (const vector_map::Lane& l : vmap.lanes) {
 		if (lno != LNO_ALL && l.lno != lno)
 			continue;
 		lane_vmap.lanes.push_back(l);
 
-		for (const vector_map::Node& n : vmap.nodes) {
-			if (n.nid != l.bnid && n.nid != l.fnid)
-				continue;
-			lane_vmap.nodes.push_back(n);
+		// nodes of both ends in vmap.nodes order
+		const std::vector<size_t>& bnodes = find_indexes(index.nodes_by_nid, l.bnid);
+		const std::vector<size_t>& fnodes = find_indexes(index.nodes_by_nid, l.fnid);
+		nodes.clear();
+		if (l.bnid == l.fnid)
+			nodes = bnodes;
+		else
+			std::merge(bnodes.begin(), bnodes.end(), fnodes.begin(), fnodes.end(), std::back_inserter(nodes));
 
-			for (const vector_map::Point& p : vmap.points) {
-				if (p.pid != n.pid)
-					continue;
-				lane_vmap.points.push_back(p);
-			}
-		}
+		for (size_t n : nodes) {
+			lane_vmap.nodes.push_back(vmap.nodes[n]);
 
-		for (const vector_map::StopLine& s : vmap.stoplines) {
-			if (s.linkid != l.lnid)
-				continue;
-			lane_vmap.stoplines.push_back(s);
+			for (size_t p : find_indexes(index.points_by_pid, vmap.nodes[n].pid))
+				lane_vmap.points.push_back(vmap.points[p]);
 		}
 
-		for (const vector_map::DTLane& d : vmap.dtlanes) {
-			if (d.did != l.did)
-				continue;
-			lane_vmap.dtlanes.push_back(d);
-		}
+		for (size_t s : find_indexes(index.stoplines_by_linkid, l.lnid))
+			lane_vmap.stoplines.push_back(vmap.stoplines[s]);
+
+		for (size_t d : find_indexes(index.dtlanes_by_did, l.did))
+			lane_vmap.dtlanes.push_back(vmap.dtlanes[d]);
 	}
 
+	build_vmap_index(lane_vmap);
+
 	return lane_vmap;
 }
 
@@ -585,9 +768,13 @@ VectorMap create_coarse_vmap_from_route(const tablet_socket_msgs::route_cmd& rou
 	return coarse_vmap;
 }
 
-VectorMap create_fine_vmap(const VectorMap& lane_vmap, int lno, const VectorMap& coarse_vmap, double search_radius,
-			   int waypoint_max)
+VectorMap create_fine_vmap(const VectorMap& lane_vmap_in, int lno, const VectorMap& coarse_vmap_in,
+			   double search_radius, int waypoint_max)
 {
+	VectorMap lane_tmp, coarse_tmp;
+	const VectorMap& lane_vmap = indexed_vmap(lane_vmap_in, lane_tmp);
+	const VectorMap& coarse_vmap = indexed_vmap(coarse_vmap_in, coarse_tmp);
+
 	VectorMap fine_vmap;
 	VectorMap null_vmap;
 
@@ -631,23 +818,17 @@ VectorMap create_fine_vmap(const VectorMap& lane_vmap, int lno, const VectorMap&
 		// last is equal to previous dtlane
 		vector_map::DTLane dtlane;
 		dtlane.did = -1;
-		for (const vector_map::DTLane& d : lane_vmap.dtlanes) {
-			if (d.did == lane.did) {
-				dtlane = d;
-				break;
-			}
-		}
+		const std::vector<size_t>& dtlanes = find_indexes(lane_vmap.index->dtlanes_by_did, lane.did);
+		if (!dtlanes.empty())
+			dtlane = lane_vmap.dtlanes[dtlanes.front()];
 		fine_vmap.dtlanes.push_back(dtlane);
 
 		// last is equal to previous stopline
 		vector_map::StopLine stopline;
 		stopline.id = -1;
-		for (const vector_map::StopLine& s : lane_vmap.stoplines) {
-			if (s.linkid == lane.lnid) {
-				stopline = s;
-				break;
-			}
-		}
+		const std::vector<size_t>& stoplines = find_indexes(lane_vmap.index->stoplines_by_linkid, lane.lnid);
+		if (!stoplines.empty())
+			stopline = lane_vmap.stoplines[stoplines.front()];
 		fine_vmap.stoplines.push_back(stopline);
 
 		if (finish)
@@ -716,8 +897,11 @@ VectorMap create_fine_vmap(const VectorMap& lane_vmap, int lno, const VectorMap&
 	return fine_vmap;
 }
 
-std::vector<vector_map::Point> create_branching_points(const VectorMap& vmap)
+std::vector<vector_map::Point> create_branching_points(const VectorMap& vmap_in)
 {
+	VectorMap tmp;
+	const VectorMap& vmap = indexed_vmap(vmap_in, tmp);
+
 	std::vector<vector_map::Point> branching_points;
 	for (const vector_map::Point& p : vmap.points) {
 		if (!is_branching_point(vmap, p))
@@ -728,8 +912,11 @@ std::vector<vector_map::Point> create_branching_points(const VectorMap& vmap)
 	return branching_points;
 }
 
-std::vector<vector_map::Point> create_merging_points(const VectorMap& vmap)
+std::vector<vector_map::Point> create_merging_points(const VectorMap& vmap_in)
 {
+	VectorMap tmp;
+	const VectorMap& vmap = indexed_vmap(vmap_in, tmp);
+
 	std::vector<vector_map::Point> merging_points;
 	for (const vector_map::Point& p : vmap.points) {
 		if (!is_merging_point(vmap, p))
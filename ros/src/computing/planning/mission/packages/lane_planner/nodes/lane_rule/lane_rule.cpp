@@ -20,6 +20,8 @@
 #include <sstream>
 #endif  // DEBUG
 
+#include <unordered_set>
+
 #include <ros/console.h>
 
 #include <vector_map/vector_map.h>
@@ -192,34 +194,24 @@ autoware_msgs::Lane apply_stopline_acceleration(const autoware_msgs::Lane& lane,
   return l;
 }
 
-std::vector<vector_map::Point> create_stop_points(const lane_planner::vmap::VectorMap& vmap)
+std::vector<vector_map::Point> create_stop_points(const lane_planner::vmap::VectorMap& vmap_in)
 {
+  lane_planner::vmap::VectorMap tmp;
+  const lane_planner::vmap::VectorMap& vmap = lane_planner::vmap::indexed_vmap(vmap_in, tmp);
+  const lane_planner::vmap::VectorMapIndex& index = *vmap.index;
+
   std::vector<vector_map::Point> stop_points;
+  std::unordered_set<int> stop_pids;
   for (const vector_map::StopLine& s : vmap.stoplines)
   {
-    for (const vector_map::Lane& l : vmap.lanes)
+    for (size_t l : lane_planner::vmap::find_indexes(index.lanes_by_lnid, s.linkid))
     {
-      if (l.lnid != s.linkid)
-        continue;
-      for (const vector_map::Node& n : vmap.nodes)
+      for (size_t n : lane_planner::vmap::find_indexes(index.nodes_by_nid, vmap.lanes[l].bnid))
       {
-        if (n.nid != l.bnid)
-          continue;
-        for (const vector_map::Point& p : vmap.points)
+        for (size_t p : lane_planner::vmap::find_indexes(index.points_by_pid, vmap.nodes[n].pid))
         {
-          if (p.pid != n.pid)
-            continue;
-          bool hit = false;
-          for (const vector_map::Point& sp : stop_points)
-          {
-            if (sp.pid == p.pid)
-            {
-              hit = true;
-              break;
-            }
-          }
-          if (!hit)
-            stop_points.push_back(p);
+          if (stop_pids.insert(vmap.points[p].pid).second)
+            stop_points.push_back(vmap.points[p]);
         }
       }
     }
@@ -0,0 +1,564 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cmath>
+#include <tuple>
+
+#include <ros/console.h>
+
+#include "lane_planner_vmap_reference.hpp"
+
+namespace lane_planner {
+
+namespace vmap {
+
+// Linear scan implementation from before the lookups were indexed, kept to check that the index does not change
+// the results
+namespace reference {
+
+namespace {
+
+double compute_direction_angle(const vector_map::Point& p1, const vector_map::Point& p2);
+
+bool is_branching_point(const VectorMap& vmap, const vector_map::Point& point);
+bool is_merging_point(const VectorMap& vmap, const vector_map::Point& point);
+bool is_branching_lane(const vector_map::Lane& lane);
+bool is_merging_lane(const vector_map::Lane& lane);
+
+vector_map::Point find_start_point(const VectorMap& vmap, const vector_map::Lane& lane);
+vector_map::Point find_end_point(const VectorMap& vmap, const vector_map::Lane& lane);
+vector_map::Point find_departure_point(const VectorMap& lane_vmap, int lno,
+				       const std::vector<vector_map::Point>& coarse_points,
+				       double search_radius);
+vector_map::Point find_arrival_point(const VectorMap& lane_vmap, int lno,
+				     const std::vector<vector_map::Point>& coarse_points,
+				     double search_radius);
+vector_map::Point find_nearest_point(const VectorMap& vmap, const vector_map::Point& point);
+std::vector<vector_map::Point> find_near_points(const VectorMap& vmap, const vector_map::Point& point,
+						double search_radius);
+
+vector_map::Lane find_lane(const VectorMap& vmap, int lno, const vector_map::Point& point);
+vector_map::Lane find_prev_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane);
+vector_map::Lane find_next_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane);
+vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane,
+					  double coarse_angle, double search_radius);
+
+double compute_direction_angle(const vector_map::Point& p1, const vector_map::Point& p2)
+{
+	return (atan2(p2.ly - p1.ly, p2.bx - p1.bx) * (180 / M_PI)); // -180 to 180 degrees
+}
+
+bool is_branching_point(const VectorMap& vmap, const vector_map::Point& point)
+{
+	vector_map::Lane lane = find_lane(vmap, LNO_ALL, point);
+	if (lane.lnid < 0)
+		return false;
+
+	lane = find_prev_lane(vmap, LNO_ALL, lane);
+	if (lane.lnid < 0)
+		return false;
+
+	return is_branching_lane(lane);
+}
+
+bool is_merging_point(const VectorMap& vmap, const vector_map::Point& point)
+{
+	vector_map::Lane lane = find_lane(vmap, LNO_ALL, point);
+	if (lane.lnid < 0)
+		return false;
+
+	return is_merging_lane(lane);
+}
+
+bool is_branching_lane(const vector_map::Lane& lane)
+{
+	return (lane.jct == 1 || lane.jct == 2 || lane.jct == 5);
+}
+
+bool is_merging_lane(const vector_map::Lane& lane)
+{
+	return (lane.jct == 3 || lane.jct == 4 || lane.jct == 5);
+}
+
+vector_map::Point find_start_point(const VectorMap& vmap, const vector_map::Lane& lane)
+{
+	vector_map::Point error;
+	error.pid = -1;
+
+	for (const vector_map::Node& n : vmap.nodes) {
+		if (n.nid != lane.bnid)
+			continue;
+		for (const vector_map::Point& p : vmap.points) {
+			if (p.pid != n.pid)
+				continue;
+			return p;
+		}
+	}
+
+	return error;
+}
+
+vector_map::Point find_end_point(const VectorMap& vmap, const vector_map::Lane& lane)
+{
+	vector_map::Point error;
+	error.pid = -1;
+
+	for (const vector_map::Node& n : vmap.nodes) {
+		if (n.nid != lane.fnid)
+			continue;
+		for (const vector_map::Point& p : vmap.points) {
+			if (p.pid != n.pid)
+				continue;
+			return p;
+		}
+	}
+
+	return error;
+}
+
+vector_map::Point find_departure_point(const VectorMap& lane_vmap, int lno,
+				       const std::vector<vector_map::Point>& coarse_points,
+				       double search_radius)
+{
+	vector_map::Point coarse_p1 = coarse_points[0];
+	vector_map::Point coarse_p2 = coarse_points[1];
+
+	vector_map::Point nearest_point = find_nearest_point(lane_vmap, coarse_p1);
+	if (nearest_point.pid < 0)
+		return nearest_point;
+
+	std::vector<vector_map::Point> near_points = find_near_points(lane_vmap, coarse_p1, search_radius);
+	double coarse_angle = compute_direction_angle(coarse_p1, coarse_p2);
+	double score = 180 + search_radius; // XXX better way?
+	for (const vector_map::Point& p1 : near_points) {
+		vector_map::Lane l = find_lane(lane_vmap, lno, p1);
+		if (l.lnid < 0)
+			continue;
+
+		vector_map::Point p2 = find_end_point(lane_vmap, l);
+		if (p2.pid < 0)
+			continue;
+
+		double a = compute_direction_angle(p1, p2);
+		a = fabs(a - coarse_angle);
+		if (a > 180)
+			a = fabs(a - 360);
+		double d = hypot(p1.bx - coarse_p1.bx, p1.ly - coarse_p1.ly);
+		double s = a + d;
+		if (s <= score) {
+			nearest_point = p1;
+			score = s;
+		}
+	}
+
+	return nearest_point;
+}
+
+vector_map::Point find_arrival_point(const VectorMap& lane_vmap, int lno,
+				     const std::vector<vector_map::Point>& coarse_points,
+				     double search_radius)
+{
+	vector_map::Point coarse_p1 = coarse_points[coarse_points.size() - 1];
+	vector_map::Point coarse_p2 = coarse_points[coarse_points.size() - 2];
+
+	vector_map::Point nearest_point = find_nearest_point(lane_vmap, coarse_p1);
+	if (nearest_point.pid < 0)
+		return nearest_point;
+
+	std::vector<vector_map::Point> near_points = find_near_points(lane_vmap, coarse_p1, search_radius);
+	double coarse_angle = compute_direction_angle(coarse_p1, coarse_p2);
+	double score = 180 + search_radius; // XXX better way?
+	for (const vector_map::Point& p1 : near_points) {
+		vector_map::Lane l = find_lane(lane_vmap, lno, p1);
+		if (l.lnid < 0)
+			continue;
+
+		l = find_prev_lane(lane_vmap, lno, l);
+		if (l.lnid < 0)
+			continue;
+
+		vector_map::Point p2 = find_start_point(lane_vmap, l);
+		if (p2.pid < 0)
+			continue;
+
+		double a = compute_direction_angle(p1, p2);
+		a = fabs(a - coarse_angle);
+		if (a > 180)
+			a = fabs(a - 360);
+		double d = hypot(p1.bx - coarse_p1.bx, p1.ly - coarse_p1.ly);
+		double s = a + d;
+		if (s <= score) {
+			nearest_point = p1;
+			score = s;
+		}
+	}
+
+	return nearest_point;
+}
+
+vector_map::Point find_nearest_point(const VectorMap& vmap, const vector_map::Point& point)
+{
+	vector_map::Point nearest_point;
+	nearest_point.pid = -1;
+
+	double distance = DBL_MAX;
+	for (const vector_map::Point& p : vmap.points) {
+		double d = hypot(p.bx - point.bx, p.ly - point.ly);
+		if (d <= distance) {
+			nearest_point = p;
+			distance = d;
+		}
+	}
+
+	return nearest_point;
+}
+
+std::vector<vector_map::Point> find_near_points(const VectorMap& vmap, const vector_map::Point& point,
+						double search_radius)
+{
+	std::vector<vector_map::Point> near_points;
+	for (const vector_map::Point& p : vmap.points) {
+		double d = hypot(p.bx - point.bx, p.ly - point.ly);
+		if (d <= search_radius)
+			near_points.push_back(p);
+	}
+
+	return near_points;
+}
+
+vector_map::Lane find_lane(const VectorMap& vmap, int lno, const vector_map::Point& point)
+{
+	vector_map::Lane error;
+	error.lnid = -1;
+
+	for (const vector_map::Node& n : vmap.nodes) {
+		if (n.pid != point.pid)
+			continue;
+		for (const vector_map::Lane& l : vmap.lanes) {
+			if (lno != LNO_ALL && l.lno != lno)
+				continue;
+			if (l.bnid != n.nid)
+				continue;
+			return l;
+		}
+	}
+
+	return error;
+}
+
+vector_map::Lane find_prev_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
+{
+	vector_map::Lane error;
+	error.lnid = -1;
+
+	if (is_merging_lane(lane)) {
+		for (const vector_map::Lane& l : vmap.lanes) {
+			if (lno != LNO_ALL && l.lno != lno)
+				continue;
+			if (l.lnid != lane.blid && l.lnid != lane.blid2 && l.lnid != lane.blid3 &&
+			    l.lnid != lane.blid4)
+				continue;
+			return l;
+		}
+	} else {
+		for (const vector_map::Lane& l : vmap.lanes) {
+			if (l.lnid != lane.blid)
+				continue;
+			return l;
+		}
+	}
+
+	return error;
+}
+
+vector_map::Lane find_next_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane)
+{
+	vector_map::Lane error;
+	error.lnid = -1;
+
+	if (is_branching_lane(lane)) {
+		for (const vector_map::Lane& l : vmap.lanes) {
+			if (lno != LNO_ALL && l.lno != lno)
+				continue;
+			if (l.lnid != lane.flid && l.lnid != lane.flid2 && l.lnid != lane.flid3 &&
+			    l.lnid != lane.flid4)
+				continue;
+			return l;
+		}
+	} else {
+		for (const vector_map::Lane& l : vmap.lanes) {
+			if (l.lnid != lane.flid)
+				continue;
+			return l;
+		}
+	}
+
+	return error;
+}
+
+vector_map::Lane find_next_branching_lane(const VectorMap& vmap, int lno, const vector_map::Lane& lane,
+					  double coarse_angle, double search_radius)
+{
+	vector_map::Lane error;
+	error.lnid = -1;
+
+	vector_map::Point p1 = find_end_point(vmap, lane);
+	if (p1.pid < 0)
+		return error;
+
+	std::vector<std::tuple<vector_map::Point, vector_map::Lane>> candidates;
+	for (const vector_map::Lane& l1 : vmap.lanes) {
+		if (lno != LNO_ALL && l1.lno != lno)
+			continue;
+		if (l1.lnid == lane.flid || l1.lnid == lane.flid2 || l1.lnid == lane.flid3 || l1.lnid == lane.flid4) {
+			vector_map::Lane l2 = l1;
+			vector_map::Point p = find_end_point(vmap, l2);
+			if (p.pid < 0)
+				continue;
+			vector_map::Point p2 = p;
+			double d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
+			while (d <= search_radius && l2.flid != 0 && !is_branching_lane(l2)) {
+				l2 = find_next_lane(vmap, LNO_ALL, l2);
+				if (l2.lnid < 0)
+					break;
+				p = find_end_point(vmap, l2);
+				if (p.pid < 0)
+					break;
+				p2 = p;
+				d = hypot(p2.bx - p1.bx, p2.ly - p1.ly);
+			}
+			candidates.push_back(std::make_tuple(p2, l1));
+		}
+	}
+
+	if (candidates.empty())
+		return error;
+
+	vector_map::Lane branching_lane;
+	double angle = 180;
+	for (const std::tuple<vector_map::Point, vector_map::Lane>& c : candidates) {
+		vector_map::Point p2 = std::get<0>(c);
+		double a = compute_direction_angle(p1, p2);
+		a = fabs(a - coarse_angle);
+		if (a > 180)
+			a = fabs(a - 360);
+		if (a <= angle) {
+			branching_lane = std::get<1>(c);
+			angle = a;
+		}
+	}
+
+	return branching_lane;
+}
+
+} // namespace
+
+VectorMap create_lane_vmap(const VectorMap& vmap, int lno)
+{
+	VectorMap lane_vmap;
+	for (const vector_map::Lane& l : vmap.lanes) {
+		if (lno != LNO_ALL && l.lno != lno)
+			continue;
+		lane_vmap.lanes.push_back(l);
+
+		for (const vector_map::Node& n : vmap.nodes) {
+			if (n.nid != l.bnid && n.nid != l.fnid)
+				continue;
+			lane_vmap.nodes.push_back(n);
+
+			for (const vector_map::Point& p : vmap.points) {
+				if (p.pid != n.pid)
+					continue;
+				lane_vmap.points.push_back(p);
+			}
+		}
+
+		for (const vector_map::StopLine& s : vmap.stoplines) {
+			if (s.linkid != l.lnid)
+				continue;
+			lane_vmap.stoplines.push_back(s);
+		}
+
+		for (const vector_map::DTLane& d : vmap.dtlanes) {
+			if (d.did != l.did)
+				continue;
+			lane_vmap.dtlanes.push_back(d);
+		}
+	}
+
+	return lane_vmap;
+}
+
+VectorMap create_fine_vmap(const VectorMap& lane_vmap, int lno, const VectorMap& coarse_vmap, double search_radius,
+			   int waypoint_max)
+{
+	VectorMap fine_vmap;
+	VectorMap null_vmap;
+
+	vector_map::Point departure_point;
+	departure_point.pid = -1;
+	if (lno == LNO_ALL)
+		departure_point = find_nearest_point(lane_vmap, coarse_vmap.points.front());
+	else {
+		for (int i = lno; i >= LNO_CROSSING; --i) {
+			departure_point = find_departure_point(lane_vmap, i, coarse_vmap.points, search_radius);
+			if (departure_point.pid >= 0)
+				break;
+		}
+	}
+	if (departure_point.pid < 0)
+		return null_vmap;
+
+	vector_map::Point arrival_point;
+	arrival_point.pid = -1;
+	if (lno == LNO_ALL)
+		arrival_point = find_nearest_point(lane_vmap, coarse_vmap.points.back());
+	else {
+		for (int i = lno; i >= LNO_CROSSING; --i) {
+			arrival_point = find_arrival_point(lane_vmap, i, coarse_vmap.points, search_radius);
+			if (arrival_point.pid >= 0)
+				break;
+		}
+	}
+	if (arrival_point.pid < 0)
+		return null_vmap;
+
+	vector_map::Point point = departure_point;
+	vector_map::Lane lane = find_lane(lane_vmap, LNO_ALL, point);
+	if (lane.lnid < 0)
+		return null_vmap;
+
+	bool finish = false;
+	for (int i = 0; i < waypoint_max; ++i) {
+		fine_vmap.points.push_back(point);
+
+		// last is equal to previous dtlane
+		vector_map::DTLane dtlane;
+		dtlane.did = -1;
+		for (const vector_map::DTLane& d : lane_vmap.dtlanes) {
+			if (d.did == lane.did) {
+				dtlane = d;
+				break;
+			}
+		}
+		fine_vmap.dtlanes.push_back(dtlane);
+
+		// last is equal to previous stopline
+		vector_map::StopLine stopline;
+		stopline.id = -1;
+		for (const vector_map::StopLine& s : lane_vmap.stoplines) {
+			if (s.linkid == lane.lnid) {
+				stopline = s;
+				break;
+			}
+		}
+		fine_vmap.stoplines.push_back(stopline);
+
+		if (finish)
+			break;
+
+		fine_vmap.lanes.push_back(lane);
+
+		point = find_end_point(lane_vmap, lane);
+		if (point.pid < 0)
+			return null_vmap;
+		if (point.bx == arrival_point.bx && point.ly == arrival_point.ly) {
+			finish = true;
+			continue;
+		}
+
+		if (is_branching_lane(lane)) {
+			vector_map::Point coarse_p1 = find_end_point(lane_vmap, lane);
+			if (coarse_p1.pid < 0)
+				return null_vmap;
+
+			coarse_p1 = find_nearest_point(coarse_vmap, coarse_p1);
+			if (coarse_p1.pid < 0)
+				return null_vmap;
+
+			vector_map::Point coarse_p2;
+			double distance = -1;
+			for (const vector_map::Point& p : coarse_vmap.points) {
+				if (distance == -1) {
+					if (p.bx == coarse_p1.bx && p.ly == coarse_p1.ly)
+						distance = 0;
+					continue;
+				}
+				coarse_p2 = p;
+				distance = hypot(coarse_p2.bx - coarse_p1.bx, coarse_p2.ly - coarse_p1.ly);
+				if (distance > search_radius)
+					break;
+			}
+			if (distance <= 0)
+				return null_vmap;
+
+			double coarse_angle = compute_direction_angle(coarse_p1, coarse_p2);
+			if (lno == LNO_ALL) {
+				lane = find_next_branching_lane(lane_vmap, LNO_ALL, lane, coarse_angle, search_radius);
+			} else {
+				vector_map::Lane l;
+				l.lnid = -1;
+				for (int j = lno; j >= LNO_CROSSING; --j) {
+					l = find_next_branching_lane(lane_vmap, j, lane, coarse_angle, search_radius);
+					if (l.lnid >= 0)
+						break;
+				}
+				lane = l;
+			}
+		} else {
+			lane = find_next_lane(lane_vmap, LNO_ALL, lane);
+		}
+		if (lane.lnid < 0)
+			return null_vmap;
+	}
+
+	if (!finish) {
+		ROS_ERROR_STREAM("lane is too long");
+		return null_vmap;
+	}
+
+	return fine_vmap;
+}
+
+std::vector<vector_map::Point> create_branching_points(const VectorMap& vmap)
+{
+	std::vector<vector_map::Point> branching_points;
+	for (const vector_map::Point& p : vmap.points) {
+		if (!is_branching_point(vmap, p))
+			continue;
+		branching_points.push_back(p);
+	}
+
+	return branching_points;
+}
+
+std::vector<vector_map::Point> create_merging_points(const VectorMap& vmap)
+{
+	std::vector<vector_map::Point> merging_points;
+	for (const vector_map::Point& p : vmap.points) {
+		if (!is_merging_point(vmap, p))
+			continue;
+		merging_points.push_back(p);
+	}
+
+	return merging_points;
+}
+
+} // namespace reference
+
+} // namespace vmap
+
+} // namespace lane_planner
@@ -0,0 +1,43 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LANE_PLANNER_VMAP_REFERENCE_HPP
+#define LANE_PLANNER_VMAP_REFERENCE_HPP
+
+#include <vector>
+
+#include <lane_planner/lane_planner_vmap.hpp>
+
+namespace lane_planner {
+
+namespace vmap {
+
+namespace reference {
+
+VectorMap create_lane_vmap(const VectorMap& vmap, int lno);
+VectorMap create_fine_vmap(const VectorMap& lane_vmap, int lno, const VectorMap& coarse_vmap, double search_radius,
+			   int waypoint_max);
+
+std::vector<vector_map::Point> create_branching_points(const VectorMap& vmap);
+std::vector<vector_map::Point> create_merging_points(const VectorMap& vmap);
+
+} // namespace reference
+
+} // namespace vmap
+
+} // namespace lane_planner
+
+#endif // LANE_PLANNER_VMAP_REFERENCE_HPP
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <lane_planner/lane_planner_vmap.hpp>
+
+#include "lane_planner_vmap_reference.hpp"
+
+namespace lane_planner {
+
+namespace vmap {
+
+namespace {
+
+std::string describe(const std::vector<vector_map::Point> &points) {
+  std::ostringstream out;
+  out.precision(17);
+  for (const vector_map::Point &p : points)
+    out << " p" << p.pid << "(" << p.bx << "," << p.ly << ")";
+  return out.str();
+}
+
+std::string describe(const VectorMap &vmap) {
+  std::ostringstream out;
+  out << describe(vmap.points);
+  for (const vector_map::Node &n : vmap.nodes)
+    out << " n" << n.nid << "/" << n.pid;
+  for (const vector_map::Lane &l : vmap.lanes)
+    out << " l" << l.lnid;
+  for (const vector_map::StopLine &s : vmap.stoplines)
+    out << " s" << s.id;
+  for (const vector_map::DTLane &d : vmap.dtlanes)
+    out << " d" << d.did;
+  return out.str();
+}
+
+class RandomVectorMap {
+public:
+  explicit RandomVectorMap(int seed) : engine_(seed) {
+    // points on a coarse grid so that distances tie, ids duplicated now and then
+    scale_ = (seed % 3 == 0) ? 0.5 : 5.0;
+    const int point_num = 20 + random(300);
+    for (int i = 0; i < point_num; ++i) {
+      vector_map::Point p;
+      p.pid = 1 + i - (random(20) == 0 ? 1 : 0);
+      p.bx = random(60) * scale_;
+      p.ly = random(60) * scale_;
+      p.h = random(5);
+      vmap.points.push_back(p);
+    }
+    for (int i = 0; i < point_num; ++i) {
+      vector_map::Node n;
+      n.nid = 1 + i + (random(25) == 0 ? 1 : 0);
+      n.pid = 1 + random(point_num + 2);
+      vmap.nodes.push_back(n);
+    }
+
+    const int lane_num = point_num + random(point_num);
+    for (int i = 0; i < lane_num; ++i) {
+      vector_map::Lane l;
+      l.lnid = 1 + i - (random(30) == 0 ? 1 : 0);
+      l.bnid = 1 + random(point_num);
+      l.fnid = (random(3) == 0) ? l.bnid + 1 : 1 + random(point_num);
+      l.did = 1 + random(lane_num);
+      l.lno = random(3);
+      l.jct = random(6);
+      l.flid = random(5) ? i + 3 + random(lane_num) : 0;
+      l.flid2 = (random(4) == 0) ? i + 3 + random(lane_num) : 0;
+      l.flid3 = (random(8) == 0) ? i + 3 + random(lane_num) : 0;
+      l.blid = random(lane_num + 1);
+      l.blid2 = (random(4) == 0) ? random(lane_num + 1) : 0;
+      l.blid4 = (random(10) == 0) ? random(lane_num + 1) : 0;
+      vmap.lanes.push_back(l);
+    }
+    // chain about half of the consecutive lanes
+    for (int i = 0; i + 1 < lane_num && i + 1 < point_num; ++i) {
+      if (random(2) == 0)
+        continue;
+      vector_map::Lane &l = vmap.lanes[i];
+      vector_map::Lane &next = vmap.lanes[i + 1];
+      l.fnid = next.bnid;
+      l.flid = (next.lnid > l.lnid + 1) ? next.lnid : 0;
+      next.blid = l.lnid;
+    }
+
+    for (int i = 0; i < lane_num / 3; ++i) {
+      vector_map::StopLine s;
+      s.id = 1 + i;
+      s.linkid = 1 + random(lane_num);
+      vmap.stoplines.push_back(s);
+    }
+    for (int i = 0; i < lane_num; ++i) {
+      vector_map::DTLane d;
+      d.did = 1 + random(lane_num);
+      d.r = random(2) ? RADIUS_MAX : random(30) - 15;
+      d.apara = (random(4) == 0);
+      vmap.dtlanes.push_back(d);
+    }
+  }
+
+  // points near the start points of a run of lanes, some of them with the pid of a map point
+  VectorMap createCoarseVmap() {
+    VectorMap coarse_vmap;
+    const int length = 2 + random(8);
+    const size_t first = random(vmap.lanes.size());
+    for (int i = 0; i < length; ++i) {
+      const vector_map::Lane &l = vmap.lanes[(first + i) % vmap.lanes.size()];
+      vector_map::Point c;
+      c.bx = random(60) * scale_ + (random(3) - 1) * 0.3;
+      c.ly = random(60) * scale_;
+      const int pid = findPid(l.bnid);
+      for (const vector_map::Point &p : vmap.points) {
+        if (p.pid == pid) {
+          c.bx = p.bx + (random(3) - 1) * 0.2;
+          c.ly = p.ly;
+          break;
+        }
+      }
+      c.pid = (random(3) == 0) ? 1 + random(vmap.points.size()) : -1;
+      coarse_vmap.points.push_back(c);
+    }
+    return coarse_vmap;
+  }
+
+  double createSearchRadius() { return 1 + random(20) * scale_; }
+
+  int createWaypointMax() { return 50 + random(100); }
+
+  VectorMap vmap;
+
+private:
+  int random(int n) { return static_cast<int>(engine_() % n); }
+
+  int findPid(int nid) const {
+    for (const vector_map::Node &n : vmap.nodes) {
+      if (n.nid == nid)
+        return n.pid;
+    }
+    return -1;
+  }
+
+  std::mt19937 engine_;
+  double scale_;
+};
+
+} // namespace
+
+TEST(LaneVmapTestSuite, indexedLookupsMatchLinearScans) {
+  for (int seed = 0; seed < 300; ++seed) {
+    RandomVectorMap random_vmap(seed);
+    for (int lno : {LNO_ALL, 1, 2}) {
+      VectorMap expected_lane_vmap = reference::create_lane_vmap(random_vmap.vmap, lno);
+      VectorMap lane_vmap = create_lane_vmap(random_vmap.vmap, lno);
+      ASSERT_EQ(describe(expected_lane_vmap), describe(lane_vmap)) << "seed " << seed << ", lno " << lno;
+      ASSERT_EQ(describe(reference::create_branching_points(expected_lane_vmap)),
+                describe(create_branching_points(lane_vmap)))
+          << "seed " << seed << ", lno " << lno;
+      ASSERT_EQ(describe(reference::create_merging_points(expected_lane_vmap)),
+                describe(create_merging_points(lane_vmap)))
+          << "seed " << seed << ", lno " << lno;
+
+      for (int i = 0; i < 10; ++i) {
+        VectorMap coarse_vmap = random_vmap.createCoarseVmap();
+        for (int fine_lno : {LNO_ALL, 1, 2}) {
+          double search_radius = random_vmap.createSearchRadius();
+          int waypoint_max = random_vmap.createWaypointMax();
+          ASSERT_EQ(
+              describe(reference::create_fine_vmap(expected_lane_vmap, fine_lno, coarse_vmap, search_radius,
+                                                   waypoint_max)),
+              describe(create_fine_vmap(lane_vmap, fine_lno, coarse_vmap, search_radius, waypoint_max)))
+              << "seed " << seed << ", lno " << lno << ", fine lno " << fine_lno;
+        }
+      }
+    }
+  }
+}
+
+TEST(LaneVmapTestSuite, resizedMapIsIndexedAgain) {
+  RandomVectorMap random_vmap(0);
+  VectorMap &vmap = random_vmap.vmap;
+  build_vmap_index(vmap);
+
+  VectorMap tmp;
+  ASSERT_EQ(&vmap, &indexed_vmap(vmap, tmp));
+
+  vector_map::Point p = vmap.points.front();
+  p.pid = vmap.points.size() + 1000;
+  vmap.points.push_back(p);
+  const VectorMap &indexed = indexed_vmap(vmap, tmp);
+  ASSERT_EQ(&tmp, &indexed);
+  EXPECT_EQ(1U, find_indexes(indexed.index->points_by_pid, p.pid).size());
+  EXPECT_TRUE(find_indexes(indexed.index->points_by_pid, -1).empty());
+}
+
+} // namespace vmap
+
+} // namespace lane_planner
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
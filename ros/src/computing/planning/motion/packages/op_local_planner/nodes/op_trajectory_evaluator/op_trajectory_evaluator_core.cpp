@@ -256,13 +256,12 @@ void TrajectoryEval::MainLoop()
 
 		if(bNewCurrentPos && m_GlobalPaths.size()>0)
 		{
-			m_GlobalPathSections.clear();
+			m_GlobalPathSections.resize(m_GlobalPathsToUse.size());
 
 			for(unsigned int i = 0; i < m_GlobalPathsToUse.size(); i++)
 			{
-				t_centerTrajectorySmoothed.clear();
-				PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPathsToUse.at(i), m_CurrentPos, m_PlanningParams.horizonDistance , m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
-				m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
+				m_GlobalPathSections.at(i).clear();
+				PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPathsToUse.at(i), m_CurrentPos, m_PlanningParams.horizonDistance , m_PlanningParams.pathDensity ,m_GlobalPathSections.at(i));
 			}
 
 			if(m_GlobalPathSections.size()>0)
@@ -205,15 +205,13 @@ void TrajectoryGen::MainLoop()
 
 		if(bInitPos && m_GlobalPaths.size()>0)
 		{
-			m_GlobalPathSections.clear();
+			m_GlobalPathSections.resize(m_GlobalPaths.size());
 
 			for(unsigned int i = 0; i < m_GlobalPaths.size(); i++)
 			{
-				t_centerTrajectorySmoothed.clear();
+				m_GlobalPathSections.at(i).clear();
 				PlannerHNS::PlanningHelpers::ExtractPartFromPointToDistanceDirectionFast(m_GlobalPaths.at(i), m_CurrentPos, m_PlanningParams.horizonDistance ,
-						m_PlanningParams.pathDensity ,t_centerTrajectorySmoothed);
-
-				m_GlobalPathSections.push_back(t_centerTrajectorySmoothed);
+						m_PlanningParams.pathDensity ,m_GlobalPathSections.at(i));
 			}
 
 			std::vector<PlannerHNS::WayPoint> sampledPoints_debug;
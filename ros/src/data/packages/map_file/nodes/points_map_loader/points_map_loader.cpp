@@ -14,13 +14,21 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
 #include <queue>
+#include <set>
 #include <thread>
+#include <unordered_map>
 
 #include <geometry_msgs/PoseWithCovarianceStamped.h>
 #include <pcl_conversions/pcl_conversions.h>
 #include <std_msgs/Bool.h>
+#include <std_msgs/String.h>
 #include <tf/transform_listener.h>
 
 #include "autoware_msgs/LaneArray.h"
@@ -88,6 +96,131 @@ geometry_msgs::Point RequestQueue::dequeue()
 	}
 }
 
+typedef std::shared_ptr<const sensor_msgs::PointCloud2> TilePtr;
+
+// Least recently used PCD tiles, keyed by path
+class TileCache {
+private:
+	typedef std::list<std::pair<std::string, TilePtr>> TileList;
+
+	TileList tiles_; // most recently used first
+	std::unordered_map<std::string, TileList::iterator> index_;
+	std::set<std::string> pending_; // being loaded by some thread
+	size_t capacity_ = 0;
+	std::mutex mtx_;
+	std::condition_variable cv_;
+
+public:
+	void set_capacity(size_t capacity);
+	// Return the cached tile, or null after reserving the path, in which case
+	// the caller loads the tile and put()s it. If another thread is loading
+	// it, wait for it, or return null without reserving if wait is false.
+	TilePtr acquire(const std::string& path, bool wait, bool& reserved);
+	// True if the tile is cached or being loaded
+	bool contains(const std::string& path);
+	// Store a tile reserved by acquire(), null if it could not be loaded
+	void put(const std::string& path, const TilePtr& tile);
+};
+
+void TileCache::set_capacity(size_t capacity)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	capacity_ = capacity;
+	while (tiles_.size() > capacity_) {
+		index_.erase(tiles_.back().first);
+		tiles_.pop_back();
+	}
+}
+
+TilePtr TileCache::acquire(const std::string& path, bool wait, bool& reserved)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	reserved = false;
+	while (true) {
+		auto it = index_.find(path);
+		if (it != index_.end()) {
+			tiles_.splice(tiles_.begin(), tiles_, it->second);
+			return it->second->second;
+		}
+		if (pending_.find(path) == pending_.end())
+			break;
+		if (!wait)
+			return TilePtr();
+		cv_.wait(lock);
+	}
+	pending_.insert(path);
+	reserved = true;
+	return TilePtr();
+}
+
+bool TileCache::contains(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	return (index_.find(path) != index_.end() || pending_.find(path) != pending_.end());
+}
+
+void TileCache::put(const std::string& path, const TilePtr& tile)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	pending_.erase(path);
+	cv_.notify_all();
+	if (!tile || capacity_ == 0)
+		return;
+	auto it = index_.find(path);
+	if (it != index_.end()) {
+		it->second->second = tile;
+		tiles_.splice(tiles_.begin(), tiles_, it->second);
+		return;
+	}
+	tiles_.emplace_front(path, tile);
+	index_[path] = tiles_.begin();
+	while (tiles_.size() > capacity_) {
+		index_.erase(tiles_.back().first);
+		tiles_.pop_back();
+	}
+}
+
+// Paths of PCD tiles to be loaded in background
+class PrefetchQueue {
+private:
+	std::deque<std::string> queue_;
+	std::set<std::string> queued_;
+	std::mutex mtx_;
+	std::condition_variable cv_;
+
+public:
+	void enqueue(const std::string& path);
+	void clear();
+	std::string dequeue();
+};
+
+void PrefetchQueue::enqueue(const std::string& path)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	if (!queued_.insert(path).second)
+		return;
+	queue_.push_back(path);
+	cv_.notify_one();
+}
+
+void PrefetchQueue::clear()
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	queue_.clear();
+	queued_.clear();
+}
+
+std::string PrefetchQueue::dequeue()
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	while (queue_.empty())
+		cv_.wait(lock);
+	std::string path = queue_.front();
+	queue_.pop_front();
+	queued_.erase(path);
+	return path;
+}
+
 struct Area {
 	std::string path;
 	double x_min;
@@ -102,14 +235,20 @@ typedef std::vector<Area> AreaList;
 typedef std::vector<std::vector<std::string>> Tbl;
 
 constexpr int DEFAULT_UPDATE_RATE = 1000; // ms
+constexpr int DEFAULT_CACHE_SIZE = 128; // tiles
+constexpr int DEFAULT_LOADER_THREADS = 2;
+constexpr double DEFAULT_PREFETCH_TIME = 5; // sec
+constexpr double PREFETCH_MAX_INTERVAL = 5; // sec, older poses are not used to estimate the velocity
 constexpr double MARGIN_UNIT = 100; // meter
 constexpr int ROUNDING_UNIT = 1000; // meter
 const std::string AREALIST_FILENAME = "arealist.txt";
 const std::string TEMPORARY_DIRNAME = "/tmp/";
+const std::string VOXEL_MAP_EXTENSION = ".ndtv"; // pre-voxelized NDT map tile, see ndt_voxel_map_generator
 
 int update_rate;
 int fallback_rate;
 double margin;
+double prefetch_time;
 bool can_download;
 
 ros::Time gnss_time;
@@ -117,7 +256,10 @@ ros::Time current_time;
 
 ros::Publisher pcd_pub;
 ros::Publisher stat_pub;
+ros::Publisher voxel_map_pub;
 std_msgs::Bool stat_msg;
+std::string published_voxel_map;
+std::vector<std::string> published_pcd_paths;
 
 AreaList all_areas;
 AreaList downloaded_areas;
@@ -126,6 +268,8 @@ std::vector<std::string> cached_arealist_paths;
 
 GetFile gf;
 RequestQueue request_queue;
+TileCache tile_cache;
+PrefetchQueue prefetch_queue;
 
 Tbl read_csv(const std::string& path)
 {
@@ -199,6 +343,13 @@ bool is_downloaded(const std::string& path)
 	return (stat(path.c_str(), &st) == 0);
 }
 
+bool is_voxel_map(const std::string& path)
+{
+	return (path.size() >= VOXEL_MAP_EXTENSION.size() &&
+		path.compare(path.size() - VOXEL_MAP_EXTENSION.size(), VOXEL_MAP_EXTENSION.size(),
+			     VOXEL_MAP_EXTENSION) == 0);
+}
+
 bool is_in_area(double x, double y, const Area& area, double m)
 {
 	return ((area.x_min - m) <= x && x <= (area.x_max + m) && (area.y_min - m) <= y && y <= (area.y_max + m));
@@ -296,20 +447,84 @@ void download_map()
 	}
 }
 
-sensor_msgs::PointCloud2 create_pcd(const geometry_msgs::Point& p)
+std::vector<std::string> find_pcd_paths(const geometry_msgs::Point& p)
 {
-	sensor_msgs::PointCloud2 pcd, part;
+	std::vector<std::string> paths;
 	std::unique_lock<std::mutex> lock(downloaded_areas_mtx);
 	for (const Area& area : downloaded_areas) {
-		if (is_in_area(p.x, p.y, area, margin)) {
-			if (pcd.width == 0)
-				pcl::io::loadPCDFile(area.path.c_str(), pcd);
-			else {
-				pcl::io::loadPCDFile(area.path.c_str(), part);
-				pcd.width += part.width;
-				pcd.row_step += part.row_step;
-				pcd.data.insert(pcd.data.end(), part.data.begin(), part.data.end());
-			}
+		if (!is_voxel_map(area.path) && is_in_area(p.x, p.y, area, margin))
+			paths.push_back(area.path);
+	}
+
+	return paths;
+}
+
+// A tile being loaded by another thread is waited for, or skipped if wait is
+// false. If that load failed, the tile is loaded again.
+TilePtr load_tile(const std::string& path, bool wait)
+{
+	bool reserved;
+	TilePtr tile = tile_cache.acquire(path, wait, reserved);
+	if (!reserved)
+		return tile;
+
+	std::shared_ptr<sensor_msgs::PointCloud2> pcd(new sensor_msgs::PointCloud2);
+	if (pcl::io::loadPCDFile(path.c_str(), *pcd) == -1) {
+		std::cerr << "load failed " << path << std::endl;
+		tile_cache.put(path, TilePtr());
+		return TilePtr();
+	}
+	tile_cache.put(path, pcd);
+
+	return pcd;
+}
+
+void prefetch_tiles()
+{
+	while (true) {
+		std::string path = prefetch_queue.dequeue();
+		load_tile(path, false);
+	}
+}
+
+// Queue the tiles along the path the vehicle is expected to drive in the
+// next prefetch_time seconds, extrapolated from the previous pose.
+void prefetch_ahead(const geometry_msgs::PoseStamped& msg, geometry_msgs::PoseStamped& prev_msg)
+{
+	double dt = (msg.header.stamp - prev_msg.header.stamp).toSec();
+	double dx = msg.pose.position.x - prev_msg.pose.position.x;
+	double dy = msg.pose.position.y - prev_msg.pose.position.y;
+	prev_msg = msg;
+
+	if (prefetch_time <= 0 || dt <= 0 || dt > PREFETCH_MAX_INTERVAL)
+		return;
+
+	double scale = prefetch_time / dt;
+	double distance = hypot(dx, dy) * scale;
+	int steps = static_cast<int>(std::ceil(distance / (MARGIN_UNIT / 2)));
+
+	prefetch_queue.clear();
+	for (int i = 1; i <= steps; ++i) {
+		geometry_msgs::Point p;
+		p.x = msg.pose.position.x + dx * scale * i / steps;
+		p.y = msg.pose.position.y + dy * scale * i / steps;
+		for (const std::string& path : find_pcd_paths(p)) {
+			if (!tile_cache.contains(path))
+				prefetch_queue.enqueue(path);
+		}
+	}
+}
+
+sensor_msgs::PointCloud2 create_pcd(const std::vector<TilePtr>& tiles)
+{
+	sensor_msgs::PointCloud2 pcd;
+	for (const TilePtr& part : tiles) {
+		if (pcd.width == 0)
+			pcd = *part;
+		else {
+			pcd.width += part->width;
+			pcd.row_step += part->row_step;
+			pcd.data.insert(pcd.data.end(), part->data.begin(), part->data.end());
 		}
 	}
 
@@ -320,6 +535,8 @@ sensor_msgs::PointCloud2 create_pcd(const std::vector<std::string>& pcd_paths, i
 {
 	sensor_msgs::PointCloud2 pcd, part;
 	for (const std::string& path : pcd_paths) {
+		if (is_voxel_map(path))
+			continue;
 		// Following outputs are used for progress bar of Runtime Manager.
 		if (pcd.width == 0) {
 			if (pcl::io::loadPCDFile(path.c_str(), pcd) == -1) {
@@ -342,6 +559,31 @@ sensor_msgs::PointCloud2 create_pcd(const std::vector<std::string>& pcd_paths, i
 	return pcd;
 }
 
+// Voxel map tiles are not parsed here, their paths are passed to the
+// localizer, which maps the files itself.
+std::string create_voxel_map(const geometry_msgs::Point& p)
+{
+	std::string paths;
+	std::unique_lock<std::mutex> lock(downloaded_areas_mtx);
+	for (const Area& area : downloaded_areas) {
+		if (is_voxel_map(area.path) && is_in_area(p.x, p.y, area, margin))
+			paths += area.path + "\n";
+	}
+
+	return paths;
+}
+
+std::string create_voxel_map(const std::vector<std::string>& pcd_paths)
+{
+	std::string paths;
+	for (const std::string& path : pcd_paths) {
+		if (is_voxel_map(path))
+			paths += path + "\n";
+	}
+
+	return paths;
+}
+
 void publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp = NULL)
 {
 	if (pcd.width != 0) {
@@ -355,8 +597,47 @@ void publish_pcd(sensor_msgs::PointCloud2 pcd, const int* errp = NULL)
 	}
 }
 
+// An empty list is published too once tiles have been, so that the localizer
+// unloads them when the vehicle leaves the mapped area.
+void publish_voxel_map(const std::string& paths)
+{
+	if (paths == published_voxel_map)
+		return;
+
+	std_msgs::String msg;
+	msg.data = paths;
+	voxel_map_pub.publish(msg);
+	published_voxel_map = paths;
+
+	if (!paths.empty()) {
+		stat_msg.data = true;
+		stat_pub.publish(stat_msg);
+	}
+}
+
+// Publish the tiles around p. The map is rebuilt from the tile cache, and
+// only when the set of tiles has changed unless force is set.
+void publish_area_pcd(const geometry_msgs::Point& p, bool force = false)
+{
+	std::vector<std::string> paths = find_pcd_paths(p);
+	if (force || paths != published_pcd_paths) {
+		std::vector<TilePtr> tiles;
+		for (const std::string& path : paths) {
+			TilePtr tile = load_tile(path, true);
+			if (tile)
+				tiles.push_back(tile);
+		}
+		publish_pcd(create_pcd(tiles));
+		published_pcd_paths = paths;
+	}
+
+	publish_voxel_map(create_voxel_map(p));
+}
+
 void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
 {
+	static geometry_msgs::PoseStamped prev_msg;
+
 	ros::Time now = ros::Time::now();
 	if (((now - current_time).toSec() * 1000) < fallback_rate)
 		return;
@@ -367,11 +648,14 @@ void publish_gnss_pcd(const geometry_msgs::PoseStamped& msg)
 	if (can_download)
 		request_queue.enqueue(msg.pose.position);
 
-	publish_pcd(create_pcd(msg.pose.position));
+	publish_area_pcd(msg.pose.position);
+	prefetch_ahead(msg, prev_msg);
 }
 
 void publish_current_pcd(const geometry_msgs::PoseStamped& msg)
 {
+	static geometry_msgs::PoseStamped prev_msg;
+
 	ros::Time now = ros::Time::now();
 	if (((now - current_time).toSec() * 1000) < update_rate)
 		return;
@@ -380,7 +664,8 @@ void publish_current_pcd(const geometry_msgs::PoseStamped& msg)
 	if (can_download)
 		request_queue.enqueue(msg.pose.position);
 
-	publish_pcd(create_pcd(msg.pose.position));
+	publish_area_pcd(msg.pose.position);
+	prefetch_ahead(msg, prev_msg);
 }
 
 void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
@@ -402,7 +687,7 @@ void publish_dragged_pcd(const geometry_msgs::PoseWithCovarianceStamped& msg)
 	if (can_download)
 		request_queue.enqueue(p);
 
-	publish_pcd(create_pcd(p));
+	publish_area_pcd(p, true);
 }
 
 void request_lookahead_download(const autoware_msgs::LaneArray& msg)
@@ -441,6 +726,7 @@ void print_usage()
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader noupdate [PCD]...");
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader {1x1|3x3|5x5|7x7|9x9} AREALIST [PCD]...");
 	ROS_ERROR_STREAM("rosrun map_file points_map_loader {1x1|3x3|5x5|7x7|9x9} download");
+	ROS_ERROR_STREAM("PCD may also be a voxel map tile (" << VOXEL_MAP_EXTENSION << "), published on points_map_voxels");
 }
 
 } // namespace
@@ -507,6 +793,7 @@ int main(int argc, char **argv)
 
 	pcd_pub = n.advertise<sensor_msgs::PointCloud2>("points_map", 1, true);
 	stat_pub = n.advertise<std_msgs::Bool>("pmap_stat", 1, true);
+	voxel_map_pub = n.advertise<std_msgs::String>("points_map_voxels", 1, true);
 
 	stat_msg.data = false;
 	stat_pub.publish(stat_msg);
@@ -518,10 +805,26 @@ int main(int argc, char **argv)
 	if (margin < 0) {
 		int err = 0;
 		publish_pcd(create_pcd(pcd_paths, &err), &err);
+		publish_voxel_map(create_voxel_map(pcd_paths));
 	} else {
 		n.param<int>("points_map_loader/update_rate", update_rate, DEFAULT_UPDATE_RATE);
 		fallback_rate = update_rate * 2; // XXX better way?
 
+		int cache_size;
+		n.param<int>("points_map_loader/cache_size", cache_size, DEFAULT_CACHE_SIZE);
+		tile_cache.set_capacity(std::max(cache_size, 0));
+		int loader_threads;
+		n.param<int>("points_map_loader/loader_threads", loader_threads, DEFAULT_LOADER_THREADS);
+		n.param<double>("points_map_loader/prefetch_time", prefetch_time, DEFAULT_PREFETCH_TIME);
+		for (int i = 0; i < loader_threads && cache_size > 0; ++i) {
+			try {
+				std::thread loader(prefetch_tiles);
+				loader.detach();
+			} catch (std::exception &ex) {
+				ROS_ERROR_STREAM("failed to create thread from " << ex.what());
+			}
+		}
+
 		gnss_sub = n.subscribe("gnss_pose", 1000, publish_gnss_pcd);
 		current_sub = n.subscribe("current_pose", 1000, publish_current_pcd);
 		initial_sub = n.subscribe("initialpose", 1, publish_dragged_pcd);
@@ -0,0 +1,223 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libgen.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector_map/vector_map.h>
+
+namespace
+{
+struct Result
+{
+  size_t records;
+  size_t lookups;
+  double map_seconds;
+  double table_seconds;
+  bool same;
+};
+
+void printUsage()
+{
+  std::cerr << "Usage:" << std::endl;
+  std::cerr << "rosrun map_file vector_map_lookup_benchmark [-r REPEATS] [CSV]..." << std::endl;
+}
+
+// Look up every record in random order, and as many random ids in the same range, half of which usually miss
+std::vector<int> createQueries(const std::vector<int>& ids)
+{
+  std::vector<int> queries(ids);
+  if (ids.empty())
+    return queries;
+
+  std::mt19937 engine(0);
+  int min_id = *std::min_element(ids.begin(), ids.end());
+  int max_id = *std::max_element(ids.begin(), ids.end());
+  std::uniform_int_distribution<int> distribution(min_id, max_id);
+  for (size_t i = 0; i < ids.size(); ++i)
+    queries.push_back(distribution(engine));
+  std::shuffle(queries.begin(), queries.end(), engine);
+  return queries;
+}
+
+// Same lookups through the std::map used by vector_map::Handle before vector_map::RecordTable, kept as the reference
+template <class T, int T::*Id>
+Result benchmark(const std::string& file_path, int repeats)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  std::vector<T> objs = vector_map::parse<T>(file_path);
+
+  std::map<vector_map::Key<T>, T> map;
+  std::vector<int> ids;
+  for (const auto& obj : objs)
+  {
+    if (obj.*Id == 0)
+      continue;
+    map.insert(std::make_pair(vector_map::Key<T>(obj.*Id), obj));
+    ids.push_back(obj.*Id);
+  }
+
+  vector_map::RecordTable<T> table;
+  table.assign(objs, [](const T& obj) { return obj.*Id; });
+
+  std::vector<int> queries = createQueries(ids);
+  std::vector<int> map_found, table_found;
+  map_found.reserve(queries.size());
+  table_found.reserve(queries.size());
+
+  Result result;
+  result.records = map.size();
+  result.lookups = queries.size();
+  result.map_seconds = 0;
+  result.table_seconds = 0;
+  for (int i = 0; i < repeats; ++i)
+  {
+    map_found.clear();
+    table_found.clear();
+
+    Clock::time_point start = Clock::now();
+    for (int id : queries)
+    {
+      auto it = map.find(vector_map::Key<T>(id));
+      map_found.push_back(it == map.end() ? 0 : it->second.*Id);
+    }
+    Clock::time_point middle = Clock::now();
+    for (int id : queries)
+    {
+      const T* obj = table.find(id);
+      table_found.push_back(obj == nullptr ? 0 : obj->*Id);
+    }
+    Clock::time_point end = Clock::now();
+
+    result.map_seconds += std::chrono::duration<double>(middle - start).count();
+    result.table_seconds += std::chrono::duration<double>(end - middle).count();
+  }
+  result.same = (map_found == table_found);
+  return result;
+}
+
+std::map<std::string, std::function<Result(const std::string&, int)>> createBenchmarks()
+{
+  std::map<std::string, std::function<Result(const std::string&, int)>> benchmarks;
+  benchmarks["point.csv"] = benchmark<vector_map::Point, &vector_map::Point::pid>;
+  benchmarks["vector.csv"] = benchmark<vector_map::Vector, &vector_map::Vector::vid>;
+  benchmarks["line.csv"] = benchmark<vector_map::Line, &vector_map::Line::lid>;
+  benchmarks["area.csv"] = benchmark<vector_map::Area, &vector_map::Area::aid>;
+  benchmarks["pole.csv"] = benchmark<vector_map::Pole, &vector_map::Pole::plid>;
+  benchmarks["box.csv"] = benchmark<vector_map::Box, &vector_map::Box::bid>;
+  benchmarks["dtlane.csv"] = benchmark<vector_map::DTLane, &vector_map::DTLane::did>;
+  benchmarks["node.csv"] = benchmark<vector_map::Node, &vector_map::Node::nid>;
+  benchmarks["lane.csv"] = benchmark<vector_map::Lane, &vector_map::Lane::lnid>;
+  benchmarks["wayarea.csv"] = benchmark<vector_map::WayArea, &vector_map::WayArea::waid>;
+  benchmarks["roadedge.csv"] = benchmark<vector_map::RoadEdge, &vector_map::RoadEdge::id>;
+  benchmarks["gutter.csv"] = benchmark<vector_map::Gutter, &vector_map::Gutter::id>;
+  benchmarks["curb.csv"] = benchmark<vector_map::Curb, &vector_map::Curb::id>;
+  benchmarks["whiteline.csv"] = benchmark<vector_map::WhiteLine, &vector_map::WhiteLine::id>;
+  benchmarks["stopline.csv"] = benchmark<vector_map::StopLine, &vector_map::StopLine::id>;
+  benchmarks["zebrazone.csv"] = benchmark<vector_map::ZebraZone, &vector_map::ZebraZone::id>;
+  benchmarks["crosswalk.csv"] = benchmark<vector_map::CrossWalk, &vector_map::CrossWalk::id>;
+  benchmarks["road_surface_mark.csv"] = benchmark<vector_map::RoadMark, &vector_map::RoadMark::id>;
+  benchmarks["poledata.csv"] = benchmark<vector_map::RoadPole, &vector_map::RoadPole::id>;
+  benchmarks["roadsign.csv"] = benchmark<vector_map::RoadSign, &vector_map::RoadSign::id>;
+  benchmarks["signaldata.csv"] = benchmark<vector_map::Signal, &vector_map::Signal::id>;
+  benchmarks["streetlight.csv"] = benchmark<vector_map::StreetLight, &vector_map::StreetLight::id>;
+  benchmarks["utilitypole.csv"] = benchmark<vector_map::UtilityPole, &vector_map::UtilityPole::id>;
+  benchmarks["guardrail.csv"] = benchmark<vector_map::GuardRail, &vector_map::GuardRail::id>;
+  benchmarks["sidewalk.csv"] = benchmark<vector_map::SideWalk, &vector_map::SideWalk::id>;
+  benchmarks["driveon_portion.csv"] = benchmark<vector_map::DriveOnPortion, &vector_map::DriveOnPortion::id>;
+  benchmarks["intersection.csv"] = benchmark<vector_map::CrossRoad, &vector_map::CrossRoad::id>;
+  benchmarks["sidestrip.csv"] = benchmark<vector_map::SideStrip, &vector_map::SideStrip::id>;
+  benchmarks["curvemirror.csv"] = benchmark<vector_map::CurveMirror, &vector_map::CurveMirror::id>;
+  benchmarks["wall.csv"] = benchmark<vector_map::Wall, &vector_map::Wall::id>;
+  benchmarks["fence.csv"] = benchmark<vector_map::Fence, &vector_map::Fence::id>;
+  benchmarks["railroad_crossing.csv"] = benchmark<vector_map::RailCrossing, &vector_map::RailCrossing::id>;
+  return benchmarks;
+}
+
+void printResult(const std::string& name, size_t records, size_t lookups, double map_seconds, double table_seconds)
+{
+  std::printf("%-22s %10zu %10zu %12.1f %12.1f %8.1f\n", name.c_str(), records, lookups, map_seconds * 1e9 / lookups,
+              table_seconds * 1e9 / lookups, map_seconds / table_seconds);
+}
+} // namespace
+
+// Lookup time by id of the Aisan records with the former std::map backend and with vector_map::RecordTable
+int main(int argc, char** argv)
+{
+  int repeats = 10;
+  std::vector<std::string> file_paths;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if (arg == "-r" && i + 1 < argc)
+      repeats = std::max(1, std::atoi(argv[++i]));
+    else
+      file_paths.push_back(arg);
+  }
+  if (file_paths.empty())
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::map<std::string, std::function<Result(const std::string&, int)>> benchmarks = createBenchmarks();
+
+  std::printf("%-22s %10s %10s %12s %12s %8s\n", "file", "records", "lookups", "map ns", "table ns", "speedup");
+  bool all_same = true;
+  size_t total_records = 0;
+  size_t total_lookups = 0;
+  double total_map_seconds = 0;
+  double total_table_seconds = 0;
+  for (const auto& file_path : file_paths)
+  {
+    std::string file_name(basename(const_cast<char*>(file_path.c_str())));
+    auto it = benchmarks.find(file_name);
+    if (it == benchmarks.end())
+    {
+      std::cerr << "skipping " << file_path << std::endl;
+      continue;
+    }
+
+    Result result = it->second(file_path, repeats);
+    if (result.lookups == 0)
+      continue;
+
+    printResult(file_name, result.records, result.lookups, result.map_seconds / repeats,
+                result.table_seconds / repeats);
+    if (!result.same)
+    {
+      std::cerr << file_name << ": the lookups disagree" << std::endl;
+      all_same = false;
+    }
+
+    total_records += result.records;
+    total_lookups += result.lookups;
+    total_map_seconds += result.map_seconds;
+    total_table_seconds += result.table_seconds;
+  }
+
+  if (total_lookups > 0)
+    printResult("total", total_records, total_lookups, total_map_seconds / repeats, total_table_seconds / repeats);
+
+  return all_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
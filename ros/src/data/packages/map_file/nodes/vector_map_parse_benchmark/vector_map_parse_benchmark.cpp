@@ -0,0 +1,211 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <libgen.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <vector_map/vector_map.h>
+
+namespace
+{
+struct Result
+{
+  size_t rows;
+  double stream_seconds;
+  double reader_seconds;
+  bool same;
+};
+
+void printUsage()
+{
+  std::cerr << "Usage:" << std::endl;
+  std::cerr << "rosrun map_file vector_map_parse_benchmark [-r REPEATS] [CSV]..." << std::endl;
+}
+
+// Parser used by vector_map_loader before vector_map::CsvReader, kept as the reference
+template <class T>
+std::vector<T> parseWithStream(const std::string& csv_file)
+{
+  std::ifstream ifs(csv_file.c_str());
+  std::string line;
+  std::getline(ifs, line); // remove first line
+  std::vector<T> objs;
+  while (std::getline(ifs, line))
+  {
+    T obj;
+    std::istringstream iss(line);
+    iss >> obj;
+    objs.push_back(obj);
+  }
+  return objs;
+}
+
+template <class T>
+bool isSame(const std::vector<T>& objs1, const std::vector<T>& objs2)
+{
+  if (objs1.size() != objs2.size())
+    return false;
+
+  std::ostringstream oss1, oss2;
+  oss1.precision(17);
+  oss2.precision(17);
+  for (size_t i = 0; i < objs1.size(); ++i)
+  {
+    oss1.str("");
+    oss2.str("");
+    oss1 << objs1[i];
+    oss2 << objs2[i];
+    if (oss1.str() != oss2.str())
+      return false;
+  }
+  return true;
+}
+
+template <class T>
+Result benchmark(const std::string& file_path, int repeats)
+{
+  typedef std::chrono::steady_clock Clock;
+
+  Result result;
+  result.stream_seconds = 0;
+  result.reader_seconds = 0;
+  std::vector<T> stream_objs, reader_objs;
+  for (int i = 0; i < repeats; ++i)
+  {
+    Clock::time_point start = Clock::now();
+    stream_objs = parseWithStream<T>(file_path);
+    Clock::time_point middle = Clock::now();
+    reader_objs = vector_map::parse<T>(file_path);
+    Clock::time_point end = Clock::now();
+    result.stream_seconds += std::chrono::duration<double>(middle - start).count();
+    result.reader_seconds += std::chrono::duration<double>(end - middle).count();
+  }
+  result.rows = reader_objs.size();
+  result.same = isSame(stream_objs, reader_objs);
+  return result;
+}
+
+std::map<std::string, std::function<Result(const std::string&, int)>> createBenchmarks()
+{
+  std::map<std::string, std::function<Result(const std::string&, int)>> benchmarks;
+  benchmarks["point.csv"] = benchmark<vector_map::Point>;
+  benchmarks["vector.csv"] = benchmark<vector_map::Vector>;
+  benchmarks["line.csv"] = benchmark<vector_map::Line>;
+  benchmarks["area.csv"] = benchmark<vector_map::Area>;
+  benchmarks["pole.csv"] = benchmark<vector_map::Pole>;
+  benchmarks["box.csv"] = benchmark<vector_map::Box>;
+  benchmarks["dtlane.csv"] = benchmark<vector_map::DTLane>;
+  benchmarks["node.csv"] = benchmark<vector_map::Node>;
+  benchmarks["lane.csv"] = benchmark<vector_map::Lane>;
+  benchmarks["wayarea.csv"] = benchmark<vector_map::WayArea>;
+  benchmarks["roadedge.csv"] = benchmark<vector_map::RoadEdge>;
+  benchmarks["gutter.csv"] = benchmark<vector_map::Gutter>;
+  benchmarks["curb.csv"] = benchmark<vector_map::Curb>;
+  benchmarks["whiteline.csv"] = benchmark<vector_map::WhiteLine>;
+  benchmarks["stopline.csv"] = benchmark<vector_map::StopLine>;
+  benchmarks["zebrazone.csv"] = benchmark<vector_map::ZebraZone>;
+  benchmarks["crosswalk.csv"] = benchmark<vector_map::CrossWalk>;
+  benchmarks["road_surface_mark.csv"] = benchmark<vector_map::RoadMark>;
+  benchmarks["poledata.csv"] = benchmark<vector_map::RoadPole>;
+  benchmarks["roadsign.csv"] = benchmark<vector_map::RoadSign>;
+  benchmarks["signaldata.csv"] = benchmark<vector_map::Signal>;
+  benchmarks["streetlight.csv"] = benchmark<vector_map::StreetLight>;
+  benchmarks["utilitypole.csv"] = benchmark<vector_map::UtilityPole>;
+  benchmarks["guardrail.csv"] = benchmark<vector_map::GuardRail>;
+  benchmarks["sidewalk.csv"] = benchmark<vector_map::SideWalk>;
+  benchmarks["driveon_portion.csv"] = benchmark<vector_map::DriveOnPortion>;
+  benchmarks["intersection.csv"] = benchmark<vector_map::CrossRoad>;
+  benchmarks["sidestrip.csv"] = benchmark<vector_map::SideStrip>;
+  benchmarks["curvemirror.csv"] = benchmark<vector_map::CurveMirror>;
+  benchmarks["wall.csv"] = benchmark<vector_map::Wall>;
+  benchmarks["fence.csv"] = benchmark<vector_map::Fence>;
+  benchmarks["railroad_crossing.csv"] = benchmark<vector_map::RailCrossing>;
+  return benchmarks;
+}
+
+void printResult(const std::string& name, double megabytes, size_t rows, double stream_seconds,
+                 double reader_seconds)
+{
+  std::printf("%-22s %10zu %9.1f %12.1f %12.1f %8.1f\n", name.c_str(), rows, megabytes, megabytes / stream_seconds,
+              megabytes / reader_seconds, stream_seconds / reader_seconds);
+}
+} // namespace
+
+// Parse throughput of the Aisan CSV files with the std::istream based parser and with vector_map::parse
+int main(int argc, char** argv)
+{
+  int repeats = 3;
+  std::vector<std::string> file_paths;
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if (arg == "-r" && i + 1 < argc)
+      repeats = std::max(1, std::atoi(argv[++i]));
+    else
+      file_paths.push_back(arg);
+  }
+  if (file_paths.empty())
+  {
+    printUsage();
+    return EXIT_FAILURE;
+  }
+
+  std::map<std::string, std::function<Result(const std::string&, int)>> benchmarks = createBenchmarks();
+
+  std::printf("%-22s %10s %9s %12s %12s %8s\n", "file", "rows", "MB", "stream MB/s", "reader MB/s", "speedup");
+  bool all_same = true;
+  double total_megabytes = 0;
+  size_t total_rows = 0;
+  double total_stream_seconds = 0;
+  double total_reader_seconds = 0;
+  for (const auto& file_path : file_paths)
+  {
+    std::string file_name(basename(const_cast<char*>(file_path.c_str())));
+    auto it = benchmarks.find(file_name);
+    struct stat st;
+    if (it == benchmarks.end() || stat(file_path.c_str(), &st) != 0)
+    {
+      std::cerr << "skipping " << file_path << std::endl;
+      continue;
+    }
+
+    Result result = it->second(file_path, repeats);
+    double megabytes = st.st_size / 1e6;
+    printResult(file_name, megabytes, result.rows, result.stream_seconds / repeats,
+                result.reader_seconds / repeats);
+    if (!result.same)
+    {
+      std::cerr << file_name << ": the parsers disagree" << std::endl;
+      all_same = false;
+    }
+
+    total_megabytes += megabytes;
+    total_rows += result.rows;
+    total_stream_seconds += result.stream_seconds;
+    total_reader_seconds += result.reader_seconds;
+  }
+
+  if (total_reader_seconds > 0)
+    printResult("total", total_megabytes, total_rows, total_stream_seconds / repeats,
+                total_reader_seconds / repeats);
+
+  return all_same ? EXIT_SUCCESS : EXIT_FAILURE;
+}
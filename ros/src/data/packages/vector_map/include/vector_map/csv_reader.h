@@ -0,0 +1,75 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VECTOR_MAP_CSV_READER_H
+#define VECTOR_MAP_CSV_READER_H
+
+#include <stddef.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vector_map
+{
+// Line by line reader of the CSV files of Aisan vector maps. The file is mapped in memory and each line is split in
+// place, so reading a line does not allocate and the columns are parsed straight from the mapping.
+// Columns are split like std::getline(stream, column, separator) does: a separator at the end of a line does not
+// start an extra column. A trailing '\r' is not part of the line.
+class CsvReader
+{
+public:
+  explicit CsvReader(const std::string& file_path, char separator = ',');
+  ~CsvReader();
+
+  CsvReader(const CsvReader&) = delete;
+  CsvReader& operator=(const CsvReader&) = delete;
+
+  bool isOpen() const;
+
+  // Number of lines after the current one
+  size_t countLines() const;
+
+  // Move to the next line, return false at the end of the file
+  bool readLine();
+
+  // Number of columns of the current line, 0 for an empty line
+  size_t size() const;
+
+  std::string getLine() const;
+
+  // Parse a column of the current line like std::strtol and std::strtod do: leading blanks are skipped and parsing
+  // stops at the first character that does not belong to the number. Missing columns read as 0.
+  int getInt(size_t column) const;
+  double getDouble(size_t column) const;
+  std::string getString(size_t column) const;
+
+private:
+  bool open_;
+  const char* begin_;
+  const char* end_;
+  const char* next_; // beginning of the next line
+  void* mapping_;
+  size_t mapping_size_;
+  std::vector<char> buffer_; // contents of the files that cannot be mapped
+  char separator_;
+
+  const char* line_begin_;
+  const char* line_end_;
+  std::vector<std::pair<const char*, const char*>> columns_;
+};
+} // namespace vector_map
+
+#endif // VECTOR_MAP_CSV_READER_H
@@ -17,12 +17,19 @@
 #ifndef VECTOR_MAP_VECTOR_MAP_H
 #define VECTOR_MAP_VECTOR_MAP_H
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <ros/ros.h>
 #include <geometry_msgs/Point.h>
 #include <geometry_msgs/Quaternion.h>
 #include <visualization_msgs/Marker.h>
 
+#include <vector_map/csv_reader.h>
+
 #include <vector_map_msgs/PointArray.h>
 #include <vector_map_msgs/VectorArray.h>
 #include <vector_map_msgs/LineArray.h>
@@ -222,8 +229,126 @@ public:
   }
 };
 
+// Records of one category stored contiguously in id order. Lookups go through a dense id to slot table,
+// or a binary search over the sorted ids when the ids are too sparse for one.
+template <class T>
+class RecordTable
+{
+private:
+  std::vector<T> records_;
+  std::vector<int> ids_;
+  std::vector<int> slots_; // index in records_ of id min_id_ + i, -1 if none
+  int min_id_;
+
+  static const size_t MAX_SLOTS_PER_RECORD = 4;
+
+public:
+  RecordTable()
+    : min_id_(0)
+  {
+  }
+
+  // Replace all records in one pass. Records with id 0 are ignored and, like std::map::insert,
+  // the first record of a duplicated id is kept.
+  template <class IdFunction>
+  void assign(const std::vector<T>& items, IdFunction get_id)
+  {
+    std::vector<std::pair<int, size_t>> order;
+    order.reserve(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+      int id = get_id(items[i]);
+      if (id != 0)
+        order.push_back(std::make_pair(id, i));
+    }
+    std::sort(order.begin(), order.end());
+
+    records_.clear();
+    ids_.clear();
+    slots_.clear();
+    records_.reserve(order.size());
+    ids_.reserve(order.size());
+    for (const auto& pair : order)
+    {
+      if (!ids_.empty() && ids_.back() == pair.first)
+        continue;
+      ids_.push_back(pair.first);
+      records_.push_back(items[pair.second]);
+    }
+
+    min_id_ = ids_.empty() ? 0 : ids_.front();
+    if (ids_.empty())
+      return;
+
+    long long range = static_cast<long long>(ids_.back()) - min_id_ + 1;
+    if (range <= static_cast<long long>(MAX_SLOTS_PER_RECORD * ids_.size()))
+    {
+      slots_.assign(range, -1);
+      for (size_t i = 0; i < ids_.size(); ++i)
+        slots_[ids_[i] - min_id_] = i;
+    }
+  }
+
+  // Return nullptr if there is no record with the id
+  const T* find(int id) const
+  {
+    if (!slots_.empty())
+    {
+      long long slot = static_cast<long long>(id) - min_id_;
+      if (slot < 0 || slot >= static_cast<long long>(slots_.size()) || slots_[slot] < 0)
+        return nullptr;
+      return &records_[slots_[slot]];
+    }
+
+    auto it = std::lower_bound(ids_.begin(), ids_.end(), id);
+    if (it == ids_.end() || *it != id)
+      return nullptr;
+    return &records_[it - ids_.begin()];
+  }
+
+  const std::vector<T>& records() const
+  {
+    return records_;
+  }
+
+  bool empty() const
+  {
+    return records_.empty();
+  }
+};
+
+// Reverse relationship of one category, e.g. lane id -> ids of the stop lines linked to it.
+// The referring ids of each referenced id are kept in the order of the records, i.e. in id order.
+class ReferenceIndex
+{
+private:
+  std::unordered_map<int, std::vector<int>> ids_;
+
+public:
+  // Records with id 0 or reference 0 are ignored
+  template <class T, class IdFunction, class ReferenceFunction>
+  void assign(const std::vector<T>& records, IdFunction get_id, ReferenceFunction get_reference)
+  {
+    ids_.clear();
+    for (const auto& record : records)
+    {
+      int id = get_id(record);
+      int reference = get_reference(record);
+      if (id != 0 && reference != 0)
+        ids_[reference].push_back(id);
+    }
+  }
+
+  const std::vector<int>& find(int reference) const
+  {
+    static const std::vector<int> none;
+    auto it = ids_.find(reference);
+    return (it != ids_.end()) ? it->second : none;
+  }
+};
+
 template <class T, class U>
-using Updater = std::function<void(std::map<Key<T>, T>&, const U&)>;
+using Updater = std::function<void(RecordTable<T>&, const U&)>;
 
 template <class T>
 using Callback = std::function<void(const T&)>;
@@ -238,11 +363,11 @@ private:
   ros::Subscriber sub_;
   Updater<T, U> update_;
   std::vector<Callback<U>> cbs_;
-  std::map<Key<T>, T> map_;
+  RecordTable<T> table_;
 
   void subscribe(const U& msg)
   {
-    update_(map_, msg);
+    update_(table_, msg);
     for (const auto& cb : cbs_)
       cb(msg);
   }
@@ -269,41 +394,82 @@ public:
 
   T findByKey(const Key<T>& key) const
   {
-    auto it = map_.find(key);
-    if (it == map_.end())
+    const T* record = table_.find(key.getId());
+    if (record == nullptr)
       return T();
-    return it->second;
+    return *record;
   }
 
   std::vector<T> findByFilter(const Filter<T>& filter) const
   {
     std::vector<T> vector;
-    for (const auto& pair : map_)
+    for (const auto& record : table_.records())
     {
-      if (filter(pair.second))
-        vector.push_back(pair.second);
+      if (filter(record))
+        vector.push_back(record);
     }
     return vector;
   }
 
+  const std::vector<T>& records() const
+  {
+    return table_.records();
+  }
+
   bool empty() const
   {
-    return map_.empty();
+    return table_.empty();
   }
 };
 
+// Set an object from the columns of the current line of a CSV file
+void readColumns(const CsvReader& reader, Point& obj);
+void readColumns(const CsvReader& reader, Vector& obj);
+void readColumns(const CsvReader& reader, Line& obj);
+void readColumns(const CsvReader& reader, Area& obj);
+void readColumns(const CsvReader& reader, Pole& obj);
+void readColumns(const CsvReader& reader, Box& obj);
+void readColumns(const CsvReader& reader, DTLane& obj);
+void readColumns(const CsvReader& reader, Node& obj);
+void readColumns(const CsvReader& reader, Lane& obj);
+void readColumns(const CsvReader& reader, WayArea& obj);
+void readColumns(const CsvReader& reader, RoadEdge& obj);
+void readColumns(const CsvReader& reader, Gutter& obj);
+void readColumns(const CsvReader& reader, Curb& obj);
+void readColumns(const CsvReader& reader, WhiteLine& obj);
+void readColumns(const CsvReader& reader, StopLine& obj);
+void readColumns(const CsvReader& reader, ZebraZone& obj);
+void readColumns(const CsvReader& reader, CrossWalk& obj);
+void readColumns(const CsvReader& reader, RoadMark& obj);
+void readColumns(const CsvReader& reader, RoadPole& obj);
+void readColumns(const CsvReader& reader, RoadSign& obj);
+void readColumns(const CsvReader& reader, Signal& obj);
+void readColumns(const CsvReader& reader, StreetLight& obj);
+void readColumns(const CsvReader& reader, UtilityPole& obj);
+void readColumns(const CsvReader& reader, GuardRail& obj);
+void readColumns(const CsvReader& reader, SideWalk& obj);
+void readColumns(const CsvReader& reader, DriveOnPortion& obj);
+void readColumns(const CsvReader& reader, CrossRoad& obj);
+void readColumns(const CsvReader& reader, SideStrip& obj);
+void readColumns(const CsvReader& reader, CurveMirror& obj);
+void readColumns(const CsvReader& reader, Wall& obj);
+void readColumns(const CsvReader& reader, Fence& obj);
+void readColumns(const CsvReader& reader, RailCrossing& obj);
+
 template <class T>
 std::vector<T> parse(const std::string& csv_file)
 {
-  std::ifstream ifs(csv_file.c_str());
-  std::string line;
-  std::getline(ifs, line); // remove first line
   std::vector<T> objs;
-  while (std::getline(ifs, line))
+  CsvReader reader(csv_file);
+  if (!reader.readLine()) // remove first line
+    return objs;
+  objs.reserve(reader.countLines());
+  while (reader.readLine())
   {
+    if (reader.size() == 0)
+      continue;
     T obj;
-    std::istringstream iss(line);
-    iss >> obj;
+    readColumns(reader, obj);
     objs.push_back(obj);
   }
   return objs;
@@ -311,40 +477,82 @@ std::vector<T> parse(const std::string& csv_file)
 
 /* namespace */
 /* { */
-/* void updatePoint(std::map<Key<Point>, Point>& map, const PointArray& msg); */
-/* void updateVector(std::map<Key<Vector>, Vector>& map, const VectorArray& msg); */
-/* void updateLine(std::map<Key<Line>, Line>& map, const LineArray& msg); */
-/* void updateArea(std::map<Key<Area>, Area>& map, const AreaArray& msg); */
-/* void updatePole(std::map<Key<Pole>, Pole>& map, const PoleArray& msg); */
-/* void updateBox(std::map<Key<Box>, Box>& map, const BoxArray& msg); */
-/* void updateDTLane(std::map<Key<DTLane>, DTLane>& map, const DTLaneArray& msg); */
-/* void updateNode(std::map<Key<Node>, Node>& map, const NodeArray& msg); */
-/* void updateLane(std::map<Key<Lane>, Lane>& map, const LaneArray& msg); */
-/* void updateWayArea(std::map<Key<WayArea>, WayArea>& map, const WayAreaArray& msg); */
-/* void updateRoadEdge(std::map<Key<RoadEdge>, RoadEdge>& map, const RoadEdgeArray& msg); */
-/* void updateGutter(std::map<Key<Gutter>, Gutter>& map, const GutterArray& msg); */
-/* void updateCurb(std::map<Key<Curb>, Curb>& map, const CurbArray& msg); */
-/* void updateWhiteLine(std::map<Key<WhiteLine>, WhiteLine>& map, const WhiteLineArray& msg); */
-/* void updateStopLine(std::map<Key<StopLine>, StopLine>& map, const StopLineArray& msg); */
-/* void updateZebraZone(std::map<Key<ZebraZone>, ZebraZone>& map, const ZebraZoneArray& msg); */
-/* void updateCrossWalk(std::map<Key<CrossWalk>, CrossWalk>& map, const CrossWalkArray& msg); */
-/* void updateRoadMark(std::map<Key<RoadMark>, RoadMark>& map, const RoadMarkArray& msg); */
-/* void updateRoadPole(std::map<Key<RoadPole>, RoadPole>& map, const RoadPoleArray& msg); */
-/* void updateRoadSign(std::map<Key<RoadSign>, RoadSign>& map, const RoadSignArray& msg); */
-/* void updateSignal(std::map<Key<Signal>, Signal>& map, const SignalArray& msg); */
-/* void updateStreetLight(std::map<Key<StreetLight>, StreetLight>& map, const StreetLightArray& msg); */
-/* void updateUtilityPole(std::map<Key<UtilityPole>, UtilityPole>& map, const UtilityPoleArray& msg); */
-/* void updateGuardRail(std::map<Key<GuardRail>, GuardRail>& map, const GuardRailArray& msg); */
-/* void updateSideWalk(std::map<Key<SideWalk>, SideWalk>& map, const SideWalkArray& msg); */
-/* void updateDriveOnPortion(std::map<Key<DriveOnPortion>, DriveOnPortion>& map, const DriveOnPortionArray& msg); */
-/* void updateCrossRoad(std::map<Key<CrossRoad>, CrossRoad>& map, const CrossRoadArray& msg); */
-/* void updateSideStrip(std::map<Key<SideStrip>, SideStrip>& map, const SideStripArray& msg); */
-/* void updateCurveMirror(std::map<Key<CurveMirror>, CurveMirror>& map, const CurveMirrorArray& msg); */
-/* void updateWall(std::map<Key<Wall>, Wall>& map, const WallArray& msg); */
-/* void updateFence(std::map<Key<Fence>, Fence>& map, const FenceArray& msg); */
-/* void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const RailCrossingArray& msg); */
+/* void updatePoint(RecordTable<Point>& table, const PointArray& msg); */
+/* void updateVector(RecordTable<Vector>& table, const VectorArray& msg); */
+/* void updateLine(RecordTable<Line>& table, const LineArray& msg); */
+/* void updateArea(RecordTable<Area>& table, const AreaArray& msg); */
+/* void updatePole(RecordTable<Pole>& table, const PoleArray& msg); */
+/* void updateBox(RecordTable<Box>& table, const BoxArray& msg); */
+/* void updateDTLane(RecordTable<DTLane>& table, const DTLaneArray& msg); */
+/* void updateNode(RecordTable<Node>& table, const NodeArray& msg); */
+/* void updateLane(RecordTable<Lane>& table, const LaneArray& msg); */
+/* void updateWayArea(RecordTable<WayArea>& table, const WayAreaArray& msg); */
+/* void updateRoadEdge(RecordTable<RoadEdge>& table, const RoadEdgeArray& msg); */
+/* void updateGutter(RecordTable<Gutter>& table, const GutterArray& msg); */
+/* void updateCurb(RecordTable<Curb>& table, const CurbArray& msg); */
+/* void updateWhiteLine(RecordTable<WhiteLine>& table, const WhiteLineArray& msg); */
+/* void updateStopLine(RecordTable<StopLine>& table, const StopLineArray& msg); */
+/* void updateZebraZone(RecordTable<ZebraZone>& table, const ZebraZoneArray& msg); */
+/* void updateCrossWalk(RecordTable<CrossWalk>& table, const CrossWalkArray& msg); */
+/* void updateRoadMark(RecordTable<RoadMark>& table, const RoadMarkArray& msg); */
+/* void updateRoadPole(RecordTable<RoadPole>& table, const RoadPoleArray& msg); */
+/* void updateRoadSign(RecordTable<RoadSign>& table, const RoadSignArray& msg); */
+/* void updateSignal(RecordTable<Signal>& table, const SignalArray& msg); */
+/* void updateStreetLight(RecordTable<StreetLight>& table, const StreetLightArray& msg); */
+/* void updateUtilityPole(RecordTable<UtilityPole>& table, const UtilityPoleArray& msg); */
+/* void updateGuardRail(RecordTable<GuardRail>& table, const GuardRailArray& msg); */
+/* void updateSideWalk(RecordTable<SideWalk>& table, const SideWalkArray& msg); */
+/* void updateDriveOnPortion(RecordTable<DriveOnPortion>& table, const DriveOnPortionArray& msg); */
+/* void updateCrossRoad(RecordTable<CrossRoad>& table, const CrossRoadArray& msg); */
+/* void updateSideStrip(RecordTable<SideStrip>& table, const SideStripArray& msg); */
+/* void updateCurveMirror(RecordTable<CurveMirror>& table, const CurveMirrorArray& msg); */
+/* void updateWall(RecordTable<Wall>& table, const WallArray& msg); */
+/* void updateFence(RecordTable<Fence>& table, const FenceArray& msg); */
+/* void updateRailCrossing(RecordTable<RailCrossing>& table, const RailCrossingArray& msg); */
 /* } // namespace */
 
+// Uniform 2D grid over the geometry of map elements in the map frame (x = Point::ly, y = Point::bx).
+// Each element is a set of segments, a single point being a zero-length segment, and is stored in every
+// cell overlapped by its bounding box. Distances are measured to the segments, heights are ignored.
+class SpatialIndex
+{
+public:
+  struct Segment
+  {
+    double x0;
+    double y0;
+    double x1;
+    double y1;
+  };
+
+  SpatialIndex();
+
+  void clear(double cell_size);
+  void insert(int id, const std::vector<Segment>& segments);
+
+  // Ids of the elements within radius of (x, y) accepted by filter, nearest first
+  std::vector<int> findWithinRadius(double x, double y, double radius, const std::function<bool(int)>& filter) const;
+
+  // Id of the nearest element closer than max_distance to (x, y) accepted by filter, or 0 if there is none
+  int findNearest(double x, double y, double max_distance, const std::function<bool(int)>& filter) const;
+
+  bool empty() const;
+
+private:
+  double cell_size_;
+  int min_cx_;
+  int min_cy_;
+  int max_cx_;
+  int max_cy_;
+  std::vector<int> ids_;
+  std::vector<std::vector<Segment>> segments_;
+  std::unordered_map<unsigned long long, std::vector<size_t>> cells_;
+
+  int toCell(double v) const;
+  unsigned long long cellKey(int cx, int cy) const;
+  double distance(size_t index, double x, double y) const;
+};
+
 class VectorMap
 {
 private:
@@ -381,7 +589,41 @@ private:
   Handle<Fence, FenceArray> fence_;
   Handle<RailCrossing, RailCrossingArray> rail_crossing_;
 
+  double spatial_index_cell_size_;
+  SpatialIndex point_index_;
+  SpatialIndex dtlane_index_;
+  SpatialIndex lane_index_;
+  SpatialIndex stop_line_index_;
+  SpatialIndex cross_walk_index_;
+
+  ReferenceIndex point_node_index_;      // pid -> nodes
+  ReferenceIndex start_node_lane_index_; // bnid -> lanes
+  ReferenceIndex end_node_lane_index_;   // fnid -> lanes
+  ReferenceIndex road_edge_link_index_;
+  ReferenceIndex gutter_link_index_;
+  ReferenceIndex curb_link_index_;
+  ReferenceIndex white_line_link_index_;
+  ReferenceIndex stop_line_link_index_;
+  ReferenceIndex zebra_zone_link_index_;
+  ReferenceIndex cross_walk_link_index_;
+  ReferenceIndex road_mark_link_index_;
+  ReferenceIndex road_pole_link_index_;
+  ReferenceIndex road_sign_link_index_;
+  ReferenceIndex signal_link_index_;
+  ReferenceIndex street_light_link_index_;
+  ReferenceIndex utility_pole_link_index_;
+  ReferenceIndex guard_rail_link_index_;
+  ReferenceIndex side_walk_link_index_;
+  ReferenceIndex drive_on_portion_link_index_;
+  ReferenceIndex cross_road_link_index_;
+  ReferenceIndex side_strip_link_index_;
+  ReferenceIndex curve_mirror_link_index_;
+  ReferenceIndex wall_link_index_;
+  ReferenceIndex fence_link_index_;
+  ReferenceIndex rail_crossing_link_index_;
+
   void registerSubscriber(ros::NodeHandle& nh, category_t category);
+  void updateSpatialIndex(category_t category);
 
 public:
   VectorMap();
@@ -458,6 +700,42 @@ public:
 
   bool hasSubscribed(category_t category) const;
 
+  // Spatial queries are supported for POINT, DTLANE, LANE, STOP_LINE and CROSS_WALK. Like the reverse
+  // relationships, their grid index is built as soon as the categories they depend on are received. Queries take
+  // a position in the map frame and ignore its height.
+  void setSpatialIndexCellSize(double cell_size);
+
+  std::vector<Point> findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                      const Filter<Point>& filter) const;
+  std::vector<DTLane> findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                       const Filter<DTLane>& filter) const;
+  std::vector<Lane> findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                     const Filter<Lane>& filter) const;
+  std::vector<StopLine> findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                         const Filter<StopLine>& filter) const;
+  std::vector<CrossWalk> findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                          const Filter<CrossWalk>& filter) const;
+
+  // Return an empty object if nothing accepted by filter is closer than max_distance
+  Point findNearest(const geometry_msgs::Point& position, double max_distance, const Filter<Point>& filter) const;
+  DTLane findNearest(const geometry_msgs::Point& position, double max_distance, const Filter<DTLane>& filter) const;
+  Lane findNearest(const geometry_msgs::Point& position, double max_distance, const Filter<Lane>& filter) const;
+  StopLine findNearest(const geometry_msgs::Point& position, double max_distance,
+                       const Filter<StopLine>& filter) const;
+  CrossWalk findNearest(const geometry_msgs::Point& position, double max_distance,
+                        const Filter<CrossWalk>& filter) const;
+
+  // Reverse relationships, indexed as soon as their category is received. Like findByFilter, the objects are
+  // returned in id order.
+  std::vector<Node> findNodesByPoint(const Key<Point>& key) const;
+  std::vector<Lane> findLanesByStartNode(const Key<Node>& key) const;
+  std::vector<Lane> findLanesByEndNode(const Key<Node>& key) const;
+
+  // Objects of category T whose linkid is the lane, T being one of the object data categories from RoadEdge to
+  // RailCrossing, e.g. findByLinkId<StopLine>(Key<Lane>(lane.lnid))
+  template <class T>
+  std::vector<T> findByLinkId(const Key<Lane>& key) const;
+
   void registerCallback(const Callback<PointArray>& cb);
   void registerCallback(const Callback<VectorArray>& cb);
   void registerCallback(const Callback<LineArray>& cb);
@@ -492,6 +770,51 @@ public:
   void registerCallback(const Callback<RailCrossingArray>& cb);
 };
 
+template <>
+std::vector<RoadEdge> VectorMap::findByLinkId<RoadEdge>(const Key<Lane>& key) const;
+template <>
+std::vector<Gutter> VectorMap::findByLinkId<Gutter>(const Key<Lane>& key) const;
+template <>
+std::vector<Curb> VectorMap::findByLinkId<Curb>(const Key<Lane>& key) const;
+template <>
+std::vector<WhiteLine> VectorMap::findByLinkId<WhiteLine>(const Key<Lane>& key) const;
+template <>
+std::vector<StopLine> VectorMap::findByLinkId<StopLine>(const Key<Lane>& key) const;
+template <>
+std::vector<ZebraZone> VectorMap::findByLinkId<ZebraZone>(const Key<Lane>& key) const;
+template <>
+std::vector<CrossWalk> VectorMap::findByLinkId<CrossWalk>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadMark> VectorMap::findByLinkId<RoadMark>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadPole> VectorMap::findByLinkId<RoadPole>(const Key<Lane>& key) const;
+template <>
+std::vector<RoadSign> VectorMap::findByLinkId<RoadSign>(const Key<Lane>& key) const;
+template <>
+std::vector<Signal> VectorMap::findByLinkId<Signal>(const Key<Lane>& key) const;
+template <>
+std::vector<StreetLight> VectorMap::findByLinkId<StreetLight>(const Key<Lane>& key) const;
+template <>
+std::vector<UtilityPole> VectorMap::findByLinkId<UtilityPole>(const Key<Lane>& key) const;
+template <>
+std::vector<GuardRail> VectorMap::findByLinkId<GuardRail>(const Key<Lane>& key) const;
+template <>
+std::vector<SideWalk> VectorMap::findByLinkId<SideWalk>(const Key<Lane>& key) const;
+template <>
+std::vector<DriveOnPortion> VectorMap::findByLinkId<DriveOnPortion>(const Key<Lane>& key) const;
+template <>
+std::vector<CrossRoad> VectorMap::findByLinkId<CrossRoad>(const Key<Lane>& key) const;
+template <>
+std::vector<SideStrip> VectorMap::findByLinkId<SideStrip>(const Key<Lane>& key) const;
+template <>
+std::vector<CurveMirror> VectorMap::findByLinkId<CurveMirror>(const Key<Lane>& key) const;
+template <>
+std::vector<Wall> VectorMap::findByLinkId<Wall>(const Key<Lane>& key) const;
+template <>
+std::vector<Fence> VectorMap::findByLinkId<Fence>(const Key<Lane>& key) const;
+template <>
+std::vector<RailCrossing> VectorMap::findByLinkId<RailCrossing>(const Key<Lane>& key) const;
+
 extern const double COLOR_VALUE_MIN;
 extern const double COLOR_VALUE_MAX;
 extern const double COLOR_VALUE_MEDIAN;
@@ -0,0 +1,263 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector_map/csv_reader.h>
+
+namespace vector_map
+{
+namespace
+{
+// Powers of ten that are exact doubles
+const double POWERS_OF_TEN[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+const int MAX_EXACT_POWER_OF_TEN = 22;
+const uint64_t MAX_EXACT_MANTISSA = 1ULL << 53;
+const int MAX_MANTISSA_DIGITS = 19;
+
+bool isBlank(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+bool isDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+const char* skipBlanks(const char* begin, const char* end)
+{
+  while (begin != end && isBlank(*begin))
+    ++begin;
+  return begin;
+}
+
+double parseDoubleSlow(const char* begin, const char* end)
+{
+  char buffer[64];
+  size_t length = end - begin;
+  if (length < sizeof(buffer))
+  {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    return std::strtod(buffer, nullptr);
+  }
+  return std::strtod(std::string(begin, end).c_str(), nullptr);
+}
+
+// Plain decimals whose digits fit in a double are computed with one exactly rounded multiplication or division,
+// which gives the same result as std::strtod. Anything else (exponents, long mantissas, inf, nan, hexadecimal
+// numbers) goes through std::strtod.
+double parseDouble(const char* begin, const char* end)
+{
+  const char* p = skipBlanks(begin, end);
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  uint64_t mantissa = 0;
+  int digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  for (; p != end && isDigit(*p); ++p)
+  {
+    if (mantissa != 0 || *p != '0')
+    {
+      if (++digits > MAX_MANTISSA_DIGITS)
+        return parseDoubleSlow(begin, end);
+    }
+    mantissa = mantissa * 10 + (*p - '0');
+    has_digits = true;
+  }
+  if (p != end && *p == '.')
+  {
+    for (++p; p != end && isDigit(*p); ++p)
+    {
+      if (mantissa != 0 || *p != '0')
+      {
+        if (++digits > MAX_MANTISSA_DIGITS)
+          return parseDoubleSlow(begin, end);
+      }
+      mantissa = mantissa * 10 + (*p - '0');
+      --exponent;
+      has_digits = true;
+    }
+  }
+
+  if (!has_digits || skipBlanks(p, end) != end || mantissa > MAX_EXACT_MANTISSA ||
+      exponent < -MAX_EXACT_POWER_OF_TEN)
+    return parseDoubleSlow(begin, end);
+
+  double value = static_cast<double>(mantissa) / POWERS_OF_TEN[-exponent];
+  return negative ? -value : value;
+}
+
+int parseInt(const char* begin, const char* end)
+{
+  const char* p = skipBlanks(begin, end);
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+  {
+    negative = (*p == '-');
+    ++p;
+  }
+
+  long long value = 0;
+  for (; p != end && isDigit(*p); ++p)
+  {
+    if (value < (1LL << 40))
+      value = value * 10 + (*p - '0');
+  }
+  return static_cast<int>(negative ? -value : value);
+}
+} // namespace
+
+CsvReader::CsvReader(const std::string& file_path, char separator)
+  : open_(false)
+  , begin_(nullptr)
+  , end_(nullptr)
+  , next_(nullptr)
+  , mapping_(nullptr)
+  , mapping_size_(0)
+  , separator_(separator)
+  , line_begin_(nullptr)
+  , line_end_(nullptr)
+{
+  int fd = ::open(file_path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+  {
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping != MAP_FAILED)
+    {
+      madvise(mapping, st.st_size, MADV_SEQUENTIAL);
+      mapping_ = mapping;
+      mapping_size_ = st.st_size;
+      begin_ = static_cast<const char*>(mapping);
+      end_ = begin_ + mapping_size_;
+    }
+  }
+  ::close(fd);
+
+  if (mapping_ == nullptr)
+  {
+    std::ifstream ifs(file_path.c_str(), std::ios::binary);
+    if (!ifs)
+      return;
+    buffer_.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+    begin_ = buffer_.data();
+    end_ = begin_ + buffer_.size();
+  }
+
+  next_ = begin_;
+  open_ = true;
+}
+
+CsvReader::~CsvReader()
+{
+  if (mapping_ != nullptr)
+    munmap(mapping_, mapping_size_);
+}
+
+bool CsvReader::isOpen() const
+{
+  return open_;
+}
+
+size_t CsvReader::countLines() const
+{
+  if (next_ == end_)
+    return 0;
+  size_t lines = std::count(next_, end_, '\n');
+  if (end_[-1] != '\n')
+    ++lines;
+  return lines;
+}
+
+bool CsvReader::readLine()
+{
+  columns_.clear();
+  if (next_ == end_)
+    return false;
+
+  line_begin_ = next_;
+  const char* newline = static_cast<const char*>(std::memchr(next_, '\n', end_ - next_));
+  line_end_ = (newline != nullptr) ? newline : end_;
+  next_ = (newline != nullptr) ? newline + 1 : end_;
+  if (line_end_ != line_begin_ && line_end_[-1] == '\r')
+    --line_end_;
+
+  const char* column = line_begin_;
+  while (column != line_end_)
+  {
+    const char* separator = static_cast<const char*>(std::memchr(column, separator_, line_end_ - column));
+    if (separator == nullptr)
+    {
+      columns_.push_back(std::make_pair(column, line_end_));
+      break;
+    }
+    columns_.push_back(std::make_pair(column, separator));
+    column = separator + 1;
+  }
+  return true;
+}
+
+size_t CsvReader::size() const
+{
+  return columns_.size();
+}
+
+std::string CsvReader::getLine() const
+{
+  return std::string(line_begin_, line_end_);
+}
+
+int CsvReader::getInt(size_t column) const
+{
+  if (column >= columns_.size())
+    return 0;
+  return parseInt(columns_[column].first, columns_[column].second);
+}
+
+double CsvReader::getDouble(size_t column) const
+{
+  if (column >= columns_.size())
+    return 0;
+  return parseDouble(columns_[column].first, columns_[column].second);
+}
+
+std::string CsvReader::getString(size_t column) const
+{
+  if (column >= columns_.size())
+    return std::string();
+  return std::string(columns_[column].first, columns_[column].second);
+}
+} // namespace vector_map
@@ -14,6 +14,9 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <tf/transform_datatypes.h>
 #include <vector_map/vector_map.h>
 
@@ -21,358 +24,507 @@ namespace vector_map
 {
 namespace
 {
-void updatePoint(std::map<Key<Point>, Point>& map, const PointArray& msg)
+void updatePoint(RecordTable<Point>& table, const PointArray& msg)
 {
-  map = std::map<Key<Point>, Point>();
-  for (const auto& item : msg.data)
-  {
-    if (item.pid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Point>(item.pid), item));
-  }
+  table.assign(msg.data, [](const Point& item) { return item.pid; });
 }
 
-void updateVector(std::map<Key<Vector>, Vector>& map, const VectorArray& msg)
+void updateVector(RecordTable<Vector>& table, const VectorArray& msg)
 {
-  map = std::map<Key<Vector>, Vector>();
-  for (const auto& item : msg.data)
-  {
-    if (item.vid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Vector>(item.vid), item));
-  }
+  table.assign(msg.data, [](const Vector& item) { return item.vid; });
 }
 
-void updateLine(std::map<Key<Line>, Line>& map, const LineArray& msg)
+void updateLine(RecordTable<Line>& table, const LineArray& msg)
 {
-  map = std::map<Key<Line>, Line>();
-  for (const auto& item : msg.data)
-  {
-    if (item.lid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Line>(item.lid), item));
-  }
+  table.assign(msg.data, [](const Line& item) { return item.lid; });
 }
 
-void updateArea(std::map<Key<Area>, Area>& map, const AreaArray& msg)
+void updateArea(RecordTable<Area>& table, const AreaArray& msg)
 {
-  map = std::map<Key<Area>, Area>();
-  for (const auto& item : msg.data)
-  {
-    if (item.aid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Area>(item.aid), item));
-  }
+  table.assign(msg.data, [](const Area& item) { return item.aid; });
 }
 
-void updatePole(std::map<Key<Pole>, Pole>& map, const PoleArray& msg)
+void updatePole(RecordTable<Pole>& table, const PoleArray& msg)
 {
-  map = std::map<Key<Pole>, Pole>();
-  for (const auto& item : msg.data)
-  {
-    if (item.plid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Pole>(item.plid), item));
-  }
+  table.assign(msg.data, [](const Pole& item) { return item.plid; });
 }
 
-void updateBox(std::map<Key<Box>, Box>& map, const BoxArray& msg)
+void updateBox(RecordTable<Box>& table, const BoxArray& msg)
 {
-  map = std::map<Key<Box>, Box>();
-  for (const auto& item : msg.data)
-  {
-    if (item.bid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Box>(item.bid), item));
-  }
+  table.assign(msg.data, [](const Box& item) { return item.bid; });
 }
 
-void updateDTLane(std::map<Key<DTLane>, DTLane>& map, const DTLaneArray& msg)
+void updateDTLane(RecordTable<DTLane>& table, const DTLaneArray& msg)
 {
-  map = std::map<Key<DTLane>, DTLane>();
-  for (const auto& item : msg.data)
-  {
-    if (item.did == 0)
-      continue;
-    map.insert(std::make_pair(Key<DTLane>(item.did), item));
-  }
+  table.assign(msg.data, [](const DTLane& item) { return item.did; });
 }
 
-void updateNode(std::map<Key<Node>, Node>& map, const NodeArray& msg)
+void updateNode(RecordTable<Node>& table, const NodeArray& msg)
 {
-  map = std::map<Key<Node>, Node>();
-  for (const auto& item : msg.data)
-  {
-    if (item.nid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Node>(item.nid), item));
-  }
+  table.assign(msg.data, [](const Node& item) { return item.nid; });
 }
 
-void updateLane(std::map<Key<Lane>, Lane>& map, const LaneArray& msg)
+void updateLane(RecordTable<Lane>& table, const LaneArray& msg)
 {
-  map = std::map<Key<Lane>, Lane>();
-  for (const auto& item : msg.data)
-  {
-    if (item.lnid == 0)
-      continue;
-    map.insert(std::make_pair(Key<Lane>(item.lnid), item));
-  }
+  table.assign(msg.data, [](const Lane& item) { return item.lnid; });
 }
 
-void updateWayArea(std::map<Key<WayArea>, WayArea>& map, const WayAreaArray& msg)
+void updateWayArea(RecordTable<WayArea>& table, const WayAreaArray& msg)
 {
-  map = std::map<Key<WayArea>, WayArea>();
-  for (const auto& item : msg.data)
-  {
-    if (item.waid == 0)
-      continue;
-    map.insert(std::make_pair(Key<WayArea>(item.waid), item));
-  }
+  table.assign(msg.data, [](const WayArea& item) { return item.waid; });
 }
 
-void updateRoadEdge(std::map<Key<RoadEdge>, RoadEdge>& map, const RoadEdgeArray& msg)
+void updateRoadEdge(RecordTable<RoadEdge>& table, const RoadEdgeArray& msg)
 {
-  map = std::map<Key<RoadEdge>, RoadEdge>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<RoadEdge>(item.id), item));
-  }
+  table.assign(msg.data, [](const RoadEdge& item) { return item.id; });
 }
 
-void updateGutter(std::map<Key<Gutter>, Gutter>& map, const GutterArray& msg)
+void updateGutter(RecordTable<Gutter>& table, const GutterArray& msg)
 {
-  map = std::map<Key<Gutter>, Gutter>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<Gutter>(item.id), item));
-  }
+  table.assign(msg.data, [](const Gutter& item) { return item.id; });
 }
 
-void updateCurb(std::map<Key<Curb>, Curb>& map, const CurbArray& msg)
+void updateCurb(RecordTable<Curb>& table, const CurbArray& msg)
 {
-  map = std::map<Key<Curb>, Curb>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<Curb>(item.id), item));
-  }
+  table.assign(msg.data, [](const Curb& item) { return item.id; });
 }
 
-void updateWhiteLine(std::map<Key<WhiteLine>, WhiteLine>& map, const WhiteLineArray& msg)
+void updateWhiteLine(RecordTable<WhiteLine>& table, const WhiteLineArray& msg)
 {
-  map = std::map<Key<WhiteLine>, WhiteLine>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<WhiteLine>(item.id), item));
-  }
+  table.assign(msg.data, [](const WhiteLine& item) { return item.id; });
 }
 
-void updateStopLine(std::map<Key<StopLine>, StopLine>& map, const StopLineArray& msg)
+void updateStopLine(RecordTable<StopLine>& table, const StopLineArray& msg)
 {
-  map = std::map<Key<StopLine>, StopLine>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<StopLine>(item.id), item));
-  }
+  table.assign(msg.data, [](const StopLine& item) { return item.id; });
 }
 
-void updateZebraZone(std::map<Key<ZebraZone>, ZebraZone>& map, const ZebraZoneArray& msg)
+void updateZebraZone(RecordTable<ZebraZone>& table, const ZebraZoneArray& msg)
 {
-  map = std::map<Key<ZebraZone>, ZebraZone>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<ZebraZone>(item.id), item));
-  }
+  table.assign(msg.data, [](const ZebraZone& item) { return item.id; });
 }
 
-void updateCrossWalk(std::map<Key<CrossWalk>, CrossWalk>& map, const CrossWalkArray& msg)
+void updateCrossWalk(RecordTable<CrossWalk>& table, const CrossWalkArray& msg)
 {
-  map = std::map<Key<CrossWalk>, CrossWalk>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<CrossWalk>(item.id), item));
-  }
+  table.assign(msg.data, [](const CrossWalk& item) { return item.id; });
 }
 
-void updateRoadMark(std::map<Key<RoadMark>, RoadMark>& map, const RoadMarkArray& msg)
+void updateRoadMark(RecordTable<RoadMark>& table, const RoadMarkArray& msg)
 {
-  map = std::map<Key<RoadMark>, RoadMark>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<RoadMark>(item.id), item));
-  }
+  table.assign(msg.data, [](const RoadMark& item) { return item.id; });
 }
 
-void updateRoadPole(std::map<Key<RoadPole>, RoadPole>& map, const RoadPoleArray& msg)
+void updateRoadPole(RecordTable<RoadPole>& table, const RoadPoleArray& msg)
 {
-  map = std::map<Key<RoadPole>, RoadPole>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<RoadPole>(item.id), item));
-  }
+  table.assign(msg.data, [](const RoadPole& item) { return item.id; });
 }
 
-void updateRoadSign(std::map<Key<RoadSign>, RoadSign>& map, const RoadSignArray& msg)
+void updateRoadSign(RecordTable<RoadSign>& table, const RoadSignArray& msg)
 {
-  map = std::map<Key<RoadSign>, RoadSign>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<RoadSign>(item.id), item));
-  }
+  table.assign(msg.data, [](const RoadSign& item) { return item.id; });
 }
 
-void updateSignal(std::map<Key<Signal>, Signal>& map, const SignalArray& msg)
+void updateSignal(RecordTable<Signal>& table, const SignalArray& msg)
 {
-  map = std::map<Key<Signal>, Signal>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<Signal>(item.id), item));
-  }
+  table.assign(msg.data, [](const Signal& item) { return item.id; });
 }
 
-void updateStreetLight(std::map<Key<StreetLight>, StreetLight>& map, const StreetLightArray& msg)
+void updateStreetLight(RecordTable<StreetLight>& table, const StreetLightArray& msg)
 {
-  map = std::map<Key<StreetLight>, StreetLight>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<StreetLight>(item.id), item));
-  }
+  table.assign(msg.data, [](const StreetLight& item) { return item.id; });
 }
 
-void updateUtilityPole(std::map<Key<UtilityPole>, UtilityPole>& map, const UtilityPoleArray& msg)
+void updateUtilityPole(RecordTable<UtilityPole>& table, const UtilityPoleArray& msg)
 {
-  map = std::map<Key<UtilityPole>, UtilityPole>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<UtilityPole>(item.id), item));
-  }
+  table.assign(msg.data, [](const UtilityPole& item) { return item.id; });
 }
 
-void updateGuardRail(std::map<Key<GuardRail>, GuardRail>& map, const GuardRailArray& msg)
+void updateGuardRail(RecordTable<GuardRail>& table, const GuardRailArray& msg)
 {
-  map = std::map<Key<GuardRail>, GuardRail>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<GuardRail>(item.id), item));
-  }
+  table.assign(msg.data, [](const GuardRail& item) { return item.id; });
 }
 
-void updateSideWalk(std::map<Key<SideWalk>, SideWalk>& map, const SideWalkArray& msg)
+void updateSideWalk(RecordTable<SideWalk>& table, const SideWalkArray& msg)
 {
-  map = std::map<Key<SideWalk>, SideWalk>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<SideWalk>(item.id), item));
-  }
+  table.assign(msg.data, [](const SideWalk& item) { return item.id; });
 }
 
-void updateDriveOnPortion(std::map<Key<DriveOnPortion>, DriveOnPortion>& map, const DriveOnPortionArray& msg)
+void updateDriveOnPortion(RecordTable<DriveOnPortion>& table, const DriveOnPortionArray& msg)
 {
-  map = std::map<Key<DriveOnPortion>, DriveOnPortion>();
-  for (const auto& item : msg.data)
-  {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<DriveOnPortion>(item.id), item));
-  }
+  table.assign(msg.data, [](const DriveOnPortion& item) { return item.id; });
+}
+
+void updateCrossRoad(RecordTable<CrossRoad>& table, const CrossRoadArray& msg)
+{
+  table.assign(msg.data, [](const CrossRoad& item) { return item.id; });
+}
+
+void updateSideStrip(RecordTable<SideStrip>& table, const SideStripArray& msg)
+{
+  table.assign(msg.data, [](const SideStrip& item) { return item.id; });
+}
+
+void updateCurveMirror(RecordTable<CurveMirror>& table, const CurveMirrorArray& msg)
+{
+  table.assign(msg.data, [](const CurveMirror& item) { return item.id; });
+}
+
+void updateWall(RecordTable<Wall>& table, const WallArray& msg)
+{
+  table.assign(msg.data, [](const Wall& item) { return item.id; });
+}
+
+void updateFence(RecordTable<Fence>& table, const FenceArray& msg)
+{
+  table.assign(msg.data, [](const Fence& item) { return item.id; });
+}
+
+void updateRailCrossing(RecordTable<RailCrossing>& table, const RailCrossingArray& msg)
+{
+  table.assign(msg.data, [](const RailCrossing& item) { return item.id; });
+}
+
+SpatialIndex::Segment createSegment(const Point& bp, const Point& fp)
+{
+  SpatialIndex::Segment segment;
+  segment.x0 = bp.ly;
+  segment.y0 = bp.bx;
+  segment.x1 = fp.ly;
+  segment.y1 = fp.bx;
+  return segment;
+}
+
+std::vector<SpatialIndex::Segment> createGeometry(const VectorMap& vmap, const Point& point)
+{
+  std::vector<SpatialIndex::Segment> segments;
+  segments.push_back(createSegment(point, point));
+  return segments;
+}
+
+std::vector<SpatialIndex::Segment> createGeometry(const VectorMap& vmap, const DTLane& dtlane)
+{
+  std::vector<SpatialIndex::Segment> segments;
+  Point point = vmap.findByKey(Key<Point>(dtlane.pid));
+  if (point.pid == 0)
+    return segments;
+
+  segments.push_back(createSegment(point, point));
+  return segments;
+}
+
+std::vector<SpatialIndex::Segment> createGeometry(const VectorMap& vmap, const Lane& lane)
+{
+  std::vector<SpatialIndex::Segment> segments;
+  Node bn = vmap.findByKey(Key<Node>(lane.bnid));
+  Point bp = vmap.findByKey(Key<Point>(bn.pid));
+  if (bp.pid == 0)
+    return segments;
+
+  Node fn = vmap.findByKey(Key<Node>(lane.fnid));
+  Point fp = vmap.findByKey(Key<Point>(fn.pid));
+  if (fp.pid == 0)
+    return segments;
+
+  segments.push_back(createSegment(bp, fp));
+  return segments;
+}
+
+std::vector<SpatialIndex::Segment> createGeometry(const VectorMap& vmap, const StopLine& stop_line)
+{
+  std::vector<SpatialIndex::Segment> segments;
+  Line line = vmap.findByKey(Key<Line>(stop_line.lid));
+  Point bp = vmap.findByKey(Key<Point>(line.bpid));
+  if (bp.pid == 0)
+    return segments;
+
+  Point fp = vmap.findByKey(Key<Point>(line.fpid));
+  if (fp.pid == 0)
+    return segments;
+
+  segments.push_back(createSegment(bp, fp));
+  return segments;
 }
 
-void updateCrossRoad(std::map<Key<CrossRoad>, CrossRoad>& map, const CrossRoadArray& msg)
+std::vector<SpatialIndex::Segment> createGeometry(const VectorMap& vmap, const CrossWalk& cross_walk)
 {
-  map = std::map<Key<CrossRoad>, CrossRoad>();
-  for (const auto& item : msg.data)
+  // Same line chain as createAreaMarker
+  std::vector<SpatialIndex::Segment> segments;
+  Area area = vmap.findByKey(Key<Area>(cross_walk.aid));
+  if (area.aid == 0)
+    return segments;
+
+  Line line = vmap.findByKey(Key<Line>(area.slid));
+  while (line.lid != 0)
   {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<CrossRoad>(item.id), item));
+    Point bp = vmap.findByKey(Key<Point>(line.bpid));
+    Point fp = vmap.findByKey(Key<Point>(line.fpid));
+    if (bp.pid == 0 || fp.pid == 0)
+      break;
+
+    segments.push_back(createSegment(bp, fp));
+
+    if (line.lid == area.elid || line.flid == 0 || line.flid == area.slid)
+      break;
+    line = vmap.findByKey(Key<Line>(line.flid));
   }
+  return segments;
 }
 
-void updateSideStrip(std::map<Key<SideStrip>, SideStrip>& map, const SideStripArray& msg)
+template <class T>
+void updateLinkIndex(ReferenceIndex& index, const std::vector<T>& objs)
 {
-  map = std::map<Key<SideStrip>, SideStrip>();
-  for (const auto& item : msg.data)
+  index.assign(objs, [](const T& obj) { return obj.id; }, [](const T& obj) { return obj.linkid; });
+}
+
+template <class T, class U>
+std::vector<T> findByReference(const Handle<T, U>& handle, const ReferenceIndex& index, int reference)
+{
+  const std::vector<int>& ids = index.find(reference);
+  std::vector<T> objs;
+  objs.reserve(ids.size());
+  for (int id : ids)
+    objs.push_back(handle.findByKey(Key<T>(id)));
+  return objs;
+}
+
+template <class T>
+void buildSpatialIndex(const VectorMap& vmap, const std::vector<T>& objs, const std::function<int(const T&)>& get_id,
+                       double cell_size, SpatialIndex& index)
+{
+  index.clear(cell_size);
+  for (const auto& obj : objs)
   {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<SideStrip>(item.id), item));
+    std::vector<SpatialIndex::Segment> segments = createGeometry(vmap, obj);
+    if (!segments.empty())
+      index.insert(get_id(obj), segments);
   }
 }
 
-void updateCurveMirror(std::map<Key<CurveMirror>, CurveMirror>& map, const CurveMirrorArray& msg)
+template <class T>
+std::vector<T> findWithinRadiusInIndex(const VectorMap& vmap, const SpatialIndex& index,
+                                       const geometry_msgs::Point& position, double radius, const Filter<T>& filter)
 {
-  map = std::map<Key<CurveMirror>, CurveMirror>();
-  for (const auto& item : msg.data)
+  std::vector<int> ids = index.findWithinRadius(position.x, position.y, radius, [&vmap, &filter](int id) {
+    return filter(vmap.findByKey(Key<T>(id)));
+  });
+
+  std::vector<T> objs;
+  objs.reserve(ids.size());
+  for (int id : ids)
+    objs.push_back(vmap.findByKey(Key<T>(id)));
+  return objs;
+}
+
+template <class T>
+T findNearestInIndex(const VectorMap& vmap, const SpatialIndex& index, const geometry_msgs::Point& position,
+                     double max_distance, const Filter<T>& filter)
+{
+  int id = index.findNearest(position.x, position.y, max_distance, [&vmap, &filter](int candidate) {
+    return filter(vmap.findByKey(Key<T>(candidate)));
+  });
+  if (id == 0)
+    return T();
+  return vmap.findByKey(Key<T>(id));
+}
+} // namespace
+
+SpatialIndex::SpatialIndex()
+  : cell_size_(1.0), min_cx_(0), min_cy_(0), max_cx_(-1), max_cy_(-1)
+{
+}
+
+void SpatialIndex::clear(double cell_size)
+{
+  cell_size_ = cell_size;
+  min_cx_ = min_cy_ = 0;
+  max_cx_ = max_cy_ = -1;
+  ids_.clear();
+  segments_.clear();
+  cells_.clear();
+}
+
+int SpatialIndex::toCell(double v) const
+{
+  return static_cast<int>(std::floor(v / cell_size_));
+}
+
+unsigned long long SpatialIndex::cellKey(int cx, int cy) const
+{
+  return (static_cast<unsigned long long>(static_cast<unsigned int>(cx)) << 32) | static_cast<unsigned int>(cy);
+}
+
+void SpatialIndex::insert(int id, const std::vector<Segment>& segments)
+{
+  double min_x = std::numeric_limits<double>::max();
+  double min_y = std::numeric_limits<double>::max();
+  double max_x = -std::numeric_limits<double>::max();
+  double max_y = -std::numeric_limits<double>::max();
+  for (const auto& segment : segments)
   {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<CurveMirror>(item.id), item));
+    min_x = std::min(min_x, std::min(segment.x0, segment.x1));
+    min_y = std::min(min_y, std::min(segment.y0, segment.y1));
+    max_x = std::max(max_x, std::max(segment.x0, segment.x1));
+    max_y = std::max(max_y, std::max(segment.y0, segment.y1));
+  }
+
+  size_t index = ids_.size();
+  ids_.push_back(id);
+  segments_.push_back(segments);
+
+  int min_cx = toCell(min_x);
+  int min_cy = toCell(min_y);
+  int max_cx = toCell(max_x);
+  int max_cy = toCell(max_y);
+  for (int cx = min_cx; cx <= max_cx; ++cx)
+  {
+    for (int cy = min_cy; cy <= max_cy; ++cy)
+      cells_[cellKey(cx, cy)].push_back(index);
+  }
+
+  if (index == 0)
+  {
+    min_cx_ = min_cx;
+    min_cy_ = min_cy;
+    max_cx_ = max_cx;
+    max_cy_ = max_cy;
+  }
+  else
+  {
+    min_cx_ = std::min(min_cx_, min_cx);
+    min_cy_ = std::min(min_cy_, min_cy);
+    max_cx_ = std::max(max_cx_, max_cx);
+    max_cy_ = std::max(max_cy_, max_cy);
   }
 }
 
-void updateWall(std::map<Key<Wall>, Wall>& map, const WallArray& msg)
+double SpatialIndex::distance(size_t index, double x, double y) const
 {
-  map = std::map<Key<Wall>, Wall>();
-  for (const auto& item : msg.data)
+  double min_distance = std::numeric_limits<double>::max();
+  for (const auto& segment : segments_[index])
   {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<Wall>(item.id), item));
+    double dx = segment.x1 - segment.x0;
+    double dy = segment.y1 - segment.y0;
+    double length2 = dx * dx + dy * dy;
+    double t = (length2 > 0.0) ? ((x - segment.x0) * dx + (y - segment.y0) * dy) / length2 : 0.0;
+    t = std::max(0.0, std::min(1.0, t));
+    min_distance = std::min(min_distance, std::hypot(segment.x0 + t * dx - x, segment.y0 + t * dy - y));
   }
+  return min_distance;
 }
 
-void updateFence(std::map<Key<Fence>, Fence>& map, const FenceArray& msg)
+std::vector<int> SpatialIndex::findWithinRadius(double x, double y, double radius,
+                                                const std::function<bool(int)>& filter) const
 {
-  map = std::map<Key<Fence>, Fence>();
-  for (const auto& item : msg.data)
+  std::vector<int> ids;
+  if (ids_.empty() || radius < 0.0)
+    return ids;
+
+  std::vector<size_t> candidates;
+  int min_cx = std::max(toCell(x - radius), min_cx_);
+  int min_cy = std::max(toCell(y - radius), min_cy_);
+  int max_cx = std::min(toCell(x + radius), max_cx_);
+  int max_cy = std::min(toCell(y + radius), max_cy_);
+  if (min_cx > max_cx || min_cy > max_cy)
+    return ids;
+
+  if (static_cast<double>(max_cx - min_cx + 1) * (max_cy - min_cy + 1) > ids_.size())
   {
-    if (item.id == 0)
-      continue;
-    map.insert(std::make_pair(Key<Fence>(item.id), item));
+    // Large radius, checking every element is cheaper than visiting the cells
+    candidates.resize(ids_.size());
+    for (size_t i = 0; i < candidates.size(); ++i)
+      candidates[i] = i;
+  }
+  else
+  {
+    for (int cx = min_cx; cx <= max_cx; ++cx)
+    {
+      for (int cy = min_cy; cy <= max_cy; ++cy)
+      {
+        auto it = cells_.find(cellKey(cx, cy));
+        if (it != cells_.end())
+          candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
   }
+
+  std::vector<std::pair<double, int>> found;
+  for (size_t index : candidates)
+  {
+    double d = distance(index, x, y);
+    if (d <= radius && filter(ids_[index]))
+      found.push_back(std::make_pair(d, ids_[index]));
+  }
+  std::sort(found.begin(), found.end());
+
+  ids.reserve(found.size());
+  for (const auto& pair : found)
+    ids.push_back(pair.second);
+  return ids;
 }
 
-void updateRailCrossing(std::map<Key<RailCrossing>, RailCrossing>& map, const RailCrossingArray& msg)
+int SpatialIndex::findNearest(double x, double y, double max_distance, const std::function<bool(int)>& filter) const
 {
-  map = std::map<Key<RailCrossing>, RailCrossing>();
-  for (const auto& item : msg.data)
+  if (ids_.empty() || max_distance <= 0.0)
+    return 0;
+
+  int cx = toCell(x);
+  int cy = toCell(y);
+
+  // Visit rings of cells around the query cell, starting from the first ring reaching the grid.
+  // Elements first found in ring r are at least (r - 1) * cell_size_ away.
+  int min_ring = std::max(std::max(std::max(min_cx_ - cx, cx - max_cx_), std::max(min_cy_ - cy, cy - max_cy_)), 0);
+  int max_ring = std::max(std::max(std::abs(cx - min_cx_), std::abs(cx - max_cx_)),
+                          std::max(std::abs(cy - min_cy_), std::abs(cy - max_cy_)));
+  double best_distance = std::numeric_limits<double>::max();
+  int best_id = 0;
+
+  auto visit = [&](int i, int j) {
+    if (i < min_cx_ || i > max_cx_ || j < min_cy_ || j > max_cy_)
+      return;
+    auto it = cells_.find(cellKey(i, j));
+    if (it == cells_.end())
+      return;
+    for (size_t index : it->second)
+    {
+      double d = distance(index, x, y);
+      if (d < best_distance && d < max_distance && filter(ids_[index]))
+      {
+        best_distance = d;
+        best_id = ids_[index];
+      }
+    }
+  };
+
+  for (int r = min_ring; r <= max_ring; ++r)
   {
-    if (item.id == 0)
+    if ((r - 1) * cell_size_ > std::min(best_distance, max_distance))
+      break;
+
+    if (r == 0)
+    {
+      visit(cx, cy);
       continue;
-    map.insert(std::make_pair(Key<RailCrossing>(item.id), item));
+    }
+    for (int i = cx - r; i <= cx + r; ++i)
+    {
+      visit(i, cy - r);
+      visit(i, cy + r);
+    }
+    for (int j = cy - r + 1; j <= cy + r - 1; ++j)
+    {
+      visit(cx - r, j);
+      visit(cx + r, j);
+    }
   }
+  return best_id;
+}
+
+bool SpatialIndex::empty() const
+{
+  return ids_.empty();
 }
-} // namespace
 
 bool VectorMap::hasSubscribed(category_t category) const
 {
@@ -701,10 +853,162 @@ void VectorMap::registerSubscriber(ros::NodeHandle& nh, category_t category)
     rail_crossing_.registerSubscriber(nh, "/vector_map_info/rail_crossing");
     rail_crossing_.registerUpdater(updateRailCrossing);
   }
+
+  // Spatial indexes depend on the categories their geometry is made of
+  if (category & POINT)
+    point_.registerCallback([this](const PointArray& msg) {
+      updateSpatialIndex(POINT | DTLANE | LANE | STOP_LINE | CROSS_WALK);
+    });
+  if (category & LINE)
+    line_.registerCallback([this](const LineArray& msg) { updateSpatialIndex(STOP_LINE | CROSS_WALK); });
+  if (category & AREA)
+    area_.registerCallback([this](const AreaArray& msg) { updateSpatialIndex(CROSS_WALK); });
+  if (category & DTLANE)
+    dtlane_.registerCallback([this](const DTLaneArray& msg) { updateSpatialIndex(DTLANE); });
+  if (category & NODE)
+    node_.registerCallback([this](const NodeArray& msg) { updateSpatialIndex(LANE); });
+  if (category & LANE)
+    lane_.registerCallback([this](const LaneArray& msg) { updateSpatialIndex(LANE); });
+  if (category & STOP_LINE)
+    stop_line_.registerCallback([this](const StopLineArray& msg) { updateSpatialIndex(STOP_LINE); });
+  if (category & CROSS_WALK)
+    cross_walk_.registerCallback([this](const CrossWalkArray& msg) { updateSpatialIndex(CROSS_WALK); });
+
+  // Reverse relationship indexes
+  if (category & NODE)
+    node_.registerCallback([this](const NodeArray& msg) {
+      point_node_index_.assign(node_.records(), [](const Node& node) { return node.nid; },
+                               [](const Node& node) { return node.pid; });
+    });
+  if (category & LANE)
+    lane_.registerCallback([this](const LaneArray& msg) {
+      start_node_lane_index_.assign(lane_.records(), [](const Lane& lane) { return lane.lnid; },
+                                    [](const Lane& lane) { return lane.bnid; });
+      end_node_lane_index_.assign(lane_.records(), [](const Lane& lane) { return lane.lnid; },
+                                  [](const Lane& lane) { return lane.fnid; });
+    });
+  if (category & ROAD_EDGE)
+    road_edge_.registerCallback([this](const RoadEdgeArray& msg) {
+      updateLinkIndex(road_edge_link_index_, road_edge_.records());
+    });
+  if (category & GUTTER)
+    gutter_.registerCallback([this](const GutterArray& msg) {
+      updateLinkIndex(gutter_link_index_, gutter_.records());
+    });
+  if (category & CURB)
+    curb_.registerCallback([this](const CurbArray& msg) {
+      updateLinkIndex(curb_link_index_, curb_.records());
+    });
+  if (category & WHITE_LINE)
+    white_line_.registerCallback([this](const WhiteLineArray& msg) {
+      updateLinkIndex(white_line_link_index_, white_line_.records());
+    });
+  if (category & STOP_LINE)
+    stop_line_.registerCallback([this](const StopLineArray& msg) {
+      updateLinkIndex(stop_line_link_index_, stop_line_.records());
+    });
+  if (category & ZEBRA_ZONE)
+    zebra_zone_.registerCallback([this](const ZebraZoneArray& msg) {
+      updateLinkIndex(zebra_zone_link_index_, zebra_zone_.records());
+    });
+  if (category & CROSS_WALK)
+    cross_walk_.registerCallback([this](const CrossWalkArray& msg) {
+      updateLinkIndex(cross_walk_link_index_, cross_walk_.records());
+    });
+  if (category & ROAD_MARK)
+    road_mark_.registerCallback([this](const RoadMarkArray& msg) {
+      updateLinkIndex(road_mark_link_index_, road_mark_.records());
+    });
+  if (category & ROAD_POLE)
+    road_pole_.registerCallback([this](const RoadPoleArray& msg) {
+      updateLinkIndex(road_pole_link_index_, road_pole_.records());
+    });
+  if (category & ROAD_SIGN)
+    road_sign_.registerCallback([this](const RoadSignArray& msg) {
+      updateLinkIndex(road_sign_link_index_, road_sign_.records());
+    });
+  if (category & SIGNAL)
+    signal_.registerCallback([this](const SignalArray& msg) {
+      updateLinkIndex(signal_link_index_, signal_.records());
+    });
+  if (category & STREET_LIGHT)
+    street_light_.registerCallback([this](const StreetLightArray& msg) {
+      updateLinkIndex(street_light_link_index_, street_light_.records());
+    });
+  if (category & UTILITY_POLE)
+    utility_pole_.registerCallback([this](const UtilityPoleArray& msg) {
+      updateLinkIndex(utility_pole_link_index_, utility_pole_.records());
+    });
+  if (category & GUARD_RAIL)
+    guard_rail_.registerCallback([this](const GuardRailArray& msg) {
+      updateLinkIndex(guard_rail_link_index_, guard_rail_.records());
+    });
+  if (category & SIDE_WALK)
+    side_walk_.registerCallback([this](const SideWalkArray& msg) {
+      updateLinkIndex(side_walk_link_index_, side_walk_.records());
+    });
+  if (category & DRIVE_ON_PORTION)
+    drive_on_portion_.registerCallback([this](const DriveOnPortionArray& msg) {
+      updateLinkIndex(drive_on_portion_link_index_, drive_on_portion_.records());
+    });
+  if (category & CROSS_ROAD)
+    cross_road_.registerCallback([this](const CrossRoadArray& msg) {
+      updateLinkIndex(cross_road_link_index_, cross_road_.records());
+    });
+  if (category & SIDE_STRIP)
+    side_strip_.registerCallback([this](const SideStripArray& msg) {
+      updateLinkIndex(side_strip_link_index_, side_strip_.records());
+    });
+  if (category & CURVE_MIRROR)
+    curve_mirror_.registerCallback([this](const CurveMirrorArray& msg) {
+      updateLinkIndex(curve_mirror_link_index_, curve_mirror_.records());
+    });
+  if (category & WALL)
+    wall_.registerCallback([this](const WallArray& msg) {
+      updateLinkIndex(wall_link_index_, wall_.records());
+    });
+  if (category & FENCE)
+    fence_.registerCallback([this](const FenceArray& msg) {
+      updateLinkIndex(fence_link_index_, fence_.records());
+    });
+  if (category & RAIL_CROSSING)
+    rail_crossing_.registerCallback([this](const RailCrossingArray& msg) {
+      updateLinkIndex(rail_crossing_link_index_, rail_crossing_.records());
+    });
+}
+
+void VectorMap::updateSpatialIndex(category_t category)
+{
+  if (category & POINT)
+    buildSpatialIndex<Point>(*this, findByFilter([](const Point& point) { return true; }),
+                             [](const Point& point) { return point.pid; }, spatial_index_cell_size_, point_index_);
+  if (category & DTLANE)
+    buildSpatialIndex<DTLane>(*this, findByFilter([](const DTLane& dtlane) { return true; }),
+                              [](const DTLane& dtlane) { return dtlane.did; }, spatial_index_cell_size_,
+                              dtlane_index_);
+  if (category & LANE)
+    buildSpatialIndex<Lane>(*this, findByFilter([](const Lane& lane) { return true; }),
+                            [](const Lane& lane) { return lane.lnid; }, spatial_index_cell_size_, lane_index_);
+  if (category & STOP_LINE)
+    buildSpatialIndex<StopLine>(*this, findByFilter([](const StopLine& stop_line) { return true; }),
+                                [](const StopLine& stop_line) { return stop_line.id; }, spatial_index_cell_size_,
+                                stop_line_index_);
+  if (category & CROSS_WALK)
+    buildSpatialIndex<CrossWalk>(*this, findByFilter([](const CrossWalk& cross_walk) { return true; }),
+                                 [](const CrossWalk& cross_walk) { return cross_walk.id; }, spatial_index_cell_size_,
+                                 cross_walk_index_);
+}
+
+VectorMap::VectorMap() : spatial_index_cell_size_(10.0)
+{
 }
 
-VectorMap::VectorMap()
+void VectorMap::setSpatialIndexCellSize(double cell_size)
 {
+  if (cell_size == spatial_index_cell_size_)
+    return;
+  spatial_index_cell_size_ = cell_size;
+  updateSpatialIndex(POINT | DTLANE | LANE | STOP_LINE | CROSS_WALK);
 }
 
 void VectorMap::subscribe(ros::NodeHandle& nh, category_t category)
@@ -1062,6 +1366,213 @@ std::vector<RailCrossing> VectorMap::findByFilter(const Filter<RailCrossing>& fi
   return rail_crossing_.findByFilter(filter);
 }
 
+std::vector<Node> VectorMap::findNodesByPoint(const Key<Point>& key) const
+{
+  return findByReference(node_, point_node_index_, key.getId());
+}
+
+std::vector<Lane> VectorMap::findLanesByStartNode(const Key<Node>& key) const
+{
+  return findByReference(lane_, start_node_lane_index_, key.getId());
+}
+
+std::vector<Lane> VectorMap::findLanesByEndNode(const Key<Node>& key) const
+{
+  return findByReference(lane_, end_node_lane_index_, key.getId());
+}
+
+template <>
+std::vector<RoadEdge> VectorMap::findByLinkId<RoadEdge>(const Key<Lane>& key) const
+{
+  return findByReference(road_edge_, road_edge_link_index_, key.getId());
+}
+
+template <>
+std::vector<Gutter> VectorMap::findByLinkId<Gutter>(const Key<Lane>& key) const
+{
+  return findByReference(gutter_, gutter_link_index_, key.getId());
+}
+
+template <>
+std::vector<Curb> VectorMap::findByLinkId<Curb>(const Key<Lane>& key) const
+{
+  return findByReference(curb_, curb_link_index_, key.getId());
+}
+
+template <>
+std::vector<WhiteLine> VectorMap::findByLinkId<WhiteLine>(const Key<Lane>& key) const
+{
+  return findByReference(white_line_, white_line_link_index_, key.getId());
+}
+
+template <>
+std::vector<StopLine> VectorMap::findByLinkId<StopLine>(const Key<Lane>& key) const
+{
+  return findByReference(stop_line_, stop_line_link_index_, key.getId());
+}
+
+template <>
+std::vector<ZebraZone> VectorMap::findByLinkId<ZebraZone>(const Key<Lane>& key) const
+{
+  return findByReference(zebra_zone_, zebra_zone_link_index_, key.getId());
+}
+
+template <>
+std::vector<CrossWalk> VectorMap::findByLinkId<CrossWalk>(const Key<Lane>& key) const
+{
+  return findByReference(cross_walk_, cross_walk_link_index_, key.getId());
+}
+
+template <>
+std::vector<RoadMark> VectorMap::findByLinkId<RoadMark>(const Key<Lane>& key) const
+{
+  return findByReference(road_mark_, road_mark_link_index_, key.getId());
+}
+
+template <>
+std::vector<RoadPole> VectorMap::findByLinkId<RoadPole>(const Key<Lane>& key) const
+{
+  return findByReference(road_pole_, road_pole_link_index_, key.getId());
+}
+
+template <>
+std::vector<RoadSign> VectorMap::findByLinkId<RoadSign>(const Key<Lane>& key) const
+{
+  return findByReference(road_sign_, road_sign_link_index_, key.getId());
+}
+
+template <>
+std::vector<Signal> VectorMap::findByLinkId<Signal>(const Key<Lane>& key) const
+{
+  return findByReference(signal_, signal_link_index_, key.getId());
+}
+
+template <>
+std::vector<StreetLight> VectorMap::findByLinkId<StreetLight>(const Key<Lane>& key) const
+{
+  return findByReference(street_light_, street_light_link_index_, key.getId());
+}
+
+template <>
+std::vector<UtilityPole> VectorMap::findByLinkId<UtilityPole>(const Key<Lane>& key) const
+{
+  return findByReference(utility_pole_, utility_pole_link_index_, key.getId());
+}
+
+template <>
+std::vector<GuardRail> VectorMap::findByLinkId<GuardRail>(const Key<Lane>& key) const
+{
+  return findByReference(guard_rail_, guard_rail_link_index_, key.getId());
+}
+
+template <>
+std::vector<SideWalk> VectorMap::findByLinkId<SideWalk>(const Key<Lane>& key) const
+{
+  return findByReference(side_walk_, side_walk_link_index_, key.getId());
+}
+
+template <>
+std::vector<DriveOnPortion> VectorMap::findByLinkId<DriveOnPortion>(const Key<Lane>& key) const
+{
+  return findByReference(drive_on_portion_, drive_on_portion_link_index_, key.getId());
+}
+
+template <>
+std::vector<CrossRoad> VectorMap::findByLinkId<CrossRoad>(const Key<Lane>& key) const
+{
+  return findByReference(cross_road_, cross_road_link_index_, key.getId());
+}
+
+template <>
+std::vector<SideStrip> VectorMap::findByLinkId<SideStrip>(const Key<Lane>& key) const
+{
+  return findByReference(side_strip_, side_strip_link_index_, key.getId());
+}
+
+template <>
+std::vector<CurveMirror> VectorMap::findByLinkId<CurveMirror>(const Key<Lane>& key) const
+{
+  return findByReference(curve_mirror_, curve_mirror_link_index_, key.getId());
+}
+
+template <>
+std::vector<Wall> VectorMap::findByLinkId<Wall>(const Key<Lane>& key) const
+{
+  return findByReference(wall_, wall_link_index_, key.getId());
+}
+
+template <>
+std::vector<Fence> VectorMap::findByLinkId<Fence>(const Key<Lane>& key) const
+{
+  return findByReference(fence_, fence_link_index_, key.getId());
+}
+
+template <>
+std::vector<RailCrossing> VectorMap::findByLinkId<RailCrossing>(const Key<Lane>& key) const
+{
+  return findByReference(rail_crossing_, rail_crossing_link_index_, key.getId());
+}
+
+std::vector<Point> VectorMap::findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                               const Filter<Point>& filter) const
+{
+  return findWithinRadiusInIndex(*this, point_index_, position, radius, filter);
+}
+
+std::vector<DTLane> VectorMap::findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                                const Filter<DTLane>& filter) const
+{
+  return findWithinRadiusInIndex(*this, dtlane_index_, position, radius, filter);
+}
+
+std::vector<Lane> VectorMap::findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                              const Filter<Lane>& filter) const
+{
+  return findWithinRadiusInIndex(*this, lane_index_, position, radius, filter);
+}
+
+std::vector<StopLine> VectorMap::findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                                  const Filter<StopLine>& filter) const
+{
+  return findWithinRadiusInIndex(*this, stop_line_index_, position, radius, filter);
+}
+
+std::vector<CrossWalk> VectorMap::findWithinRadius(const geometry_msgs::Point& position, double radius,
+                                                   const Filter<CrossWalk>& filter) const
+{
+  return findWithinRadiusInIndex(*this, cross_walk_index_, position, radius, filter);
+}
+
+Point VectorMap::findNearest(const geometry_msgs::Point& position, double max_distance,
+                             const Filter<Point>& filter) const
+{
+  return findNearestInIndex(*this, point_index_, position, max_distance, filter);
+}
+
+DTLane VectorMap::findNearest(const geometry_msgs::Point& position, double max_distance,
+                              const Filter<DTLane>& filter) const
+{
+  return findNearestInIndex(*this, dtlane_index_, position, max_distance, filter);
+}
+
+Lane VectorMap::findNearest(const geometry_msgs::Point& position, double max_distance,
+                            const Filter<Lane>& filter) const
+{
+  return findNearestInIndex(*this, lane_index_, position, max_distance, filter);
+}
+
+StopLine VectorMap::findNearest(const geometry_msgs::Point& position, double max_distance,
+                                const Filter<StopLine>& filter) const
+{
+  return findNearestInIndex(*this, stop_line_index_, position, max_distance, filter);
+}
+
+CrossWalk VectorMap::findNearest(const geometry_msgs::Point& position, double max_distance,
+                                 const Filter<CrossWalk>& filter) const
+{
+  return findNearestInIndex(*this, cross_walk_index_, position, max_distance, filter);
+}
+
 void VectorMap::registerCallback(const Callback<PointArray>& cb)
 {
   point_.registerCallback(cb);
@@ -1626,6 +2137,289 @@ Vector convertGeomQuaternionToVector(const geometry_msgs::Quaternion& geom_quate
   vector.hang = -convertRadianToDegree(yaw) + 90;
   return vector;
 }
+
+void readColumns(const CsvReader& reader, Point& obj)
+{
+  obj.pid = reader.getInt(0);
+  obj.b = reader.getDouble(1);
+  obj.l = reader.getDouble(2);
+  obj.h = reader.getDouble(3);
+  obj.bx = reader.getDouble(4);
+  obj.ly = reader.getDouble(5);
+  obj.ref = reader.getInt(6);
+  obj.mcode1 = reader.getInt(7);
+  obj.mcode2 = reader.getInt(8);
+  obj.mcode3 = reader.getInt(9);
+}
+
+void readColumns(const CsvReader& reader, Vector& obj)
+{
+  obj.vid = reader.getInt(0);
+  obj.pid = reader.getInt(1);
+  obj.hang = reader.getDouble(2);
+  obj.vang = reader.getDouble(3);
+}
+
+void readColumns(const CsvReader& reader, Line& obj)
+{
+  obj.lid = reader.getInt(0);
+  obj.bpid = reader.getInt(1);
+  obj.fpid = reader.getInt(2);
+  obj.blid = reader.getInt(3);
+  obj.flid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, Area& obj)
+{
+  obj.aid = reader.getInt(0);
+  obj.slid = reader.getInt(1);
+  obj.elid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, Pole& obj)
+{
+  obj.plid = reader.getInt(0);
+  obj.vid = reader.getInt(1);
+  obj.length = reader.getDouble(2);
+  obj.dim = reader.getDouble(3);
+}
+
+void readColumns(const CsvReader& reader, Box& obj)
+{
+  obj.bid = reader.getInt(0);
+  obj.pid1 = reader.getInt(1);
+  obj.pid2 = reader.getInt(2);
+  obj.pid3 = reader.getInt(3);
+  obj.pid4 = reader.getInt(4);
+  obj.height = reader.getDouble(5);
+}
+
+void readColumns(const CsvReader& reader, DTLane& obj)
+{
+  obj.did = reader.getInt(0);
+  obj.dist = reader.getDouble(1);
+  obj.pid = reader.getInt(2);
+  obj.dir = reader.getDouble(3);
+  obj.apara = reader.getDouble(4);
+  obj.r = reader.getDouble(5);
+  obj.slope = reader.getDouble(6);
+  obj.cant = reader.getDouble(7);
+  obj.lw = reader.getDouble(8);
+  obj.rw = reader.getDouble(9);
+}
+
+void readColumns(const CsvReader& reader, Node& obj)
+{
+  obj.nid = reader.getInt(0);
+  obj.pid = reader.getInt(1);
+}
+
+// Older lane.csv files end at lno or lanecfgfg, the missing columns read as 0
+void readColumns(const CsvReader& reader, Lane& obj)
+{
+  obj.lnid = reader.getInt(0);
+  obj.did = reader.getInt(1);
+  obj.blid = reader.getInt(2);
+  obj.flid = reader.getInt(3);
+  obj.bnid = reader.getInt(4);
+  obj.fnid = reader.getInt(5);
+  obj.jct = reader.getInt(6);
+  obj.blid2 = reader.getInt(7);
+  obj.blid3 = reader.getInt(8);
+  obj.blid4 = reader.getInt(9);
+  obj.flid2 = reader.getInt(10);
+  obj.flid3 = reader.getInt(11);
+  obj.flid4 = reader.getInt(12);
+  obj.clossid = reader.getInt(13);
+  obj.span = reader.getDouble(14);
+  obj.lcnt = reader.getInt(15);
+  obj.lno = reader.getInt(16);
+  obj.lanetype = reader.getInt(17);
+  obj.limitvel = reader.getInt(18);
+  obj.refvel = reader.getInt(19);
+  obj.roadsecid = reader.getInt(20);
+  obj.lanecfgfg = reader.getInt(21);
+  obj.linkwaid = reader.getInt(22);
+}
+
+void readColumns(const CsvReader& reader, WayArea& obj)
+{
+  obj.waid = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+}
+
+void readColumns(const CsvReader& reader, RoadEdge& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, Gutter& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.type = reader.getInt(2);
+  obj.linkid = reader.getInt(3);
+}
+
+void readColumns(const CsvReader& reader, Curb& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.height = reader.getDouble(2);
+  obj.width = reader.getDouble(3);
+  obj.dir = reader.getInt(4);
+  obj.linkid = reader.getInt(5);
+}
+
+void readColumns(const CsvReader& reader, WhiteLine& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.width = reader.getDouble(2);
+  obj.type = reader.getInt(4);
+  obj.linkid = reader.getInt(5);
+}
+
+void readColumns(const CsvReader& reader, StopLine& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.tlid = reader.getInt(2);
+  obj.signid = reader.getInt(3);
+  obj.linkid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, ZebraZone& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, CrossWalk& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.type = reader.getInt(2);
+  obj.bdid = reader.getInt(3);
+  obj.linkid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, RoadMark& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.type = reader.getInt(2);
+  obj.linkid = reader.getInt(3);
+}
+
+void readColumns(const CsvReader& reader, RoadPole& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.plid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, RoadSign& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.vid = reader.getInt(1);
+  obj.plid = reader.getInt(2);
+  obj.type = reader.getInt(3);
+  obj.linkid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, Signal& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.vid = reader.getInt(1);
+  obj.plid = reader.getInt(2);
+  obj.type = reader.getInt(3);
+  obj.linkid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, StreetLight& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.plid = reader.getInt(2);
+  obj.linkid = reader.getInt(3);
+}
+
+void readColumns(const CsvReader& reader, UtilityPole& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.plid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, GuardRail& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.type = reader.getInt(2);
+  obj.linkid = reader.getInt(3);
+}
+
+void readColumns(const CsvReader& reader, SideWalk& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, DriveOnPortion& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, CrossRoad& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, SideStrip& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.lid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, CurveMirror& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.vid = reader.getInt(1);
+  obj.plid = reader.getInt(2);
+  obj.type = reader.getInt(3);
+  obj.linkid = reader.getInt(4);
+}
+
+void readColumns(const CsvReader& reader, Wall& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, Fence& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
+
+void readColumns(const CsvReader& reader, RailCrossing& obj)
+{
+  obj.id = reader.getInt(0);
+  obj.aid = reader.getInt(1);
+  obj.linkid = reader.getInt(2);
+}
 } // namespace vector_map
 
 std::ostream& operator<<(std::ostream& os, const vector_map::Point& obj)
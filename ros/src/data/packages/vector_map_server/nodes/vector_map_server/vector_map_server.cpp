@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include <geometry_msgs/PoseStamped.h>
 #include "autoware_msgs/Lane.h"
 #include <visualization_msgs/MarkerArray.h>
@@ -212,9 +214,9 @@ std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point&
 std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
+  for (const auto& node : vmap.findNodesByPoint(Key<Point>(start_point.pid)))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
+    for (const auto& lane : vmap.findLanesByStartNode(Key<Node>(node.nid)))
       lanes.push_back(lane);
   }
   return lanes;
@@ -223,14 +225,33 @@ std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& star
 std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
 {
   std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
+  for (const auto& node : vmap.findNodesByPoint(Key<Point>(end_point.pid)))
   {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
+    for (const auto& lane : vmap.findLanesByEndNode(Key<Node>(node.nid)))
       lanes.push_back(lane);
   }
   return lanes;
 }
 
+// Same lanes, in the same id order, as filtering all lanes by flid to flid4
+std::vector<Lane> findNextLanes(const VectorMap& vmap, const Lane& lane)
+{
+  std::vector<int> lnids = { lane.flid, lane.flid2, lane.flid3, lane.flid4 };
+  std::sort(lnids.begin(), lnids.end());
+  lnids.erase(std::unique(lnids.begin(), lnids.end()), lnids.end());
+
+  std::vector<Lane> next_lanes;
+  for (int lnid : lnids)
+  {
+    if (lnid == 0)
+      continue;
+    Lane next_lane = vmap.findByKey(Key<Lane>(lnid));
+    if (next_lane.lnid != 0)
+      next_lanes.push_back(next_lane);
+  }
+  return next_lanes;
+}
+
 Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
 {
   Lane start_lane;
@@ -386,12 +407,7 @@ std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::La
         return null_lanes;
 
       double max_score = -DBL_MAX;
-      Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
-        {
-          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
-                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
-        };
-      for (const auto& lane : vmap.findByFilter(is_next_lane))
+      for (const auto& lane : findNextLanes(vmap, current_lane))
       {
         Lane next_lane = lane;
         Point next_point = findEndPoint(vmap, next_lane);
@@ -671,8 +687,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_edge : vmap_.findByFilter(
-           [&lane](const RoadEdge& road_edge){return road_edge.linkid == lane.lnid;}))
+      for (const auto& road_edge : vmap_.findByLinkId<RoadEdge>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_edge);
     }
     return true;
@@ -687,8 +702,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& gutter : vmap_.findByFilter(
-           [&lane](const Gutter& gutter){return gutter.linkid == lane.lnid;}))
+      for (const auto& gutter : vmap_.findByLinkId<Gutter>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(gutter);
     }
     return true;
@@ -703,8 +717,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curb : vmap_.findByFilter(
-           [&lane](const Curb& curb){return curb.linkid == lane.lnid;}))
+      for (const auto& curb : vmap_.findByLinkId<Curb>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(curb);
     }
     return true;
@@ -719,8 +732,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& white_line : vmap_.findByFilter(
-           [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;}))
+      for (const auto& white_line : vmap_.findByLinkId<WhiteLine>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(white_line);
     }
     return true;
@@ -735,8 +747,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& stop_line : vmap_.findByFilter(
-           [&lane](const StopLine& stop_line){return stop_line.linkid == lane.lnid;}))
+      for (const auto& stop_line : vmap_.findByLinkId<StopLine>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(stop_line);
     }
     return true;
@@ -751,8 +762,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& zebra_zone : vmap_.findByFilter(
-           [&lane](const ZebraZone& zebra_zone){return zebra_zone.linkid == lane.lnid;}))
+      for (const auto& zebra_zone : vmap_.findByLinkId<ZebraZone>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(zebra_zone);
     }
     return true;
@@ -767,8 +777,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_walk : vmap_.findByFilter(
-           [&lane](const CrossWalk& cross_walk){return cross_walk.linkid == lane.lnid;}))
+      for (const auto& cross_walk : vmap_.findByLinkId<CrossWalk>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(cross_walk);
     }
     return true;
@@ -783,8 +792,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_mark : vmap_.findByFilter(
-           [&lane](const RoadMark& road_mark){return road_mark.linkid == lane.lnid;}))
+      for (const auto& road_mark : vmap_.findByLinkId<RoadMark>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_mark);
     }
     return true;
@@ -799,8 +807,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_pole : vmap_.findByFilter(
-           [&lane](const RoadPole& road_pole){return road_pole.linkid == lane.lnid;}))
+      for (const auto& road_pole : vmap_.findByLinkId<RoadPole>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_pole);
     }
     return true;
@@ -815,8 +822,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_sign : vmap_.findByFilter(
-           [&lane](const RoadSign& road_sign){return road_sign.linkid == lane.lnid;}))
+      for (const auto& road_sign : vmap_.findByLinkId<RoadSign>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(road_sign);
     }
     return true;
@@ -831,8 +837,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& signal : vmap_.findByFilter(
-           [&lane](const Signal& signal){return signal.linkid == lane.lnid;}))
+      for (const auto& signal : vmap_.findByLinkId<Signal>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(signal);
     }
     return true;
@@ -847,8 +852,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& street_light : vmap_.findByFilter(
-           [&lane](const StreetLight& street_light){return street_light.linkid == lane.lnid;}))
+      for (const auto& street_light : vmap_.findByLinkId<StreetLight>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(street_light);
     }
     return true;
@@ -863,8 +867,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& utility_pole : vmap_.findByFilter(
-           [&lane](const UtilityPole& utility_pole){return utility_pole.linkid == lane.lnid;}))
+      for (const auto& utility_pole : vmap_.findByLinkId<UtilityPole>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(utility_pole);
     }
     return true;
@@ -879,8 +882,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& guard_rail : vmap_.findByFilter(
-           [&lane](const GuardRail& guard_rail){return guard_rail.linkid == lane.lnid;}))
+      for (const auto& guard_rail : vmap_.findByLinkId<GuardRail>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(guard_rail);
     }
     return true;
@@ -895,8 +897,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_walk : vmap_.findByFilter(
-           [&lane](const SideWalk& side_walk){return side_walk.linkid == lane.lnid;}))
+      for (const auto& side_walk : vmap_.findByLinkId<SideWalk>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(side_walk);
     }
     return true;
@@ -911,8 +912,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& drive_on_portion : vmap_.findByFilter(
-           [&lane](const DriveOnPortion& drive_on_portion){return drive_on_portion.linkid == lane.lnid;}))
+      for (const auto& drive_on_portion : vmap_.findByLinkId<DriveOnPortion>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(drive_on_portion);
     }
     return true;
@@ -927,8 +927,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_road : vmap_.findByFilter(
-           [&lane](const CrossRoad& cross_road){return cross_road.linkid == lane.lnid;}))
+      for (const auto& cross_road : vmap_.findByLinkId<CrossRoad>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(cross_road);
     }
     return true;
@@ -943,8 +942,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_strip : vmap_.findByFilter(
-           [&lane](const SideStrip& side_strip){return side_strip.linkid == lane.lnid;}))
+      for (const auto& side_strip : vmap_.findByLinkId<SideStrip>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(side_strip);
     }
     return true;
@@ -959,8 +957,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curve_mirror : vmap_.findByFilter(
-           [&lane](const CurveMirror& curve_mirror){return curve_mirror.linkid == lane.lnid;}))
+      for (const auto& curve_mirror : vmap_.findByLinkId<CurveMirror>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(curve_mirror);
     }
     return true;
@@ -975,8 +972,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& wall : vmap_.findByFilter(
-           [&lane](const Wall& wall){return wall.linkid == lane.lnid;}))
+      for (const auto& wall : vmap_.findByLinkId<Wall>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(wall);
     }
     return true;
@@ -991,8 +987,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& fence : vmap_.findByFilter(
-           [&lane](const Fence& fence){return fence.linkid == lane.lnid;}))
+      for (const auto& fence : vmap_.findByLinkId<Fence>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(fence);
     }
     return true;
@@ -1007,8 +1002,7 @@ public:
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& rail_crossing : vmap_.findByFilter(
-           [&lane](const RailCrossing& rail_crossing){return rail_crossing.linkid == lane.lnid;}))
+      for (const auto& rail_crossing : vmap_.findByLinkId<RailCrossing>(Key<Lane>(lane.lnid)))
         response.objects.data.push_back(rail_crossing);
     }
     return true;
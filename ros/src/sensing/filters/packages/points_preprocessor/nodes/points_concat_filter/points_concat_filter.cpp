@@ -14,6 +14,11 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#include <Eigen/Geometry>
 #include <message_filters/subscriber.h>
 #include <message_filters/sync_policies/approximate_time.h>
 #include <message_filters/synchronizer.h>
@@ -23,6 +28,7 @@
 #include <pcl_ros/transforms.h>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
+#include <std_msgs/Float32.h>
 #include <tf/tf.h>
 #include <tf/transform_listener.h>
 #include <velodyne_pointcloud/point_types.h>
@@ -47,22 +53,41 @@ private:
   message_filters::Synchronizer<SyncPolicyT> *cloud_synchronizer_;
   ros::Subscriber config_subscriber_;
   ros::Publisher cloud_publisher_;
+  ros::Publisher latency_publisher_;
   tf::TransformListener tf_listener_;
 
   size_t input_topics_size_;
   std::string input_topics_;
   std::string output_frame_id_;
+  bool use_static_transforms_;
+  bool keep_ring_and_time_;
+
+  // Offsets of the fields read from an input cloud, -1 if the field is missing
+  struct FieldOffsets
+  {
+    int x, y, z, intensity, ring, time;
+  };
+
+  std::map<std::string, Eigen::Affine3f> static_transforms_;
+  PointCloudMsgT output_cloud_;
 
   void pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
                            const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
                            const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
                            const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8);
+
+  bool concatenate_with_tf(const PointCloudMsgT::ConstPtr *msgs);
+  bool concatenate_with_static_transforms(const PointCloudMsgT::ConstPtr *msgs);
+  bool get_static_transform(const std::string &frame_id, Eigen::Affine3f &transform);
+  static int find_field(const PointCloudMsgT &msg, const std::string &name, uint8_t datatype);
 };
 
 PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_("~"), tf_listener_()
 {
   private_node_handle_.param("input_topics", input_topics_, std::string("[/points_alpha, /points_beta]"));
   private_node_handle_.param("output_frame_id", output_frame_id_, std::string("velodyne"));
+  private_node_handle_.param("use_static_transforms", use_static_transforms_, false);
+  private_node_handle_.param("keep_ring_and_time", keep_ring_and_time_, false);
 
   YAML::Node topics = YAML::Load(input_topics_);
   input_topics_size_ = topics.size();
@@ -90,6 +115,27 @@ PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_(
   cloud_synchronizer_->registerCallback(
       boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1, _2, _3, _4, _5, _6, _7, _8));
   cloud_publisher_ = node_handle_.advertise<PointCloudMsgT>("/points_concat", 1);
+  latency_publisher_ = node_handle_.advertise<std_msgs::Float32>("/points_concat_latency", 1);
+
+  // x, y, z, intensity (float32), then ring (uint16) and time (float32) if requested
+  const char *field_names[] = { "x", "y", "z", "intensity", "ring", "time" };
+  const uint8_t field_types[] = { sensor_msgs::PointField::FLOAT32, sensor_msgs::PointField::FLOAT32,
+                                  sensor_msgs::PointField::FLOAT32, sensor_msgs::PointField::FLOAT32,
+                                  sensor_msgs::PointField::UINT16,  sensor_msgs::PointField::FLOAT32 };
+  const uint32_t field_offsets[] = { 0, 4, 8, 12, 16, 20 };
+  size_t field_num = keep_ring_and_time_ ? 6 : 4;
+  for (size_t i = 0; i < field_num; ++i)
+  {
+    sensor_msgs::PointField field;
+    field.name = field_names[i];
+    field.offset = field_offsets[i];
+    field.datatype = field_types[i];
+    field.count = 1;
+    output_cloud_.fields.push_back(field);
+  }
+  output_cloud_.height = 1;
+  output_cloud_.is_bigendian = false;
+  output_cloud_.point_step = keep_ring_and_time_ ? 24 : 16;
 }
 
 void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
@@ -100,6 +146,26 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   assert(2 <= input_topics_size_ && input_topics_size_ <= 8);
 
   PointCloudMsgT::ConstPtr msgs[8] = { msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8 };
+
+  bool published = use_static_transforms_ ? concatenate_with_static_transforms(msgs) : concatenate_with_tf(msgs);
+  if (!published)
+  {
+    return;
+  }
+
+  // publish latency from the newest input [ms]
+  ros::Time newest_stamp = msgs[0]->header.stamp;
+  for (size_t i = 1; i < input_topics_size_; ++i)
+  {
+    newest_stamp = std::max(newest_stamp, msgs[i]->header.stamp);
+  }
+  std_msgs::Float32 latency;
+  latency.data = (ros::Time::now() - newest_stamp).toSec() * 1000.0;
+  latency_publisher_.publish(latency);
+}
+
+bool PointsConcatFilter::concatenate_with_tf(const PointCloudMsgT::ConstPtr *msgs)
+{
   PointCloudT::Ptr cloud_sources[8];
   PointCloudT::Ptr cloud_concatenated(new PointCloudT);
 
@@ -119,7 +185,7 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   catch (tf::TransformException &ex)
   {
     ROS_ERROR("%s", ex.what());
-    return;
+    return false;
   }
 
   // merge points
@@ -132,6 +198,147 @@ void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg
   cloud_concatenated->header = pcl_conversions::toPCL(msgs[0]->header);
   cloud_concatenated->header.frame_id = output_frame_id_;
   cloud_publisher_.publish(cloud_concatenated);
+  return true;
+}
+
+bool PointsConcatFilter::concatenate_with_static_transforms(const PointCloudMsgT::ConstPtr *msgs)
+{
+  Eigen::Affine3f transforms[8];
+  FieldOffsets fields[8];
+  size_t first_point[9];
+  bool is_dense = true;
+
+  first_point[0] = 0;
+  for (size_t i = 0; i < input_topics_size_; ++i)
+  {
+    if (!get_static_transform(msgs[i]->header.frame_id, transforms[i]))
+    {
+      return false;
+    }
+    fields[i].x = find_field(*msgs[i], "x", sensor_msgs::PointField::FLOAT32);
+    fields[i].y = find_field(*msgs[i], "y", sensor_msgs::PointField::FLOAT32);
+    fields[i].z = find_field(*msgs[i], "z", sensor_msgs::PointField::FLOAT32);
+    fields[i].intensity = find_field(*msgs[i], "intensity", sensor_msgs::PointField::FLOAT32);
+    fields[i].ring = find_field(*msgs[i], "ring", sensor_msgs::PointField::UINT16);
+    fields[i].time = find_field(*msgs[i], "time", sensor_msgs::PointField::FLOAT32);
+    if (fields[i].x < 0 || fields[i].y < 0 || fields[i].z < 0)
+    {
+      ROS_ERROR("%s has no float32 x, y, z fields", msgs[i]->header.frame_id.c_str());
+      return false;
+    }
+    first_point[i + 1] = first_point[i] + msgs[i]->width * msgs[i]->height;
+    is_dense = is_dense && msgs[i]->is_dense;
+  }
+
+  // The output buffer keeps its capacity between frames
+  const size_t output_step = output_cloud_.point_step;
+  output_cloud_.header = msgs[0]->header;
+  output_cloud_.header.frame_id = output_frame_id_;
+  output_cloud_.width = first_point[input_topics_size_];
+  output_cloud_.row_step = output_cloud_.width * output_step;
+  output_cloud_.is_dense = is_dense;
+  output_cloud_.data.resize(output_cloud_.row_step);
+
+  // Every input point has its own slot in the output, so the threads never write to the same bytes
+#pragma omp parallel
+  for (size_t i = 0; i < input_topics_size_; ++i)
+  {
+    const PointCloudMsgT &msg = *msgs[i];
+    const FieldOffsets &field = fields[i];
+    const Eigen::Affine3f &transform = transforms[i];
+    const int point_num = static_cast<int>(first_point[i + 1] - first_point[i]);
+
+#pragma omp for
+    for (int j = 0; j < point_num; ++j)
+    {
+      const uint8_t *in = &msg.data[(j / msg.width) * msg.row_step + (j % msg.width) * msg.point_step];
+      uint8_t *out = &output_cloud_.data[(first_point[i] + j) * output_step];
+
+      Eigen::Vector3f point;
+      std::memcpy(&point[0], in + field.x, sizeof(float));
+      std::memcpy(&point[1], in + field.y, sizeof(float));
+      std::memcpy(&point[2], in + field.z, sizeof(float));
+      point = transform * point;
+      std::memcpy(out, point.data(), 3 * sizeof(float));
+
+      float intensity = 0.0f;
+      if (field.intensity >= 0)
+      {
+        std::memcpy(&intensity, in + field.intensity, sizeof(float));
+      }
+      std::memcpy(out + 12, &intensity, sizeof(float));
+
+      if (keep_ring_and_time_)
+      {
+        uint16_t ring = 0;
+        float time = 0.0f;
+        if (field.ring >= 0)
+        {
+          std::memcpy(&ring, in + field.ring, sizeof(uint16_t));
+        }
+        if (field.time >= 0)
+        {
+          std::memcpy(&time, in + field.time, sizeof(float));
+        }
+        std::memcpy(out + 16, &ring, sizeof(uint16_t));
+        std::memset(out + 18, 0, 2);
+        std::memcpy(out + 20, &time, sizeof(float));
+      }
+    }
+  }
+
+  cloud_publisher_.publish(output_cloud_);
+  return true;
+}
+
+bool PointsConcatFilter::get_static_transform(const std::string &frame_id, Eigen::Affine3f &transform)
+{
+  std::map<std::string, Eigen::Affine3f>::const_iterator it = static_transforms_.find(frame_id);
+  if (it != static_transforms_.end())
+  {
+    transform = it->second;
+    return true;
+  }
+
+  // Sensor extrinsics are looked up once, the first time a frame is seen
+  try
+  {
+    tf::StampedTransform stamped_transform;
+    tf_listener_.waitForTransform(output_frame_id_, frame_id, ros::Time(0), ros::Duration(1.0));
+    tf_listener_.lookupTransform(output_frame_id_, frame_id, ros::Time(0), stamped_transform);
+
+    const tf::Matrix3x3 &basis = stamped_transform.getBasis();
+    const tf::Vector3 &origin = stamped_transform.getOrigin();
+    transform.setIdentity();
+    for (int r = 0; r < 3; ++r)
+    {
+      for (int c = 0; c < 3; ++c)
+      {
+        transform.matrix()(r, c) = basis[r][c];
+      }
+      transform.matrix()(r, 3) = origin[r];
+    }
+  }
+  catch (tf::TransformException &ex)
+  {
+    ROS_ERROR("%s", ex.what());
+    return false;
+  }
+
+  static_transforms_[frame_id] = transform;
+  return true;
+}
+
+int PointsConcatFilter::find_field(const PointCloudMsgT &msg, const std::string &name, uint8_t datatype)
+{
+  for (size_t i = 0; i < msg.fields.size(); ++i)
+  {
+    if (msg.fields[i].name == name && msg.fields[i].datatype == datatype)
+    {
+      return msg.fields[i].offset;
+    }
+  }
+  return -1;
 }
 
 int main(int argc, char **argv)
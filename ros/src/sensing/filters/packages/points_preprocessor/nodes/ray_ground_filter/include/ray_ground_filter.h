@@ -64,6 +64,7 @@ private:
 	double              clipping_height_; //the points higher than this will be removed from the input cloud.
 	double              min_point_distance_;//minimum distance from the origin to consider a point as valid
 	double              reclass_distance_threshold_;//distance between points at which re classification will occur
+	bool                high_throughput_mode_;//use counting sort buckets and parallel classification, without colors
 
 	size_t              radial_dividers_num_;
 	size_t              concentric_dividers_num_;
@@ -89,6 +90,35 @@ private:
 	};
 	typedef std::vector<PointXYZIRTColor> PointCloudXYZIRTColor;
 
+	/*!
+	 * Points of a cloud grouped by radial division and ordered by radius inside each one,
+	 * stored as one array per attribute
+	 */
+	struct RadialPoints
+	{
+		std::vector<float>    radius;     //cylindric coords on XY Plane
+		std::vector<float>    height;     //z coordinate
+		std::vector<uint32_t> index;      //index of the point in the source pointcloud
+		std::vector<uint32_t> ray_begin;  //position of the first point of each radial division, plus the total at the end
+	};
+
+	//one point of RadialPoints, to sort a division in one go
+	struct RadialPoint
+	{
+		float    radius;
+		float    height;
+		uint32_t index;
+	};
+
+	//buffers of the high throughput mode, kept between frames
+	RadialPoints          radial_points_;
+	std::vector<uint32_t> radial_div_;
+	std::vector<uint32_t> concentric_div_;
+	std::vector<float>    point_radius_;
+	std::vector<uint32_t> bucket_begin_;
+	std::vector<uint32_t> concentric_order_;
+	std::vector<unsigned char> ground_labels_;
+
 	void update_config_params(const autoware_config_msgs::ConfigRayGroundFilter::ConstPtr& param);
 
 	void publish_cloud(const ros::Publisher& in_publisher,
@@ -117,6 +147,25 @@ private:
 	void ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_radial_ordered_clouds,
 	                        pcl::PointIndices& out_ground_indices,
 	                        pcl::PointIndices& out_no_ground_indices);
+
+	/*!
+	 * Same as ConvertXYZIToRTZColor, without colors. Points are bucketed with counting sorts
+	 * by concentric and radial division, points with non finite x or y are skipped
+	 * @param[in] in_cloud Input Point Cloud to be organized in radial segments
+	 * @param[out] out_radial_points Points ordered by radial division, then by radius
+	 */
+	void ConvertXYZIToRadialPoints(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
+	                               RadialPoints& out_radial_points);
+
+	/*!
+	 * Same as ClassifyPointCloud, the radial divisions are classified in parallel
+	 * @param in_radial_points Points ordered by radial division, then by radius
+	 * @param out_ground_indices Returns the indices of the points classified as ground in the original PointCloud
+	 * @param out_no_ground_indices Returns the indices of the points classified as not ground in the original PointCloud
+	 */
+	void ClassifyRadialPoints(const RadialPoints& in_radial_points,
+	                          pcl::PointIndices& out_ground_indices,
+	                          pcl::PointIndices& out_no_ground_indices);
 	
 
 	/*!
@@ -156,6 +205,7 @@ private:
 	void CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_sensor_cloud);
 	
 friend class RayGroundFilter_clipCloud_Test;
+friend class RayGroundFilter_highThroughputClassification_Test;
 public:
 	RayGroundFilter();
   void Run();
@@ -17,6 +17,7 @@
  */
 #include <iostream>
 #include <algorithm>
+#include <limits>
 #include <vector>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
@@ -119,6 +120,136 @@ void RayGroundFilter::ConvertXYZIToRTZColor(const pcl::PointCloud<pcl::PointXYZI
   }
 }
 
+/*!
+ * Same as ConvertXYZIToRTZColor, without colors. Points are bucketed with counting sorts
+ * by concentric and radial division, points with non finite x or y are skipped
+ * @param[in] in_cloud Input Point Cloud to be organized in radial segments
+ * @param[out] out_radial_points Points ordered by radial division, then by radius
+ */
+void RayGroundFilter::ConvertXYZIToRadialPoints(const pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud,
+    RadialPoints& out_radial_points)
+{
+  const int points_num = in_cloud->points.size();
+  const uint32_t invalid_div = std::numeric_limits<uint32_t>::max();
+  //farther points share the last concentric division, the sort below orders them
+  const uint32_t last_concentric_div = 4 * (uint32_t) points_num + 1024;
+  radial_div_.resize(points_num);
+  concentric_div_.resize(points_num);
+  point_radius_.resize(points_num);
+
+  uint32_t max_concentric_div = 0;
+#pragma omp parallel for reduction(max:max_concentric_div)
+  for (int i = 0; i < points_num; i++)
+  {
+    const pcl::PointXYZI& point = in_cloud->points[i];
+    if (!std::isfinite(point.x) || !std::isfinite(point.y))
+    {
+      radial_div_[i] = invalid_div;
+      continue;
+    }
+
+    auto radius         = (float) sqrt(point.x*point.x + point.y*point.y);
+    auto theta          = (float) atan2(point.y, point.x) * 180 / M_PI;
+    if (theta < 0){ theta+=360; }
+
+    point_radius_[i]    = radius;
+    radial_div_[i]      = std::min((uint32_t) floor(theta/radial_divider_angle_), (uint32_t) radial_dividers_num_ - 1);
+    concentric_div_[i]  = (uint32_t) std::min(floor(fabs(radius/concentric_divider_distance_)), (double) last_concentric_div);
+    max_concentric_div  = std::max(max_concentric_div, concentric_div_[i]);
+  }
+
+  //first pass, stable counting sort by concentric division
+  concentric_order_.resize(points_num);
+  bucket_begin_.assign(max_concentric_div + 2, 0);
+  for (int i = 0; i < points_num; i++)
+  {
+    if (radial_div_[i] != invalid_div)
+      bucket_begin_[concentric_div_[i] + 1]++;
+  }
+  for (size_t b = 1; b < bucket_begin_.size(); b++)
+    bucket_begin_[b] += bucket_begin_[b - 1];
+  for (int i = 0; i < points_num; i++)
+  {
+    if (radial_div_[i] != invalid_div)
+      concentric_order_[bucket_begin_[concentric_div_[i]]++] = i;
+  }
+  concentric_order_.resize(bucket_begin_[max_concentric_div]);
+
+  //second pass, stable counting sort by radial division
+  std::vector<uint32_t>& ray_begin = out_radial_points.ray_begin;
+  ray_begin.assign(radial_dividers_num_ + 1, 0);
+  for (size_t k = 0; k < concentric_order_.size(); k++)
+    ray_begin[radial_div_[concentric_order_[k]] + 1]++;
+  for (size_t r = 1; r < ray_begin.size(); r++)
+    ray_begin[r] += ray_begin[r - 1];
+
+  const size_t valid_num = concentric_order_.size();
+  out_radial_points.radius.resize(valid_num);
+  out_radial_points.height.resize(valid_num);
+  out_radial_points.index.resize(valid_num);
+  bucket_begin_.assign(ray_begin.begin(), ray_begin.end() - 1);
+  for (size_t k = 0; k < valid_num; k++)
+  {
+    const uint32_t i = concentric_order_[k];
+    const uint32_t position = bucket_begin_[radial_div_[i]]++;
+    out_radial_points.radius[position] = point_radius_[i];
+    out_radial_points.height[position] = in_cloud->points[i].z;
+    out_radial_points.index[position]  = i;
+  }
+
+  //order radial points on each division, points of the same concentric division are already next to each other.
+  //The insertion sort only has to fix the order inside the concentric divisions, if that takes too many moves
+  //(crowded divisions, or far points sharing the last one) the division is stable sorted instead
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int r = 0; r < (int) radial_dividers_num_; r++)
+  {
+    float* radius = out_radial_points.radius.data();
+    float* height = out_radial_points.height.data();
+    uint32_t* index = out_radial_points.index.data();
+    const uint32_t begin = ray_begin[r];
+    const uint32_t end = ray_begin[r + 1];
+    const uint64_t max_moves = 16 * (uint64_t) (end - begin);
+    uint64_t moves = 0;
+    uint32_t j = begin + 1;
+    for (; j < end && moves <= max_moves; j++)
+    {
+      const float key_radius = radius[j];
+      const float key_height = height[j];
+      const uint32_t key_index = index[j];
+      uint32_t k = j;
+      for (; k > begin && radius[k - 1] > key_radius; k--)
+      {
+        radius[k] = radius[k - 1];
+        height[k] = height[k - 1];
+        index[k]  = index[k - 1];
+      }
+      moves += j - k;
+      radius[k] = key_radius;
+      height[k] = key_height;
+      index[k]  = key_index;
+    }
+
+    if (j < end)
+    {
+      std::vector<RadialPoint> points(end - begin);
+      for (uint32_t k = begin; k < end; k++)
+      {
+        points[k - begin].radius = radius[k];
+        points[k - begin].height = height[k];
+        points[k - begin].index  = index[k];
+      }
+      std::stable_sort(points.begin(), points.end(),
+                       [](const RadialPoint& a, const RadialPoint& b) { return a.radius < b.radius; });
+      for (uint32_t k = begin; k < end; k++)
+      {
+        radius[k] = points[k - begin].radius;
+        height[k] = points[k - begin].height;
+        index[k]  = points[k - begin].index;
+      }
+    }
+  }
+}
+
 /*!
  * Classifies Points in the PointCoud as Ground and Not Ground
  * @param in_radial_ordered_clouds Vector of an Ordered PointsCloud ordered by radial distance from the origin
@@ -201,6 +332,84 @@ void RayGroundFilter::ClassifyPointCloud(std::vector<PointCloudXYZIRTColor>& in_
   }
 }
 
+/*!
+ * Same as ClassifyPointCloud, the radial divisions are classified in parallel
+ * @param in_radial_points Points ordered by radial division, then by radius
+ * @param out_ground_indices Returns the indices of the points classified as ground in the original PointCloud
+ * @param out_no_ground_indices Returns the indices of the points classified as not ground in the original PointCloud
+ */
+void RayGroundFilter::ClassifyRadialPoints(const RadialPoints& in_radial_points,
+    pcl::PointIndices& out_ground_indices,
+    pcl::PointIndices& out_no_ground_indices)
+{
+  const std::vector<uint32_t>& ray_begin = in_radial_points.ray_begin;
+  const float* radius = in_radial_points.radius.data();
+  const float* height = in_radial_points.height.data();
+  const double local_slope = tan(DEG2RAD(local_max_slope_));
+  const double general_slope = tan(DEG2RAD(general_max_slope_));
+  ground_labels_.resize(in_radial_points.index.size());
+
+#pragma omp parallel for schedule(dynamic, 64)
+  for (int i = 0; i < (int) ray_begin.size() - 1; i++)//sweep through each radial division
+  {
+    float prev_radius = 0.f;
+    float prev_height = - sensor_height_;
+    bool prev_ground = false;
+    bool current_ground = false;
+    for (uint32_t j = ray_begin[i]; j < ray_begin[i + 1]; j++)//loop through each point in the radial div
+    {
+      float points_distance = radius[j] - prev_radius;
+      float height_threshold = local_slope * points_distance;
+      float current_height = height[j];
+      float general_height_threshold = general_slope * radius[j];
+
+      //for points which are very close causing the height threshold to be tiny, set a minimum value
+      if (points_distance > concentric_divider_distance_ && height_threshold < min_height_threshold_)
+      { height_threshold = min_height_threshold_; }
+
+      //check current point height against the LOCAL threshold (previous point)
+      if (current_height <= (prev_height + height_threshold)
+          && current_height >= (prev_height - height_threshold)
+         )
+      {
+        //Check again using general geometry (radius from origin) if previous points wasn't ground
+        if (!prev_ground)
+        {
+          current_ground = (current_height <= (-sensor_height_ + general_height_threshold)
+              && current_height >= (-sensor_height_ - general_height_threshold));
+        }
+        else
+        {
+          current_ground = true;
+        }
+      }
+      else
+      {
+        //check if previous point is too far from previous one, if so classify again
+        current_ground = (points_distance > reclass_distance_threshold_ &&
+            (current_height <= (-sensor_height_ + height_threshold)
+             && current_height >= (-sensor_height_ - height_threshold)));
+      }
+
+      ground_labels_[j] = current_ground;
+      prev_ground = current_ground;
+      prev_radius = radius[j];
+      prev_height = height[j];
+    }
+  }
+
+  //collect the indices in the same order as ClassifyPointCloud
+  out_ground_indices.indices.clear();
+  out_no_ground_indices.indices.clear();
+  for (size_t j = 0; j < ground_labels_.size(); j++)
+  {
+    if (ground_labels_[j])
+      out_ground_indices.indices.push_back(in_radial_points.index[j]);
+    else
+      out_no_ground_indices.indices.push_back(in_radial_points.index[j]);
+  }
+}
+
 /*!
  * Removes the points higher than a threshold
  * @param in_cloud_ptr PointCloud to perform Clipping
@@ -301,21 +510,29 @@ void RayGroundFilter::CloudCallback(const sensor_msgs::PointCloud2ConstPtr &in_s
   //pcl::PointCloud<pcl::PointXYZINormal>::Ptr cloud_with_normals_ptr (new pcl::PointCloud<pcl::PointXYZINormal>);
   //GetCloudNormals(current_sensor_cloud_ptr, cloud_with_normals_ptr, 5.0);
 
-  PointCloudXYZIRTColor organized_points;
-  std::vector<pcl::PointIndices> radial_division_indices;
-  std::vector<pcl::PointIndices> closest_indices;
-  std::vector<PointCloudXYZIRTColor> radial_ordered_clouds;
-
   radial_dividers_num_ = ceil(360 / radial_divider_angle_);
 
-  ConvertXYZIToRTZColor(filtered_cloud_ptr,
-      organized_points,
-      radial_division_indices,
-      radial_ordered_clouds);
-
   pcl::PointIndices ground_indices, no_ground_indices;
 
-  ClassifyPointCloud(radial_ordered_clouds, ground_indices, no_ground_indices);
+  if (high_throughput_mode_)
+  {
+    ConvertXYZIToRadialPoints(filtered_cloud_ptr, radial_points_);
+
+    ClassifyRadialPoints(radial_points_, ground_indices, no_ground_indices);
+  }
+  else
+  {
+    PointCloudXYZIRTColor organized_points;
+    std::vector<pcl::PointIndices> radial_division_indices;
+    std::vector<PointCloudXYZIRTColor> radial_ordered_clouds;
+
+    ConvertXYZIToRTZColor(filtered_cloud_ptr,
+        organized_points,
+        radial_division_indices,
+        radial_ordered_clouds);
+
+    ClassifyPointCloud(radial_ordered_clouds, ground_indices, no_ground_indices);
+  }
 
   pcl::PointCloud<pcl::PointXYZI>::Ptr ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
   pcl::PointCloud<pcl::PointXYZI>::Ptr no_ground_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
@@ -368,6 +585,8 @@ void RayGroundFilter::Run()
   ROS_INFO("min_point_distance[meters]: %f", min_point_distance_);
   node_handle_.param("reclass_distance_threshold", reclass_distance_threshold_, 0.2);//0.5 meters default
   ROS_INFO("reclass_distance_threshold[meters]: %f", reclass_distance_threshold_);
+  node_handle_.param("high_throughput_mode", high_throughput_mode_, false);
+  ROS_INFO("high_throughput_mode: %d", high_throughput_mode_);
 
 
 #if (CV_MAJOR_VERSION == 3)
@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 #include <ros/ros.h>
 
@@ -8,9 +10,6 @@
 // test fixtures are necessary to use friend classes
 TEST(RayGroundFilter, clipCloud)
 {
-  char* argv = "test_points_preprocessor";
-  int argc = 1;
-  ros::init(argc, &argv, "test_raygroundfilter_clipcloud");
   pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
   pcl::PointCloud<pcl::PointXYZI>::Ptr out_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
 
@@ -53,3 +52,66 @@ TEST(RayGroundFilter, clipCloud)
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].y - 6.0F), TOL);
   ASSERT_LT(fabsf(out_cloud_ptr->points[3].z - 1.5F), TOL);
 }
+
+TEST(RayGroundFilter, highThroughputClassification)
+{
+  pcl::PointCloud<pcl::PointXYZI>::Ptr in_cloud_ptr(new pcl::PointCloud<pcl::PointXYZI>);
+
+  RayGroundFilter rgfilter;
+  rgfilter.sensor_height_ = 1.8;
+  rgfilter.general_max_slope_ = 5.0;
+  rgfilter.local_max_slope_ = 8.0;
+  rgfilter.radial_divider_angle_ = 0.5;
+  rgfilter.concentric_divider_distance_ = 0.01;
+  rgfilter.min_height_threshold_ = 0.05;
+  rgfilter.reclass_distance_threshold_ = 0.2;
+  rgfilter.radial_dividers_num_ = ceil(360 / rgfilter.radial_divider_angle_);
+  rgfilter.colors_.resize(rgfilter.color_num_);
+
+  // flat ground rings with a wall and a box in front of the sensor
+  pcl::PointXYZI pt;
+  pt.intensity = 0.0F;
+  for (int ring = 0; ring < 16; ++ring)
+  {
+    const float range = 3.0F + ring * ring * 0.2F;
+    for (int azimuth = 0; azimuth < 720; ++azimuth)
+    {
+      // in the middle of the radial divisions, so no two points of a division have the same radius
+      const float angle = (azimuth + 0.5F) * 0.5F * M_PI / 180.0F;
+      pt.x = range * cos(angle);
+      pt.y = range * sin(angle);
+      pt.z = -1.8F + 0.01F * (azimuth % 3);
+      if (pt.x > 8.0F && fabsf(pt.y) < 1.0F)
+      {
+        pt.z = -1.0F + 0.1F * ring;
+      }
+      if (pt.y > 10.0F)
+      {
+        pt.x = 10.0F * cos(angle) / sin(angle);
+        pt.y = 10.0F;
+      }
+      in_cloud_ptr->push_back(pt);
+    }
+  }
+
+  RayGroundFilter::PointCloudXYZIRTColor organized_points;
+  std::vector<pcl::PointIndices> radial_division_indices;
+  std::vector<RayGroundFilter::PointCloudXYZIRTColor> radial_ordered_clouds;
+  pcl::PointIndices ground_indices, no_ground_indices;
+  rgfilter.ConvertXYZIToRTZColor(in_cloud_ptr, organized_points, radial_division_indices, radial_ordered_clouds);
+  rgfilter.ClassifyPointCloud(radial_ordered_clouds, ground_indices, no_ground_indices);
+
+  pcl::PointIndices fast_ground_indices, fast_no_ground_indices;
+  rgfilter.ConvertXYZIToRadialPoints(in_cloud_ptr, rgfilter.radial_points_);
+  rgfilter.ClassifyRadialPoints(rgfilter.radial_points_, fast_ground_indices, fast_no_ground_indices);
+
+  // both modes give the same labels
+  ASSERT_GT(ground_indices.indices.size(), 0);
+  ASSERT_GT(no_ground_indices.indices.size(), 0);
+  std::sort(ground_indices.indices.begin(), ground_indices.indices.end());
+  std::sort(fast_ground_indices.indices.begin(), fast_ground_indices.indices.end());
+  std::sort(no_ground_indices.indices.begin(), no_ground_indices.indices.end());
+  std::sort(fast_no_ground_indices.indices.begin(), fast_no_ground_indices.indices.end());
+  ASSERT_EQ(ground_indices.indices, fast_ground_indices.indices);
+  ASSERT_EQ(no_ground_indices.indices, fast_no_ground_indices.indices);
+}
@@ -6,5 +6,6 @@
 int32_t main(int32_t argc, char ** argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "test_points_preprocessor");
   return RUN_ALL_TESTS();
 }
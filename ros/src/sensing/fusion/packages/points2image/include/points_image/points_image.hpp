@@ -17,15 +17,45 @@
 #ifndef _POINTS_IMAGE_H_
 #define _POINTS_IMAGE_H_
 
+#include <vector>
 #include <opencv2/opencv.hpp>
 #include <sensor_msgs/PointCloud2.h>
 #include "autoware_msgs/PointsImage.h"
+#include "autoware_msgs/SparsePointsImage.h"
 
 void resetMatrix();
 autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
                                                 const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
                                                 const cv::Mat& distCoeff, const cv::Size& imageSize);
 
+/* A point projected on the image, pid is the row major index of its pixel */
+struct ProjectedPoint
+{
+  int pid;
+  double depth;
+  float intensity;
+  float min_height;
+  float max_height;
+};
+
+/* Same projection as pointcloud2_to_image, but only the pixels hit by a point are stored,
+ * so the cost depends on the number of points and not on the image size */
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize);
+
+/* Same as above, the projected points are stored in a buffer owned by the caller,
+ * which can be kept from one scan to the next to avoid reallocating it */
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize,
+                                                             std::vector<ProjectedPoint>& projected);
+
+/* Dense PointsImage, as published by pointcloud2_to_image, from a sparse one */
+autoware_msgs::PointsImage sparse_to_dense_image(const autoware_msgs::SparsePointsImage& sparse);
+
 /*points2image::CameraExtrinsic
 pointcloud2_to_3d_calibration(const sensor_msgs::PointCloud2ConstPtr& pointclound2,
             const cv::Mat& cameraExtrinsicMat);
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <vector>
 #include <include/points_image/points_image.hpp>
 #include <stdint.h>
@@ -35,100 +36,217 @@ void initMatrix(const cv::Mat& cameraExtrinsicMat)
   init_matrix = true;
 }
 
-autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
-                                                const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
-                                                const cv::Mat& distCoeff, const cv::Size& imageSize)
+namespace
+{
+bool comparePixel(const ProjectedPoint& a, const ProjectedPoint& b)
+{
+  return a.pid < b.pid;
+}
+}
+
+/* Project every point in front of the camera and inside the image, in scan order */
+static void projectPoints(const sensor_msgs::PointCloud2ConstPtr& pointcloud2, const cv::Mat& cameraMat,
+                          const cv::Mat& distCoeff, const cv::Size& imageSize, std::vector<ProjectedPoint>& projected)
 {
   int w = imageSize.width;
   int h = imageSize.height;
 
-  autoware_msgs::PointsImage msg;
-
-  msg.header = pointcloud2->header;
-
-  msg.intensity.assign(w * h, 0);
-  msg.distance.assign(w * h, 0);
-  msg.min_height.assign(w * h, 0);
-  msg.max_height.assign(w * h, 0);
-
-  uintptr_t cp = (uintptr_t)pointcloud2->data.data();
-
-  msg.max_y = -1;
-  msg.min_y = h;
-
-  msg.image_height = imageSize.height;
-  msg.image_width = imageSize.width;
-  if (!init_matrix)
+  // read the matrices once instead of going through cv::Mat::at for every point
+  double rt[3][3], tt[3];
+  for (int i = 0; i < 3; i++)
   {
-    initMatrix(cameraExtrinsicMat);
+    tt[i] = invTt.at<double>(i);
+    for (int j = 0; j < 3; j++)
+    {
+      rt[j][i] = invRt.at<double>(j, i);
+    }
   }
+  const double k1 = distCoeff.at<double>(0);
+  const double k2 = distCoeff.at<double>(1);
+  const double p1 = distCoeff.at<double>(2);
+  const double p2 = distCoeff.at<double>(3);
+  const double k3 = distCoeff.at<double>(4);
+  const double fx = cameraMat.at<double>(0, 0);
+  const double cx = cameraMat.at<double>(0, 2);
+  const double fy = cameraMat.at<double>(1, 1);
+  const double cy = cameraMat.at<double>(1, 2);
+
+  const uintptr_t cp = (uintptr_t)pointcloud2->data.data();
+  const uint32_t width = pointcloud2->width;
+  const uint32_t point_step = pointcloud2->point_step;
+  const bool has_height_layers = pointcloud2->height == 2;
+
+  projected.clear();
+  projected.reserve(pointcloud2->width * pointcloud2->height);
 
-  cv::Mat point(1, 3, CV_64F);
-  cv::Point2d imagepoint;
   for (uint32_t y = 0; y < pointcloud2->height; ++y)
   {
-    for (uint32_t x = 0; x < pointcloud2->width; ++x)
+    for (uint32_t x = 0; x < width; ++x)
     {
-      float* fp = (float*)(cp + (x + y * pointcloud2->width) * pointcloud2->point_step);
-      double intensity = fp[4];
+      const float* fp = (const float*)(cp + (x + y * width) * point_step);
+      double point[3];
       for (int i = 0; i < 3; i++)
       {
-        point.at<double>(i) = invTt.at<double>(i);
+        point[i] = tt[i];
         for (int j = 0; j < 3; j++)
         {
-          point.at<double>(i) += double(fp[j]) * invRt.at<double>(j, i);
+          point[i] += double(fp[j]) * rt[j][i];
         }
       }
 
-      if (point.at<double>(2) <= 1)
+      if (point[2] <= 1)
       {
         continue;
       }
 
-      double tmpx = point.at<double>(0) / point.at<double>(2);
-      double tmpy = point.at<double>(1) / point.at<double>(2);
+      double tmpx = point[0] / point[2];
+      double tmpy = point[1] / point[2];
       double r2 = tmpx * tmpx + tmpy * tmpy;
-      double tmpdist =
-          1 + distCoeff.at<double>(0) * r2 + distCoeff.at<double>(1) * r2 * r2 + distCoeff.at<double>(4) * r2 * r2 * r2;
-
-      imagepoint.x =
-          tmpx * tmpdist + 2 * distCoeff.at<double>(2) * tmpx * tmpy + distCoeff.at<double>(3) * (r2 + 2 * tmpx * tmpx);
-      imagepoint.y =
-          tmpy * tmpdist + distCoeff.at<double>(2) * (r2 + 2 * tmpy * tmpy) + 2 * distCoeff.at<double>(3) * tmpx * tmpy;
-      imagepoint.x = cameraMat.at<double>(0, 0) * imagepoint.x + cameraMat.at<double>(0, 2);
-      imagepoint.y = cameraMat.at<double>(1, 1) * imagepoint.y + cameraMat.at<double>(1, 2);
-
-      int px = int(imagepoint.x + 0.5);
-      int py = int(imagepoint.y + 0.5);
+      double tmpdist = 1 + k1 * r2 + k2 * r2 * r2 + k3 * r2 * r2 * r2;
+
+      double imagepoint_x = tmpx * tmpdist + 2 * p1 * tmpx * tmpy + p2 * (r2 + 2 * tmpx * tmpx);
+      double imagepoint_y = tmpy * tmpdist + p1 * (r2 + 2 * tmpy * tmpy) + 2 * p2 * tmpx * tmpy;
+      imagepoint_x = fx * imagepoint_x + cx;
+      imagepoint_y = fy * imagepoint_y + cy;
+
+      int px = int(imagepoint_x + 0.5);
+      int py = int(imagepoint_y + 0.5);
       if (0 <= px && px < w && 0 <= py && py < h)
       {
-        int pid = py * w + px;
-        if (msg.distance[pid] == 0 || msg.distance[pid] > point.at<double>(2))
-        {
-          msg.distance[pid] = float(point.at<double>(2) * 100);
-          msg.intensity[pid] = float(intensity);
-
-          msg.max_y = py > msg.max_y ? py : msg.max_y;
-          msg.min_y = py < msg.min_y ? py : msg.min_y;
-        }
-        if (0 == y && pointcloud2->height == 2)  // process simultaneously min and max during the first layer
+        ProjectedPoint projected_point;
+        projected_point.pid = py * w + px;
+        projected_point.depth = point[2];
+        projected_point.intensity = fp[4];
+        if (0 == y && has_height_layers)  // process simultaneously min and max during the first layer
         {
-          float* fp2 = (float*)(cp + (x + (y + 1) * pointcloud2->width) * pointcloud2->point_step);
-          msg.min_height[pid] = fp[2];
-          msg.max_height[pid] = fp2[2];
+          const float* fp2 = (const float*)(cp + (x + (y + 1) * width) * point_step);
+          projected_point.min_height = fp[2];
+          projected_point.max_height = fp2[2];
         }
         else
         {
-          msg.min_height[pid] = -1.25;
-          msg.max_height[pid] = 0;
+          projected_point.min_height = -1.25;
+          projected_point.max_height = 0;
         }
+        projected.push_back(projected_point);
       }
     }
   }
+}
+
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize)
+{
+  std::vector<ProjectedPoint> projected;
+  return pointcloud2_to_sparse_image(pointcloud2, cameraExtrinsicMat, cameraMat, distCoeff, imageSize, projected);
+}
+
+autoware_msgs::SparsePointsImage pointcloud2_to_sparse_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
+                                                             const cv::Mat& cameraExtrinsicMat,
+                                                             const cv::Mat& cameraMat, const cv::Mat& distCoeff,
+                                                             const cv::Size& imageSize,
+                                                             std::vector<ProjectedPoint>& projected)
+{
+  int w = imageSize.width;
+  int h = imageSize.height;
+
+  autoware_msgs::SparsePointsImage msg;
+
+  msg.header = pointcloud2->header;
+
+  msg.max_y = -1;
+  msg.min_y = h;
+
+  msg.image_height = imageSize.height;
+  msg.image_width = imageSize.width;
+  if (!init_matrix)
+  {
+    initMatrix(cameraExtrinsicMat);
+  }
+
+  projectPoints(pointcloud2, cameraMat, distCoeff, imageSize, projected);
+
+  // group the points by pixel, keeping the scan order inside a pixel
+  std::stable_sort(projected.begin(), projected.end(), comparePixel);
+
+  size_t begin = 0;
+  while (begin < projected.size())
+  {
+    const int pid = projected[begin].pid;
+    float distance = 0;
+    float intensity = 0;
+    size_t end = begin;
+    for (; end < projected.size() && projected[end].pid == pid; end++)
+    {
+      if (distance == 0 || distance > projected[end].depth)
+      {
+        distance = float(projected[end].depth * 100);
+        intensity = projected[end].intensity;
+      }
+    }
+    // the height of a pixel is the one of its last point
+    const ProjectedPoint& last = projected[end - 1];
+
+    int px = pid % w;
+    int py = pid / w;
+    msg.x.push_back(px);
+    msg.y.push_back(py);
+    msg.distance.push_back(distance);
+    msg.intensity.push_back(intensity);
+    msg.min_height.push_back(last.min_height);
+    msg.max_height.push_back(last.max_height);
+
+    msg.max_y = py > msg.max_y ? py : msg.max_y;
+    msg.min_y = py < msg.min_y ? py : msg.min_y;
+
+    begin = end;
+  }
 
   return msg;
 }
 
+autoware_msgs::PointsImage sparse_to_dense_image(const autoware_msgs::SparsePointsImage& sparse)
+{
+  int w = sparse.image_width;
+  int h = sparse.image_height;
+
+  autoware_msgs::PointsImage msg;
+
+  msg.header = sparse.header;
+
+  msg.intensity.assign(w * h, 0);
+  msg.distance.assign(w * h, 0);
+  msg.min_height.assign(w * h, 0);
+  msg.max_height.assign(w * h, 0);
+
+  msg.max_y = sparse.max_y;
+  msg.min_y = sparse.min_y;
+
+  msg.image_height = sparse.image_height;
+  msg.image_width = sparse.image_width;
+
+  for (size_t i = 0; i < sparse.x.size(); i++)
+  {
+    int pid = sparse.y[i] * w + sparse.x[i];
+    msg.distance[pid] = sparse.distance[i];
+    msg.intensity[pid] = sparse.intensity[i];
+    msg.min_height[pid] = sparse.min_height[i];
+    msg.max_height[pid] = sparse.max_height[i];
+  }
+
+  return msg;
+}
+
+autoware_msgs::PointsImage pointcloud2_to_image(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
+                                                const cv::Mat& cameraExtrinsicMat, const cv::Mat& cameraMat,
+                                                const cv::Mat& distCoeff, const cv::Size& imageSize)
+{
+  return sparse_to_dense_image(
+      pointcloud2_to_sparse_image(pointcloud2, cameraExtrinsicMat, cameraMat, distCoeff, imageSize));
+}
+
 /*autoware_msgs::CameraExtrinsic
 pointcloud2_to_3d_calibration(const sensor_msgs::PointCloud2ConstPtr& pointcloud2,
             const cv::Mat& cameraExtrinsicMat)
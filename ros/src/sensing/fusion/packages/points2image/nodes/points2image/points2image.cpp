@@ -18,6 +18,7 @@
 #include <sensor_msgs/PointCloud2.h>
 #include <sensor_msgs/CameraInfo.h>
 #include "autoware_msgs/PointsImage.h"
+#include "autoware_msgs/SparsePointsImage.h"
 #include "autoware_msgs/ProjectionMatrix.h"
 //#include "autoware_msgs/CameraExtrinsic.h"
 
@@ -34,6 +35,8 @@ static cv::Mat distCoeff;
 static cv::Size imageSize;
 
 static ros::Publisher pub;
+static ros::Publisher sparse_pub;
+static std::vector<ProjectedPoint> projected_points;
 
 static void projection_callback(const autoware_msgs::ProjectionMatrix& msg)
 {
@@ -80,8 +83,22 @@ static void callback(const sensor_msgs::PointCloud2ConstPtr& msg)
     return;
   }
 
-  autoware_msgs::PointsImage pub_msg = pointcloud2_to_image(msg, cameraExtrinsicMat, cameraMat, distCoeff, imageSize);
-  pub.publish(pub_msg);
+  // project only when somebody listens, the dense image is only built for its own subscribers
+  if (pub.getNumSubscribers() == 0 && sparse_pub.getNumSubscribers() == 0)
+  {
+    return;
+  }
+
+  autoware_msgs::SparsePointsImage sparse_msg =
+      pointcloud2_to_sparse_image(msg, cameraExtrinsicMat, cameraMat, distCoeff, imageSize, projected_points);
+  if (pub.getNumSubscribers() > 0)
+  {
+    pub.publish(sparse_to_dense_image(sparse_msg));
+  }
+  if (sparse_pub.getNumSubscribers() > 0)
+  {
+    sparse_pub.publish(sparse_msg);
+  }
 }
 
 int main(int argc, char* argv[])
@@ -94,6 +111,7 @@ int main(int argc, char* argv[])
   std::string camera_info_topic_str;
   std::string projection_matrix_topic;
   std::string pub_topic_str = "/points_image";
+  std::string sparse_pub_topic_str = "/points_image_sparse";
 
   private_nh.param<std::string>("projection_matrix_topic", projection_matrix_topic, "/projection_matrix");
   private_nh.param<std::string>("camera_info_topic", camera_info_topic_str, "/camera_info");
@@ -109,6 +127,7 @@ int main(int argc, char* argv[])
       name_space_str.erase(name_space_str.begin());
     }
     pub_topic_str = name_space_str + pub_topic_str;
+    sparse_pub_topic_str = name_space_str + sparse_pub_topic_str;
     projection_matrix_topic = name_space_str + projection_matrix_topic;
     camera_info_topic_str = name_space_str + camera_info_topic_str;
   }
@@ -126,6 +145,8 @@ int main(int argc, char* argv[])
 
   ROS_INFO("[points2image]Publishing to... %s", pub_topic_str.c_str());
   pub = n.advertise<autoware_msgs::PointsImage>(pub_topic_str, 10);
+  ROS_INFO("[points2image]Publishing to... %s", sparse_pub_topic_str.c_str());
+  sparse_pub = n.advertise<autoware_msgs::SparsePointsImage>(sparse_pub_topic_str, 10);
 
   ros::Subscriber sub = n.subscribe(points_topic, 1, callback);
 